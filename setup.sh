@@ -118,6 +118,23 @@ setup_python() {
     pip install --upgrade pip -q
     pip install -r "${ROOT}/tools/requirements.txt" -q
     ok "Python deps installed"
+    if python3 "${ROOT}/tools/ingest.py" build >/dev/null; then
+        ok "Serial frame accelerator built"
+    else
+        warn "No C compiler for tools/_pgframe.c — using pure-Python ingestion"
+    fi
+}
+
+build_host_firmware() {
+    if ! have make || ! have cc; then
+        warn "No host compiler — Virtual Lab will use the Python device model"
+        return 0
+    fi
+    if make -C "${ROOT}/usb_dev_keyboard" host >/dev/null; then
+        ok "Host firmware library built (Virtual Lab co-simulation)"
+    else
+        warn "Host firmware build failed — Virtual Lab will use the Python device model"
+    fi
 }
 
 build_firmware() {
@@ -195,6 +212,7 @@ do_setup_virtual() {
     info "Mode: ${BOLD}Virtual Lab${NC} (GUI simulation)"
     install_apt_deps 1
     setup_python
+    build_host_firmware
     ok "Virtual Lab ready!"
     echo ""
     read -r -p "Launch Virtual Lab now? [Y/n]: " launch
@@ -0,0 +1,398 @@
+/*
+ * _pgframe - optional C accelerator for tools/ingest.py.
+ *
+ * scan(chunk, want_lines) splits a block of complete device lines and
+ * returns (items, nlines). Each item is a dict for a flat @PG{...} record,
+ * a str for a text line (only when want_lines is true), or bytes holding a
+ * record this parser does not handle (nesting, escapes), which the caller
+ * hands to json.loads. Anything json.loads would reject (leading zeros, raw
+ * control characters, invalid UTF-8) also goes back as bytes, so both paths
+ * accept exactly the same records.
+ *
+ * Build: python3 tools/ingest.py build
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <string.h>
+
+static const char *SkipSpace(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    {
+        p++;
+    }
+    return p;
+}
+
+/* Parse "..." without escapes or control characters; returns pointer past the closing quote. */
+static const char *ScanString(const char *p, const char *end,
+                              const char **start, Py_ssize_t *len)
+{
+    const char *q;
+
+    if (p >= end || *p != '"')
+    {
+        return NULL;
+    }
+    p++;
+    for (q = p; q < end && *q != '"'; q++)
+    {
+        if (*q == '\\' || (unsigned char)*q < 0x20)
+        {
+            return NULL;
+        }
+    }
+    if (q >= end)
+    {
+        return NULL;
+    }
+    *start = p;
+    *len = q - p;
+    return q + 1;
+}
+
+static const char *SkipDigits(const char *p, const char *end)
+{
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        p++;
+    }
+    return p;
+}
+
+/* A JSON number: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? */
+static PyObject *ParseNumber(const char **pp, const char *end)
+{
+    const char *p = *pp;
+    const char *start = p;
+    const char *digits;
+    int is_float = 0;
+    char buf[64];
+    Py_ssize_t n;
+
+    if (p < end && *p == '-')
+    {
+        p++;
+    }
+    if (p < end && *p == '0')
+    {
+        p++;
+    }
+    else
+    {
+        digits = p;
+        p = SkipDigits(p, end);
+        if (p == digits)
+        {
+            return NULL;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        digits = ++p;
+        p = SkipDigits(p, end);
+        if (p == digits)
+        {
+            return NULL;
+        }
+        is_float = 1;
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        if (p < end && (*p == '+' || *p == '-'))
+        {
+            p++;
+        }
+        digits = p;
+        p = SkipDigits(p, end);
+        if (p == digits)
+        {
+            return NULL;
+        }
+        is_float = 1;
+    }
+    n = p - start;
+    if (n == 0 || n >= (Py_ssize_t)sizeof(buf))
+    {
+        return NULL;
+    }
+    memcpy(buf, start, (size_t)n);
+    buf[n] = '\0';
+    *pp = p;
+
+    if (is_float)
+    {
+        double d = PyOS_string_to_double(buf, NULL, NULL);
+        if (d == -1.0 && PyErr_Occurred())
+        {
+            PyErr_Clear();
+            return NULL;
+        }
+        return PyFloat_FromDouble(d);
+    }
+
+    PyObject *v = PyLong_FromString(buf, NULL, 10);
+    if (!v)
+    {
+        PyErr_Clear();
+    }
+    return v;
+}
+
+/*
+ * Parse a flat JSON object starting at '{'. Returns a new dict, or NULL
+ * without an exception set when the record needs the json fallback.
+ */
+static PyObject *ParseFlatObject(const char *p, const char *end)
+{
+    PyObject *dict = PyDict_New();
+
+    if (!dict)
+    {
+        return NULL;
+    }
+    p = SkipSpace(p + 1, end);
+    if (p < end && *p == '}')
+    {
+        p++;
+        goto done;
+    }
+
+    for (;;)
+    {
+        const char *ks;
+        Py_ssize_t klen;
+        PyObject *key;
+        PyObject *val = NULL;
+
+        p = ScanString(SkipSpace(p, end), end, &ks, &klen);
+        if (!p)
+        {
+            goto fallback;
+        }
+        p = SkipSpace(p, end);
+        if (p >= end || *p != ':')
+        {
+            goto fallback;
+        }
+        p = SkipSpace(p + 1, end);
+        if (p >= end)
+        {
+            goto fallback;
+        }
+
+        if (*p == '"')
+        {
+            const char *vs;
+            Py_ssize_t vlen;
+            p = ScanString(p, end, &vs, &vlen);
+            if (p)
+            {
+                val = PyUnicode_DecodeUTF8(vs, vlen, NULL);
+            }
+        }
+        else if ((*p >= '0' && *p <= '9') || *p == '-')
+        {
+            val = ParseNumber(&p, end);
+        }
+        else if (end - p >= 4 && memcmp(p, "true", 4) == 0)
+        {
+            Py_INCREF(Py_True);
+            val = Py_True;
+            p += 4;
+        }
+        else if (end - p >= 5 && memcmp(p, "false", 5) == 0)
+        {
+            Py_INCREF(Py_False);
+            val = Py_False;
+            p += 5;
+        }
+        else if (end - p >= 4 && memcmp(p, "null", 4) == 0)
+        {
+            Py_INCREF(Py_None);
+            val = Py_None;
+            p += 4;
+        }
+        if (!val || !p)
+        {
+            Py_XDECREF(val);
+            PyErr_Clear();
+            goto fallback;
+        }
+
+        key = PyUnicode_DecodeUTF8(ks, klen, NULL);
+        if (!key)
+        {
+            Py_DECREF(val);
+            PyErr_Clear();
+            goto fallback;
+        }
+        PyUnicode_InternInPlace(&key);
+        if (PyDict_SetItem(dict, key, val) < 0)
+        {
+            Py_DECREF(key);
+            Py_DECREF(val);
+            Py_DECREF(dict);
+            return NULL;
+        }
+        Py_DECREF(key);
+        Py_DECREF(val);
+
+        p = SkipSpace(p, end);
+        if (p < end && *p == ',')
+        {
+            p++;
+            continue;
+        }
+        if (p < end && *p == '}')
+        {
+            p++;
+            break;
+        }
+        goto fallback;
+    }
+
+done:
+    if (SkipSpace(p, end) != end)
+    {
+        goto fallback;
+    }
+    return dict;
+
+fallback:
+    Py_DECREF(dict);
+    return NULL;
+}
+
+static int AppendRecord(PyObject *items, const char *rec, const char *end)
+{
+    PyObject *obj = ParseFlatObject(rec, end);
+    int rc;
+
+    if (!obj)
+    {
+        if (PyErr_Occurred())
+        {
+            return -1;
+        }
+        while (end > rec && end[-1] == '\r')
+        {
+            end--;
+        }
+        obj = PyBytes_FromStringAndSize(rec, end - rec);
+        if (!obj)
+        {
+            return -1;
+        }
+    }
+    rc = PyList_Append(items, obj);
+    Py_DECREF(obj);
+    return rc;
+}
+
+static int AppendText(PyObject *items, const char *p, const char *end)
+{
+    PyObject *text;
+    int rc;
+
+    while (p < end && *p == '\r')
+    {
+        p++;
+    }
+    while (end > p && end[-1] == '\r')
+    {
+        end--;
+    }
+    if (p == end)
+    {
+        return 0;
+    }
+    text = PyUnicode_DecodeUTF8(p, end - p, "replace");
+    if (!text)
+    {
+        return -1;
+    }
+    rc = PyList_Append(items, text);
+    Py_DECREF(text);
+    return rc;
+}
+
+static PyObject *pgframe_scan(PyObject *self, PyObject *args)
+{
+    Py_buffer view;
+    int want_lines = 1;
+    Py_ssize_t nlines = 0;
+    PyObject *items;
+    const char *p;
+    const char *end;
+
+    (void)self;
+    if (!PyArg_ParseTuple(args, "y*|p", &view, &want_lines))
+    {
+        return NULL;
+    }
+    items = PyList_New(0);
+    if (!items)
+    {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    p = (const char *)view.buf;
+    end = p + view.len;
+    while (p <= end)
+    {
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        const char *rec;
+        int rc = 0;
+
+        if (!eol)
+        {
+            eol = end;
+        }
+        nlines++;
+        rec = memchr(p, '@', (size_t)(eol - p));
+        while (rec && (eol - rec < 4 || memcmp(rec, "@PG{", 4) != 0))
+        {
+            rec = memchr(rec + 1, '@', (size_t)(eol - rec - 1));
+        }
+        if (rec)
+        {
+            rc = AppendRecord(items, rec + 3, eol);
+        }
+        else if (want_lines)
+        {
+            rc = AppendText(items, p, eol);
+        }
+        if (rc < 0)
+        {
+            Py_DECREF(items);
+            PyBuffer_Release(&view);
+            return NULL;
+        }
+        p = eol + 1;
+    }
+
+    PyBuffer_Release(&view);
+    return Py_BuildValue("(Nn)", items, nlines);
+}
+
+static PyMethodDef pgframe_methods[] =
+{
+    { "scan", pgframe_scan, METH_VARARGS,
+      "scan(chunk, want_lines=True) -> (items, nlines)" },
+    { NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef pgframe_module =
+{
+    PyModuleDef_HEAD_INIT, "_pgframe", "PortGremlin @PG frame scanner", -1, pgframe_methods,
+    NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit__pgframe(void)
+{
+    return PyModule_Create(&pgframe_module);
+}
@@ -0,0 +1,540 @@
+"""Declarative enumeration campaigns for one LaunchPad.
+
+A campaign plan (JSON, or YAML when PyYAML is installed) is a list of
+phases run in order, repeated per target host:
+
+    {"name": "overnight", "seed": "0x5EED", "repeat": {"linux": 3, "default": 1},
+     "settle": 5, "stop": {"findings": 40},
+     "phases": [
+       {"name": "probe", "duration": 600, "persona": "phantom", "classes": ["keyboard", "audio"]},
+       {"name": "fuzz", "duration": 1800, "flags": ["malformed", "rand_strings", "auto"],
+        "genome": {"interval": 3, "malformed": 1, "real_vid": 0, "contradiction": 0},
+        "at": [{"t": 900, "keys": "["}], "stop": {"enums": 20000, "disconnects": 25}}]}
+
+Every phase starts from `!stop` and its own `!seed` (derived from the plan
+seed, repetition and phase index), then applies classes, genome, flags and
+persona over the framed command channel, each waiting for its ack. Unset
+classes and genome fall back to all classes and the firmware's default
+genome, so no phase inherits state from the one before it. Raw
+console keys and `at` entries are sent at their offsets from the phase
+start on the monotonic clock. A phase ends at its duration or as soon as
+one of its stop conditions is met; campaign-wide stop conditions count
+across all phases. Each phase reports throughput (enumerations/s, kernel
+findings/h, inter-enumeration gaps) so runs can be compared; the plan
+digest in the report identifies exactly what was run.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import re
+import subprocess
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import Any, Callable, Optional, Protocol
+
+from correlate import split_kernel_timestamp
+from triage import TriageDB
+
+# Must match DeviceType, GremlinPersona and PORTGREMLIN_FLAG_* in the firmware.
+CLASS_NAMES = ["keyboard", "audio", "printer", "midi", "gamepad"]
+PERSONA_NAMES = ["manual", "chimera", "mimic", "storm", "haunted", "phantom", "spectre"]
+FLAG_BITS = {
+    "malformed": 0x01,
+    "contradiction": 0x02,
+    "real_vid": 0x04,
+    "rand_strings": 0x08,
+    "power_pinned": 0x10,
+    "auto": 0x20,
+    "alias_walk": 0x40,
+}
+ALL_CLASSES = (1 << len(CLASS_NAMES)) - 1
+INTERVAL_MIN, INTERVAL_MAX = 1, 100
+DEFAULT_GENOME = (5, 0, 1, 0)   # PortGremlinEvolveInit()
+
+STOP_KEYS = ("enums", "findings", "disconnects", "host_errors", "recoveries")
+SYSTICK_S = 0.01
+ACK_TIMEOUT_S = 1.0
+USB_ERROR_RE = re.compile(
+    r"(usb|USB|xhci|ehci|ohci|udev).*(error|fail|reject|stall|timeout|unable|warn)",
+    re.IGNORECASE,
+)
+
+
+class PlanError(ValueError):
+    pass
+
+
+class Link(Protocol):
+    def send(self, cmd: str) -> None:
+        ...
+
+
+def _lookup(names: list[str], value: Any, what: str) -> int:
+    if isinstance(value, int) and 0 <= value < len(names):
+        return value
+    text = str(value).lower()
+    if text in names:
+        return names.index(text)
+    raise PlanError(f"unknown {what} {value!r} (expected one of {', '.join(names)})")
+
+
+def _number(value: Any, what: str) -> int:
+    try:
+        return int(value, 0) if isinstance(value, str) else int(value)
+    except (TypeError, ValueError):
+        raise PlanError(f"{what} must be an integer, not {value!r}") from None
+
+
+def _flags(value: Any) -> int:
+    if isinstance(value, (list, tuple)):
+        bits = 0
+        for name in value:
+            if str(name).lower() not in FLAG_BITS:
+                raise PlanError(f"unknown flag {name!r} (expected {', '.join(FLAG_BITS)})")
+            bits |= FLAG_BITS[str(name).lower()]
+        return bits
+    return _number(value, "flags")
+
+
+def _class_mask(value: Any) -> int:
+    if isinstance(value, (list, tuple)):
+        mask = 0
+        for name in value:
+            mask |= 1 << _lookup(CLASS_NAMES, name, "class")
+    else:
+        mask = _number(value, "classes")
+    if not 0 < mask < 1 << len(CLASS_NAMES):
+        raise PlanError(f"class mask {mask:#x} enables no known class")
+    return mask
+
+
+def _genome(value: Any) -> tuple[int, int, int, int]:
+    if isinstance(value, dict):
+        fields = [value.get("interval", 5), value.get("malformed", 0),
+                  value.get("real_vid", 1), value.get("contradiction", 0)]
+    else:
+        fields = list(value)
+    if len(fields) != 4:
+        raise PlanError("genome needs interval, malformed, real_vid and contradiction")
+    interval, *bits = (_number(v, "genome field") for v in fields)
+    if not INTERVAL_MIN <= interval <= INTERVAL_MAX:
+        raise PlanError(f"genome interval {interval} outside {INTERVAL_MIN}..{INTERVAL_MAX} ticks")
+    return interval, int(bool(bits[0])), int(bool(bits[1])), int(bool(bits[2]))
+
+
+def _stop(value: Any, where: str) -> dict[str, int]:
+    value = value or {}
+    unknown = set(value) - set(STOP_KEYS)
+    if unknown:
+        raise PlanError(f"{where}: unknown stop condition(s) {', '.join(sorted(unknown))}")
+    return {k: _number(v, f"{where} stop.{k}") for k, v in value.items()}
+
+
+@dataclass(frozen=True)
+class Action:
+    """Text sent `at` seconds into a phase: a `!` frame or raw console keys."""
+
+    at: float
+    text: str
+
+
+@dataclass
+class Phase:
+    name: str
+    duration_s: float
+    persona: Optional[int] = None
+    genome: Optional[tuple[int, int, int, int]] = None
+    flags: Optional[int] = None
+    classes: Optional[int] = None
+    actions: list[Action] = field(default_factory=list)
+    stop: dict[str, int] = field(default_factory=dict)
+
+    @classmethod
+    def from_dict(cls, data: dict[str, Any], index: int) -> Phase:
+        name = str(data.get("name", f"phase{index + 1}"))
+        duration = float(data.get("duration", 0))
+        if duration <= 0:
+            raise PlanError(f"phase {name}: duration (seconds) is required")
+        actions = [Action(0.0, str(c)) for c in data.get("commands", [])]
+        if data.get("keys"):
+            actions.append(Action(0.0, str(data["keys"])))
+        for entry in data.get("at", []):
+            text = entry.get("cmd") or entry.get("keys")
+            if not text:
+                raise PlanError(f"phase {name}: each 'at' entry needs cmd or keys")
+            actions.append(Action(float(entry.get("t", 0)), str(text)))
+        for a in actions:
+            if a.at >= duration:
+                raise PlanError(f"phase {name}: action {a.text!r} at {a.at:g}s is past the phase end")
+        return cls(
+            name=name,
+            duration_s=duration,
+            persona=_lookup(PERSONA_NAMES, data["persona"], "persona") if "persona" in data else None,
+            genome=_genome(data["genome"]) if "genome" in data else None,
+            flags=_flags(data["flags"]) if "flags" in data else None,
+            classes=_class_mask(data["classes"]) if "classes" in data else None,
+            actions=sorted(actions, key=lambda a: a.at),
+            stop=_stop(data.get("stop"), f"phase {name}"),
+        )
+
+    def setup(self, seed: int) -> list[str]:
+        """Frames that put the device into this phase's state, in order.
+
+        The genome sets the interval and turns auto-cycling on, explicit
+        flags then override its bits, and the persona goes last since it
+        reconfigures everything.
+        """
+        cmds = ["!stop", "!tlm 1", f"!seed {seed:X}",
+                f"!cls {ALL_CLASSES if self.classes is None else self.classes:X}",
+                "!gen " + " ".join(f"{v:X}" for v in self.genome or DEFAULT_GENOME)]
+        if self.flags is not None:
+            cmds.append(f"!cfg {self.flags:X}")
+        if self.persona is not None:
+            cmds.append(f"!per {self.persona:X}")
+        return cmds
+
+
+@dataclass
+class Plan:
+    name: str
+    seed: int
+    phases: list[Phase]
+    repeat: dict[str, int]
+    settle_s: float = 2.0
+    stop: dict[str, int] = field(default_factory=dict)
+    digest: str = ""
+
+    @classmethod
+    def from_dict(cls, data: dict[str, Any]) -> Plan:
+        if not isinstance(data, dict) or not data.get("phases"):
+            raise PlanError("a plan needs a non-empty 'phases' list")
+        repeat = data.get("repeat", 1)
+        if not isinstance(repeat, dict):
+            repeat = {"default": repeat}
+        canonical = json.dumps(data, sort_keys=True, separators=(",", ":"))
+        return cls(
+            name=str(data.get("name", "campaign")),
+            seed=_number(data.get("seed", 0x5EED), "seed") & 0xFFFFFFFF,
+            phases=[Phase.from_dict(p, i) for i, p in enumerate(data["phases"])],
+            repeat={str(k).lower(): _number(v, "repeat") for k, v in repeat.items()},
+            settle_s=float(data.get("settle", 2.0)),
+            stop=_stop(data.get("stop"), "campaign"),
+            digest=hashlib.sha256(canonical.encode("utf-8")).hexdigest()[:16],
+        )
+
+    def repetitions(self, host: str) -> int:
+        return self.repeat.get(host.lower(), self.repeat.get("default", 1))
+
+    def phase_seed(self, rep: int, index: int) -> int:
+        return (self.seed + (rep << 16) + index) & 0xFFFFFFFF
+
+    def duration_s(self, host: str) -> float:
+        per_rep = sum(p.duration_s for p in self.phases) + self.settle_s * len(self.phases)
+        return per_rep * self.repetitions(host)
+
+
+def load_plan(path: str) -> Plan:
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    if path.endswith((".yaml", ".yml")):
+        try:
+            import yaml
+        except ImportError:
+            raise PlanError("YAML plans need PyYAML (pip install pyyaml); "
+                            "JSON plans work without it") from None
+        data = yaml.safe_load(text)
+    else:
+        try:
+            data = json.loads(text)
+        except json.JSONDecodeError as exc:
+            raise PlanError(f"{path}: {exc}") from None
+    return Plan.from_dict(data)
+
+
+@dataclass
+class Counters:
+    enums: int = 0
+    findings: int = 0
+    disconnects: int = 0
+    host_errors: int = 0
+    recoveries: int = 0             # firmware `rec` records: USB, full and watchdog resets
+    down_ticks: int = 0             # SysTicks of outage closed by `recd` records
+
+    def minus(self, base: Counters) -> Counters:
+        return Counters(**{key: value - getattr(base, key) for key, value in vars(self).items()})
+
+    def reached(self, limits: dict[str, int]) -> Optional[str]:
+        for key, limit in limits.items():
+            if getattr(self, key) >= limit:
+                return f"{key}>={limit}"
+        return None
+
+
+@dataclass
+class PhaseStats:
+    phase: str
+    host: str
+    rep: int
+    seed: int
+    planned_s: float
+    started_s: float = 0.0          # since campaign start
+    elapsed_s: float = 0.0
+    counts: Counters = field(default_factory=Counters)
+    gaps_ms: list[float] = field(default_factory=list)
+    nacks: list[str] = field(default_factory=list)
+    late_ms: float = 0.0            # worst action dispatch lateness
+    ended: str = "duration"
+
+    def to_dict(self) -> dict[str, Any]:
+        c, t = self.counts, max(self.elapsed_s, 1e-9)
+        gaps = sorted(self.gaps_ms)
+
+        def pct(q: float) -> Optional[float]:
+            return round(gaps[min(len(gaps) - 1, int(q * len(gaps)))], 1) if gaps else None
+
+        return {
+            "phase": self.phase, "host": self.host, "rep": self.rep, "seed": f"{self.seed:X}",
+            "planned_s": self.planned_s, "started_s": round(self.started_s, 3),
+            "elapsed_s": round(self.elapsed_s, 3), "ended": self.ended,
+            "enums": c.enums, "findings": c.findings, "disconnects": c.disconnects,
+            "host_errors": c.host_errors, "recoveries": c.recoveries,
+            "down_s": round(c.down_ticks * SYSTICK_S, 2),
+            "duty": round(max(0.0, 1.0 - c.down_ticks * SYSTICK_S / t), 4),
+            "enums_per_s": round(c.enums / t, 3),
+            "findings_per_hour": round(c.findings * 3600.0 / t, 2),
+            "gap_ms_p50": pct(0.5), "gap_ms_p95": pct(0.95),
+            "late_ms_max": round(self.late_ms, 1), "nacks": self.nacks,
+        }
+
+
+class CampaignRunner:
+    """Runs a Plan against one device; feed it records and kernel lines.
+
+    on_record() and on_kernel() may be called from other threads. The
+    runner owns the schedule: run() blocks until the campaign finishes,
+    a campaign stop condition fires or `stop` is set.
+    """
+
+    def __init__(self, plan: Plan, link: Link, host: str = "default",
+                 log: Callable[[str], None] = print,
+                 clock: Callable[[], float] = time.monotonic) -> None:
+        self.plan = plan
+        self.link = link
+        self.host = host
+        self.log = log
+        self.clock = clock
+        self.triage = TriageDB(clock=time.time)
+        self.totals = Counters()
+        self.phases: list[PhaseStats] = []
+        self._changed = threading.Condition()
+        self._acks: list[tuple[str, bool]] = []
+        self._last_enum_t: Optional[float] = None
+        self._current: Optional[PhaseStats] = None
+        self.stack_margin: Optional[int] = None     # lowest `stk` margin, bytes
+
+    # -- inputs --------------------------------------------------------------
+
+    def on_record(self, rec: dict[str, Any]) -> None:
+        etype = rec.get("e")
+        with self._changed:
+            if etype == "ack":
+                self._acks.append((str(rec.get("cmd", "")), bool(rec.get("ok"))))
+            elif etype == "enum":
+                self.totals.enums += 1
+                now = self.clock()
+                if self._current is not None and self._last_enum_t is not None:
+                    self._current.gaps_ms.append((now - self._last_enum_t) * 1000.0)
+                self._last_enum_t = now
+            elif etype == "disconnect":
+                self.totals.disconnects += 1
+            elif etype == "rec":
+                self.totals.recoveries += 1
+                self.log(f"[campaign] recovery: {rec.get('act')} reset after {rec.get('why')} stall")
+            elif etype == "recd":
+                self.totals.down_ticks += int(rec.get("dn", 0))
+            elif etype == "stk":
+                margin = int(rec.get("mg", 0))
+                self.stack_margin = margin if self.stack_margin is None else min(self.stack_margin, margin)
+                self.log(f"[campaign] stack high-water {rec.get('hw')}/{rec.get('sz')} bytes, "
+                         f"{margin} left")
+                return
+            else:
+                return
+            self._changed.notify_all()
+
+    def on_kernel(self, message: str, host_t: Optional[float] = None) -> None:
+        if not USB_ERROR_RE.search(message):
+            return
+        _, new = self.triage.record(message, "kernel", host_t)
+        with self._changed:
+            self.totals.host_errors += 1
+            if new:
+                self.totals.findings += 1
+                self.log(f"[campaign] new finding: {message[:100]}")
+            self._changed.notify_all()
+
+    # -- device control ------------------------------------------------------
+
+    def _frame(self, cmd: str) -> bool:
+        verb = cmd[1:].split(" ", 1)[0]
+        with self._changed:
+            self._acks.clear()
+        self.link.send(cmd + "\n")
+        deadline = self.clock() + ACK_TIMEOUT_S
+        with self._changed:
+            while True:
+                for got, ok in self._acks:
+                    if got == verb:
+                        return ok
+                left = deadline - self.clock()
+                if left <= 0:
+                    raise RuntimeError(f"no ack for {cmd!r}; is the firmware too old or the port busy?")
+                self._changed.wait(left)
+
+    def _send(self, text: str, stats: PhaseStats) -> None:
+        if text.startswith("!"):
+            if not self._frame(text):
+                stats.nacks.append(text)
+                self.log(f"[campaign] device rejected {text!r}")
+        else:
+            self.link.send(text)
+
+    # -- schedule ------------------------------------------------------------
+
+    def _run_phase(self, phase: Phase, stats: PhaseStats, t_campaign: float,
+                   stop: threading.Event) -> bool:
+        """Returns False when the campaign as a whole should end."""
+        with self._changed:
+            base = Counters(**vars(self.totals))
+            self._current = stats
+            self._last_enum_t = None
+        t0 = self.clock()
+        for cmd in phase.setup(stats.seed):
+            self._send(cmd, stats)
+        stats.started_s = t0 - t_campaign
+        deadline = t0 + phase.duration_s
+        pending = list(phase.actions)
+        result = True
+        while not stop.is_set():
+            now = self.clock()
+            while pending and t0 + pending[0].at <= now:
+                action = pending.pop(0)
+                stats.late_ms = max(stats.late_ms, (now - t0 - action.at) * 1000.0)
+                self._send(action.text, stats)
+                now = self.clock()
+            with self._changed:
+                stats.counts = self.totals.minus(base)
+                reason = stats.counts.reached(phase.stop)
+                overall = self.totals.reached(self.plan.stop)
+                if overall:
+                    stats.ended, result = f"campaign {overall}", False
+                    break
+                if reason:
+                    stats.ended = reason
+                    break
+                if now >= deadline:
+                    break
+                wake = min([deadline] + [t0 + a.at for a in pending[:1]])
+                self._changed.wait(max(0.0, wake - now))
+        if stop.is_set():
+            stats.ended, result = "interrupted", False
+        stats.elapsed_s = self.clock() - t0
+        with self._changed:
+            stats.counts = self.totals.minus(base)
+            self._current = None
+        return result
+
+    def run(self, stop: Optional[threading.Event] = None) -> dict[str, Any]:
+        stop = stop or threading.Event()
+        plan = self.plan
+        reps = plan.repetitions(self.host)
+        t_campaign = self.clock()
+        wall = time.time()
+        self.log(f"[campaign] {plan.name} ({plan.digest}) on {self.host}: {len(plan.phases)} phases "
+                 f"x {reps} reps, up to {plan.duration_s(self.host) / 3600:.2f} h")
+        running = True
+        for rep in range(reps):
+            for index, phase in enumerate(plan.phases):
+                if not running or stop.is_set():
+                    break
+                if self.phases and plan.settle_s > 0:
+                    # Let the host recover between phases; !stop halts cycling meanwhile.
+                    self._frame("!stop")
+                    if stop.wait(plan.settle_s):
+                        break
+                stats = PhaseStats(phase.name, self.host, rep, plan.phase_seed(rep, index), phase.duration_s)
+                self.phases.append(stats)
+                running = self._run_phase(phase, stats, t_campaign, stop)
+                d = stats.to_dict()
+                self.log(f"[campaign] rep {rep + 1}/{reps} {phase.name}: {d['elapsed_s']:.1f}s "
+                         f"{d['enums']} enums ({d['enums_per_s']}/s) {d['findings']} findings "
+                         f"{d['disconnects']} disconnects, ended by {d['ended']}")
+        try:
+            self.link.send("!stop\n")
+        except (OSError, RuntimeError):
+            pass
+        elapsed = self.clock() - t_campaign
+        return {
+            "campaign": plan.name,
+            "plan_digest": plan.digest,
+            "seed": f"{plan.seed:X}",
+            "host": self.host,
+            "started": round(wall, 3),
+            "elapsed_s": round(elapsed, 3),
+            "totals": {**vars(self.totals),
+                       "enums_per_s": round(self.totals.enums / max(elapsed, 1e-9), 3),
+                       "duty": round(max(0.0, 1.0 - self.totals.down_ticks * SYSTICK_S
+                                         / max(elapsed, 1e-9)), 4),
+                       "findings_per_hour": round(self.totals.findings * 3600.0 / max(elapsed, 1e-9), 2),
+                       "stack_margin": self.stack_margin},
+            "phases": [p.to_dict() for p in self.phases],
+            "findings": self.triage.to_list(),
+        }
+
+
+def describe(plan: Plan, host: str) -> list[str]:
+    """The exact command schedule run() would send, for --dry-run."""
+    lines = [f"{plan.name} ({plan.digest}) on {host}: {plan.repetitions(host)} reps, "
+             f"settle {plan.settle_s:g}s, stop {plan.stop or 'never'}, "
+             f"up to {plan.duration_s(host) / 3600:.2f} h"]
+    for rep in range(plan.repetitions(host)):
+        for index, phase in enumerate(plan.phases):
+            lines.append(f"rep {rep + 1} {phase.name}: {phase.duration_s:g}s, stop {phase.stop or 'never'}")
+            lines.extend(f"  +0s     {cmd}" for cmd in phase.setup(plan.phase_seed(rep, index)))
+            lines.extend(f"  +{a.at:<6g}{a.text!r}" for a in phase.actions)
+    return lines
+
+
+def print_summary(report: dict[str, Any]) -> None:
+    print(f"\n=== CAMPAIGN {report['campaign']} ({report['plan_digest']}) on {report['host']} ===")
+    print(f"{'rep':>3} {'phase':16} {'time s':>8} {'enums':>7} {'enum/s':>7} {'find':>5} "
+          f"{'find/h':>7} {'disc':>5} {'gap p50':>8} {'gap p95':>8}  ended")
+    for p in report["phases"]:
+        print(f"{p['rep'] + 1:>3} {p['phase'][:16]:16} {p['elapsed_s']:>8.1f} {p['enums']:>7} "
+              f"{p['enums_per_s']:>7.2f} {p['findings']:>5} {p['findings_per_hour']:>7.1f} "
+              f"{p['disconnects']:>5} {p['gap_ms_p50'] or 0:>8.0f} {p['gap_ms_p95'] or 0:>8.0f}  {p['ended']}")
+    t = report["totals"]
+    print(f"total {report['elapsed_s']:.1f}s: {t['enums']} enums ({t['enums_per_s']}/s), "
+          f"{t['findings']} unique findings ({t['findings_per_hour']}/h), "
+          f"{t['host_errors']} kernel errors, {t['disconnects']} disconnects, "
+          f"{t['recoveries']} recoveries ({100.0 * t['duty']:.2f}% duty)")
+
+
+def follow_kernel(command: str, on_line: Callable[[str, Optional[float]], None],
+                  stop: threading.Event) -> None:
+    """Stream a kernel log command (e.g. `dmesg -w`) into on_line until stop."""
+    try:
+        proc = subprocess.Popen(command, shell=True, stdout=subprocess.PIPE,
+                                stderr=subprocess.DEVNULL, text=True)
+    except OSError:
+        return
+    while not stop.is_set() and proc.stdout:
+        line = proc.stdout.readline()
+        if not line:
+            break
+        ts, msg = split_kernel_timestamp(line)
+        on_line(msg, ts)
+    proc.terminate()
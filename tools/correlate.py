@@ -0,0 +1,310 @@
+"""Device/host event correlation for PortGremlin telemetry.
+
+The firmware stamps every @PG record with its SysTick count ("t", 10 ms per
+tick). The host sees kernel messages and uevents stamped with CLOCK_MONOTONIC.
+ClockSync maps device ticks onto host monotonic time, and EventCorrelator
+joins each host-side event to the enumeration that most plausibly caused it.
+"""
+
+from __future__ import annotations
+
+import re
+import time
+from bisect import bisect_right
+from dataclasses import dataclass, field
+from typing import Any, Callable, Optional
+
+DEVICE_TICK_S = 0.010
+
+# "[ 1234.567890] usb 1-1: ..." (dmesg / journalctl -o short-monotonic)
+KMSG_TS_RE = re.compile(r"^\s*\[\s*(\d+\.\d+)\]\s*(.*)$")
+# "KERNEL[1234.567890] add /devices/... (usb)" (udevadm monitor --kernel)
+UEVENT_RE = re.compile(r"^KERNEL\[(\d+\.\d+)\]\s+(\w+)\s+(\S+)\s+\((\w+)\)")
+
+
+def split_kernel_timestamp(line: str) -> tuple[Optional[float], str]:
+    m = KMSG_TS_RE.match(line)
+    if not m:
+        return None, line.strip()
+    return float(m.group(1)), m.group(2).strip()
+
+
+class ClockSync:
+    """Online offset/drift estimate between device ticks and host time.
+
+    Serial delivery only ever adds delay, so the lowest (host - device)
+    sample in each window is the best estimate of the true offset. The
+    window minima are fitted with least squares to get offset and drift.
+    """
+
+    def __init__(self, window_s: float = 1.0, max_windows: int = 64) -> None:
+        self.window_s = window_s
+        self.max_windows = max_windows
+        self._minima: list[tuple[float, float]] = []
+        self._win_start: Optional[float] = None
+        self._win_best: Optional[tuple[float, float]] = None
+        self._last_dev: Optional[float] = None
+        self.offset = 0.0
+        self.drift = 0.0
+        self.samples = 0
+        self.resets = 0
+
+    @property
+    def locked(self) -> bool:
+        return self.samples > 0
+
+    def reset(self) -> None:
+        self._minima.clear()
+        self._win_start = None
+        self._win_best = None
+        self._last_dev = None
+        self.offset = 0.0
+        self.drift = 0.0
+        self.samples = 0
+        self.resets += 1
+
+    def observe(self, dev_tick: int, host_t: float) -> None:
+        dev_s = dev_tick * DEVICE_TICK_S
+        if self._last_dev is not None and dev_s < self._last_dev:
+            # Tick went backwards: the device rebooted.
+            self.reset()
+        self._last_dev = dev_s
+        self.samples += 1
+
+        delta = host_t - dev_s
+        if self._win_best is None or delta < self._win_best[1]:
+            self._win_best = (dev_s, delta)
+        if self._win_start is None:
+            self._win_start = host_t
+            self._close_window()
+        elif host_t - self._win_start >= self.window_s:
+            self._close_window()
+            self._win_start = host_t
+
+    def _close_window(self) -> None:
+        if self._win_best is None:
+            return
+        self._minima.append(self._win_best)
+        if len(self._minima) > self.max_windows:
+            del self._minima[0]
+        self._win_best = None
+        self._fit()
+
+    def _fit(self) -> None:
+        n = len(self._minima)
+        if n == 1:
+            self.offset = self._minima[0][1]
+            self.drift = 0.0
+            return
+        mx = sum(x for x, _ in self._minima) / n
+        my = sum(y for _, y in self._minima) / n
+        sxx = sum((x - mx) ** 2 for x, _ in self._minima)
+        if sxx <= 0.0:
+            self.offset, self.drift = my, 0.0
+            return
+        sxy = sum((x - mx) * (y - my) for x, y in self._minima)
+        self.drift = sxy / sxx
+        self.offset = my - self.drift * mx
+        # Keep the line on the lower envelope of the observed minima.
+        self.offset += min(y - (self.offset + self.drift * x) for x, y in self._minima)
+
+    def to_host(self, dev_tick: int) -> float:
+        dev_s = dev_tick * DEVICE_TICK_S
+        return dev_s + self.offset + self.drift * dev_s
+
+    def to_dict(self) -> dict[str, Any]:
+        return {
+            "offset_s": round(self.offset, 6),
+            "drift_ppm": round(self.drift * 1e6, 2),
+            "samples": self.samples,
+            "resets": self.resets,
+        }
+
+
+@dataclass
+class EnumRecord:
+    host_t: float
+    dev_tick: int
+    n: int
+    vid: str
+    pid: str
+    cls: str
+    gen: int
+    genome: dict[str, int]
+    persona: str
+    flags: int = 0
+    cv: Optional[int] = None
+    mw: Optional[int] = None
+    pa: Optional[int] = None
+
+    def identity(self) -> str:
+        return f"{self.vid}:{self.pid}/{self.cls}"
+
+    def to_dict(self) -> dict[str, Any]:
+        return {
+            "n": self.n,
+            "vid": self.vid,
+            "pid": self.pid,
+            "cls": self.cls,
+            "gen": self.gen,
+            "genome": dict(self.genome),
+            "persona": self.persona,
+            "f": self.flags,
+            "cv": self.cv,
+            "mw": self.mw,
+            "pa": self.pa,
+            "t": self.dev_tick,
+        }
+
+
+@dataclass
+class HostEvent:
+    host_t: float
+    source: str
+    message: str
+
+
+@dataclass
+class Attribution:
+    event: HostEvent
+    enum: Optional[EnumRecord]
+    lag_ms: Optional[float]
+
+    def blame(self) -> str:
+        if self.enum is None:
+            return "unattributed"
+        return f"enum #{self.enum.n} {self.enum.identity()} gen={self.enum.gen} (+{self.lag_ms:.0f} ms)"
+
+
+@dataclass
+class EventCorrelator:
+    """Streaming join of host events against device enumerations.
+
+    Host events are held until the device stream has caught up past their
+    timestamp (or hold_s expires), so a kernel message that overtakes the
+    enumeration's serial telemetry still gets blamed on the right identity.
+    """
+
+    on_attribution: Optional[Callable[[Attribution], None]] = None
+    max_lag_s: float = 2.0
+    hold_s: float = 0.25
+    slack_s: float = 0.005
+    capacity: int = 4096
+    clock: ClockSync = field(default_factory=ClockSync)
+    persona: str = "unknown"
+    gen: int = 0
+    genome: dict[str, int] = field(default_factory=dict)
+    attributed: int = 0
+    unattributed: int = 0
+    _times: list[float] = field(default_factory=list)
+    _enums: list[EnumRecord] = field(default_factory=list)
+    _pending: list[HostEvent] = field(default_factory=list)
+    _watermark: float = 0.0
+
+    def on_device(self, payload: dict[str, Any], host_t: Optional[float] = None) -> Optional[EnumRecord]:
+        if host_t is None:
+            host_t = time.monotonic()
+        tick = payload.get("t")
+        if tick is None:
+            return None
+        tick = int(tick)
+        self.clock.observe(tick, host_t)
+        self._watermark = max(self._watermark, self.clock.to_host(tick))
+
+        etype = payload.get("e", "")
+        rec = None
+        if etype == "enum":
+            rec = EnumRecord(
+                host_t=self.clock.to_host(tick),
+                dev_tick=tick,
+                n=int(payload.get("n", 0)),
+                vid=payload.get("vid", ""),
+                pid=payload.get("pid", ""),
+                cls=payload.get("cls", ""),
+                gen=int(payload.get("gen", self.gen)),
+                genome=self.genome,
+                persona=self.persona,
+                flags=int(payload.get("f", 0)),
+                cv=payload.get("cv"),
+                mw=payload.get("mw"),
+                pa=payload.get("pa"),
+            )
+            self._insert(rec)
+        elif etype == "evolve":
+            self.gen = int(payload.get("gen", 0))
+            self.genome = {
+                k: int(payload[k]) for k in ("int", "mal", "rv", "con", "mut") if k in payload
+            }
+        elif etype == "persona":
+            self.persona = payload.get("name", self.persona)
+        self.flush(host_t)
+        return rec
+
+    def _insert(self, rec: EnumRecord) -> None:
+        if self._times and rec.host_t < self._times[-1]:
+            i = bisect_right(self._times, rec.host_t)
+            self._times.insert(i, rec.host_t)
+            self._enums.insert(i, rec)
+        else:
+            self._times.append(rec.host_t)
+            self._enums.append(rec)
+        if len(self._times) > 2 * self.capacity:
+            del self._times[: self.capacity]
+            del self._enums[: self.capacity]
+
+    def on_host(self, source: str, message: str, host_t: Optional[float] = None,
+                now: Optional[float] = None) -> None:
+        if now is None:
+            now = time.monotonic()
+        self._pending.append(HostEvent(now if host_t is None else host_t, source, message))
+        self.flush(now)
+
+    def flush(self, now: Optional[float] = None, force: bool = False) -> list[Attribution]:
+        if not self._pending:
+            return []
+        if now is None:
+            now = time.monotonic()
+        ready: list[HostEvent] = []
+        keep: list[HostEvent] = []
+        for ev in self._pending:
+            if force or ev.host_t <= self._watermark or now - ev.host_t >= self.hold_s:
+                ready.append(ev)
+            else:
+                keep.append(ev)
+        self._pending = keep
+        out = [self.attribute(ev) for ev in ready]
+        if self.on_attribution:
+            for att in out:
+                self.on_attribution(att)
+        return out
+
+    def attribute(self, ev: HostEvent) -> Attribution:
+        i = bisect_right(self._times, ev.host_t + self.slack_s)
+        if i == 0:
+            self.unattributed += 1
+            return Attribution(ev, None, None)
+        rec = self._enums[i - 1]
+        lag = ev.host_t - rec.host_t
+        if lag > self.max_lag_s:
+            self.unattributed += 1
+            return Attribution(ev, None, None)
+        self.attributed += 1
+        return Attribution(ev, rec, max(0.0, lag) * 1000.0)
+
+    def recent(self, count: int) -> list[EnumRecord]:
+        return self._enums[-count:]
+
+    def trail(self, rec: EnumRecord, count: int) -> list[EnumRecord]:
+        """The enumerations leading up to and including rec, oldest first."""
+        i = bisect_right(self._times, rec.host_t)
+        while i > 0 and self._enums[i - 1] is not rec:
+            i -= 1
+        return self._enums[max(0, i - count):i]
+
+    def to_dict(self) -> dict[str, Any]:
+        return {
+            "clock": self.clock.to_dict(),
+            "attributed": self.attributed,
+            "unattributed": self.unattributed,
+            "pending": len(self._pending),
+        }
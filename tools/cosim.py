@@ -0,0 +1,624 @@
+"""Co-simulation: the Virtual Lab driven by the firmware's own decision code.
+
+`make -C usb_dev_keyboard host` builds the portable portgremlin_*.c modules
+(Oracle, Brain, personas, evolution, identity randomization, command parser)
+into libportgremlin_host.so. FirmwareCoSimulator loads a private copy of it,
+advances it one 10 ms SysTick at a time and plays the USB host: connect,
+bus resets and SET_CONFIGURATION at the latency of the chosen host OS, and
+a disconnect when the host model rejects the device. The host side (pain,
+kernel errors, device cache) is shared with sim_engine; everything the
+device decides comes from the shipped C.
+
+SessionSimulator instead plays back a session recorded on hardware (see
+session.py), so the lab can scrub through a real run at up to 1000x.
+
+    python3 tools/cosim.py --build
+    python3 tools/cosim.py --host linux --seconds 3600 --overdrive
+    python3 tools/cosim.py --replay reports/linux-1.pgses
+"""
+
+from __future__ import annotations
+
+import argparse
+import ctypes
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from enum import Enum
+from typing import Any, Callable, Optional, TypeVar
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from host_model import HostModel, load_models
+from ingest import FrameReader
+from session import SessionReader
+from sim_engine import (
+    EV_CONFIGURE,
+    EV_CONNECT,
+    EV_DISCONNECT,
+    EV_RESET,
+    TICK_S,
+    BrainPhase,
+    DeviceClass,
+    Genome,
+    HostDevice,
+    HostOS,
+    Persona,
+    PortGremlinSimulator,
+    SimEvent,
+    SimulationState,
+)
+
+FIRMWARE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "usb_dev_keyboard")
+LIB_NAME = "libportgremlin_host.so"
+
+# Orders match the C enums (HostProfile, GremlinPersona, BrainPhase, DeviceType).
+HOSTS = [HostOS.UNKNOWN, HostOS.WINDOWS, HostOS.LINUX, HostOS.MACOS, HostOS.EMBEDDED]
+PERSONAS = list(Persona)
+PHASES = list(BrainPhase)
+CLASSES = DeviceClass.all()
+
+FLAG_MALFORMED = 0x01
+FLAG_CONTRADICTION = 0x02
+FLAG_AUTO_CYCLE = 0x20
+
+_TAG_SOURCES = {
+    "ORACLE": "oracle",
+    "BRAIN": "brain",
+    "PERSONA": "persona",
+    "CHOREO": "persona",
+    "HAUNTED": "persona",
+    "MIMIC": "mimic",
+    "EVOLVE": "evolve",
+    "OVERDRIVE": "host",
+}
+_PER_ENUM_LINES = ("Re-enumerating USB", "New VID:", "Switching to ")
+# Pain a recorded kernel message adds, on sim_engine's per-error scale.
+_KERNEL_PAIN = {"kernel": 2.5, "journal": 1.25}
+
+E = TypeVar("E", bound=Enum)
+
+
+def _firmware_line_source(line: str) -> Optional[tuple[str, str]]:
+    """(source, level) to log a firmware console line under, or None to drop it."""
+    if line.startswith(_PER_ENUM_LINES):
+        return None
+    source = "device"
+    if line.startswith("["):
+        tag = line[1:line.find("]")]
+        source = _TAG_SOURCES.get(tag, "device")
+    return source, "warn" if "rejected" in line or "Maximum chaos" in line else "info"
+
+
+def _member(enum: type[E], value: Any, default: E) -> E:
+    """Enum member whose value or name matches a telemetry string, ignoring case."""
+    text = str(value).lower()
+    for member in enum:
+        if member.value.lower() == text or member.name.lower() == text:
+            return member
+    return default
+
+
+class HostState(ctypes.Structure):
+    """Mirror of PortGremlinHostState in host/portgremlin_host.h."""
+
+    _fields_ = [(name, ctypes.c_uint32) for name in (
+        "tick", "enum_count", "cycle_count", "device", "vid", "pid", "max_power_ma",
+        "pwr_attributes", "flags", "interval_ticks", "connected", "persona", "host",
+        "brain_active", "brain_phase", "tolerance", "stable_enums", "disconnects",
+        "resets", "config_latency_ticks", "pinned_vid", "pinned_pid", "evolve_active",
+        "generation", "genome_interval", "genome_malformed", "genome_real_vid",
+        "genome_contradiction", "genome_fitness", "config_version",
+        "config_latency_frames", "genome_mutations", "mutate_ops", "boots", "usb_resets",
+        "full_resets", "downtime_ticks", "bandit_active", "bandit_rounds",
+    )] + [
+        ("manufacturer", ctypes.c_char * 25),
+        ("product", ctypes.c_char * 25),
+    ]
+
+
+def library_path() -> str:
+    return os.path.normpath(os.path.join(FIRMWARE_DIR, LIB_NAME))
+
+
+def build_library(verbose: bool = True) -> Optional[str]:
+    """Run `make host` in the firmware directory; returns the library path."""
+    cmd = ["make", "-C", os.path.normpath(FIRMWARE_DIR), "host"]
+    try:
+        subprocess.run(cmd, check=True, stdout=None if verbose else subprocess.DEVNULL)
+    except (OSError, subprocess.CalledProcessError) as exc:
+        print(f"host firmware build failed ({exc})", file=sys.stderr)
+        return None
+    return library_path()
+
+
+def available() -> bool:
+    return os.path.exists(library_path())
+
+
+class FirmwareLibrary:
+    """One private copy of the host library: its own globals, RNG and UART."""
+
+    def __init__(self, seed: int = 1, path: Optional[str] = None) -> None:
+        src = path or library_path()
+        if not os.path.exists(src):
+            raise FileNotFoundError(f"{src} not built; run: make -C usb_dev_keyboard host")
+        # dlopen() shares one instance per path, so load from a throwaway copy.
+        fd, self._copy = tempfile.mkstemp(prefix="portgremlin_host_", suffix=".so")
+        os.close(fd)
+        shutil.copyfile(src, self._copy)
+        try:
+            lib = ctypes.CDLL(self._copy)
+        finally:
+            os.unlink(self._copy)
+        self._lib = lib
+
+        u32 = ctypes.c_uint32
+        lib.PortGremlinHostInit.argtypes = [u32]
+        lib.PortGremlinHostRun.argtypes = [u32]
+        lib.PortGremlinHostRun.restype = u32
+        lib.PortGremlinHostInput.argtypes = [ctypes.c_char_p, u32]
+        lib.PortGremlinHostOutput.argtypes = [ctypes.c_char_p, u32]
+        lib.PortGremlinHostOutput.restype = u32
+        lib.PortGremlinHostSnapshot.argtypes = [ctypes.POINTER(HostState)]
+        lib.PortGremlinHostStateSize.restype = u32
+        if lib.PortGremlinHostStateSize() != ctypes.sizeof(HostState):
+            raise RuntimeError("libportgremlin_host.so does not match cosim.HostState; rebuild it")
+
+        self._state = HostState()
+        self._out = ctypes.create_string_buffer(65536)
+        lib.PortGremlinHostInit(seed & 0xFFFFFFFF)
+
+    def run(self, ticks: int) -> int:
+        return self._lib.PortGremlinHostRun(ticks)
+
+    def send(self, text: str) -> None:
+        data = text.encode("ascii")
+        self._lib.PortGremlinHostInput(data, len(data))
+
+    def output(self) -> bytes:
+        n = self._lib.PortGremlinHostOutput(self._out, len(self._out))
+        return self._out.raw[:n]
+
+    def connect(self) -> None:
+        self._lib.PortGremlinHostConnect()
+
+    def bus_reset(self) -> None:
+        self._lib.PortGremlinHostBusReset()
+
+    def configure(self) -> None:
+        self._lib.PortGremlinHostConfigure()
+
+    def disconnect(self) -> None:
+        self._lib.PortGremlinHostDisconnect()
+
+    def snapshot(self) -> HostState:
+        self._lib.PortGremlinHostSnapshot(ctypes.byref(self._state))
+        return self._state
+
+
+class FirmwareCoSimulator(PortGremlinSimulator):
+    """PortGremlinSimulator whose device side is the real firmware modules.
+
+    `host` is the OS being attacked; `state.host_os` is what the firmware's
+    Oracle has classified it as, exactly as on hardware.
+    """
+
+    def __init__(self, on_event: Optional[Callable[[SimEvent], None]] = None,
+                 seed: Optional[int] = None, library: Optional[str] = None,
+                 host_models: Optional[dict[str, HostModel]] = None) -> None:
+        super().__init__(on_event, seed, host_models)
+        self.seed = seed if seed is not None else int(time.time())
+        self.library = library
+        self._boot()
+
+    def _boot(self) -> None:
+        self.fw = FirmwareLibrary(self.seed, self.library)
+        self._reset_clock()
+        self._enums_seen = 0
+        self._errors_fed = 0
+        self.feedback = False
+        self.bandit_arms: dict[str, dict[str, Any]] = {}
+        self._reader = FrameReader(self._on_firmware_record, self._on_firmware_line)
+        snap = self.fw.snapshot()
+        self._interval_ticks = snap.interval_ticks
+        self._sync(snap)
+
+    # -- firmware I/O -------------------------------------------------------
+
+    def _on_firmware_line(self, line: str) -> None:
+        shown = _firmware_line_source(line)
+        if shown:
+            self.log(shown[0], line, shown[1])
+
+    def _on_firmware_record(self, rec: dict[str, Any]) -> None:
+        if rec.get("e") == "bnda":
+            self.bandit_arms[str(rec.get("arm", ""))] = rec
+
+    def _command(self, keys: str) -> None:
+        """Type keys on the firmware console and give it one tick to act."""
+        self.fw.send(keys)
+        self.advance(1)
+        self.state.revision += 1
+
+    def _sync(self, snap: HostState) -> None:
+        st = self.state
+        st.host_os = HOSTS[snap.host] if snap.host < len(HOSTS) else HostOS.UNKNOWN
+        st.persona = PERSONAS[snap.persona] if snap.persona < len(PERSONAS) else Persona.MANUAL
+        st.brain_active = bool(snap.brain_active)
+        st.brain_phase = PHASES[snap.brain_phase] if snap.brain_phase < len(PHASES) else BrainPhase.IDLE
+        st.evolve_active = bool(snap.evolve_active)
+        st.auto_cycle = bool(snap.flags & FLAG_AUTO_CYCLE)
+        st.malformed = bool(snap.flags & FLAG_MALFORMED)
+        st.contradiction = bool(snap.flags & FLAG_CONTRADICTION)
+        st.pinned_vid, st.pinned_pid = snap.pinned_vid, snap.pinned_pid
+        st.device_class = CLASSES[snap.device] if snap.device < len(CLASSES) else DeviceClass.KEYBOARD
+        st.vid, st.pid = snap.vid, snap.pid
+        st.manufacturer = snap.manufacturer.decode("ascii", "replace")
+        st.product = snap.product.decode("ascii", "replace")
+        st.enum_count = snap.enum_count + snap.cycle_count
+        st.cycle_count = snap.cycle_count
+        st.disconnects = snap.disconnects
+        st.tolerance = snap.tolerance
+        st.config_latency_ms = snap.config_latency_ticks * 10
+        st.reset_count = snap.resets
+        st.genome = Genome(snap.genome_interval, bool(snap.genome_malformed),
+                           bool(snap.genome_real_vid), bool(snap.genome_contradiction),
+                           snap.genome_fitness, snap.generation)
+
+    # -- host model ---------------------------------------------------------
+
+    def _dispatch(self, kind: str) -> None:
+        if kind == EV_CONNECT:
+            self.fw.connect()
+        elif kind == EV_RESET:
+            self.fw.bus_reset()
+        elif kind == EV_CONFIGURE:
+            self.fw.configure()
+        elif kind == EV_DISCONNECT:
+            self._host_disconnect()
+
+    def _cycle_interval_ticks(self) -> int:
+        return self._interval_ticks
+
+    def _host_disconnect(self) -> None:
+        self.log("host", "Host disconnected device (stack rejection)", "warn")
+        self.fw.disconnect()
+
+    def _on_enumeration(self, snap: HostState) -> None:
+        """The device dropped off the bus and came back with a new identity."""
+        self._sync(snap)
+        self._interval_ticks = snap.interval_ticks
+        st = self.state
+        st.last_enum_flash = time.time()
+
+        label = f"{st.manufacturer} {st.product}"[:28]
+        st.host_devices.insert(0, HostDevice(st.vid, st.pid, st.device_class, label, st.contradiction))
+        del st.host_devices[24:]
+        st.devices_revision += 1
+
+        self._host_enumerate(self._host_pain())
+        if self.feedback and st.host_errors > self._errors_fed:
+            # Each host error stands in for a new kernel signature.
+            self.fw.send(f"!fb {st.host_errors - self._errors_fed:x}\r")
+            self._errors_fed = st.host_errors
+        self.log("enum", f"#{st.enum_count} {st.device_class.value} {st.vid:04X}:{st.pid:04X} "
+                         f"[{st.persona.value}]")
+
+    # -- clock --------------------------------------------------------------
+
+    def advance(self, ticks: int) -> None:
+        """Run the firmware up to each host bus event in turn for `ticks` SysTicks.
+
+        The firmware owns the cycle timer, so only bus events live on the
+        heap; the library stops early on every enumeration so the host can
+        react at the exact tick.
+        """
+        end = self.now + ticks
+        while self.now < end:
+            limit = min(end, self._queue[0][0]) if self._queue else end
+            if limit > self.now:
+                self.now += self.fw.run(limit - self.now)
+            snap = self.fw.snapshot()
+            self._reader.feed(self.fw.output())
+            enums = snap.enum_count + snap.cycle_count
+            if enums != self._enums_seen:
+                self._enums_seen = enums
+                self._on_enumeration(snap)
+            for kind in self._pop_due(self.now):
+                self._dispatch(kind)
+                self.state.revision += 1
+        snap = self.fw.snapshot()
+        self._reader.feed(self.fw.output())
+        self._sync(snap)
+
+    # -- controls (same keys as the serial console) -------------------------
+
+    def set_host_os(self, host: HostOS) -> None:
+        self.host = host
+        self.log("oracle", f"Host set to {host.value}")
+
+    def set_auto_cycle(self, enabled: bool) -> None:
+        if self.state.auto_cycle != enabled:
+            self._command("a")
+
+    def next_persona(self) -> None:
+        self._command("p")
+
+    def toggle_brain(self) -> None:
+        self._command("b")
+
+    def toggle_evolve(self) -> None:
+        self._command("g")
+
+    def overdrive(self) -> None:
+        self._command("x")
+
+    def toggle_contradiction(self) -> None:
+        self._command("d")
+
+    def deploy_mimic(self, index: int) -> None:
+        self._command(f"!mim {index:x}\n")
+
+    def enumerate(self) -> None:
+        self._command("e")
+
+    def bandit(self) -> None:
+        """Start the bandit scheduler and report host errors back to it with !fb."""
+        self.feedback = True
+        self._errors_fed = self.state.host_errors
+        self._command("!bnd 1\r")
+
+    def bandit_report(self) -> list[dict[str, Any]]:
+        """The firmware's per-arm statistics, from !bnd."""
+        self.bandit_arms.clear()
+        self._command("!bnd\r")
+        return list(self.bandit_arms.values())
+
+    def reset(self) -> None:
+        old = self.state
+        self.state = SimulationState(revision=old.revision + 1, devices_revision=old.devices_revision + 1)
+        self._boot()
+        self.log("sim", "Simulation reset")
+
+
+class SessionSimulator(PortGremlinSimulator):
+    """One lane of a recorded session, played back as a simulation.
+
+    Nothing is modelled: the state follows the lane's @PG telemetry and
+    kernel messages as virtual time passes their recorded offsets. The
+    recording cannot be steered, so the controls only say so.
+    """
+
+    def __init__(self, path: str, lane: Optional[str] = None,
+                 on_event: Optional[Callable[[SimEvent], None]] = None) -> None:
+        super().__init__(on_event)
+        self.reader = SessionReader(path)
+        lanes = self.reader.lanes()
+        if lane is None:
+            lane = next(iter(lanes), "")
+        elif lane not in lanes:
+            raise ValueError(f"{path} has no lane {lane!r} (lanes: {', '.join(lanes) or 'none'})")
+        self.path = path
+        self.lane = lane
+        self.host = _member(HostOS, lanes.get(lane, {}).get("os", ""), HostOS.UNKNOWN)
+        self.state.host_os = self.host
+        self._rewind()
+
+    @property
+    def duration(self) -> float:
+        return self.reader.duration
+
+    def _rewind(self) -> None:
+        self._reset_clock()
+        self._records = self.reader.records()
+        self._pending = next(self._records, None)
+
+    def _cycle_interval_ticks(self) -> int:
+        return self.state.genome.interval
+
+    def advance(self, ticks: int) -> None:
+        """Apply every record of the lane up to `ticks` SysTicks from now."""
+        if self._pending is None:
+            self.state.running = False
+            return
+        end = self.now + ticks
+        limit = self.reader.t0 + end * TICK_S + 1e-9
+        while self._pending is not None and float(self._pending.get("t", 0.0)) <= limit:
+            entry = self._pending
+            self._pending = next(self._records, None)
+            if entry.get("lane", "") == self.lane:
+                self._apply(entry)
+                self.state.revision += 1
+            if self._pending is None:
+                self.log("sim", f"End of recording ({self.duration:.1f} s)")
+                self.state.running = False
+        self.now = max(self.now, end)
+
+    def seek(self, seconds: float) -> None:
+        """Move to `seconds` into the recording; going back replays from the start."""
+        target = max(0, int(seconds / TICK_S + 1e-9))
+        if target < self.now:
+            running = self.state.running
+            self._clear_state()
+            self.state.running = running
+            self._rewind()
+        self.advance(target - self.now)
+
+    def _clear_state(self) -> None:
+        old = self.state
+        self.state = SimulationState(host_os=self.host, revision=old.revision + 1,
+                                     devices_revision=old.devices_revision + 1)
+
+    def _apply(self, entry: dict[str, Any]) -> None:
+        st = self.state
+        kind = entry.get("k")
+        msg = str(entry.get("msg", ""))
+        if kind == "pg" and isinstance(entry.get("rec"), dict):
+            self._apply_record(entry["rec"])
+        elif kind in _KERNEL_PAIN:
+            st.host_errors += 1
+            st.pain_score = min(100.0, st.pain_score + _KERNEL_PAIN[kind])
+            self.log("kernel", msg, "error")
+        elif kind == "line":
+            shown = _firmware_line_source(msg)
+            if shown:
+                self.log(shown[0], msg, shown[1])
+        elif kind == "uevent":
+            self.log("host", msg)
+        elif kind == "cmd":
+            self.log("host", f"CMD {entry.get('cmd')!r}")
+
+    def _apply_record(self, rec: dict[str, Any]) -> None:
+        st = self.state
+        etype = rec.get("e")
+        if etype == "enum":
+            st.vid = int(str(rec.get("vid", "0")), 16)
+            st.pid = int(str(rec.get("pid", "0")), 16)
+            st.device_class = _member(DeviceClass, rec.get("cls", ""), st.device_class)
+            st.enum_count = int(rec.get("n", st.enum_count + 1))
+            flags = int(rec.get("f", 0))
+            st.malformed = bool(flags & FLAG_MALFORMED)
+            st.contradiction = bool(flags & FLAG_CONTRADICTION)
+            st.auto_cycle = bool(flags & FLAG_AUTO_CYCLE)
+            st.pain_score *= 0.95
+            st.last_enum_flash = time.time()
+            st.host_devices.insert(0, HostDevice(st.vid, st.pid, st.device_class,
+                                                 f"{st.device_class.value} #{st.enum_count}",
+                                                 st.contradiction))
+            del st.host_devices[24:]
+            st.devices_revision += 1
+            self.log("enum", f"#{st.enum_count} {st.device_class.value} {st.vid:04X}:{st.pid:04X} "
+                             f"[{st.persona.value}]")
+        elif etype == "host":
+            st.host_os = _member(HostOS, rec.get("os", ""), HostOS.UNKNOWN)
+            st.config_latency_ms = int(rec.get("lat", 0)) * 10
+            st.reset_count = int(rec.get("rst", 0))
+            self.log("oracle", f"Host classified: {st.host_os.value} "
+                               f"(config {st.config_latency_ms} ms, {st.reset_count} resets)")
+        elif etype == "persona":
+            st.persona = _member(Persona, rec.get("name", ""), Persona.MANUAL)
+            self.log("persona", f"Persona: {st.persona.value}")
+        elif etype == "brain":
+            st.brain_phase = _member(BrainPhase, rec.get("phase", ""), BrainPhase.IDLE)
+            st.brain_active = st.brain_phase != BrainPhase.IDLE
+            st.tolerance = int(rec.get("tol", st.tolerance))
+            self.log("brain", f"Phase {st.brain_phase.value} (tolerance {st.tolerance})")
+        elif etype == "disconnect":
+            st.disconnects = int(rec.get("total", st.disconnects + 1))
+            self.log("host", "Host disconnected device (stack rejection)", "warn")
+        elif etype == "evolve":
+            st.evolve_active = True
+            st.genome = Genome(int(rec.get("int", 0)), bool(rec.get("mal")), bool(rec.get("rv")),
+                               bool(rec.get("con")), int(rec.get("fit", 0)), int(rec.get("gen", 0)))
+            self.log("evolve", f"Generation {st.genome.generation} fitness {st.genome.fitness}")
+        elif etype == "ack":
+            self.log("device", f"ack {rec.get('cmd')} ok={rec.get('ok')}")
+
+    # -- controls: a recording cannot be steered ----------------------------
+
+    def _read_only(self, *_args: Any) -> None:
+        self.log("sim", "Replaying a recorded session; controls are disabled", "warn")
+
+    next_persona = toggle_brain = toggle_evolve = overdrive = _read_only
+    toggle_contradiction = deploy_mimic = enumerate = _read_only
+
+    def set_auto_cycle(self, enabled: bool) -> None:
+        """Start turns auto cycling on; in a recording the telemetry decides."""
+
+    def set_host_os(self, host: HostOS) -> None:
+        self._read_only()
+
+    def reset(self) -> None:
+        self._clear_state()
+        self._rewind()
+        self.log("sim", f"Replay of {os.path.basename(self.path)} rewound")
+
+
+def make_simulator(on_event: Optional[Callable[[SimEvent], None]] = None,
+                   engine: str = "auto", seed: Optional[int] = None,
+                   host_model: Optional[str] = None, session: Optional[str] = None,
+                   lane: Optional[str] = None) -> PortGremlinSimulator:
+    """Firmware co-simulation when the host library is built, else sim_engine.
+
+    host_model is a portgremlin-calibrate.py output file; without one the
+    built-in host latencies and error rates are used. A session file
+    replays that recording instead of simulating anything.
+    """
+    if session:
+        return SessionSimulator(session, lane, on_event)
+    models = load_models(host_model) if host_model else None
+    if engine == "firmware" or (engine == "auto" and available()):
+        return FirmwareCoSimulator(on_event, seed, host_models=models)
+    return PortGremlinSimulator(on_event, seed, models)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Batch run of the firmware co-simulation")
+    parser.add_argument("--build", action="store_true", help="build the host library and exit")
+    parser.add_argument("--host", default="linux", choices=[h.name.lower() for h in HostOS])
+    parser.add_argument("--seconds", type=float, default=600.0, help="simulated time")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--overdrive", action="store_true", help="engage the full autonomous stack")
+    parser.add_argument("--bandit", action="store_true",
+                        help="run the bandit persona scheduler, with host errors fed back (firmware engine)")
+    parser.add_argument("--engine", choices=["firmware", "python"], default="firmware")
+    parser.add_argument("--host-model", metavar="JSON",
+                        help="calibrated host models from portgremlin-calibrate.py")
+    parser.add_argument("--replay", metavar="SESSION", help="play back a recorded session instead")
+    parser.add_argument("--lane", help="lane of --replay to play (default: the first)")
+    parser.add_argument("-v", "--verbose", action="store_true", help="print the event stream")
+    args = parser.parse_args()
+
+    if args.build:
+        return 0 if build_library() else 1
+    if args.bandit and (args.engine != "firmware" or args.replay):
+        parser.error("--bandit needs the firmware engine")
+
+    on_event = (lambda ev: print(f"[{ev.source:7}] {ev.message}")) if args.verbose else None
+    if args.replay:
+        try:
+            sim = make_simulator(on_event, session=args.replay, lane=args.lane)
+        except (OSError, ValueError) as exc:
+            print(f"Cannot replay {args.replay}: {exc}", file=sys.stderr)
+            return 1
+        args.engine, args.host = "replay", sim.host.name.lower()
+        args.seconds = sim.duration
+    else:
+        sim = make_simulator(on_event, args.engine, args.seed, args.host_model)
+        sim.set_host_os(HostOS[args.host.upper()])
+    sim.start()
+    sim.set_auto_cycle(True)
+    if args.overdrive:
+        sim.overdrive()
+    if args.bandit:
+        sim.bandit()
+
+    t0 = time.perf_counter()
+    sim.run_until(sim.virtual_time + args.seconds)
+    wall = time.perf_counter() - t0
+
+    st = sim.state
+    model = "recorded" if args.replay else "calibrated" if sim._host_model() else "built-in"
+    print(f"engine={args.engine} host={args.host} ({model}) simulated={args.seconds:.0f}s wall={wall:.2f}s")
+    print(f"  enumerations={st.enum_count} disconnects={st.disconnects} "
+          f"host_errors={st.host_errors} detected={st.host_os.value}")
+    print(f"  persona={st.persona.value} brain={st.brain_phase.value if st.brain_active else 'off'} "
+          f"tolerance={st.tolerance}")
+    g = st.genome
+    print(f"  genome gen={g.generation} int={g.interval} mal={int(g.malformed)} "
+          f"vid={int(g.real_vid)} contra={int(g.contradiction)} fit={g.fitness}")
+    if args.bandit:
+        rounds = sim.fw.snapshot().bandit_rounds
+        print(f"  bandit rounds={rounds}")
+        for arm in sim.bandit_report():
+            print(f"    {arm.get('arm', ''):8} played={arm.get('k', 0):>4} "
+                  f"mean={arm.get('mu', 0) / 256:.3f} n={arm.get('n', 0) / 256:.2f}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
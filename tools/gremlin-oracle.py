@@ -5,11 +5,17 @@ Gremlin Oracle — dual-perspective USB enumeration forensics.
 Correlates what the host OS sees (USB device arrivals) with what PortGremlin
 reports over serial (personas, mimic deploys, host fingerprinting). This is
 the novel bit: attack telemetry from both sides of the cable.
+
+Device @PG records carry SysTick timestamps; kernel messages and uevents are
+joined against them (see correlate.py) so every host-side failure is blamed
+on the enumeration that caused it.
 """
 
 from __future__ import annotations
 
 import argparse
+import json
+import os
 import re
 import subprocess
 import sys
@@ -19,6 +25,12 @@ from collections import deque
 from dataclasses import dataclass, field
 from typing import Optional
 
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from correlate import UEVENT_RE, Attribution, EventCorrelator, split_kernel_timestamp
+from ingest import FrameReader, pump
+from session import JsonlWriter, open_recorder
+
 try:
     import serial
     from serial.tools import list_ports
@@ -27,11 +39,11 @@ except ImportError:
     sys.exit(1)
 
 ORACLE_HOST_RE = re.compile(r"Host classified:\s+(\w+)")
-PERSONA_RE = re.compile(r"\[PERSONA\]\s+(\w+)")
-MIMIC_RE = re.compile(r"\[MIMIC\]\s+#(\d+)")
-BRAIN_RE = re.compile(r"\[BRAIN\]\s+(.+)")
+TAG_RE = re.compile(r"\[(PERSONA|MIMIC|BRAIN|CHOREO)\]\s+(.+)")
+PERSONA_RE = re.compile(r"\w+")
+MIMIC_RE = re.compile(r"#(\d+)")
 VID_RE = re.compile(r"VID:\s*0x([0-9A-Fa-f]{4}),\s*PID:\s*0x([0-9A-Fa-f]{4})")
-CHOREO_RE = re.compile(r"\[CHOREO\]\s+(.+)")
+USB_KMSG_RE = re.compile(r"\b(usb|xhci|ehci|ohci|hid)\S*", re.IGNORECASE)
 
 
 @dataclass
@@ -39,6 +51,7 @@ class CorrelatedEvent:
     ts: float
     source: str
     message: str
+    blame: Optional[str] = None
 
 
 @dataclass
@@ -47,9 +60,40 @@ class OracleSession:
     host_profile: Optional[str] = None
     persona: Optional[str] = None
     usb_snapshots: int = 0
+    lock: threading.Lock = field(default_factory=threading.Lock)
+    correlator: EventCorrelator = field(default_factory=EventCorrelator)
+    blames: deque = field(default_factory=lambda: deque(maxlen=200))
+    recorder: Optional[JsonlWriter] = None
+
+    def __post_init__(self) -> None:
+        self.correlator.on_attribution = self._on_attribution
+
+    def add(self, source: str, message: str, blame: Optional[str] = None) -> None:
+        self.events.append(CorrelatedEvent(time.time(), source, message, blame))
+
+    def record(self, kind: str, **fields) -> None:
+        if self.recorder:
+            self.recorder.write("oracle", kind, **fields)
+
+    def _on_attribution(self, att: Attribution) -> None:
+        blame = att.blame()
+        self.blames.append(att)
+        self.add(att.event.source, att.event.message, blame)
+        print(f"[BLAME] {att.event.message[:80]} <- {blame}")
 
-    def add(self, source: str, message: str) -> None:
-        self.events.append(CorrelatedEvent(time.time(), source, message))
+    def device_record(self, payload: dict) -> None:
+        self.record("pg", rec=payload)
+        with self.lock:
+            self.correlator.on_device(payload)
+
+    def host_record(self, source: str, message: str, host_t: Optional[float]) -> None:
+        self.record(source, host_t=host_t, msg=message)
+        with self.lock:
+            self.correlator.on_host(source, message, host_t)
+
+    def flush(self) -> None:
+        with self.lock:
+            self.correlator.flush()
 
 
 def find_serial_port(hint: Optional[str]) -> Optional[str]:
@@ -78,45 +122,49 @@ def snapshot_lsusb(session: OracleSession) -> None:
 def parse_device_line(line: str, session: OracleSession) -> None:
     session.add("device", line)
 
-    m = ORACLE_HOST_RE.search(line)
-    if m:
-        session.host_profile = m.group(1)
-        session.add("correlate", f"ORACLE fingerprint -> {session.host_profile}")
+    if "Host classified" in line:
+        m = ORACLE_HOST_RE.search(line)
+        if m:
+            session.host_profile = m.group(1)
+            session.add("correlate", f"ORACLE fingerprint -> {session.host_profile}")
+
+    if "[" in line:
+        m = TAG_RE.search(line)
+        if m:
+            tag, rest = m.groups()
+            if tag == "PERSONA":
+                n = PERSONA_RE.match(rest)
+                if n:
+                    session.persona = n.group(0)
+                    session.add("correlate", f"Persona engaged: {session.persona}")
+            elif tag == "MIMIC":
+                n = MIMIC_RE.match(rest)
+                if n:
+                    session.add("correlate", f"Mimic vault deploy #{n.group(1)}")
+            elif tag == "BRAIN":
+                session.add("correlate", f"Brain: {rest}")
+            else:
+                session.add("correlate", f"Choreography: {rest}")
+
+    if "VID:" in line:
+        m = VID_RE.search(line)
+        if m:
+            session.add("correlate", f"Identity swap VID:PID = {m.group(1)}:{m.group(2)}")
 
-    m = PERSONA_RE.search(line)
-    if m:
-        session.persona = m.group(1)
-        session.add("correlate", f"Persona engaged: {session.persona}")
 
-    m = MIMIC_RE.search(line)
-    if m:
-        session.add("correlate", f"Mimic vault deploy #{m.group(1)}")
-
-    m = BRAIN_RE.search(line)
-    if m:
-        session.add("correlate", f"Brain: {m.group(1)}")
+def serial_reader(ser: serial.Serial, session: OracleSession, stop: threading.Event) -> None:
+    def on_line(line: str) -> None:
+        print(f"[DEV] {line}")
+        session.record("line", msg=line)
+        parse_device_line(line, session)
 
-    m = CHOREO_RE.search(line)
-    if m:
-        session.add("correlate", f"Choreography: {m.group(1)}")
+    def on_record(rec: dict) -> None:
+        line = "@PG" + json.dumps(rec, separators=(",", ":"))
+        print(f"[DEV] {line}")
+        session.add("device", line)
+        session.device_record(rec)
 
-    m = VID_RE.search(line)
-    if m:
-        session.add("correlate", f"Identity swap VID:PID = {m.group(1)}:{m.group(2)}")
-
-
-def serial_reader(ser: serial.Serial, session: OracleSession, stop: threading.Event) -> None:
-    while not stop.is_set():
-        try:
-            raw = ser.readline()
-        except serial.SerialException:
-            break
-        if not raw:
-            continue
-        line = raw.decode("utf-8", errors="replace").rstrip("\r\n")
-        if line:
-            print(f"[DEV] {line}")
-            parse_device_line(line, session)
+    pump(ser, FrameReader(on_record, on_line), stop)
 
 
 def host_watcher(session: OracleSession, interval: float, stop: threading.Event) -> None:
@@ -134,12 +182,62 @@ def host_watcher(session: OracleSession, interval: float, stop: threading.Event)
         stop.wait(interval)
 
 
+def kernel_watcher(session: OracleSession, stop: threading.Event) -> None:
+    try:
+        proc = subprocess.Popen(["dmesg", "-w"], stdout=subprocess.PIPE,
+                                stderr=subprocess.DEVNULL, text=True)
+    except FileNotFoundError:
+        return
+    while not stop.is_set() and proc.stdout:
+        line = proc.stdout.readline()
+        if not line:
+            break
+        ts, msg = split_kernel_timestamp(line)
+        if USB_KMSG_RE.search(msg):
+            session.host_record("kernel", msg[:160], ts)
+    proc.terminate()
+
+
+def uevent_watcher(session: OracleSession, stop: threading.Event) -> None:
+    try:
+        proc = subprocess.Popen(
+            ["udevadm", "monitor", "--kernel", "--subsystem-match=usb"],
+            stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True,
+        )
+    except FileNotFoundError:
+        return
+    while not stop.is_set() and proc.stdout:
+        line = proc.stdout.readline()
+        if not line:
+            break
+        m = UEVENT_RE.match(line)
+        if m:
+            session.host_record("uevent", f"{m.group(2)} {m.group(3)}", float(m.group(1)))
+    proc.terminate()
+
+
+def blame_flusher(session: OracleSession, stop: threading.Event) -> None:
+    while not stop.wait(0.1):
+        session.flush()
+
+
 def print_report(session: OracleSession) -> None:
     print("\n=== GREMLIN ORACLE SESSION REPORT ===")
     print(f"Host profile (device-side): {session.host_profile or 'not yet classified'}")
     print(f"Active persona:             {session.persona or 'n/a'}")
     print(f"Host USB snapshots:         {session.usb_snapshots}")
     print(f"Correlated events:          {len(session.events)}")
+    corr = session.correlator.to_dict()
+    clock = corr["clock"]
+    print(f"Clock offset / drift:       {clock['offset_s']:.6f} s / {clock['drift_ppm']:+.1f} ppm "
+          f"({clock['samples']} samples)")
+    print(f"Host events attributed:     {corr['attributed']} "
+          f"(unattributed {corr['unattributed']})")
+    if session.blames:
+        print("\nRecent blame:")
+        for att in list(session.blames)[-10:]:
+            print(f"  [{att.event.source:6}] {att.event.message[:60]}")
+            print(f"           <- {att.blame()}")
     print("\nRecent timeline:")
     for ev in list(session.events)[-20:]:
         ts = time.strftime("%H:%M:%S", time.localtime(ev.ts))
@@ -153,6 +251,8 @@ def main() -> int:
     parser.add_argument("-b", "--baud", type=int, default=115200)
     parser.add_argument("--host-poll", type=float, default=2.0, help="lsusb poll interval (s)")
     parser.add_argument("--duration", type=float, default=0, help="Run N seconds then report (0=forever)")
+    parser.add_argument("--record", metavar="PATH",
+                        help="Record the session (.jsonl, else compressed PGSES1; see session.py)")
     args = parser.parse_args()
 
     port = find_serial_port(args.port)
@@ -161,15 +261,22 @@ def main() -> int:
         return 1
 
     session = OracleSession()
+    if args.record:
+        session.recorder = open_recorder(args.record)
+        session.record("lane", port=port, host="local", wall=round(time.time(), 3))
     stop = threading.Event()
 
     ser = serial.Serial(port, args.baud, timeout=0.2)
     time.sleep(0.3)
     ser.write(b"o")  # request oracle report on connect
+    session.record("cmd", cmd="o")
 
     threads = [
         threading.Thread(target=serial_reader, args=(ser, session, stop), daemon=True),
         threading.Thread(target=host_watcher, args=(session, args.host_poll, stop), daemon=True),
+        threading.Thread(target=kernel_watcher, args=(session, stop), daemon=True),
+        threading.Thread(target=uevent_watcher, args=(session, stop), daemon=True),
+        threading.Thread(target=blame_flusher, args=(session, stop), daemon=True),
     ]
     for t in threads:
         t.start()
@@ -189,6 +296,9 @@ def main() -> int:
         stop.set()
 
     ser.close()
+    session.correlator.flush(force=True)
+    if session.recorder:
+        session.recorder.close()
     print_report(session)
     return 0
 
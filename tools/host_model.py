@@ -0,0 +1,182 @@
+"""Host models fitted from recorded Overwatch sessions.
+
+portgremlin-calibrate.py turns `portgremlin-overwatch.py --record`
+recordings into a host_models.json; sim_engine and cosim sample from it
+instead of their built-in guesses. Per host OS a model holds:
+
+- the connect-to-SET_CONFIGURATION latency in ticks, as a Kaplan-Meier
+  estimate, because a re-enumeration before the host configures censors
+  the sample (fast cycling would otherwise bias it short)
+- the bus-reset count distribution
+- kernel errors per enumeration and the disconnect probability, keyed by
+  what the enumeration looked like (malformed, contradiction, fast cycling)
+  and shrunk toward the host's pooled rate where a key was rarely seen
+- the most common normalized kernel messages, for realistic logs
+"""
+
+from __future__ import annotations
+
+import json
+import math
+import random
+from collections import Counter
+from dataclasses import asdict, dataclass, field
+from typing import Any, Optional
+
+MODEL_VERSION = 1
+FAST_INTERVAL_TICKS = 2
+PRIOR_WEIGHT = 10.0
+POOLED = "*"
+TOP_MESSAGES = 8
+
+
+def feature_key(malformed: bool, contradiction: bool, fast: bool) -> str:
+    key = ("m" if malformed else "") + ("c" if contradiction else "") + ("f" if fast else "")
+    return key or "-"
+
+
+@dataclass
+class Observations:
+    """Raw counts for one host OS, accumulated over any number of sessions."""
+
+    latencies: list[tuple[int, bool]] = field(default_factory=list)
+    resets: Counter = field(default_factory=Counter)
+    enums: Counter = field(default_factory=Counter)
+    errors: Counter = field(default_factory=Counter)
+    disconnects: Counter = field(default_factory=Counter)
+    messages: Counter = field(default_factory=Counter)
+    unattributed: int = 0
+    duration_s: float = 0.0
+
+    def merge(self, other: Observations) -> None:
+        self.latencies += other.latencies
+        for name in ("resets", "enums", "errors", "disconnects", "messages"):
+            getattr(self, name).update(getattr(other, name))
+        self.unattributed += other.unattributed
+        self.duration_s += other.duration_s
+
+
+def kaplan_meier(samples: list[tuple[int, bool]]) -> tuple[list[tuple[int, float]], float]:
+    """CDF steps [(ticks, P(latency <= ticks))] and the mass never observed to end.
+
+    samples are (ticks, observed); observed=False means the enumeration was
+    abandoned after `ticks` without the host configuring it.
+    """
+    done = Counter(t for t, obs in samples if obs)
+    censored = Counter(t for t, obs in samples if not obs)
+    at_risk = len(samples)
+    surv = 1.0
+    steps: list[tuple[int, float]] = []
+    for t in sorted(set(done) | set(censored)):
+        d = done.get(t, 0)
+        if d and at_risk:
+            surv *= 1.0 - d / at_risk
+            steps.append((t, round(1.0 - surv, 6)))
+        at_risk -= d + censored.get(t, 0)
+    return steps, round(surv, 6)
+
+
+def _shrunk_rates(hits: Counter, enums: Counter) -> dict[str, float]:
+    total = sum(enums.values())
+    pooled = sum(hits.values()) / total if total else 0.0
+    rates = {POOLED: round(pooled, 6)}
+    for key, n in enums.items():
+        rates[key] = round((hits.get(key, 0) + pooled * PRIOR_WEIGHT) / (n + PRIOR_WEIGHT), 6)
+    return rates
+
+
+@dataclass
+class HostModel:
+    os: str
+    enums: int
+    latency: list[tuple[int, float]]
+    never_configures: float
+    resets: list[tuple[int, float]]
+    error_rate: dict[str, float]
+    disconnect_p: dict[str, float]
+    messages: list[tuple[str, float]] = field(default_factory=list)
+    enums_per_hour: float = 0.0
+
+    @classmethod
+    def fit(cls, os_name: str, obs: Observations) -> HostModel:
+        steps, residual = kaplan_meier(obs.latencies)
+        configured = sum(obs.resets.values())
+        resets = sorted((n, round(c / configured, 6)) for n, c in obs.resets.items()) if configured else []
+        total_msgs = sum(obs.messages.values())
+        messages = [(m, round(c / total_msgs, 6)) for m, c in obs.messages.most_common(TOP_MESSAGES)]
+        enums = sum(obs.enums.values())
+        rate = enums * 3600.0 / obs.duration_s if obs.duration_s > 0 else 0.0
+        return cls(os_name, enums, steps, residual, resets,
+                   _shrunk_rates(obs.errors, obs.enums),
+                   _shrunk_rates(obs.disconnects, obs.enums),
+                   messages, round(rate, 1))
+
+    def sample_latency(self, rng: random.Random) -> Optional[int]:
+        """Ticks until SET_CONFIGURATION, or None if this host would not configure."""
+        u = rng.random()
+        for ticks, cdf in self.latency:
+            if u <= cdf:
+                return ticks
+        return None
+
+    def sample_resets(self, rng: random.Random) -> int:
+        u = rng.random()
+        acc = 0.0
+        for count, p in self.resets:
+            acc += p
+            if u <= acc:
+                return count
+        return self.resets[-1][0] if self.resets else 0
+
+    def sample_errors(self, rng: random.Random, key: str) -> int:
+        lam = self.error_rate.get(key, self.error_rate.get(POOLED, 0.0))
+        if lam <= 0.0:
+            return 0
+        limit = math.exp(-lam)
+        count, prod = 0, rng.random()
+        while prod > limit:
+            count += 1
+            prod *= rng.random()
+        return count
+
+    def rejects(self, rng: random.Random, key: str) -> bool:
+        return rng.random() < self.disconnect_p.get(key, self.disconnect_p.get(POOLED, 0.0))
+
+    def sample_message(self, rng: random.Random) -> str:
+        if not self.messages:
+            return "usb: error (calibrated)"
+        return rng.choices([m for m, _ in self.messages], [w for _, w in self.messages])[0]
+
+    def latency_quantile(self, q: float) -> Optional[int]:
+        for ticks, cdf in self.latency:
+            if cdf >= q:
+                return ticks
+        return None
+
+    @classmethod
+    def from_dict(cls, data: dict[str, Any]) -> HostModel:
+        return cls(
+            data["os"], int(data["enums"]),
+            [(int(t), float(p)) for t, p in data["latency"]],
+            float(data["never_configures"]),
+            [(int(n), float(p)) for n, p in data["resets"]],
+            {k: float(v) for k, v in data["error_rate"].items()},
+            {k: float(v) for k, v in data["disconnect_p"].items()},
+            [(m, float(w)) for m, w in data.get("messages", [])],
+            float(data.get("enums_per_hour", 0.0)),
+        )
+
+
+def load_models(path: str) -> dict[str, HostModel]:
+    with open(path, encoding="utf-8") as f:
+        data = json.load(f)
+    if data.get("version") != MODEL_VERSION:
+        raise ValueError(f"{path}: unsupported host model version {data.get('version')}")
+    return {name: HostModel.from_dict(m) for name, m in data["hosts"].items()}
+
+
+def save_models(path: str, models: dict[str, HostModel]) -> None:
+    data = {"version": MODEL_VERSION, "hosts": {name: asdict(m) for name, m in sorted(models.items())}}
+    with open(path, "w", encoding="utf-8") as f:
+        json.dump(data, f, indent=1)
+        f.write("\n")
@@ -0,0 +1,204 @@
+"""Bulk serial ingestion and incremental frame parsing for the host tools.
+
+The device writes CR/LF-terminated text with @PG{...} telemetry records
+mixed in. Rather than a readline() per line, pump() drains whatever the port
+has buffered in one read, FrameReader splits all complete lines of the chunk
+at once and keeps the tail in a reusable buffer, and records are recognised
+by prefix instead of a regex. If the optional _pgframe extension is built
+(python3 tools/ingest.py build), flat records are parsed straight into
+dicts in C; anything it cannot handle falls back to json.loads.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import subprocess
+import sys
+import sysconfig
+import threading
+import time
+from typing import Any, Callable, Optional
+
+try:
+    import _pgframe  # type: ignore[import-not-found]
+except ImportError:
+    _pgframe = None
+
+PG_PREFIX = b"@PG{"
+MAX_LINE = 4096
+READ_CHUNK = 65536
+
+RecordHandler = Callable[[dict[str, Any]], None]
+LineHandler = Callable[[str], None]
+
+
+class FrameReader:
+    """Incremental line framer; feed() raw bytes, get records and text lines."""
+
+    def __init__(self, on_record: RecordHandler, on_line: Optional[LineHandler] = None,
+                 max_line: int = MAX_LINE, accelerated: bool = True) -> None:
+        self.on_record = on_record
+        self.on_line = on_line
+        self.max_line = max_line
+        self.accelerated = accelerated and _pgframe is not None
+        self._buf = bytearray()
+        self.bytes_in = 0
+        self.lines = 0
+        self.records = 0
+        self.bad_records = 0
+        self.overflows = 0
+
+    def feed(self, data: bytes) -> None:
+        self.bytes_in += len(data)
+        buf = self._buf
+        buf += data
+        end = buf.rfind(b"\n")
+        if end < 0:
+            if len(buf) > self.max_line:
+                self.overflows += 1
+                buf.clear()
+            return
+        chunk = bytes(buf[:end])
+        del buf[:end + 1]
+        if self.accelerated:
+            self._dispatch_c(chunk)
+        else:
+            self._dispatch_py(chunk)
+
+    def flush(self) -> None:
+        """Process a trailing unterminated line (e.g. at shutdown)."""
+        if self._buf:
+            self.feed(b"\n")
+
+    def _record_bytes(self, raw: bytes) -> None:
+        try:
+            payload = json.loads(raw)
+        except (json.JSONDecodeError, UnicodeDecodeError):
+            self.bad_records += 1
+            return
+        if isinstance(payload, dict):
+            self.records += 1
+            self.on_record(payload)
+        else:
+            self.bad_records += 1
+
+    def _dispatch_py(self, chunk: bytes) -> None:
+        on_line = self.on_line
+        for line in chunk.split(b"\n"):
+            self.lines += 1
+            pos = line.find(PG_PREFIX)
+            if pos >= 0:
+                self._record_bytes(line[pos + 3:].rstrip(b"\r"))
+            elif on_line is not None:
+                # The firmware ends lines with "\n\r", so the CR leads the next one.
+                text = line.strip(b"\r").decode("utf-8", errors="replace")
+                if text:
+                    on_line(text)
+
+    def _dispatch_c(self, chunk: bytes) -> None:
+        on_record = self.on_record
+        on_line = self.on_line
+        items, nlines = _pgframe.scan(chunk, on_line is not None)
+        self.lines += nlines
+        for item in items:
+            kind = type(item)
+            if kind is dict:
+                self.records += 1
+                on_record(item)
+            elif kind is str:
+                on_line(item)  # type: ignore[misc]
+            else:
+                self._record_bytes(item)
+
+    def stats(self) -> dict[str, Any]:
+        return {
+            "bytes": self.bytes_in,
+            "lines": self.lines,
+            "records": self.records,
+            "bad_records": self.bad_records,
+            "overflows": self.overflows,
+            "accelerated": self.accelerated,
+        }
+
+
+def pump(ser: Any, reader: FrameReader, stop: threading.Event,
+         chunk: int = READ_CHUNK) -> Optional[Exception]:
+    """Drain a pyserial port into reader until stop is set or the port fails.
+
+    Blocks for at most ser.timeout waiting for the first byte, then takes
+    everything already buffered in one read.
+    """
+    while not stop.is_set():
+        try:
+            data = ser.read(1)
+            if data:
+                waiting = ser.in_waiting
+                if waiting:
+                    data += ser.read(min(waiting, chunk))
+        except OSError as exc:  # serial.SerialException is an OSError
+            return exc
+        if data:
+            reader.feed(data)
+    reader.flush()
+    return None
+
+
+def build_extension(verbose: bool = True) -> Optional[str]:
+    """Compile _pgframe.c next to this file; returns the module path."""
+    here = os.path.dirname(os.path.abspath(__file__))
+    src = os.path.join(here, "_pgframe.c")
+    out = os.path.join(here, "_pgframe" + sysconfig.get_config_var("EXT_SUFFIX"))
+    cc = os.environ.get("CC") or sysconfig.get_config_var("CC") or "cc"
+    cmd = cc.split() + ["-O2", "-shared", "-fPIC", "-Wall",
+                        "-I" + sysconfig.get_paths()["include"], src, "-o", out]
+    if verbose:
+        print(" ".join(cmd))
+    try:
+        subprocess.check_call(cmd)
+    except (OSError, subprocess.CalledProcessError) as exc:
+        print(f"_pgframe build failed ({exc}); pure-Python ingestion will be used",
+              file=sys.stderr)
+        return None
+    return out
+
+
+def _bench(lines: int = 200_000) -> None:
+    sample = (b'@PG{"e":"enum","vid":"046D","pid":"C52B","cls":"Keyboard","n":123,"gen":4,'
+              b'"f":9,"mw":500,"pa":128,"t":98765}\n\r'
+              b"Re-enumerating USB with new identity...\n\r"
+              b"New VID: 0x046D, PID: 0xC52B\n\r")
+    blob = sample * (lines // 3)
+    for accel in (False, True):
+        if accel and _pgframe is None:
+            print("accelerated: _pgframe not built")
+            continue
+        count = [0, 0]
+        reader = FrameReader(lambda _r: count.__setitem__(0, count[0] + 1),
+                             lambda _l: count.__setitem__(1, count[1] + 1), accelerated=accel)
+        t0 = time.perf_counter()
+        for i in range(0, len(blob), 4096):
+            reader.feed(blob[i:i + 4096])
+        dt = time.perf_counter() - t0
+        print(f"{'accelerated' if accel else 'python':11}: {reader.lines / dt / 1e3:8.0f}k lines/s "
+              f"({count[0]} records, {count[1]} text, {len(blob) / dt / 1e6:.1f} MB/s)")
+
+
+def main() -> int:
+    import argparse
+
+    parser = argparse.ArgumentParser(description="Build or benchmark the @PG frame parser")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    sub.add_parser("build", help="compile the optional _pgframe extension")
+    bench = sub.add_parser("bench", help="compare pure-Python and accelerated parsing")
+    bench.add_argument("--lines", type=int, default=200_000)
+    args = parser.parse_args()
+
+    if args.cmd == "build":
+        return 0 if build_extension() else 1
+    _bench(args.lines)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
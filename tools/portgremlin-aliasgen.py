@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""
+PortGremlin Aliasgen — compile a lab host's modules.alias into the flash
+table behind the firmware's alias walk.
+
+Every `alias usb:v....p....` line in modules.alias names a kernel module
+and a glob over the modalias the kernel builds for each interface of a new
+device. Only aliases with a concrete vendor and product are kept. Each one
+is matched against the modaliases PortGremlin's own descriptor sets would
+produce (portgremlin_descriptors.c: bcdDevice 0100, device class 00, the
+interface triples below), so an entry is kept only if at least one of the
+five device classes would bind it as presented. The entry records which
+classes those are.
+
+The table is sorted by VID/PID for the firmware's binary search. A second
+array gives the walk order, round-robin over modules, so consecutive
+enumerations probe different drivers. --per-module caps the identities
+per module and --max caps the table.
+
+    python3 tools/portgremlin-aliasgen.py                       # this host
+    python3 tools/portgremlin-aliasgen.py lab2.modules.alias --emit usb_dev_keyboard/portgremlin_alias_table.h
+    ssh lab2 cat /lib/modules/\\$(uname -r)/modules.alias | python3 tools/portgremlin-aliasgen.py - --host lab2
+"""
+
+from __future__ import annotations
+
+import argparse
+import fnmatch
+import os
+import platform
+import re
+import sys
+from collections import OrderedDict
+
+ALIAS_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..",
+                            "usb_dev_keyboard", "portgremlin_alias_table.h")
+
+# DeviceType order, with the (class, subclass, protocol) of every interface
+# the descriptor set for that class presents.
+DEVICE_INTERFACES = [
+    ("Keyboard", [(0x03, 0x01, 0x01)]),
+    ("Audio", [(0x01, 0x01, 0x00), (0x01, 0x02, 0x00)]),
+    ("Printer", [(0x07, 0x01, 0x02)]),
+    ("MIDI", [(0x01, 0x01, 0x00), (0x01, 0x03, 0x00)]),
+    ("Gamepad", [(0x03, 0x00, 0x00)]),
+]
+BCD_DEVICE = 0x0100
+
+ALIAS_RE = re.compile(r"^alias\s+(usb:v([0-9A-F]{4})p([0-9A-F]{4})\S*)\s+(\S+)\s*$")
+
+
+def modaliases(vid: int, pid: int, interfaces: list[tuple[int, int, int]]) -> list[str]:
+    return [f"usb:v{vid:04X}p{pid:04X}d{BCD_DEVICE:04X}dc00dsc00dp00"
+            f"ic{c:02X}isc{s:02X}ip{p:02X}in{n:02X}"
+            for n, (c, s, p) in enumerate(interfaces)]
+
+
+def class_mask(pattern: str, vid: int, pid: int) -> int:
+    mask = 0
+    for bit, (_, interfaces) in enumerate(DEVICE_INTERFACES):
+        if any(fnmatch.fnmatchcase(m, pattern) for m in modaliases(vid, pid, interfaces)):
+            mask |= 1 << bit
+    return mask
+
+
+def parse_aliases(lines) -> tuple[OrderedDict, int]:
+    """(vid, pid) -> [module, class mask]; the first module to claim an identity wins."""
+    table: OrderedDict = OrderedDict()
+    seen = 0
+    for line in lines:
+        m = ALIAS_RE.match(line.strip())
+        if not m:
+            continue
+        seen += 1
+        pattern, vid, pid, module = m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4)
+        mask = class_mask(pattern, vid, pid)
+        if not mask:
+            continue
+        entry = table.get((vid, pid))
+        if entry is None:
+            table[(vid, pid)] = [module, mask]
+        elif entry[0] == module:
+            entry[1] |= mask
+    return table, seen
+
+
+def select(table: OrderedDict, per_module: int, limit: int) -> tuple[list, list[str], list[int]]:
+    by_module: OrderedDict = OrderedDict()
+    for (vid, pid), (module, mask) in table.items():
+        ids = by_module.setdefault(module, [])
+        if len(ids) < per_module:
+            ids.append((vid, pid, mask))
+
+    # Round-robin: one identity from each module, then the second of each...
+    walk: list[tuple[int, int, int, str]] = []
+    depth = 0
+    while len(walk) < limit and any(len(ids) > depth for ids in by_module.values()):
+        for module, ids in by_module.items():
+            if len(ids) > depth and len(walk) < limit:
+                walk.append((*ids[depth], module))
+        depth += 1
+
+    modules = sorted({w[3] for w in walk})
+    module_index = {name: i for i, name in enumerate(modules)}
+    entries = sorted((vid, pid, module_index[module], mask) for vid, pid, mask, module in walk)
+    position = {(e[0], e[1]): i for i, e in enumerate(entries)}
+    order = [position[(vid, pid)] for vid, pid, _, _ in walk]
+    return entries, modules, order
+
+
+def wrap(items: list[str], indent: str = "    ", width: int = 92) -> list[str]:
+    lines, cur = [], indent
+    for item in items:
+        piece = item + ","
+        if len(cur) + len(piece) + 1 > width and cur.strip():
+            lines.append(cur.rstrip())
+            cur = indent
+        cur += piece + " "
+    if cur.strip():
+        lines.append(cur.rstrip())
+    return lines
+
+
+def emit_header(path: str, entries: list, modules: list[str], order: list[int],
+                provenance: list[str]) -> None:
+    lines = [
+        "#ifndef PORTGREMLIN_ALIAS_TABLE_H",
+        "#define PORTGREMLIN_ALIAS_TABLE_H",
+        "",
+        "/*",
+        " * USB identities that bind a kernel driver on the lab host, for the",
+        " * alias walk. Generated by tools/portgremlin-aliasgen.py --emit; re-run it",
+        " * against the host's modules.alias rather than editing by hand.",
+        " *",
+    ]
+    lines += [f" * {p}" if p else " *" for p in provenance]
+    lines += [" */", "", "static const char * const g_ppcAliasModules[] =", "{"]
+    lines += wrap([f'"{m}"' for m in modules])
+    lines += ["};", "", "/* Sorted by VID, then PID. Classes: bit n set if DeviceType n binds. */",
+              "static const PortGremlinAlias g_psAliases[] =", "{"]
+    lines += [f"    {{ 0x{vid:04X}, 0x{pid:04X}, {mod}, 0x{mask:02X} }},"
+              for vid, pid, mod, mask in entries]
+    lines += ["};", "", "/* Walk order: round-robin over the modules. */",
+              "static const uint16_t g_pui16AliasWalk[] =", "{"]
+    lines += wrap([str(i) for i in order])
+    lines += ["};", "", "#endif", ""]
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines))
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Compile modules.alias into the alias walk table")
+    parser.add_argument("alias", nargs="?",
+                        default=f"/lib/modules/{platform.release()}/modules.alias",
+                        help="modules.alias to read, - for stdin (default: this host's)")
+    parser.add_argument("--host", default=platform.node(), help="host name for the provenance note")
+    parser.add_argument("--per-module", type=int, default=4, help="identities kept per module")
+    parser.add_argument("--max", type=int, default=512, help="table entries")
+    parser.add_argument("--emit", metavar="PATH", nargs="?", const=ALIAS_HEADER,
+                        help=f"write the C table (default path {os.path.relpath(ALIAS_HEADER)})")
+    args = parser.parse_args()
+
+    if args.alias == "-":
+        table, seen = parse_aliases(sys.stdin)
+        source = "stdin"
+    else:
+        with open(args.alias, encoding="utf-8", errors="replace") as f:
+            table, seen = parse_aliases(f)
+        source = args.alias
+
+    entries, modules, order = select(table, max(1, args.per_module), max(1, min(args.max, 65535)))
+    if not entries:
+        print(f"{source}: no vendor/product alias binds any PortGremlin class", file=sys.stderr)
+        return 1
+
+    names = [name for name, _ in DEVICE_INTERFACES]
+    per_class = [sum(1 for e in entries if e[3] & (1 << b)) for b in range(len(names))]
+    print(f"{source}: {seen} VID/PID aliases, {len(table)} bindable identities, "
+          f"{len(entries)} kept over {len(modules)} modules "
+          f"({len(entries) * 8 + len(order) * 2} bytes of table)")
+    print("  per class: " + ", ".join(f"{n} {c}" for n, c in zip(names, per_class)))
+
+    if args.emit:
+        emit_header(args.emit, entries, modules, order, [
+            f"Last run: {args.host}, {source}: {len(entries)} identities over",
+            f"{len(modules)} modules (--per-module {args.per_module}, --max {args.max}).",
+        ])
+        print(f"Alias table written to {args.emit}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""
+PortGremlin Calibrate — fit the simulator's host model to real sessions.
+
+Replays `portgremlin-overwatch.py --record` sessions: device
+telemetry gives each enumeration's features and the host's measured
+SET_CONFIGURATION latency and bus resets (the Oracle's "host" record),
+"disconnect" records give rejections, and kernel errors are attributed to
+enumerations through the same correlator Overwatch uses live. The per-OS
+fits are written to a host model file that sim_engine, cosim and the
+Virtual Lab load with --host-model.
+
+    python3 tools/portgremlin-overwatch.py --lane name=l1,port=/dev/ttyACM0,os=linux \\
+        --record reports/linux-1.pgses
+    python3 tools/portgremlin-calibrate.py reports/*.pgses
+    python3 tools/cosim.py --host linux --host-model reports/host_models.json
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import sys
+from collections import Counter
+from dataclasses import dataclass, field
+from typing import Any, Optional
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from correlate import Attribution, EventCorrelator
+from host_model import FAST_INTERVAL_TICKS, POOLED, HostModel, Observations, feature_key, load_models, save_models
+from session import SessionReader
+from triage import normalize
+
+# PORTGREMLIN_FLAG_* in portgremlin_config.h.
+FLAG_MALFORMED = 0x01
+FLAG_CONTRADICTION = 0x02
+
+OS_NAMES = {
+    "windows": "windows", "win": "windows",
+    "linux": "linux",
+    "macos": "macos", "mac": "macos", "osx": "macos",
+    "embedded": "embedded",
+    "unknown": "unknown",
+}
+KERNEL_SOURCES = ("kernel", "journal")
+
+
+def os_name(label: Optional[str]) -> Optional[str]:
+    if not label:
+        return None
+    return OS_NAMES.get(label.strip().lower())
+
+
+@dataclass
+class LaneReplay:
+    """Rebuilds one lane's enumerations and attributes its kernel errors."""
+
+    name: str
+    target_os: Optional[str] = None
+    kernel_source: str = "kernel"
+    obs: Observations = field(default_factory=Observations)
+    oracle: Counter = field(default_factory=Counter)
+    cur_tick: Optional[int] = None
+    cur_key: Optional[str] = None
+    configured: bool = False
+    disconnected: bool = False
+    first_t: Optional[float] = None
+    last_t: float = 0.0
+
+    def __post_init__(self) -> None:
+        self.keys: dict[tuple[int, int], str] = {}
+        self.correlator = EventCorrelator(on_attribution=self._on_attribution)
+
+    def _on_attribution(self, att: Attribution) -> None:
+        key = self.keys.get((att.enum.n, att.enum.dev_tick)) if att.enum else None
+        if key is None:
+            self.obs.unattributed += 1
+            return
+        self.obs.errors[key] += 1
+        self.obs.messages[normalize(att.event.message)] += 1
+
+    def _enum(self, rec: dict[str, Any]) -> None:
+        tick = int(rec.get("t", 0))
+        gap = None
+        if self.cur_tick is not None and tick >= self.cur_tick:
+            gap = tick - self.cur_tick
+            if not self.configured and not self.disconnected:
+                # Abandoned before the host configured it: latency > gap.
+                self.obs.latencies.append((gap, False))
+        flags = int(rec.get("f", 0))
+        key = feature_key(bool(flags & FLAG_MALFORMED), bool(flags & FLAG_CONTRADICTION),
+                          gap is not None and gap <= FAST_INTERVAL_TICKS)
+        self.cur_tick, self.cur_key = tick, key
+        self.configured = self.disconnected = False
+        self.obs.enums[key] += 1
+        self.keys[(int(rec.get("n", 0)), tick)] = key
+
+    def on_pg(self, rec: dict[str, Any], t: float) -> None:
+        if self.first_t is None:
+            self.first_t = t
+        self.last_t = t
+        etype = rec.get("e", "")
+        if etype == "enum":
+            self._enum(rec)
+        elif etype == "host":
+            self.oracle[os_name(rec.get("os"))] += 1
+            if self.cur_key is not None and not self.configured:
+                self.configured = True
+                self.obs.latencies.append((int(rec.get("lat", 0)), True))
+                self.obs.resets[int(rec.get("rst", 0))] += 1
+        elif etype == "disconnect":
+            if self.cur_key is not None and not self.disconnected:
+                self.disconnected = True
+                self.obs.disconnects[self.cur_key] += 1
+        self.correlator.on_device(rec, t)
+
+    def on_kernel(self, source: str, msg: str, host_t: Optional[float], t: float) -> None:
+        if source == self.kernel_source:
+            self.correlator.on_host(source, msg, host_t if host_t is not None else t, now=t)
+
+    def finish(self) -> None:
+        self.correlator.flush(force=True)
+        if self.first_t is not None:
+            self.obs.duration_s = self.last_t - self.first_t
+
+    def resolved_os(self) -> Optional[str]:
+        if self.target_os:
+            return self.target_os
+        votes = [(n, os_) for os_, n in self.oracle.items() if os_ and os_ != "unknown"]
+        return max(votes)[1] if votes else None
+
+
+def replay_log(path: str, override_os: Optional[str]) -> list[LaneReplay]:
+    entries = list(SessionReader(path).records())
+
+    # dmesg and journalctl both see the same kernel messages; use one of them.
+    sources: dict[str, set[str]] = {}
+    for e in entries:
+        if e.get("k") in KERNEL_SOURCES:
+            sources.setdefault(e.get("lane", ""), set()).add(e["k"])
+
+    lanes: dict[str, LaneReplay] = {}
+    for e in entries:
+        name = e.get("lane", "")
+        lane = lanes.get(name)
+        if lane is None:
+            seen = sources.get(name, set())
+            lane = LaneReplay(name, kernel_source="kernel" if "kernel" in seen or not seen else "journal")
+            lanes[name] = lane
+        kind = e.get("k")
+        t = float(e.get("t", 0.0))
+        if kind == "lane":
+            lane.target_os = override_os or os_name(e.get("os"))
+        elif kind == "pg" and isinstance(e.get("rec"), dict):
+            lane.on_pg(e["rec"], t)
+        elif kind in KERNEL_SOURCES:
+            lane.on_kernel(kind, e.get("msg", ""), e.get("host_t"), t)
+
+    for lane in lanes.values():
+        if override_os:
+            lane.target_os = override_os
+        lane.finish()
+    return list(lanes.values())
+
+
+def _fmt_rate(rates: dict[str, float]) -> str:
+    return " ".join(f"{k}={v:.3f}" for k, v in sorted(rates.items()) if k != POOLED)
+
+
+def print_model(model: HostModel, obs: Observations) -> None:
+    configured = 1.0 - model.never_configures
+    p50, p90 = model.latency_quantile(0.5), model.latency_quantile(0.9)
+    print(f"{model.os}: {model.enums} enumerations over {obs.duration_s / 3600:.2f} h "
+          f"({model.enums_per_hour:.0f}/h)")
+    print(f"  SET_CONFIGURATION: {configured:.0%} eventually, p50={p50} p90={p90} ticks "
+          f"({len(obs.latencies)} samples, {sum(1 for _, o in obs.latencies if not o)} censored)")
+    print(f"  bus resets: {', '.join(f'{n}:{p:.2f}' for n, p in model.resets) or 'none seen'}")
+    print(f"  kernel errors/enum: {model.error_rate[POOLED]:.3f} [{_fmt_rate(model.error_rate)}] "
+          f"({obs.unattributed} unattributed)")
+    print(f"  disconnect p: {model.disconnect_p[POOLED]:.4f} [{_fmt_rate(model.disconnect_p)}]")
+    for msg, w in model.messages[:3]:
+        print(f"    {w:5.1%} {msg[:90]}")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Fit PortGremlin host models from Overwatch recordings")
+    parser.add_argument("logs", nargs="+", help="Recorded sessions (PGSES1 or JSONL)")
+    parser.add_argument("--os", dest="target_os", choices=sorted(set(OS_NAMES.values())),
+                        help="Real OS of every lane in these logs (overrides lane labels)")
+    parser.add_argument("-o", "--out", default="reports/host_models.json")
+    parser.add_argument("--min-enums", type=int, default=50,
+                        help="Skip hosts with fewer recorded enumerations")
+    args = parser.parse_args()
+
+    per_os: dict[str, Observations] = {}
+    for path in args.logs:
+        for lane in replay_log(path, args.target_os):
+            host = lane.resolved_os()
+            if host is None:
+                print(f"{path} [{lane.name}]: no os= label and no Oracle verdict; skipped",
+                      file=sys.stderr)
+                continue
+            if not lane.target_os:
+                print(f"{path} [{lane.name}]: unlabelled, using Oracle majority '{host}'",
+                      file=sys.stderr)
+            per_os.setdefault(host, Observations()).merge(lane.obs)
+
+    models: dict[str, HostModel] = {}
+    if os.path.exists(args.out):
+        models = load_models(args.out)
+    fitted = 0
+    for host, obs in sorted(per_os.items()):
+        if sum(obs.enums.values()) < args.min_enums:
+            print(f"{host}: only {sum(obs.enums.values())} enumerations, not fitted", file=sys.stderr)
+            continue
+        models[host] = HostModel.fit(host, obs)
+        print_model(models[host], obs)
+        fitted += 1
+    if not fitted:
+        print("Nothing to fit", file=sys.stderr)
+        return 1
+
+    os.makedirs(os.path.dirname(args.out) or ".", exist_ok=True)
+    save_models(args.out, models)
+    print(f"Host models for {', '.join(sorted(models))} written to {args.out}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -4,12 +4,14 @@
 from __future__ import annotations
 
 import argparse
+import json
+import os
 import re
 import sys
 import threading
 import time
 from dataclasses import dataclass, field
-from typing import Optional
+from typing import Any, Callable, Optional
 
 try:
     import serial
@@ -18,6 +20,11 @@ except ImportError:
     print("pyserial required: pip install pyserial", file=sys.stderr)
     sys.exit(1)
 
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from campaign import CampaignRunner, Plan, PlanError, describe, follow_kernel, load_plan, print_summary
+from ingest import FrameReader, pump
+from session import JsonlWriter, open_recorder
+
 COMMANDS = {
     "help": "h",
     "status": "s",
@@ -45,6 +52,7 @@ COMMANDS = {
     "evolve": "g",
     "telemetry": "l",
     "overwatch": "o",
+}
 
 VID_RE = re.compile(r"VID:\s*0x([0-9A-Fa-f]{4}),\s*PID:\s*0x([0-9A-Fa-f]{4})")
 SWITCH_RE = re.compile(r"Switching to (\w+)")
@@ -66,23 +74,40 @@ class SessionStats:
 
     def record_line(self, line: str) -> None:
         now = time.time()
-        vid_match = VID_RE.search(line)
-        if vid_match:
-            self.last_vid, self.last_pid = vid_match.groups()
-            self.events.append(EnumEvent(now, "reenum", f"VID={self.last_vid} PID={self.last_pid}"))
-            return
+        if "VID:" in line:
+            vid_match = VID_RE.search(line)
+            if vid_match:
+                self.last_vid, self.last_pid = vid_match.groups()
+                self.events.append(EnumEvent(now, "reenum", f"VID={self.last_vid} PID={self.last_pid}"))
+                return
 
-        switch_match = SWITCH_RE.search(line)
-        if switch_match:
-            self.last_class = switch_match.group(1)
-            self.events.append(EnumEvent(now, "class", self.last_class))
+        if "Switching to" in line:
+            switch_match = SWITCH_RE.search(line)
+            if switch_match:
+                self.last_class = switch_match.group(1)
+                self.events.append(EnumEvent(now, "class", self.last_class))
+
+    def record_event(self, rec: dict) -> None:
+        if rec.get("e") != "enum":
+            return
+        self.last_vid = str(rec.get("vid", self.last_vid))
+        self.last_pid = str(rec.get("pid", self.last_pid))
+        if "cls" in rec:
+            self.last_class = str(rec["cls"])
+        self.events.append(EnumEvent(time.time(), "reenum", f"VID={self.last_vid} PID={self.last_pid}"))
 
 
 class PortGremlinCLI:
-    def __init__(self, port: str, baud: int = 115200) -> None:
+    def __init__(self, port: str, baud: int = 115200, record: Optional[str] = None) -> None:
         self.port = port
         self.baud = baud
         self.ser: Optional[serial.Serial] = None
+        self.recorder: Optional[JsonlWriter] = None
+        self.echo = True
+        self.on_record: Optional[Callable[[dict], None]] = None
+        if record:
+            self.recorder = open_recorder(record)
+            self.recorder.write("cli", "lane", port=port, wall=round(time.time(), 3))
         self.stats = SessionStats()
         self._reader_stop = threading.Event()
         self._reader_thread: Optional[threading.Thread] = None
@@ -100,26 +125,36 @@ class PortGremlinCLI:
             self._reader_thread.join(timeout=1.0)
         if self.ser and self.ser.is_open:
             self.ser.close()
+        if self.recorder:
+            self.recorder.close()
 
     def send(self, cmd: str) -> None:
         if not self.ser or not self.ser.is_open:
             raise RuntimeError("Not connected")
         self.ser.write(cmd.encode("ascii"))
         self.ser.flush()
+        if self.recorder:
+            self.recorder.write("cli", "cmd", cmd=cmd)
+
+    def _on_line(self, line: str) -> None:
+        if self.echo:
+            print(line)
+        self.stats.record_line(line)
+        if self.recorder:
+            self.recorder.write("cli", "line", msg=line)
+
+    def _on_record(self, rec: dict) -> None:
+        if self.echo:
+            print("@PG" + json.dumps(rec, separators=(",", ":")))
+        self.stats.record_event(rec)
+        if self.on_record:
+            self.on_record(rec)
+        if self.recorder:
+            self.recorder.write("cli", "pg", rec=rec)
 
     def _read_loop(self) -> None:
         assert self.ser is not None
-        while not self._reader_stop.is_set():
-            try:
-                raw = self.ser.readline()
-            except serial.SerialException:
-                break
-            if not raw:
-                continue
-            line = raw.decode("utf-8", errors="replace").rstrip("\r\n")
-            if line:
-                print(line)
-                self.stats.record_line(line)
+        pump(self.ser, FrameReader(self._on_record, self._on_line), self._reader_stop)
 
     def interactive(self) -> None:
         print(f"Connected to {self.port} @ {self.baud}")
@@ -163,12 +198,53 @@ def find_launchpad_port() -> Optional[str]:
     return ports[0].device if ports else None
 
 
+def run_campaign(cli: PortGremlinCLI, plan: Plan, host: str, kmsg: str,
+                 report_path: Optional[str]) -> int:
+    runner = CampaignRunner(plan, cli, host)
+    cli.echo = False
+    cli.on_record = runner.on_record
+    stop = threading.Event()
+    if kmsg != "none":
+        threading.Thread(target=follow_kernel, args=(kmsg, runner.on_kernel, stop), daemon=True).start()
+
+    result: dict[str, Any] = {}
+    worker = threading.Thread(target=lambda: result.update(runner.run(stop)), daemon=True)
+    worker.start()
+    try:
+        while worker.is_alive():
+            worker.join(0.5)
+    except KeyboardInterrupt:
+        print("\nStopping campaign...")
+        stop.set()
+        worker.join()
+    stop.set()
+
+    stamp = time.strftime("%Y%m%d-%H%M%S", time.localtime(result["started"]))
+    path = report_path or os.path.join("reports", f"campaign-{plan.name}-{host}-{stamp}.json")
+    os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+    with open(path, "w", encoding="utf-8") as f:
+        json.dump(result, f, indent=2)
+    print_summary(result)
+    print(f"Report: {path}")
+    return 0
+
+
 def main() -> int:
     parser = argparse.ArgumentParser(description="PortGremlin USB enumeration research CLI")
     parser.add_argument("-p", "--port", help="Serial port (auto-detect if omitted)")
     parser.add_argument("-b", "--baud", type=int, default=115200)
     parser.add_argument("-c", "--command", help="Send single command and exit")
     parser.add_argument("--list-ports", action="store_true", help="List serial ports")
+    parser.add_argument("--campaign", metavar="PLAN",
+                        help="Run a campaign plan (JSON, or YAML with PyYAML; see campaign.py)")
+    parser.add_argument("--host", default="default",
+                        help="Target host label; picks the plan's repetitions for it")
+    parser.add_argument("--kmsg", default="dmesg -w",
+                        help="Command streaming the target's kernel log for findings ('none' to skip)")
+    parser.add_argument("--report", metavar="PATH", help="Campaign report path")
+    parser.add_argument("--dry-run", action="store_true", help="Print the campaign schedule and exit")
+    parser.add_argument("--record", metavar="PATH",
+                        help="Record the session (.jsonl, else compressed PGSES1; see session.py)")
     args = parser.parse_args()
 
     if args.list_ports:
@@ -176,14 +252,26 @@ def main() -> int:
             print(f"{port.device}\t{port.description}")
         return 0
 
+    if args.campaign:
+        try:
+            plan = load_plan(args.campaign)
+        except (OSError, PlanError) as exc:
+            print(f"Bad campaign plan: {exc}", file=sys.stderr)
+            return 1
+        if args.dry_run:
+            print("\n".join(describe(plan, args.host)))
+            return 0
+
     port = args.port or find_launchpad_port()
     if not port:
         print("No serial port found. Use -p /dev/ttyACM0", file=sys.stderr)
         return 1
 
-    cli = PortGremlinCLI(port, args.baud)
+    cli = PortGremlinCLI(port, args.baud, args.record)
     try:
         cli.connect()
+        if args.campaign:
+            return run_campaign(cli, plan, args.host, args.kmsg, args.report)
         if args.command:
             cmd = COMMANDS.get(args.command.lower(), args.command)
             cli.send(cmd[0] if len(cmd) == 1 else cmd)
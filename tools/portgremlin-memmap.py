@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+"""
+PortGremlin Memmap — where the flash and the 32 KB of SRAM go, by module.
+
+`make -C usb_dev_keyboard` links with -Map=portgremlin.map and runs this
+over it. Every input section the linker placed is charged to the object
+it came from: .text/.vectors as code, .rodata as constants, .data to both
+flash (its load image) and SRAM, .bss/COMMON and .noinit to SRAM only.
+Library members are folded into their library (driverlib, usblib, libc...)
+unless --members is given. The stack is the linker script's __stack_size;
+what is left of SRAM above it is free.
+
+    python3 tools/portgremlin-memmap.py usb_dev_keyboard/portgremlin.map
+    python3 tools/portgremlin-memmap.py usb_dev_keyboard/portgremlin.map --members --sort flash
+    python3 tools/portgremlin-memmap.py usb_dev_keyboard/portgremlin.map --save portgremlin.mem.json \\
+        --min-free 2048
+
+Static sizes are only half the budget: the firmware's `!mem` command (and
+the `stk` record it sends when the margin gets thin) reports how deep the
+stack has actually gone since reset.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import re
+import sys
+from dataclasses import asdict, dataclass
+
+KINDS = ("text", "rodata", "data", "bss", "noinit")
+
+SECTION_RE = re.compile(r"^(\.\S+|/DISCARD/)(?:\s+0x[0-9a-fA-F]+\s+0x[0-9a-fA-F]+.*)?$")
+INPUT_RE = re.compile(r"^ (\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*))?$")
+CONT_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+FILL_RE = re.compile(r"^ \*fill\*\s+0x[0-9a-fA-F]+\s+0x([0-9a-fA-F]+)")
+STACK_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+__stack_size\s*=")
+REGION_RE = re.compile(r"^(\w+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+\w+)?\s*$")
+MEMBER_RE = re.compile(r"^(.*?)([^/\\]+)\.a\(([^)]+)\)$")
+
+
+@dataclass
+class Module:
+    name: str
+    text: int = 0
+    rodata: int = 0
+    data: int = 0
+    bss: int = 0
+    noinit: int = 0
+
+    @property
+    def flash(self) -> int:
+        return self.text + self.rodata + self.data
+
+    @property
+    def ram(self) -> int:
+        return self.data + self.bss + self.noinit
+
+
+def module_name(path: str, members: bool) -> str:
+    m = MEMBER_RE.match(path.strip())
+    if m:
+        lib = m.group(2)[3:] if m.group(2).startswith("lib") else m.group(2)
+        return f"{lib}/{m.group(3)}" if members else lib
+    return os.path.basename(path.strip())
+
+
+def kind_of(output: str, section: str) -> str | None:
+    if output in (".vectors", ".ARM.extab", ".ARM"):
+        return "text"
+    if output == ".text":
+        return "rodata" if section.startswith(".rodata") else "text"
+    if output == ".data":
+        return "data"
+    if output == ".bss":
+        return "bss"
+    if output == ".noinit":
+        return "noinit"
+    return None
+
+
+def parse_map(lines, members: bool) -> tuple[dict[str, Module], dict[str, int], int]:
+    """Per-module sizes, memory region lengths and __stack_size."""
+    modules: dict[str, Module] = {}
+    regions: dict[str, int] = {}
+    stack = 0
+    in_regions = in_layout = False
+    output = None
+    pending = None
+
+    def charge(section: str, size: int, path: str) -> None:
+        kind = kind_of(output or "", section)
+        if kind is None or size == 0:
+            return
+        name = module_name(path, members)
+        mod = modules.setdefault(name, Module(name))
+        setattr(mod, kind, getattr(mod, kind) + size)
+
+    for raw in lines:
+        line = raw.rstrip("\n")
+        if line.startswith("Memory Configuration"):
+            in_regions = True
+            continue
+        if line.startswith("Linker script and memory map"):
+            in_regions, in_layout = False, True
+            continue
+        if in_regions:
+            m = REGION_RE.match(line)
+            if m and m.group(1) != "Name" and m.group(1) != "default":
+                regions[m.group(1)] = int(m.group(3), 16)
+            continue
+        if not in_layout:
+            continue
+        if line.startswith("OUTPUT("):
+            break
+
+        m = STACK_RE.match(line)
+        if m:
+            stack = int(m.group(1), 16)
+            continue
+        if pending is not None:
+            m = CONT_RE.match(line)
+            if m:
+                charge(pending, int(m.group(2), 16), m.group(3))
+            pending = None
+            continue
+        m = SECTION_RE.match(line)
+        if m:
+            output = m.group(1)
+            continue
+        m = FILL_RE.match(line)
+        if m:
+            charge(".fill", int(m.group(1), 16), "[fill]")
+            continue
+        m = INPUT_RE.match(line)
+        if m and not m.group(1).startswith("*"):
+            if m.group(2) is None:
+                pending = m.group(1)
+            else:
+                charge(m.group(1), int(m.group(3), 16), m.group(4))
+    return modules, regions, stack
+
+
+def pct(part: int, whole: int) -> str:
+    return f"{100.0 * part / whole:5.1f}%" if whole else "     -"
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Per-module flash/SRAM breakdown from a GNU ld map file")
+    parser.add_argument("map", help="map file from -Wl,-Map")
+    parser.add_argument("--members", action="store_true", help="list library members separately")
+    parser.add_argument("--sort", choices=("ram", "flash", "name"), default="ram")
+    parser.add_argument("--top", type=int, default=0, help="rows to print (default: all)")
+    parser.add_argument("--save", metavar="PATH", help="write the breakdown as JSON")
+    parser.add_argument("--min-free", type=int, default=0, metavar="BYTES",
+                        help="exit 1 if less SRAM than this is left above the stack")
+    args = parser.parse_args()
+
+    with open(args.map, encoding="utf-8", errors="replace") as f:
+        modules, regions, stack = parse_map(f, args.members)
+    if not modules:
+        print(f"{args.map}: no placed sections found; is it a GNU ld map?", file=sys.stderr)
+        return 1
+
+    rows = list(modules.values())
+    if args.sort == "name":
+        rows.sort(key=lambda r: r.name)
+    else:
+        rows.sort(key=lambda r: (getattr(r, args.sort), r.flash, r.ram), reverse=True)
+
+    totals = Module("total")
+    for r in rows:
+        for k in KINDS:
+            setattr(totals, k, getattr(totals, k) + getattr(r, k))
+    flash_len = regions.get("FLASH", 0)
+    sram_len = regions.get("SRAM", 0)
+    free = sram_len - totals.ram - stack if sram_len else 0
+
+    print(f"{'module':<28}{'text':>8}{'rodata':>8}{'data':>7}{'bss':>7}{'noinit':>7}"
+          f"{'flash':>8}{'sram':>7}")
+    for r in rows[:args.top or None]:
+        print(f"{r.name:<28}{r.text:>8}{r.rodata:>8}{r.data:>7}{r.bss:>7}{r.noinit:>7}"
+              f"{r.flash:>8}{r.ram:>7}")
+    if args.top and len(rows) > args.top:
+        print(f"  ... {len(rows) - args.top} more")
+    print(f"{'total':<28}{totals.text:>8}{totals.rodata:>8}{totals.data:>7}{totals.bss:>7}"
+          f"{totals.noinit:>7}{totals.flash:>8}{totals.ram:>7}")
+    print(f"Flash: {totals.flash} of {flash_len} bytes {pct(totals.flash, flash_len)}")
+    print(f"SRAM:  {totals.ram} static + {stack} stack = {totals.ram + stack} of {sram_len} bytes "
+          f"{pct(totals.ram + stack, sram_len)}, {free} free")
+
+    if args.save:
+        report = {
+            "map": os.path.abspath(args.map),
+            "regions": regions,
+            "stack": stack,
+            "free": free,
+            "total": {**asdict(totals), "flash": totals.flash, "sram": totals.ram},
+            "modules": [{**asdict(r), "flash": r.flash, "sram": r.ram} for r in rows],
+        }
+        with open(args.save, "w", encoding="utf-8") as f:
+            json.dump(report, f, indent=2)
+            f.write("\n")
+
+    if args.min_free and free < args.min_free:
+        print(f"SRAM above the stack is {free} bytes, under --min-free {args.min_free}",
+              file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
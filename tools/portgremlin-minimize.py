@@ -0,0 +1,400 @@
+#!/usr/bin/env python3
+"""
+PortGremlin Minimize — delta-debug kernel findings down to a reproducer.
+
+Takes the enumeration trail Overwatch recorded with each triage finding,
+replays it through the framed command channel (!cfg/!pwr/!id/!seed/!go) and
+shrinks it, first by dropping enumerations (ddmin) and then by simplifying
+each survivor (malformed strings, random strings, descriptor mutators,
+pinned power, class, contradiction identity), keeping only changes that still produce the same
+kernel signature. Each step reseeds the firmware RNG from a seed kept with
+it, so dropping a step leaves the random draws of the others unchanged.
+The result is a small standalone JSON reproducer that --replay runs in
+seconds.
+
+The serial port must not be held by Overwatch while this runs.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import queue
+import subprocess
+import sys
+import threading
+import time
+from dataclasses import asdict, dataclass, field, replace
+from typing import Any, Optional, Protocol, Sequence
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from correlate import split_kernel_timestamp
+from ingest import FrameReader, pump
+from triage import normalize, signature
+
+# Must match DeviceType order and PORTGREMLIN_FLAG_* in portgremlin_config.h.
+CLASS_NAMES = ["Keyboard", "Audio", "Printer", "MIDI", "Gamepad"]
+FLAG_MALFORMED = 0x01
+FLAG_RAND_STRINGS = 0x08
+# Only flags that still change behaviour once VID/PID and power are pinned.
+REPLAY_FLAGS = FLAG_MALFORMED | FLAG_RAND_STRINGS
+NEUTRAL_VID = 0x1209  # pid.codes test VID
+
+
+def step_seed(seed: int, index: int) -> int:
+    """RNG seed for trail step `index`, so each step draws the same whatever ddmin drops."""
+    return (seed + (index + 1) * 0x9E3779B9) & 0xFFFFFFFF
+
+
+@dataclass(frozen=True)
+class Step:
+    vid: int
+    pid: int
+    cls: int
+    flags: int = 0
+    mw: Optional[int] = None
+    pa: Optional[int] = None
+    mut: int = 0
+    seed: int = 1
+
+    @classmethod
+    def from_enum(cls, rec: dict[str, Any], seed: int = 1) -> "Step":
+        name = rec.get("cls", "Keyboard")
+        return cls(
+            vid=int(rec.get("vid", "0"), 16),
+            pid=int(rec.get("pid", "0"), 16),
+            cls=CLASS_NAMES.index(name) if name in CLASS_NAMES else 0,
+            flags=int(rec.get("f", 0)) & REPLAY_FLAGS,
+            mw=rec.get("mw"),
+            pa=rec.get("pa"),
+            mut=int((rec.get("genome") or {}).get("mut", 0)),
+            seed=seed,
+        )
+
+    def commands(self) -> list[str]:
+        cmds = [f"!cfg {self.flags:X}", f"!mut {self.mut:X}"]
+        if self.mw is None or self.pa is None:
+            cmds.append("!pwr")
+        else:
+            cmds.append(f"!pwr {self.mw:X} {self.pa:X}")
+        cmds.append(f"!id {self.vid:X} {self.pid:X} {self.cls:X}")
+        cmds.append(f"!seed {self.seed:X}")
+        cmds.append("!go")
+        return cmds
+
+    def describe(self) -> str:
+        power = "default" if self.mw is None else f"{self.mw}mA/0x{self.pa:02X}"
+        return (f"{self.vid:04X}:{self.pid:04X} {CLASS_NAMES[self.cls]} "
+                f"flags=0x{self.flags:02X} mut=0x{self.mut:02X} power={power}")
+
+
+@dataclass
+class Reproducer:
+    signature: str
+    template: str
+    seed: int
+    steps: list[Step] = field(default_factory=list)
+    settle_s: float = 0.4
+    window_s: float = 1.5
+    original_steps: int = 0
+    replays: int = 0
+
+    def to_dict(self) -> dict[str, Any]:
+        data = asdict(self)
+        data["steps"] = [asdict(s) for s in self.steps]
+        data["commands"] = ["!stop", "!per 0"] + [
+            c for s in self.steps for c in s.commands()
+        ]
+        return data
+
+    @classmethod
+    def from_dict(cls, data: dict[str, Any]) -> "Reproducer":
+        return cls(
+            signature=data["signature"],
+            template=data.get("template", ""),
+            seed=int(data.get("seed", 1)),
+            steps=[Step(**s) for s in data.get("steps", [])],
+            settle_s=float(data.get("settle_s", 0.4)),
+            window_s=float(data.get("window_s", 1.5)),
+            original_steps=int(data.get("original_steps", 0)),
+            replays=int(data.get("replays", 0)),
+        )
+
+
+class ReplayBackend(Protocol):
+    def run(self, steps: Sequence[Step], settle_s: float, window_s: float) -> set[str]:
+        """Replay steps from a quiet device; return kernel signatures seen."""
+        ...
+
+    def close(self) -> None:
+        ...
+
+
+class SerialBackend:
+    """Replays over the LaunchPad's framed command channel, watching dmesg."""
+
+    def __init__(self, port: str, baud: int, cooldown_s: float = 0.5) -> None:
+        import serial
+
+        self.ser = serial.Serial(port, baud, timeout=0.1)
+        self.cooldown_s = cooldown_s
+        self.events: "queue.Queue[dict[str, Any]]" = queue.Queue()
+        self.kernel: list[tuple[float, str]] = []
+        self.kernel_lock = threading.Lock()
+        self.stop = threading.Event()
+        self.threads = [
+            threading.Thread(target=self._serial_reader, daemon=True),
+            threading.Thread(target=self._kernel_reader, daemon=True),
+        ]
+        for t in self.threads:
+            t.start()
+        time.sleep(0.3)
+
+    def _serial_reader(self) -> None:
+        pump(self.ser, FrameReader(self.events.put), self.stop)
+
+    def _kernel_reader(self) -> None:
+        proc = subprocess.Popen(["dmesg", "-w"], stdout=subprocess.PIPE,
+                                stderr=subprocess.DEVNULL, text=True)
+        while not self.stop.is_set() and proc.stdout:
+            line = proc.stdout.readline()
+            if not line:
+                break
+            _, msg = split_kernel_timestamp(line)
+            with self.kernel_lock:
+                self.kernel.append((time.monotonic(), signature(normalize(msg))))
+        proc.terminate()
+
+    def _send(self, cmd: str, timeout: float = 1.0) -> bool:
+        verb = cmd[1:].split(" ", 1)[0]
+        self.ser.write((cmd + "\n").encode("ascii"))
+        self.ser.flush()
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            try:
+                ev = self.events.get(timeout=deadline - time.monotonic())
+            except queue.Empty:
+                break
+            if ev.get("e") == "ack" and ev.get("cmd") == verb:
+                return bool(ev.get("ok"))
+        raise RuntimeError(f"no ack for {cmd!r}; is the firmware too old or the port busy?")
+
+    def _wait_enum(self, timeout: float) -> None:
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            try:
+                ev = self.events.get(timeout=deadline - time.monotonic())
+            except queue.Empty:
+                return
+            if ev.get("e") == "enum":
+                return
+
+    def run(self, steps: Sequence[Step], settle_s: float, window_s: float) -> set[str]:
+        for cmd in ("!stop", "!per 0"):
+            self._send(cmd)
+        time.sleep(self.cooldown_s)
+        with self.kernel_lock:
+            self.kernel.clear()
+        for step in steps:
+            for cmd in step.commands():
+                if not self._send(cmd):
+                    raise RuntimeError(f"device rejected {cmd!r}")
+            self._wait_enum(settle_s + 1.0)
+            time.sleep(settle_s)
+        time.sleep(window_s)
+        with self.kernel_lock:
+            return {sig for _, sig in self.kernel}
+
+    def close(self) -> None:
+        self.stop.set()
+        self.ser.close()
+
+
+def _simplifications(step: Step, index: int) -> list[Step]:
+    out = []
+    if step.flags & FLAG_MALFORMED:
+        out.append(replace(step, flags=step.flags & ~FLAG_MALFORMED))
+    if step.mut:
+        out.append(replace(step, mut=0))
+        if step.mut & (step.mut - 1):
+            out += [replace(step, mut=step.mut & ~bit) for bit in (1 << b for b in range(8))
+                    if step.mut & bit]
+    if step.flags & FLAG_RAND_STRINGS:
+        out.append(replace(step, flags=step.flags & ~FLAG_RAND_STRINGS))
+    if step.mw is not None:
+        out.append(replace(step, mw=None, pa=None))
+    if step.cls != 0:
+        out.append(replace(step, cls=0))
+    neutral = (NEUTRAL_VID, 0xF000 + index)
+    if (step.vid, step.pid) != neutral:
+        out.append(replace(step, vid=neutral[0], pid=neutral[1]))
+    return out
+
+
+class Minimizer:
+    def __init__(self, backend: ReplayBackend, repro: Reproducer, trials: int = 2,
+                 verbose: bool = True) -> None:
+        self.backend = backend
+        self.repro = repro
+        self.trials = trials
+        self.verbose = verbose
+        self._cache: dict[tuple[Step, ...], bool] = {}
+
+    def log(self, msg: str) -> None:
+        if self.verbose:
+            print(f"[min] {msg}", flush=True)
+
+    def reproduces(self, steps: Sequence[Step]) -> bool:
+        key = tuple(steps)
+        if key in self._cache:
+            return self._cache[key]
+        hit = False
+        for _ in range(self.trials):
+            self.repro.replays += 1
+            seen = self.backend.run(steps, self.repro.settle_s, self.repro.window_s)
+            if self.repro.signature in seen:
+                hit = True
+                break
+        self._cache[key] = hit
+        self.log(f"{len(steps):3d} steps -> {'HIT' if hit else 'miss'}")
+        return hit
+
+    def ddmin(self, steps: list[Step]) -> list[Step]:
+        n = 2
+        while len(steps) >= 2:
+            chunk = len(steps) // n
+            subsets = [steps[i:i + chunk] for i in range(0, len(steps), chunk)]
+            reduced = False
+            for sub in subsets:
+                if self.reproduces(sub):
+                    steps, n, reduced = sub, 2, True
+                    break
+            if not reduced:
+                for i in range(len(subsets)):
+                    comp = [s for j, sub in enumerate(subsets) if j != i for s in sub]
+                    if self.reproduces(comp):
+                        steps, n, reduced = comp, max(n - 1, 2), True
+                        break
+            if not reduced:
+                if n >= len(steps):
+                    break
+                n = min(len(steps), 2 * n)
+        return steps
+
+    def simplify(self, steps: list[Step]) -> list[Step]:
+        for i in range(len(steps)):
+            changed = True
+            while changed:
+                changed = False
+                for cand in _simplifications(steps[i], i):
+                    trial = steps[:i] + [cand] + steps[i + 1:]
+                    if self.reproduces(trial):
+                        steps, changed = trial, True
+                        break
+        return steps
+
+    def run(self) -> Optional[Reproducer]:
+        steps = list(self.repro.steps)
+        self.repro.original_steps = len(steps)
+        self.log(f"target {self.repro.signature}: {self.repro.template}")
+        if not self.reproduces(steps):
+            self.log("full trail does not reproduce; giving up")
+            return None
+        steps = self.ddmin(steps)
+        self.log(f"ddmin: {self.repro.original_steps} -> {len(steps)} steps")
+        steps = self.simplify(steps)
+        self.repro.steps = steps
+        return self.repro
+
+
+def load_findings(path: str) -> list[dict[str, Any]]:
+    with open(path, encoding="utf-8") as f:
+        data = json.load(f)
+    if isinstance(data, dict):
+        data = data.get("findings", [])
+    return [b for b in data if b.get("trail")]
+
+
+def find_serial_port(hint: Optional[str]) -> Optional[str]:
+    if hint:
+        return hint
+    from serial.tools import list_ports
+
+    for p in list_ports.comports():
+        if "ICDI" in (p.description or "") or "Stellaris" in (p.description or ""):
+            return p.device
+    ports = list(list_ports.comports())
+    return ports[0].device if ports else None
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Minimize PortGremlin kernel findings")
+    parser.add_argument("findings", nargs="?", default="reports/overwatch-session.json",
+                        help="Overwatch session report or findings JSON")
+    parser.add_argument("-s", "--signature", action="append",
+                        help="Finding signature(s) to minimize (default: all with a trail)")
+    parser.add_argument("-p", "--port", help="Serial port")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("--trials", type=int, default=2, help="Replays per candidate")
+    parser.add_argument("--seed", type=lambda v: int(v, 0), default=0x5EED,
+                        help="Base RNG seed; each trail step reseeds from it")
+    parser.add_argument("--settle", type=float, default=0.4, help="Seconds after each enum")
+    parser.add_argument("--window", type=float, default=1.5, help="Seconds to watch dmesg")
+    parser.add_argument("--out", default="reports/repro")
+    parser.add_argument("--replay", metavar="REPRO_JSON", help="Replay one reproducer and exit")
+    args = parser.parse_args()
+
+    port = find_serial_port(args.port)
+    if not port:
+        print("No serial port found", file=sys.stderr)
+        return 1
+    backend = SerialBackend(port, args.baud)
+
+    try:
+        if args.replay:
+            with open(args.replay, encoding="utf-8") as f:
+                repro = Reproducer.from_dict(json.load(f))
+            t0 = time.monotonic()
+            seen = backend.run(repro.steps, repro.settle_s, repro.window_s)
+            ok = repro.signature in seen
+            print(f"{repro.signature}: {'REPRODUCED' if ok else 'not reproduced'} "
+                  f"in {time.monotonic() - t0:.1f}s ({len(repro.steps)} steps)")
+            return 0 if ok else 2
+
+        findings = load_findings(args.findings)
+        if args.signature:
+            findings = [b for b in findings if b["signature"] in args.signature]
+        if not findings:
+            print("No findings with a recorded trail", file=sys.stderr)
+            return 1
+
+        os.makedirs(args.out, exist_ok=True)
+        for bucket in findings:
+            repro = Reproducer(
+                signature=bucket["signature"],
+                template=bucket["template"],
+                seed=args.seed,
+                steps=[Step.from_enum(r, step_seed(args.seed, i))
+                       for i, r in enumerate(bucket["trail"])],
+                settle_s=args.settle,
+                window_s=args.window,
+            )
+            result = Minimizer(backend, repro, trials=args.trials).run()
+            if result is None:
+                continue
+            path = os.path.join(args.out, f"repro-{result.signature}.json")
+            with open(path, "w", encoding="utf-8") as f:
+                json.dump(result.to_dict(), f, indent=2)
+            print(f"{result.signature}: {result.original_steps} -> {len(result.steps)} steps "
+                  f"after {result.replays} replays -> {path}")
+            for step in result.steps:
+                print(f"    {step.describe()}")
+    finally:
+        backend.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -4,7 +4,34 @@ PortGremlin Overwatch — closed-loop host-side orchestrator.
 
 Reads @PG{...} JSON telemetry from the LaunchPad, monitors kernel USB errors
 (dmesg/journalctl), correlates both perspectives, and autonomously drives
-escalation when the host shows pain signals.
+escalation when the host shows pain signals. Kernel errors and uevents are
+attributed to the enumeration that caused them via correlate.py and bucketed
+into unique findings by triage.py.
+
+Several LaunchPads can be driven at once with repeated --lane options. Each
+lane has its own state, correlator and escalation ladder; all lanes share one
+findings database and one dashboard. Lanes on this machine share the local
+kernel watchers and are told apart by USB port path (usb=1-1.2); lanes aimed
+at another lab host stream its kernel log through kmsg="ssh lab2 dmesg -w".
+
+--record saves the raw session (device records, kernel errors, uevents,
+autonomous commands) for portgremlin-calibrate.py and for --replay; see
+session.py for the format. Label each lane with the target's real OS
+(os=linux) so a fitted host model does not depend on the Oracle's guess.
+
+--replay feeds a recorded session through the same lanes, correlators,
+triage and dashboard at --speed times real time (0 = as fast as possible),
+with play/pause/seek controls on the dashboard and no hardware attached.
+
+--bandit hands persona choice to the firmware's bandit scheduler in place
+of the overdrive stack and the escalation ladder. Each lane reports its
+new finding signatures and uevents back with `!fb` about once a second,
+and the scheduler scores each persona on them.
+
+--surrogate runs the Evolve engine alone and screens what it breeds. Each
+lane learns genome outcomes (see surrogate.py), seeded from the recorded
+sessions given. When the device moves to a genome the model rates well
+below the best candidate, the lane uploads that candidate with `!gen`.
 
 Live dashboard: http://127.0.0.1:8765
 """
@@ -15,6 +42,7 @@ import argparse
 import json
 import os
 import re
+import shlex
 import subprocess
 import sys
 import threading
@@ -24,7 +52,15 @@ from collections import deque
 from dataclasses import dataclass, field
 from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
 from typing import Any, Optional
-from urllib.parse import urlparse
+from urllib.parse import parse_qs, urlparse
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from correlate import UEVENT_RE, Attribution, EventCorrelator, split_kernel_timestamp
+from ingest import FrameReader, pump
+from session import SPEED_MAX, JsonlWriter, ReplayClock, SessionClock, SessionPlayer, SessionReader, open_recorder
+from surrogate import EpisodeTracker, Genome, Surrogate, load_episodes
+from triage import TriageDB
 
 try:
     import serial
@@ -33,11 +69,12 @@ except ImportError:
     print("Run ./setup.sh first to install dependencies.", file=sys.stderr)
     sys.exit(1)
 
-PG_JSON_RE = re.compile(r"@PG(\{.*\})")
 USB_ERROR_RE = re.compile(
     r"(usb|USB|xhci|ehci|ohci|udev).*(error|fail|reject|stall|timeout|unable|warn)",
     re.IGNORECASE,
 )
+# "usb 1-1.2: ..." in kmsg, ".../usb1/1-1/1-1.2" or "1-1.2:1.0" in uevent paths.
+USB_PORT_RE = re.compile(r"(?:^|[\s/])(\d+-\d+(?:\.\d+)*)(?=[:/\s]|$)")
 
 ESCALATION_LADDER = [
     ("[", "RedTeam choreography"),
@@ -48,6 +85,12 @@ ESCALATION_LADDER = [
     ("m", "malformed mode"),
 ]
 
+KERNEL_SOURCES = ("kernel", "journal")
+KERNEL_PAIN = {"kernel": 1.0, "journal": 0.5}
+TRAIL_LEN = 32
+RATE_WINDOW_S = 10.0
+FEEDBACK_S = 1.0
+
 
 @dataclass
 class OverwatchState:
@@ -60,7 +103,7 @@ class OverwatchState:
     evolve_gen: int = 0
     evolve_fit: int = 0
     host_errors: int = 0
-    usb_devices: int = 0
+    unique_findings: int = 0
     last_vid: str = ""
     last_pid: str = ""
     last_class: str = ""
@@ -80,7 +123,7 @@ class OverwatchState:
             "evolve_gen": self.evolve_gen,
             "evolve_fit": self.evolve_fit,
             "host_errors": self.host_errors,
-            "usb_devices": self.usb_devices,
+            "unique_findings": self.unique_findings,
             "last_vid": self.last_vid,
             "last_pid": self.last_pid,
             "last_class": self.last_class,
@@ -91,15 +134,22 @@ class OverwatchState:
         }
 
 
-STATE = OverwatchState()
-STATE_LOCK = threading.Lock()
+CLOCK: SessionClock = SessionClock()
+TRIAGE = TriageDB()
+EVENTS_LOG: Optional[JsonlWriter] = None
+REPLAY: Optional[SessionPlayer] = None
+ECHO = True
+HOST_EVENTS: deque = deque(maxlen=200)
+HOST_LOCK = threading.Lock()
+USB_DEVICES = 0
 
 
-def log_event(source: str, message: str) -> None:
-    entry = {"ts": time.time(), "source": source, "msg": message}
-    with STATE_LOCK:
-        STATE.events.append(entry)
-    print(f"[{source:5}] {message}")
+def log_host(message: str) -> None:
+    entry = {"ts": CLOCK.time(), "lane": "host", "source": "host", "msg": message}
+    with HOST_LOCK:
+        HOST_EVENTS.append(entry)
+    if ECHO:
+        print(f"[host ] {message}")
 
 
 def find_serial_port(hint: Optional[str]) -> Optional[str]:
@@ -113,127 +163,337 @@ def find_serial_port(hint: Optional[str]) -> Optional[str]:
     return ports[0].device if ports else None
 
 
-def parse_pg_event(payload: dict[str, Any]) -> None:
-    etype = payload.get("e", "")
-    with STATE_LOCK:
-        if etype == "host":
-            STATE.host_os = payload.get("os", "unknown")
-        elif etype == "enum":
-            STATE.enums = int(payload.get("n", STATE.enums))
-            STATE.last_vid = payload.get("vid", "")
-            STATE.last_pid = payload.get("pid", "")
-            STATE.last_class = payload.get("cls", "")
-        elif etype == "persona":
-            STATE.persona = payload.get("name", "")
-        elif etype == "brain":
-            STATE.brain_phase = payload.get("phase", "")
-            STATE.tolerance = int(payload.get("tol", 0))
-        elif etype == "disconnect":
-            STATE.disconnects = int(payload.get("total", 0))
-        elif etype == "evolve":
-            STATE.evolve_gen = int(payload.get("gen", 0))
-            STATE.evolve_fit = int(payload.get("fit", 0))
-
-
-def handle_device_line(line: str, ser: Optional[serial.Serial]) -> None:
-    log_event("dev", line)
-
-    m = PG_JSON_RE.search(line)
-    if m:
-        try:
-            payload = json.loads(m.group(1))
-            parse_pg_event(payload)
-            log_event("json", json.dumps(payload))
-            maybe_autonomous_escalate(ser, payload)
-        except json.JSONDecodeError:
-            pass
-
-
-def maybe_autonomous_escalate(ser: Optional[serial.Serial], payload: dict[str, Any]) -> None:
-    if not ser or not STATE.autonomous:
-        return
-
-    etype = payload.get("e", "")
-    with STATE_LOCK:
-        if etype == "host" and STATE.escalation_level == 0:
-            cmd = "p"
-            STATE.escalation_level = 1
-            reason = f"host classified {STATE.host_os}"
-        elif etype == "disconnect" and STATE.escalation_level < len(ESCALATION_LADDER):
-            cmd, reason = ESCALATION_LADDER[STATE.escalation_level]
-            STATE.escalation_level += 1
-        elif etype == "enum" and STATE.enums > 0 and STATE.enums % 50 == 0:
-            cmd = "e"
-            reason = f"{STATE.enums} enumerations"
-        else:
+class Lane:
+    """One LaunchPad, its serial link, and everything derived from it.
+
+    Lock order is corr_lock before state_lock, never the reverse: the
+    correlator calls on_attribution while corr_lock is held.
+    """
+
+    def __init__(self, name: str, port: str, baud: int = 115200,
+                 usb: Optional[str] = None, kmsg: Optional[str] = None,
+                 autonomous: bool = True, target_os: Optional[str] = None,
+                 bandit: bool = False, surrogate: Optional[Surrogate] = None) -> None:
+        self.name = name
+        self.port = port
+        self.baud = baud
+        self.usb = usb
+        self.kmsg = kmsg
+        self.target_os = target_os
+        self.state = OverwatchState(autonomous=autonomous)
+        self.state_lock = threading.Lock()
+        self.correlator = EventCorrelator(on_attribution=self.on_attribution)
+        self.corr_lock = threading.Lock()
+        self.ser: Optional[serial.Serial] = None
+        self.started = CLOCK.monotonic()
+        self.enum_times: deque = deque(maxlen=4096)
+        self.new_findings = 0
+        self.bandit = bandit
+        self.fb_signatures = 0          # not yet reported with !fb
+        self.fb_uevents = 0
+        self.fb_sent = 0.0
+        self.surrogate = surrogate
+        self.episodes = EpisodeTracker(os=target_os)
+        self.uploaded: Optional[Genome] = None
+
+    def log_event(self, source: str, message: str) -> None:
+        entry = {"ts": CLOCK.time(), "lane": self.name, "source": source, "msg": message}
+        with self.state_lock:
+            self.state.events.append(entry)
+        if ECHO:
+            print(f"[{self.name}:{source:5}] {message}")
+
+    def record(self, kind: str, **fields: Any) -> None:
+        if EVENTS_LOG is not None:
+            EVENTS_LOG.write(self.name, kind, **fields)
+
+    def owns_port(self, usb_port: Optional[str]) -> bool:
+        if self.usb is None or usb_port is None:
+            return True
+        return usb_port == self.usb or usb_port.startswith(self.usb + ".")
+
+    def on_attribution(self, att: Attribution) -> None:
+        if att.event.source not in KERNEL_SOURCES:
+            self.log_event("blame", f"{att.event.message[:70]} <- {att.blame()}")
+            return
+        trail = None
+        if att.enum:
+            trail = [r.to_dict() for r in self.correlator.trail(att.enum, TRAIL_LEN)]
+        bucket, is_new = TRIAGE.record_attribution(att, trail, self.name)
+        if is_new:
+            with self.state_lock:
+                self.new_findings += 1
+                self.fb_signatures += 1
+                self.episodes.on_finding()
+                self.state.unique_findings = self.new_findings
+            self.log_event("triage", f"NEW {bucket.signature} {bucket.template[:60]} <- {att.blame()}")
+
+    def on_uevent(self, message: str, host_t: float) -> None:
+        self.record("uevent", host_t=host_t, msg=message)
+        self.correlate_host("uevent", message, host_t)
+        with self.state_lock:
+            self.fb_uevents += 1
+
+    def send_feedback(self) -> None:
+        """Report new signatures and uevents to the bandit, at most every FEEDBACK_S."""
+        now = CLOCK.monotonic()
+        with self.state_lock:
+            if now - self.fb_sent < FEEDBACK_S or not (self.fb_signatures or self.fb_uevents):
+                return
+            cmd = f"!fb {self.fb_signatures:x} {self.fb_uevents:x}"
+            self.fb_signatures = self.fb_uevents = 0
+            self.fb_sent = now
+        self.ser.write((cmd + "\r").encode("ascii"))
+        self.ser.flush()
+        self.record("cmd", cmd=cmd)
+
+    def correlate_host(self, source: str, message: str, host_t: Optional[float]) -> None:
+        with self.corr_lock:
+            self.correlator.on_host(source, message, host_t, now=CLOCK.monotonic())
+
+    def flush(self, force: bool = False) -> None:
+        with self.corr_lock:
+            self.correlator.flush(CLOCK.monotonic(), force=force)
+
+    def on_host_error(self, source: str, message: str, host_t: Optional[float],
+                      pain: float) -> None:
+        with self.state_lock:
+            self.state.host_errors += 1
+            self.state.pain_score += pain
+            self.episodes.on_error(message, host_t)
+        self.record(source, host_t=host_t, msg=message)
+        self.log_event(source, message[:120])
+        self.correlate_host(source, message, host_t)
+
+    def parse_pg_event(self, payload: dict[str, Any]) -> None:
+        etype = payload.get("e", "")
+        with self.corr_lock:
+            self.correlator.on_device(payload, CLOCK.monotonic())
+        with self.state_lock:
+            st = self.state
+            if etype == "host":
+                st.host_os = payload.get("os", "unknown")
+            elif etype == "enum":
+                st.enums = int(payload.get("n", st.enums))
+                st.last_vid = payload.get("vid", "")
+                st.last_pid = payload.get("pid", "")
+                st.last_class = payload.get("cls", "")
+                self.enum_times.append(CLOCK.monotonic())
+            elif etype == "persona":
+                st.persona = payload.get("name", "")
+            elif etype == "brain":
+                st.brain_phase = payload.get("phase", "")
+                st.tolerance = int(payload.get("tol", 0))
+            elif etype == "bnd":
+                st.brain_phase = f"bandit {payload.get('arm', '')} {int(payload.get('r', 0)) / 256:.2f}"
+            elif etype == "disconnect":
+                st.disconnects = int(payload.get("total", 0))
+            elif etype == "evolve":
+                st.evolve_gen = int(payload.get("gen", 0))
+                st.evolve_fit = int(payload.get("fit", 0))
+
+    def handle_device_line(self, line: str) -> None:
+        self.record("line", msg=line)
+        self.log_event("dev", line)
+
+    def handle_device_record(self, payload: dict[str, Any]) -> None:
+        self.record("pg", rec=payload)
+        self.parse_pg_event(payload)
+        self.log_event("json", json.dumps(payload))
+        self.screen_genome(payload)
+        self.maybe_autonomous_escalate(payload)
+
+    def screen_genome(self, payload: dict[str, Any]) -> None:
+        """Learn from the genome that just ended; replace a poor successor with a better one."""
+        if self.surrogate is None:
+            return
+        with self.state_lock:
+            episode = self.episodes.on_device(payload, CLOCK.monotonic())
+        if episode is not None:
+            self.surrogate.add(episode)
+        if payload.get("e") != "evolve" or not self.ser or not self.state.autonomous:
             return
 
-    ser.write(cmd.encode("ascii"))
-    ser.flush()
-    log_event("auto", f"CMD '{cmd}' ({reason})")
-
-
-def serial_loop(port: str, baud: int, stop: threading.Event) -> None:
-    ser = serial.Serial(port, baud, timeout=0.15)
-    time.sleep(0.4)
-    ser.write(b"x")
-    ser.flush()
-    log_event("host", f"Serial {port} @ {baud}, sent overdrive engage (x)")
+        bred = Genome.from_record(payload)
+        if bred == self.uploaded:
+            self.uploaded = None
+            return
+        better = self.surrogate.screen(bred)
+        if better is None:
+            return
+        self.uploaded = better
+        cmd = better.command()
+        self.ser.write((cmd + "\r").encode("ascii"))
+        self.ser.flush()
+        self.record("cmd", cmd=cmd)
+        self.log_event("surr", f"gen {payload.get('gen')} {bred.label()} (ucb {self.surrogate.ucb(bred):.2f}) "
+                               f"-> {better.label()} (ucb {self.surrogate.ucb(better):.2f})")
+
+    def maybe_autonomous_escalate(self, payload: dict[str, Any]) -> None:
+        if not self.ser or not self.state.autonomous:
+            return
+        if self.bandit:
+            self.send_feedback()
+            return
+        if self.surrogate is not None:
+            return
 
-    while not stop.is_set():
+        etype = payload.get("e", "")
+        with self.state_lock:
+            st = self.state
+            if etype == "host" and st.escalation_level == 0:
+                cmd = "p"
+                st.escalation_level = 1
+                reason = f"host classified {st.host_os}"
+            elif etype == "disconnect" and st.escalation_level < len(ESCALATION_LADDER):
+                cmd, reason = ESCALATION_LADDER[st.escalation_level]
+                st.escalation_level += 1
+            elif etype == "enum" and st.enums > 0 and st.enums % 50 == 0:
+                cmd = "e"
+                reason = f"{st.enums} enumerations"
+            else:
+                return
+
+        self.ser.write(cmd.encode("ascii"))
+        self.ser.flush()
+        self.record("cmd", cmd=cmd)
+        self.log_event("auto", f"CMD '{cmd}' ({reason})")
+
+    def serial_loop(self, stop: threading.Event) -> None:
         try:
-            raw = ser.readline()
+            ser = serial.Serial(self.port, self.baud, timeout=0.15)
         except serial.SerialException as exc:
-            log_event("host", f"Serial error: {exc}")
-            break
-        if raw:
-            line = raw.decode("utf-8", errors="replace").rstrip("\r\n")
-            if line:
-                handle_device_line(line, ser)
-    ser.close()
+            self.log_event("host", f"Cannot open {self.port}: {exc}")
+            return
+        self.ser = ser
+        time.sleep(0.4)
+        if self.bandit:
+            ser.write(b"!tlm 1\r!bnd 1\r")
+            ser.flush()
+            self.log_event("host", f"Serial {self.port} @ {self.baud}, started the bandit scheduler")
+        elif self.surrogate is not None:
+            ser.write(b"!tlm 1\r!stop\rg")
+            ser.flush()
+            self.log_event("host", f"Serial {self.port} @ {self.baud}, started Evolve with "
+                                   f"{len(self.surrogate)} surrogate episodes")
+        else:
+            ser.write(b"x")
+            ser.flush()
+            self.log_event("host", f"Serial {self.port} @ {self.baud}, sent overdrive engage (x)")
+
+        reader = FrameReader(self.handle_device_record, self.handle_device_line)
+        exc = pump(ser, reader, stop)
+        if exc is not None:
+            self.log_event("host", f"Serial error: {exc}")
+        self.ser = None
+        ser.close()
+
+    def throughput(self, now: Optional[float] = None) -> dict[str, float]:
+        if now is None:
+            now = CLOCK.monotonic()
+        elapsed = max(now - self.started, 1e-6)
+        window = min(RATE_WINDOW_S, elapsed)
+        with self.state_lock:
+            recent = sum(1 for t in self.enum_times if now - t <= window)
+            findings = self.new_findings
+        return {
+            "enums_per_s": round(recent / window, 2),
+            "findings_per_hour": round(findings * 3600.0 / elapsed, 2),
+            "uptime_s": round(elapsed, 1),
+        }
 
+    def to_dict(self, events: bool = True) -> dict[str, Any]:
+        with self.state_lock:
+            data = self.state.to_dict()
+        if not events:
+            data.pop("events")
+        data.update(self.throughput())
+        data["name"] = self.name
+        data["port"] = self.port
+        data["usb"] = self.usb
+        data["host"] = self.kmsg or "local"
+        data["connected"] = self.ser is not None
+        return data
+
+
+LANES: list[Lane] = []
+
+
+class KernelWatcher:
+    """Feeds one host's kernel log to every lane that targets that host.
+
+    Local timestamps are CLOCK_MONOTONIC and line up with ClockSync. A
+    remote host's clock does not, so remote lines are stamped on arrival.
+    """
+
+    def __init__(self, lanes: list[Lane], kmsg: Optional[str] = None) -> None:
+        self.lanes = lanes
+        self.kmsg = kmsg
+        self.local = kmsg is None
+
+    def route(self, message: str) -> list[Lane]:
+        m = USB_PORT_RE.search(message)
+        usb_port = m.group(1) if m else None
+        return [lane for lane in self.lanes if lane.owns_port(usb_port)]
+
+    def _stream(self, argv: list[str], stop: threading.Event, handle: Any) -> None:
+        proc = subprocess.Popen(argv, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+        while not stop.is_set() and proc.stdout:
+            line = proc.stdout.readline()
+            if not line:
+                break
+            handle(line)
+        proc.terminate()
+
+    def _kernel_line(self, source: str, pain: float, line: str) -> None:
+        ts, msg = split_kernel_timestamp(line)
+        if not self.local:
+            ts = None
+        if USB_ERROR_RE.search(msg):
+            for lane in self.route(msg):
+                lane.on_host_error(source, msg, ts, pain)
+
+    def _uevent_line(self, line: str) -> None:
+        m = UEVENT_RE.match(line)
+        if m:
+            msg = f"{m.group(2)} {m.group(3)}"
+            for lane in self.route(m.group(3)):
+                lane.on_uevent(msg, float(m.group(1)))
+
+    def dmesg_loop(self, stop: threading.Event) -> None:
+        argv = shlex.split(self.kmsg) if self.kmsg else ["dmesg", "-w"]
+        self._stream(argv, stop, lambda ln: self._kernel_line("kernel", KERNEL_PAIN["kernel"], ln))
+
+    def journal_loop(self, stop: threading.Event) -> None:
+        argv = ["journalctl", "-kf", "-n", "0", "--grep=usb", "-o", "short-monotonic"]
+        self._stream(argv, stop, lambda ln: self._kernel_line("journal", KERNEL_PAIN["journal"], ln))
+
+    def uevent_loop(self, stop: threading.Event) -> None:
+        argv = ["udevadm", "monitor", "--kernel", "--subsystem-match=usb"]
+        self._stream(argv, stop, self._uevent_line)
+
+    def threads(self, stop: threading.Event) -> list[threading.Thread]:
+        targets = []
+        if not self.local:
+            targets.append(self.dmesg_loop)
+        else:
+            if shutil_which("udevadm"):
+                targets.append(self.uevent_loop)
+            if shutil_which("dmesg"):
+                targets.append(self.dmesg_loop)
+            if shutil_which("journalctl"):
+                targets.append(self.journal_loop)
+        return [threading.Thread(target=t, args=(stop,), daemon=True) for t in targets]
 
-def dmesg_loop(stop: threading.Event) -> None:
-    if not shutil_which("dmesg"):
-        return
-    proc = subprocess.Popen(
-        ["dmesg", "-w"],
-        stdout=subprocess.PIPE,
-        stderr=subprocess.DEVNULL,
-        text=True,
-    )
-    while not stop.is_set() and proc.stdout:
-        line = proc.stdout.readline()
-        if not line:
-            break
-        if USB_ERROR_RE.search(line):
-            with STATE_LOCK:
-                STATE.host_errors += 1
-                STATE.pain_score += 1.0
-            log_event("kernel", line.strip()[:120])
-
-
-def journal_loop(stop: threading.Event) -> None:
-    if not shutil_which("journalctl"):
-        return
-    proc = subprocess.Popen(
-        ["journalctl", "-kf", "-n", "0", "--grep=usb"],
-        stdout=subprocess.PIPE,
-        stderr=subprocess.DEVNULL,
-        text=True,
-    )
-    while not stop.is_set() and proc.stdout:
-        line = proc.stdout.readline()
-        if not line:
-            break
-        if USB_ERROR_RE.search(line):
-            with STATE_LOCK:
-                STATE.host_errors += 1
-                STATE.pain_score += 0.5
-            log_event("journal", line.strip()[:120])
+
+def correlate_flush_loop(stop: threading.Event) -> None:
+    while not stop.wait(0.1):
+        for lane in LANES:
+            lane.flush()
 
 
 def lsusb_loop(interval: float, stop: threading.Event) -> None:
+    global USB_DEVICES
     last = -1
     while not stop.is_set():
         try:
@@ -241,9 +501,8 @@ def lsusb_loop(interval: float, stop: threading.Event) -> None:
             count = len([ln for ln in out.splitlines() if ln.strip()])
             if count != last:
                 last = count
-                with STATE_LOCK:
-                    STATE.usb_devices = count
-                log_event("host", f"USB topology: {count} devices")
+                USB_DEVICES = count
+                log_host(f"USB topology: {count} devices")
         except (FileNotFoundError, subprocess.CalledProcessError):
             pass
         stop.wait(interval)
@@ -254,6 +513,68 @@ def shutil_which(cmd: str) -> Optional[str]:
     return which(cmd)
 
 
+def replay_lanes(reader: SessionReader) -> list[Lane]:
+    lanes = []
+    for name, hdr in reader.lanes().items():
+        host = hdr.get("host") or "local"
+        lanes.append(Lane(name, f"replay:{hdr.get('port') or name}", usb=hdr.get("usb"),
+                          kmsg=None if host == "local" else host, autonomous=False,
+                          target_os=hdr.get("os")))
+    return lanes
+
+
+def replay_record(rec: dict[str, Any]) -> None:
+    """Deliver one recorded record the way the live readers would have."""
+    lane = next((ln for ln in LANES if ln.name == rec.get("lane", "")), None)
+    kind = rec.get("k")
+    if lane is None or kind == "lane":
+        return
+    msg = rec.get("msg", "")
+    if kind == "pg" and isinstance(rec.get("rec"), dict):
+        lane.handle_device_record(rec["rec"])
+    elif kind == "line":
+        lane.handle_device_line(msg)
+    elif kind in KERNEL_PAIN:
+        lane.on_host_error(kind, msg, rec.get("host_t"), KERNEL_PAIN[kind])
+    elif kind == "uevent":
+        lane.record("uevent", host_t=rec.get("host_t"), msg=msg)
+        lane.correlate_host("uevent", msg, rec.get("host_t"))
+    elif kind == "cmd":
+        lane.record("cmd", cmd=rec.get("cmd"))
+        lane.log_event("auto", f"CMD '{rec.get('cmd')}' (recorded)")
+
+
+def restart_replay(reader: SessionReader) -> None:
+    global TRIAGE
+    TRIAGE = TriageDB(clock=CLOCK.time)
+    LANES[:] = replay_lanes(reader)
+
+
+def fleet_state() -> dict[str, Any]:
+    lanes = [lane.to_dict(events=False) for lane in LANES]
+    events: list[dict[str, Any]] = []
+    for lane in LANES:
+        with lane.state_lock:
+            events.extend(list(lane.state.events)[-30:])
+    with HOST_LOCK:
+        events.extend(list(HOST_EVENTS)[-30:])
+    events.sort(key=lambda e: e["ts"])
+    totals = {
+        "lanes": len(lanes),
+        "enums": sum(ln["enums"] for ln in lanes),
+        "enums_per_s": round(sum(ln["enums_per_s"] for ln in lanes), 2),
+        "findings_per_hour": round(sum(ln["findings_per_hour"] for ln in lanes), 2),
+        "host_errors": sum(ln["host_errors"] for ln in lanes),
+        "disconnects": sum(ln["disconnects"] for ln in lanes),
+        "unique_findings": len(TRIAGE),
+        "usb_devices": USB_DEVICES,
+    }
+    state = {"totals": totals, "lanes": lanes, "events": events[-40:]}
+    if REPLAY is not None:
+        state["replay"] = REPLAY.status()
+    return state
+
+
 DASHBOARD_HTML = """<!DOCTYPE html>
 <html><head>
 <meta charset="utf-8"><title>PortGremlin Overwatch</title>
@@ -272,27 +593,75 @@ DASHBOARD_HTML = """<!DOCTYPE html>
   .ev{padding:3px 0;border-bottom:1px solid #1a1a2a;font-size:.85em}
   .ev .src{color:#ff8844;margin-right:8px}
   .ev .ts{color:#555;margin-right:8px}
+  .ev .lane{color:#44aaff;margin-right:8px}
+  .panel{background:#14141f;border:1px solid #2a2a3a;border-radius:8px;padding:14px;margin-bottom:20px;max-height:320px;overflow-y:auto}
+  .panel h3{margin-bottom:10px;color:#888}
+  .panel table{width:100%;border-collapse:collapse;font-size:.8em}
+  .panel td,.panel th{text-align:left;padding:3px 6px;border-bottom:1px solid #1a1a2a}
+  .panel th{color:#888}
+  .panel .sig{color:#ff8844}
+  .panel .down{color:#555}
+  .replay{display:flex;gap:10px;align-items:center;margin-bottom:20px;color:#888}
+  .replay[hidden]{display:none}
+  .replay input{flex:1}
+  .replay button{background:#14141f;color:#e0e0e0;border:1px solid #2a2a3a;border-radius:4px;padding:2px 8px;font-family:inherit}
+  .replay button.on{border-color:#ff8844;color:#ff8844}
 </style></head><body>
 <h1>PortGremlin Overwatch</h1>
 <p class="sub">Closed-loop USB enumeration attack — live dual-perspective</p>
+<div class="replay" id="replay" hidden><button onclick="ctl('pause=toggle')" id="play">pause</button>
+<input type="range" id="seek" min="0" max="1" step="any" onchange="ctl('seek='+this.value)">
+<span id="pos"></span><span id="speeds"></span></div>
 <div class="grid" id="metrics"></div>
+<div class="panel"><h3>Lanes</h3><table><thead><tr><th>Lane</th><th>Port</th><th>Host</th>
+<th>Host OS</th><th>Persona</th><th>Brain</th><th>Enums</th><th>Enums/s</th><th>Findings</th>
+<th>Findings/h</th><th>Errors</th><th>Pain</th><th>Esc</th><th>Last VID:PID</th></tr></thead>
+<tbody id="lanes"></tbody></table></div>
+<div class="panel"><h3>Unique Findings</h3><table><thead><tr><th>Signature</th><th>Hits</th>
+<th>First seen</th><th>Lanes</th><th>Trigger</th><th>Template</th></tr></thead><tbody id="findings"></tbody></table></div>
 <div class="events"><h3>Event Stream</h3><div id="log"></div></div>
 <script>
+let seeking=false;
+document.getElementById('seek').addEventListener('input',()=>{seeking=true});
+// Kernel text and device strings are untrusted; never hand them to innerHTML raw.
+function esc(v){return String(v).replace(/[&<>"']/g,c=>({'&':'&amp;','<':'&lt;','>':'&gt;','"':'&quot;',"'":'&#39;'})[c])}
+async function ctl(q){seeking=false;await fetch('/api/replay?'+q);tick()}
+function replayBar(p){
+  const bar=document.getElementById('replay');bar.hidden=!p;if(!p)return;
+  const seek=document.getElementById('seek');seek.max=p.duration;if(!seeking)seek.value=p.position;
+  document.getElementById('play').textContent=p.paused?'play':'pause';
+  document.getElementById('pos').textContent=p.position.toFixed(1)+' / '+p.duration.toFixed(1)+' s'+
+    (p.finished?' (end)':'');
+  document.getElementById('speeds').innerHTML=[1,10,100,1000,0].map(x=>'<button class="'+
+    (x===p.speed?'on':'')+'" onclick="ctl(\\'speed='+x+'\\')">'+(x?x+'\u00d7':'max')+'</button>').join('');
+}
 async function tick(){
-  const r=await fetch('/api/state');const s=await r.json();
-  const m=document.getElementById('metrics');
+  const r=await fetch('/api/state');const s=await r.json();const t=s.totals;
+  replayBar(s.replay);
   const cards=[
-    ['Host OS',s.host_os],['Persona',s.persona],['Brain',s.brain_phase],
-    ['Enums',s.enums],['Disconnects',s.disconnects],['Host Errors',s.host_errors],
-    ['Pain Score',s.pain_score],['Evolve Gen',s.evolve_gen],['VID:PID',s.last_vid+':'+s.last_pid],
-    ['Class',s.last_class],['USB Devs',s.usb_devices],['Escalation',s.escalation_level]
+    ['Lanes',t.lanes],['Enums',t.enums],['Enums/s',t.enums_per_s],
+    ['Unique Findings',t.unique_findings],['Findings/h',t.findings_per_hour],
+    ['Host Errors',t.host_errors],['Disconnects',t.disconnects],['USB Devs',t.usb_devices]
   ];
-  m.innerHTML=cards.map(([k,v])=>'<div class="card"><h3>'+k+'</h3><div class="val'+
-    (k==='Pain Score'?' pain':'')+'">'+v+'</div></div>').join('');
-  const log=document.getElementById('log');
-  log.innerHTML=(s.events||[]).slice().reverse().map(e=>{
-    const t=new Date(e.ts*1000).toLocaleTimeString();
-    return '<div class="ev"><span class="ts">'+t+'</span><span class="src">'+e.source+'</span>'+e.msg+'</div>';
+  document.getElementById('metrics').innerHTML=cards.map(([k,v])=>'<div class="card"><h3>'+k+
+    '</h3><div class="val'+(k==='Host Errors'?' pain':'')+'">'+v+'</div></div>').join('');
+  document.getElementById('lanes').innerHTML=s.lanes.map(l=>
+    '<tr'+(l.connected?'':' class="down"')+'><td class="sig">'+esc(l.name)+'</td><td>'+esc(l.port)+'</td><td>'+
+    esc(l.host+(l.usb?' '+l.usb:''))+'</td><td>'+esc(l.host_os)+'</td><td>'+esc(l.persona)+'</td><td>'+
+    esc(l.brain_phase)+'</td><td>'+l.enums+'</td><td>'+l.enums_per_s+'</td><td>'+l.unique_findings+
+    '</td><td>'+l.findings_per_hour+'</td><td>'+l.host_errors+'</td><td>'+l.pain_score+'</td><td>'+
+    l.escalation_level+'</td><td>'+esc(l.last_vid+':'+l.last_pid+' '+l.last_class)+'</td></tr>').join('');
+  document.getElementById('log').innerHTML=(s.events||[]).slice().reverse().map(e=>{
+    const ts=new Date(e.ts*1000).toLocaleTimeString();
+    return '<div class="ev"><span class="ts">'+ts+'</span><span class="lane">'+esc(e.lane)+
+      '</span><span class="src">'+esc(e.source)+'</span>'+esc(e.msg)+'</div>';
+  }).join('');
+  const f=await (await fetch('/api/findings')).json();
+  document.getElementById('findings').innerHTML=f.map(b=>{
+    const i=b.identity;const trig=i?(i.vid+':'+i.pid+' '+i.cls+' gen '+i.gen):'n/a';
+    return '<tr><td class="sig">'+esc(b.signature)+'</td><td>'+b.hits+'</td><td>'+
+      new Date(b.first_seen*1000).toLocaleTimeString()+'</td><td>'+esc(b.lanes.join(' '))+'</td><td>'+
+      esc(trig)+'</td><td>'+esc(b.template)+'</td></tr>';
   }).join('');
 }
 setInterval(tick,1000);tick();
@@ -305,9 +674,32 @@ class OverwatchHandler(BaseHTTPRequestHandler):
 
     def do_GET(self) -> None:
         path = urlparse(self.path).path
+        body: Optional[bytes] = None
         if path == "/api/state":
-            with STATE_LOCK:
-                body = json.dumps(STATE.to_dict()).encode()
+            body = json.dumps(fleet_state()).encode()
+        elif path == "/api/replay" and REPLAY is not None:
+            query = parse_qs(urlparse(self.path).query)
+            try:
+                if "speed" in query:
+                    REPLAY.set_speed(max(0.0, float(query["speed"][0])))
+                if "seek" in query:
+                    REPLAY.seek(float(query["seek"][0]))
+            except ValueError:
+                self.send_error(400)
+                return
+            if "pause" in query:
+                REPLAY.set_paused(not REPLAY.paused)
+            body = json.dumps(REPLAY.status()).encode()
+        elif path == "/api/findings":
+            body = json.dumps(TRIAGE.to_list(limit=100)).encode()
+        elif path.startswith("/api/lanes/"):
+            name = path.rsplit("/", 1)[-1]
+            lane = next((ln for ln in LANES if ln.name == name), None)
+            if lane is None:
+                self.send_error(404)
+                return
+            body = json.dumps(lane.to_dict()).encode()
+        if body is not None:
             self.send_response(200)
             self.send_header("Content-Type", "application/json")
             self.send_header("Access-Control-Allow-Origin", "*")
@@ -323,50 +715,192 @@ class OverwatchHandler(BaseHTTPRequestHandler):
 def serve_dashboard(port: int, stop: threading.Event) -> None:
     server = ThreadingHTTPServer(("127.0.0.1", port), OverwatchHandler)
     server.timeout = 1
-    log_event("host", f"Dashboard http://127.0.0.1:{port}")
+    log_host(f"Dashboard http://127.0.0.1:{port}")
     while not stop.is_set():
         server.handle_request()
     server.server_close()
 
 
-def write_report(path: str) -> None:
+def write_report(path: str, findings_path: str) -> None:
     os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
-    with STATE_LOCK:
-        data = STATE.to_dict()
-    data["generated_at"] = time.strftime("%Y-%m-%d %H:%M:%S")
+    lanes = []
+    for lane in LANES:
+        lane.flush(force=True)
+        data = lane.to_dict()
+        with lane.corr_lock:
+            data["correlation"] = lane.correlator.to_dict()
+        lanes.append(data)
+    report = fleet_state()
+    report["lanes"] = lanes
+    report["findings"] = TRIAGE.to_list()
+    report["generated_at"] = time.strftime("%Y-%m-%d %H:%M:%S")
     with open(path, "w", encoding="utf-8") as f:
-        json.dump(data, f, indent=2)
-    log_event("host", f"Report written to {path}")
+        json.dump(report, f, indent=2)
+    log_host(f"Report written to {path}")
+    os.makedirs(os.path.dirname(findings_path) or ".", exist_ok=True)
+    with open(findings_path, "w", encoding="utf-8") as f:
+        f.write(TRIAGE.to_markdown())
+    log_host(f"{len(TRIAGE)} unique findings written to {findings_path}")
+
+
+def parse_lane_spec(spec: str, index: int) -> dict[str, str]:
+    """name=lab1,port=/dev/ttyACM0[,usb=1-1.2][,kmsg=ssh lab1 dmesg -w][,os=linux]"""
+    fields: dict[str, str] = {}
+    for part in spec.split(","):
+        key, sep, value = part.partition("=")
+        if not sep:
+            if "port" in fields:
+                raise ValueError(f"bad lane spec {spec!r}")
+            fields["port"] = key.strip()
+            continue
+        fields[key.strip()] = value.strip()
+    if "port" not in fields:
+        raise ValueError(f"lane spec {spec!r} needs port=")
+    fields.setdefault("name", f"lane{index}")
+    return fields
+
+
+def start_recording(path: str) -> None:
+    global EVENTS_LOG
+    EVENTS_LOG = open_recorder(path, CLOCK)
+    for lane in LANES:
+        lane.record("lane", os=lane.target_os, port=lane.port, usb=lane.usb,
+                    host=lane.kmsg or "local", wall=round(CLOCK.time(), 3))
+    log_host(f"Recording session to {path}")
+
+
+def replay_main(args: argparse.Namespace) -> int:
+    global CLOCK, TRIAGE, REPLAY
+    try:
+        reader = SessionReader(args.replay)
+    except OSError as exc:
+        print(f"Cannot open {args.replay}: {exc}", file=sys.stderr)
+        return 1
+    if not reader.count:
+        print(f"{args.replay}: empty session", file=sys.stderr)
+        return 1
+    headers = [h for h in reader.lanes().values() if "wall" in h]
+    wall0 = headers[0]["wall"] - (headers[0]["t"] - reader.t0) if headers else None
+    CLOCK = ReplayClock(reader.t0, wall0)
+    TRIAGE = TriageDB(clock=CLOCK.time)
+    LANES[:] = replay_lanes(reader)
+    if args.record:
+        start_recording(args.record)
+
+    REPLAY = SessionPlayer(reader, replay_record, CLOCK, args.speed, lambda: restart_replay(reader))
+    if args.seek > 0:
+        REPLAY.seek(args.seek)
+    truncated = " (truncated)" if reader.truncated else ""
+    log_host(f"Replaying {args.replay}{truncated}: {reader.count} records, {reader.duration:.1f} s, "
+             f"{len(LANES)} lane(s) at {'max' if args.speed == SPEED_MAX else f'{args.speed:g}x'}")
+
+    stop = threading.Event()
+    threads = [
+        threading.Thread(target=serve_dashboard, args=(args.web_port, stop), daemon=True),
+        threading.Thread(target=correlate_flush_loop, args=(stop,), daemon=True),
+        threading.Thread(target=REPLAY.run, args=(stop,), daemon=True),
+    ]
+    for t in threads:
+        t.start()
+    if not args.no_browser:
+        threading.Timer(1.5, lambda: webbrowser.open(f"http://127.0.0.1:{args.web_port}")).start()
+
+    started = time.monotonic()
+    try:
+        while not (REPLAY.finished and not args.keep_open):
+            if args.duration > 0 and time.monotonic() - started >= args.duration:
+                break
+            time.sleep(0.2)
+    except KeyboardInterrupt:
+        print("\nShutting down...")
+    finally:
+        stop.set()
+        write_report(args.report, args.findings_report)
+        if EVENTS_LOG is not None:
+            EVENTS_LOG.close()
+    return 0
 
 
 def main() -> int:
     parser = argparse.ArgumentParser(description="PortGremlin Overwatch orchestrator")
-    parser.add_argument("-p", "--port", help="Serial port")
+    parser.add_argument("-p", "--port", help="Serial port (single-lane mode)")
     parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("--lane", action="append", default=[],
+                        metavar="name=N,port=P[,usb=1-1.2][,kmsg=CMD][,os=OS]",
+                        help="Add a lane; repeat for more LaunchPads")
     parser.add_argument("--web-port", type=int, default=8765)
     parser.add_argument("--no-browser", action="store_true")
     parser.add_argument("--no-auto", action="store_true", help="Disable autonomous commands")
+    mode = parser.add_mutually_exclusive_group()
+    mode.add_argument("--bandit", action="store_true",
+                      help="Let the firmware's bandit pick personas, fed back findings and uevents")
+    mode.add_argument("--surrogate", nargs="*", metavar="SESSION",
+                      help="Run Evolve and screen its genomes with a surrogate model, "
+                           "seeded from these recorded sessions")
     parser.add_argument("--duration", type=float, default=0)
     parser.add_argument("--report", default="reports/overwatch-session.json")
+    parser.add_argument("--findings-report", default="reports/overwatch-findings.md")
+    parser.add_argument("--record", "--events-log", dest="record", metavar="PATH",
+                        help="Record the raw session (.pgses compressed, .jsonl plain)")
+    parser.add_argument("--os", dest="target_os",
+                        help="Real OS of the target host in single-lane mode (labels --record)")
+    parser.add_argument("--replay", metavar="PATH", help="Replay a recorded session instead of hardware")
+    parser.add_argument("--speed", type=float, default=1.0,
+                        help="Replay speed multiplier, 0 = as fast as possible")
+    parser.add_argument("--seek", type=float, default=0.0, help="Start the replay N seconds in")
+    parser.add_argument("--keep-open", action="store_true",
+                        help="Keep the dashboard up after the replay ends")
+    parser.add_argument("--quiet", action="store_true", help="Do not echo events to the terminal")
     args = parser.parse_args()
 
-    serial_port = find_serial_port(args.port)
-    if not serial_port:
-        print("No serial port found. Connect LaunchPad ICDI port.", file=sys.stderr)
+    global ECHO
+    ECHO = not args.quiet
+    if args.replay:
+        return replay_main(args)
+
+    specs = []
+    try:
+        specs = [parse_lane_spec(s, i) for i, s in enumerate(args.lane)]
+    except ValueError as exc:
+        print(exc, file=sys.stderr)
         return 1
+    if not specs:
+        serial_port = find_serial_port(args.port)
+        if not serial_port:
+            print("No serial port found. Connect LaunchPad ICDI port.", file=sys.stderr)
+            return 1
+        specs = [{"name": "lane0", "port": serial_port}]
+        if args.target_os:
+            specs[0]["os"] = args.target_os
+
+    history = load_episodes(args.surrogate) if args.surrogate else []
+    if args.surrogate:
+        log_host(f"Surrogate history: {len(history)} episodes from {len(args.surrogate)} session(s)")
+    for spec in specs:
+        surrogate = None
+        if args.surrogate is not None:
+            host = spec.get("os")
+            surrogate = Surrogate(episodes=[e for e in history if not host or e.os in (None, host)])
+        LANES.append(Lane(spec["name"], spec["port"], args.baud, spec.get("usb"),
+                          spec.get("kmsg"), autonomous=not args.no_auto,
+                          target_os=spec.get("os"), bandit=args.bandit, surrogate=surrogate))
+
+    if args.record:
+        start_recording(args.record)
+
+    hosts: dict[Optional[str], list[Lane]] = {}
+    for lane in LANES:
+        hosts.setdefault(lane.kmsg, []).append(lane)
 
-    STATE.autonomous = not args.no_auto
     stop = threading.Event()
-
     threads = [
-        threading.Thread(target=serial_loop, args=(serial_port, args.baud, stop), daemon=True),
         threading.Thread(target=lsusb_loop, args=(2.0, stop), daemon=True),
         threading.Thread(target=serve_dashboard, args=(args.web_port, stop), daemon=True),
+        threading.Thread(target=correlate_flush_loop, args=(stop,), daemon=True),
     ]
-    if shutil_which("dmesg"):
-        threads.append(threading.Thread(target=dmesg_loop, args=(stop,), daemon=True))
-    if shutil_which("journalctl"):
-        threads.append(threading.Thread(target=journal_loop, args=(stop,), daemon=True))
+    threads += [threading.Thread(target=lane.serial_loop, args=(stop,), daemon=True) for lane in LANES]
+    for kmsg, lanes in hosts.items():
+        threads += KernelWatcher(lanes, kmsg).threads(stop)
 
     for t in threads:
         t.start()
@@ -374,7 +908,7 @@ def main() -> int:
     if not args.no_browser:
         threading.Timer(1.5, lambda: webbrowser.open(f"http://127.0.0.1:{args.web_port}")).start()
 
-    print("\n  PortGremlin Overwatch running. Ctrl+C to stop.\n")
+    print(f"\n  PortGremlin Overwatch running {len(LANES)} lane(s). Ctrl+C to stop.\n")
     try:
         if args.duration > 0:
             time.sleep(args.duration)
@@ -385,7 +919,9 @@ def main() -> int:
         print("\nShutting down...")
     finally:
         stop.set()
-        write_report(args.report)
+        write_report(args.report, args.findings_report)
+        if EVENTS_LOG is not None:
+            EVENTS_LOG.close()
     return 0
 
 
@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+"""
+PortGremlin Profile — where the firmware spends its time.
+
+Firmware built with `make -C usb_dev_keyboard PROFILE=1` samples the
+interrupted PC from Timer1A (~1 kHz) into a table of code-address
+buckets. This tool restarts sampling, waits while you run a scenario
+(STORM, CHAOS, a campaign...), pulls the table with `!prof` and maps each
+bucket onto the symbols of portgremlin.elf. A bucket that straddles
+several functions is split by how many bytes of it each one covers.
+
+    python3 tools/portgremlin-profile.py --duration 60
+    python3 tools/portgremlin-profile.py --duration 60 --save reports/chaos.prof.json \\
+        --folded reports/chaos.folded
+    python3 tools/portgremlin-profile.py --input reports/chaos.prof.json --top 40
+
+There is no call stack, only the sampled PC, so the folded output (for
+flamegraph.pl or speedscope) is two levels deep: source file, function.
+Samples that landed in TivaWare ROM or outside .text are reported as
+[rom] and [other]; the ISR figure is the share of samples that preempted
+another interrupt handler (USB, UART or the SysTick re-enumeration).
+"""
+
+from __future__ import annotations
+
+import argparse
+import bisect
+import json
+import os
+import shutil
+import subprocess
+import sys
+import threading
+import time
+from collections import defaultdict
+from dataclasses import asdict, dataclass, field
+from typing import Any, Optional
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from ingest import FrameReader, pump
+
+DEFAULT_ELF = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))),
+                           "usb_dev_keyboard", "portgremlin.elf")
+NM_TOOLS = ("arm-none-eabi-nm", "nm")
+TEXT_TYPES = set("tTwW")
+DUMP_TIMEOUT_S = 10.0
+
+
+@dataclass
+class Profile:
+    """One !prof dump: the "prof" header plus every "pb" bucket record."""
+
+    hz: int = 0
+    shift: int = 0
+    end: int = 0
+    samples: int = 0
+    isr: int = 0
+    rom: int = 0
+    other: int = 0
+    halvings: int = 0
+    buckets: dict[int, int] = field(default_factory=dict)
+
+    def add_header(self, rec: dict[str, Any]) -> None:
+        self.hz = int(rec.get("hz", 0))
+        self.shift = int(rec.get("shift", 0))
+        self.end = int(rec.get("end", 0))
+        self.samples = int(rec.get("s", 0))
+        self.isr = int(rec.get("isr", 0))
+        self.rom = int(rec.get("rom", 0))
+        self.other = int(rec.get("other", 0))
+        self.halvings = int(rec.get("hv", 0))
+        self.buckets.clear()
+
+    def add_buckets(self, rec: dict[str, Any]) -> None:
+        for pair in str(rec.get("d", "")).split():
+            index, _, count = pair.partition(":")
+            self.buckets[int(index, 16)] = int(count, 16)
+
+    @property
+    def mapped(self) -> int:
+        return sum(self.buckets.values())
+
+    @property
+    def total(self) -> int:
+        return self.mapped + self.rom + self.other
+
+    def to_dict(self) -> dict[str, Any]:
+        out = asdict(self)
+        out["buckets"] = {f"{k:x}": v for k, v in sorted(self.buckets.items())}
+        return out
+
+    @classmethod
+    def from_dict(cls, data: dict[str, Any]) -> "Profile":
+        prof = cls(**{k: int(v) for k, v in data.items() if k != "buckets"})
+        prof.buckets = {int(k, 16): int(v) for k, v in data.get("buckets", {}).items()}
+        return prof
+
+
+@dataclass(frozen=True)
+class Symbol:
+    addr: int
+    size: int
+    name: str
+    file: str
+
+
+def load_symbols(elf: str, nm: Optional[str] = None) -> list[Symbol]:
+    """Code symbols of elf, sorted, with sizes filled in where nm has none."""
+    tool = nm or next((t for t in NM_TOOLS if shutil.which(t)), None)
+    if tool is None:
+        raise RuntimeError("no nm found; install binutils-arm-none-eabi")
+    out = subprocess.run([tool, "-n", "-S", "-l", "--defined-only", elf],
+                         capture_output=True, text=True, check=True).stdout
+
+    raw: list[tuple[int, Optional[int], str, str]] = []
+    for line in out.splitlines():
+        where = ""
+        if "\t" in line:
+            line, where = line.split("\t", 1)
+        parts = line.split()
+        if len(parts) == 4:
+            addr, size, kind, name = int(parts[0], 16), int(parts[1], 16), parts[2], parts[3]
+        elif len(parts) == 3:
+            addr, size, kind, name = int(parts[0], 16), None, parts[1], parts[2]
+        else:
+            continue
+        if kind not in TEXT_TYPES:
+            continue
+        source = os.path.basename(where.rsplit(":", 1)[0]) if where else "[lib]"
+        raw.append((addr & ~1, size, name, source))  # clear the Thumb bit
+
+    raw.sort()
+    symbols = []
+    for i, (addr, size, name, source) in enumerate(raw):
+        if not size:
+            nxt = next((a for a, *_ in raw[i + 1:] if a > addr), addr + 2)
+            size = nxt - addr
+        symbols.append(Symbol(addr, size, name, source))
+    return symbols
+
+
+def attribute(prof: Profile, symbols: list[Symbol]) -> dict[tuple[str, str], float]:
+    """Spread each bucket's count over the symbols it overlaps, by bytes."""
+    weights: dict[tuple[str, str], float] = defaultdict(float)
+    width = 1 << prof.shift
+    starts = [s.addr for s in symbols]
+    for index, count in prof.buckets.items():
+        lo, hi = index * width, (index + 1) * width
+        covered = 0
+        i = max(0, bisect.bisect_right(starts, lo) - 1)
+        while i < len(symbols) and symbols[i].addr < hi:
+            sym = symbols[i]
+            overlap = min(hi, sym.addr + sym.size) - max(lo, sym.addr)
+            if overlap > 0:
+                weights[(sym.file, sym.name)] += count * overlap / width
+                covered += overlap
+            i += 1
+        if covered < width:
+            weights[("[unknown]", f"0x{lo:05x}")] += count * (width - covered) / width
+    if prof.rom:
+        weights[("[rom]", "driverlib")] += prof.rom
+    if prof.other:
+        weights[("[other]", "?")] += prof.other
+    return dict(weights)
+
+
+def print_report(prof: Profile, weights: dict[tuple[str, str], float], top: int) -> None:
+    total = prof.total or 1
+    seconds = prof.samples / prof.hz if prof.hz else 0.0
+    print(f"{prof.samples} samples at {prof.hz} Hz ({seconds:.1f} s), "
+          f"{1 << prof.shift}-byte buckets over {prof.end} bytes of .text")
+    if prof.halvings:
+        print(f"counts halved {prof.halvings}x when a bucket saturated")
+    if prof.samples:
+        print(f"in ISR context: {100.0 * prof.isr / total:.1f}%  "
+              f"rom: {100.0 * prof.rom / total:.1f}%  other: {100.0 * prof.other / total:.1f}%")
+
+    by_file: dict[str, float] = defaultdict(float)
+    for (source, _), weight in weights.items():
+        by_file[source] += weight
+
+    print(f"\n{'%':>6}  {'samples':>8}  function")
+    for (source, name), weight in sorted(weights.items(), key=lambda kv: -kv[1])[:top]:
+        print(f"{100.0 * weight / total:6.2f}  {weight:8.1f}  {name}  ({source})")
+    print(f"\n{'%':>6}  {'samples':>8}  file")
+    for source, weight in sorted(by_file.items(), key=lambda kv: -kv[1])[:top]:
+        print(f"{100.0 * weight / total:6.2f}  {weight:8.1f}  {source}")
+
+
+def write_folded(path: str, weights: dict[tuple[str, str], float]) -> None:
+    with open(path, "w", encoding="utf-8") as fh:
+        for (source, name), weight in sorted(weights.items()):
+            count = round(weight)
+            if count:
+                fh.write(f"{source};{name} {count}\n")
+
+
+def find_launchpad_port() -> Optional[str]:
+    from serial.tools import list_ports
+
+    for port in list_ports.comports():
+        desc = (port.description or "").lower()
+        if any(token in desc for token in ("ti", "xds", "icdi", "launchpad", "tm4c")):
+            return port.device
+    ports = list(list_ports.comports())
+    return ports[0].device if ports else None
+
+
+def capture(port: str, baud: int, duration: float, hz: Optional[int]) -> Profile:
+    """Optionally restart sampling at hz, wait duration, then pull the table."""
+    import serial
+
+    prof = Profile()
+    acks: dict[str, bool] = {}
+    got_ack = threading.Condition()
+
+    def on_record(rec: dict[str, Any]) -> None:
+        kind = rec.get("e")
+        if kind == "prof":
+            prof.add_header(rec)
+        elif kind == "pb":
+            prof.add_buckets(rec)
+        elif kind == "ack" and rec.get("cmd") == "prof":
+            with got_ack:
+                acks["prof"] = bool(rec.get("ok"))
+                got_ack.notify_all()
+
+    def command(frame: str) -> bool:
+        with got_ack:
+            acks.pop("prof", None)
+            ser.write(frame.encode("ascii"))
+            ser.flush()
+            if not got_ack.wait_for(lambda: "prof" in acks, DUMP_TIMEOUT_S):
+                raise RuntimeError(f"no ack for {frame.strip()}; is the firmware built with PROFILE=1?")
+            return acks["prof"]
+
+    ser = serial.Serial(port, baud, timeout=0.1)
+    stop = threading.Event()
+    reader = threading.Thread(target=pump, args=(ser, FrameReader(on_record), stop), daemon=True)
+    reader.start()
+    try:
+        if hz is not None and not command(f"!prof {hz:x}\n"):
+            raise RuntimeError(f"firmware rejected {hz} Hz")
+        if duration > 0:
+            print(f"sampling for {duration:.0f} s...", file=sys.stderr)
+            time.sleep(duration)
+        if not command("!prof\n"):
+            raise RuntimeError("profile dump failed")
+    finally:
+        stop.set()
+        reader.join(timeout=1.0)
+        ser.close()
+    return prof
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Sample and symbolize the PortGremlin firmware profile")
+    parser.add_argument("-p", "--port", help="Serial port (auto-detect if omitted)")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("--duration", type=float, default=30.0,
+                        help="Seconds to sample before dumping (0 dumps what is there)")
+    parser.add_argument("--hz", type=int, default=1009,
+                        help="Restart sampling at this rate first; 0 keeps the running table")
+    parser.add_argument("--elf", default=DEFAULT_ELF, help="Firmware image with symbols")
+    parser.add_argument("--nm", help="nm to use (default arm-none-eabi-nm, then nm)")
+    parser.add_argument("--input", metavar="PATH", help="Read a profile saved with --save instead")
+    parser.add_argument("--save", metavar="PATH", help="Write the raw profile as JSON")
+    parser.add_argument("--folded", metavar="PATH",
+                        help="Write file;function counts for flamegraph.pl / speedscope")
+    parser.add_argument("--top", type=int, default=25)
+    args = parser.parse_args()
+
+    if args.input:
+        with open(args.input, encoding="utf-8") as fh:
+            prof = Profile.from_dict(json.load(fh))
+    else:
+        port = args.port or find_launchpad_port()
+        if not port:
+            print("No serial port found. Use -p /dev/ttyACM0", file=sys.stderr)
+            return 1
+        try:
+            prof = capture(port, args.baud, args.duration, args.hz or None)
+        except (OSError, RuntimeError) as exc:
+            print(f"profile capture failed: {exc}", file=sys.stderr)
+            return 1
+
+    if args.save:
+        with open(args.save, "w", encoding="utf-8") as fh:
+            json.dump(prof.to_dict(), fh, indent=1)
+
+    try:
+        symbols = load_symbols(args.elf, args.nm)
+    except (OSError, RuntimeError, subprocess.CalledProcessError) as exc:
+        print(f"cannot read symbols from {args.elf}: {exc}", file=sys.stderr)
+        return 1
+
+    weights = attribute(prof, symbols)
+    print_report(prof, weights, args.top)
+    if args.folded:
+        write_folded(args.folded, weights)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
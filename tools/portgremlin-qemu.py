@@ -0,0 +1,271 @@
+#!/usr/bin/env python3
+"""
+PortGremlin QEMU — run the firmware image without a LaunchPad.
+
+`make -C usb_dev_keyboard qemu` builds build-qemu/portgremlin-qemu.elf for
+qemu-system-arm's lm3s6965evb. It is the real firmware with usblib replaced
+by a virtual host (usb_dev_keyboard/qemu/). UART0 goes to a pty.
+
+    run   boot the image and print the pty; point portgremlin-cli.py,
+          Overwatch or gremlin-oracle at it with -p
+    test  boot, start auto-cycling, and check the timing records the QEMU
+          flavor prints against a baseline:
+            qboot  cycles from clock setup to the first USB stack init, and
+                   on to the first SET_CONFIGURATION
+            qenum  cycles of each re-enumeration, from the first stack call
+                   after the D+ hold to reconnect
+
+    make -C usb_dev_keyboard qemu-test                 # CI: exit 1 on regression
+    make -C usb_dev_keyboard qemu-baseline             # accept the current numbers
+
+A missing baseline fails the test (exit 2) rather than passing unchecked.
+
+The guest runs under -icount, so SysTick counts guest instructions rather
+than host time. The same image gives the same cycle counts on a loaded CI
+runner. The one varying input is when the start frames reach the guest,
+so enumeration figures are compared as a median and p90 with a tolerance.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import threading
+import time
+from dataclasses import asdict, dataclass, field
+from typing import Any, Optional
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from ingest import FrameReader, pump
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_ELF = os.path.join(ROOT, "usb_dev_keyboard", "build-qemu", "portgremlin-qemu.elf")
+DEFAULT_BASELINE = os.path.join(ROOT, "usb_dev_keyboard", "qemu", "baseline-linux.json")
+PTY_RE = re.compile(r"char device redirected to (\S+)")
+MACHINE = "lm3s6965evb"
+PTY_TIMEOUT_S = 10.0
+# !stop, a fixed seed, then auto-cycle (PORTGREMLIN_FLAG_AUTO) at the default interval.
+START_FRAMES = ("!stop\n", "!seed 1\n", "!cfg 20\n")
+METRICS = ("boot_cycles", "enum_cycles_median", "enum_cycles_p90")
+
+
+@dataclass
+class TimingRun:
+    hz: int = 0
+    boot_cycles: int = 0
+    config_cycles: int = 0
+    enum_cycles: list[int] = field(default_factory=list)
+
+    def percentile(self, q: float) -> int:
+        ordered = sorted(self.enum_cycles)
+        if not ordered:
+            return 0
+        return ordered[min(len(ordered) - 1, int(q * len(ordered)))]
+
+    def metrics(self) -> dict[str, int]:
+        return {
+            "boot_cycles": self.boot_cycles,
+            "enum_cycles_median": self.percentile(0.5),
+            "enum_cycles_p90": self.percentile(0.9),
+        }
+
+
+class QemuTarget:
+    """qemu-system-arm with UART0 on a pty, stopped on exit."""
+
+    def __init__(self, elf: str, qemu: str = "qemu-system-arm", icount: int = 4) -> None:
+        self.elf = elf
+        self.qemu = qemu
+        self.icount = icount
+        self.proc: Optional[subprocess.Popen[str]] = None
+        self.pty: Optional[str] = None
+
+    def command(self) -> list[str]:
+        return [self.qemu, "-M", MACHINE, "-nographic", "-monitor", "none",
+                "-serial", "pty", "-icount", f"shift={self.icount},sleep=off",
+                "-kernel", self.elf]
+
+    def start(self) -> str:
+        if not os.path.exists(self.elf):
+            raise RuntimeError(f"{self.elf} not found; run make -C usb_dev_keyboard qemu")
+        self.proc = subprocess.Popen(self.command(), stdout=subprocess.PIPE,
+                                     stderr=subprocess.STDOUT, text=True)
+        deadline = time.monotonic() + PTY_TIMEOUT_S
+        assert self.proc.stdout is not None
+        while time.monotonic() < deadline:
+            line = self.proc.stdout.readline()
+            if not line:
+                break
+            match = PTY_RE.search(line)
+            if match:
+                self.pty = match.group(1)
+                threading.Thread(target=self._drain, daemon=True).start()
+                return self.pty
+        self.stop()
+        raise RuntimeError("qemu did not report a serial pty")
+
+    def _drain(self) -> None:
+        assert self.proc is not None and self.proc.stdout is not None
+        for line in self.proc.stdout:
+            print(f"qemu: {line.rstrip()}", file=sys.stderr)
+
+    def stop(self) -> None:
+        if self.proc and self.proc.poll() is None:
+            self.proc.terminate()
+            try:
+                self.proc.wait(timeout=5.0)
+            except subprocess.TimeoutExpired:
+                self.proc.kill()
+
+    def __enter__(self) -> "QemuTarget":
+        return self
+
+    def __exit__(self, *exc: Any) -> None:
+        self.stop()
+
+
+def measure(pty: str, enums: int, timeout: float, echo: bool = False) -> TimingRun:
+    """Read qboot, start auto-cycling, collect `enums` re-enumeration timings."""
+    import serial
+
+    run = TimingRun()
+    booted = threading.Event()
+    done = threading.Event()
+    last_n = [0]
+
+    def on_record(rec: dict[str, Any]) -> None:
+        kind = rec.get("e")
+        if kind == "qboot":
+            run.hz = int(rec.get("hz", 0))
+            run.boot_cycles = int(rec.get("c", 0))
+            run.config_cycles = int(rec.get("cfg", 0))
+            booted.set()
+        elif kind == "qenum" and booted.is_set() and not done.is_set():
+            n = int(rec.get("n", 0))
+            if n > last_n[0]:           # re-enumeration, not a class cycle
+                last_n[0] = n
+                run.enum_cycles.append(int(rec.get("c", 0)))
+                if len(run.enum_cycles) >= enums:
+                    done.set()
+
+    def on_line(line: str) -> None:
+        if echo:
+            print(line)
+
+    ser = serial.Serial(pty, 115200, timeout=0.1)
+    stop = threading.Event()
+    reader = threading.Thread(target=pump, args=(ser, FrameReader(on_record, on_line), stop), daemon=True)
+    reader.start()
+    try:
+        if not booted.wait(timeout):
+            raise RuntimeError("no qboot record; did the image boot?")
+        for frame in START_FRAMES:
+            ser.write(frame.encode("ascii"))
+            ser.flush()
+        if not done.wait(timeout):
+            raise RuntimeError(f"only {len(run.enum_cycles)} of {enums} enumerations before timeout")
+    finally:
+        stop.set()
+        reader.join(timeout=1.0)
+        ser.close()
+    return run
+
+
+def compare(metrics: dict[str, int], baseline: dict[str, Any], tolerance: float) -> list[str]:
+    """Metrics more than tolerance above the baseline."""
+    regressions = []
+    for key in METRICS:
+        ref = baseline.get(key)
+        if not ref:
+            continue
+        if metrics[key] > ref * (1.0 + tolerance):
+            regressions.append(f"{key}: {metrics[key]} vs {ref} (+{100.0 * (metrics[key] / ref - 1):.1f}%)")
+    return regressions
+
+
+def cmd_run(args: argparse.Namespace) -> int:
+    with QemuTarget(args.elf, args.qemu, args.icount) as target:
+        pty = target.start()
+        print(f"PortGremlin on {MACHINE}: UART0 at {pty}")
+        print(f"  python3 tools/portgremlin-cli.py -p {pty}")
+        try:
+            assert target.proc is not None
+            target.proc.wait()
+        except KeyboardInterrupt:
+            print()
+    return 0
+
+
+def cmd_test(args: argparse.Namespace) -> int:
+    try:
+        with QemuTarget(args.elf, args.qemu, args.icount) as target:
+            run = measure(target.start(), args.enums, args.timeout, args.verbose)
+    except (OSError, RuntimeError) as exc:
+        print(f"qemu test failed to run: {exc}", file=sys.stderr)
+        return 2
+
+    metrics = run.metrics()
+    ms = 1000.0 / run.hz if run.hz else 0.0
+    print(f"boot to USB stack init: {run.boot_cycles} cycles ({run.boot_cycles * ms:.2f} ms at {run.hz} Hz)")
+    print(f"boot to first SET_CONFIGURATION: {run.config_cycles} cycles "
+          f"({run.config_cycles * ms:.1f} ms, mostly the virtual host's delays)")
+    print(f"re-enumeration over {len(run.enum_cycles)}: median {metrics['enum_cycles_median']}, "
+          f"p90 {metrics['enum_cycles_p90']}, max {max(run.enum_cycles)} cycles")
+
+    if args.report:
+        with open(args.report, "w", encoding="utf-8") as fh:
+            json.dump({**asdict(run), **metrics, "icount": args.icount}, fh, indent=1)
+
+    if args.update:
+        with open(args.baseline, "w", encoding="utf-8") as fh:
+            json.dump({**metrics, "icount": args.icount, "enums": len(run.enum_cycles)}, fh, indent=1)
+            fh.write("\n")
+        print(f"baseline written to {args.baseline}")
+        return 0
+
+    if not os.path.exists(args.baseline):
+        print(f"no baseline at {args.baseline}; record one with --update (make qemu-baseline) "
+              f"and commit it", file=sys.stderr)
+        return 2
+    with open(args.baseline, encoding="utf-8") as fh:
+        baseline = json.load(fh)
+    if baseline.get("icount", args.icount) != args.icount:
+        print(f"baseline was taken at icount {baseline['icount']}, not {args.icount}", file=sys.stderr)
+        return 2
+
+    regressions = compare(metrics, baseline, args.tolerance)
+    for line in regressions:
+        print(f"REGRESSION {line}")
+    if not regressions:
+        print(f"within {100.0 * args.tolerance:.0f}% of {os.path.basename(args.baseline)}")
+    return 1 if regressions else 0
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Run the PortGremlin firmware under QEMU")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    for name in ("run", "test"):
+        p = sub.add_parser(name)
+        p.add_argument("--elf", default=DEFAULT_ELF)
+        p.add_argument("--qemu", default="qemu-system-arm")
+        p.add_argument("--icount", type=int, default=4,
+                       help="2^N ns of virtual time per guest instruction")
+    test = sub.choices["test"]
+    test.add_argument("--enums", type=int, default=20, help="Re-enumerations to time")
+    test.add_argument("--timeout", type=float, default=120.0, help="Seconds to wait for each stage")
+    test.add_argument("--baseline", default=DEFAULT_BASELINE)
+    test.add_argument("--tolerance", type=float, default=0.10, help="Allowed slowdown (0.10 = 10%%)")
+    test.add_argument("--update", action="store_true", help="Write the baseline instead of checking it")
+    test.add_argument("--report", metavar="PATH", help="Write every timing as JSON")
+    test.add_argument("-v", "--verbose", action="store_true", help="Echo the guest console")
+    args = parser.parse_args()
+    return cmd_run(args) if args.cmd == "run" else cmd_test(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -3,22 +3,27 @@
 
 from __future__ import annotations
 
+import argparse
 import os
 import sys
 import time
 import tkinter as tk
+from collections import deque
 from tkinter import ttk, scrolledtext
+from typing import Any, Callable
 
 sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
 
+from cosim import FirmwareCoSimulator, SessionSimulator, make_simulator
 from sim_engine import (
     BrainPhase,
     DeviceClass,
     HostOS,
     Persona,
-    PortGremlinSimulator,
     SimEvent,
+    SimulationState,
 )
+from sim_worker import SPEEDS, SimWorker
 
 # Colors
 BG = "#0a0a0f"
@@ -50,21 +55,54 @@ HOST_COLORS = {
     HostOS.UNKNOWN: "#444444",
 }
 
+FRAME_MS = 33
+LOG_LINES_PER_FRAME = 200
+LOG_LINES_KEPT = 2000
+DEVICE_ROWS = 16
+PACKETS = 3
+PACKET_HZ = 3.0
+
 
 class PortGremlinVirtualLab(tk.Tk):
-    def __init__(self) -> None:
+    def __init__(self, engine: str = "auto", host_model: str | None = None,
+                 session: str | None = None, lane: str | None = None) -> None:
         super().__init__()
         self.title("PortGremlin Virtual Lab")
         self.configure(bg=BG)
         self.geometry("1280x820")
         self.minsize(1024, 700)
 
-        self.sim = PortGremlinSimulator(on_event=self._on_sim_event)
+        # Events arrive on the worker thread; the UI drains them each frame.
+        self._events: deque[SimEvent] = deque(maxlen=2000)
+        self.sim = make_simulator(on_event=self._events.append, engine=engine, host_model=host_model,
+                                  session=session, lane=lane)
+        self.worker = SimWorker(self.sim)
+        self._frame = self.worker.snapshot
         self._after_id: str | None = None
+        self._shown: dict[tk.Widget, dict[str, Any]] = {}
+        self._shown_revision = -1
+        self._shown_devices_revision = -1
+        self._device_rows: list[str] = []
+        self._scene: dict[str, int] = {}
+        self._item_shown: dict[int, dict[str, Any]] = {}
+        self._cable: tuple[float, float, float] | None = None
+        self.seek_scale: tk.Scale | None = None
+        self._seeking = False
 
         self._build_ui()
-        self._schedule_tick()
+        if isinstance(self.sim, SessionSimulator):
+            self.sim.log("sim", f"Replaying {session} lane {self.sim.lane or '-'}: "
+                                f"{self.sim.reader.count} records, {self.sim.duration:.1f} s")
+        elif isinstance(self.sim, FirmwareCoSimulator):
+            self.sim.log("sim", "Engine: firmware co-simulation (libportgremlin_host.so)")
+        else:
+            self.sim.log("sim", "Engine: Python model — build the firmware one with "
+                                "make -C usb_dev_keyboard host")
+        if host_model:
+            self.sim.log("sim", f"Host model: calibrated ({', '.join(sorted(self.sim.host_models))})")
         self.sim.log("sim", "Virtual Lab ready — select host OS and press Start")
+        self.worker.start()
+        self._schedule_frame()
 
     def _build_ui(self) -> None:
         header = tk.Frame(self, bg=BG, pady=8)
@@ -169,7 +207,8 @@ class PortGremlinVirtualLab(tk.Tk):
 
         self.canvas = tk.Canvas(center, bg="#080810", highlightthickness=0, height=380)
         self.canvas.pack(fill=tk.BOTH, expand=True)
-        self.canvas.bind("<Configure>", lambda _e: self._draw_scene())
+        self._build_scene()
+        self.canvas.bind("<Configure>", lambda _e: self._layout_scene())
 
         identity = self._panel(center, "CURRENT IDENTITY")
         identity.pack(fill=tk.X, pady=(6, 0))
@@ -223,7 +262,7 @@ class PortGremlinVirtualLab(tk.Tk):
                 mimic_btns,
                 text=str(i),
                 width=3,
-                command=lambda n=i: self.sim.deploy_mimic(n),
+                command=lambda n=i: self.worker.call(self.sim.deploy_mimic, n),
                 bg=BORDER,
                 fg=FG,
                 relief=tk.FLAT,
@@ -238,12 +277,12 @@ class PortGremlinVirtualLab(tk.Tk):
             ("▶ Start", self._start, GREEN),
             ("⏸ Pause", self._pause, ORANGE),
             ("↺ Reset", self._reset, MUTED),
-            ("⚡ Overdrive", self.sim.overdrive, RED),
-            ("🧠 Brain", self.sim.toggle_brain, PURPLE),
-            ("🧬 Evolve", self.sim.toggle_evolve, CYAN),
-            ("🎭 Persona", self.sim.next_persona, ORANGE),
-            ("👻 Confusion", self.sim.toggle_contradiction, PURPLE),
-            ("↻ Enum", self.sim.enumerate, FG),
+            ("⚡ Overdrive", self._cmd(self.sim.overdrive), RED),
+            ("🧠 Brain", self._cmd(self.sim.toggle_brain), PURPLE),
+            ("🧬 Evolve", self._cmd(self.sim.toggle_evolve), CYAN),
+            ("🎭 Persona", self._cmd(self.sim.next_persona), ORANGE),
+            ("👻 Confusion", self._cmd(self.sim.toggle_contradiction), PURPLE),
+            ("↻ Enum", self._cmd(self.sim.enumerate), FG),
         ]
         for text, cmd, color in buttons:
             tk.Button(
@@ -260,6 +299,46 @@ class PortGremlinVirtualLab(tk.Tk):
                 activeforeground=color,
             ).pack(side=tk.LEFT, padx=3)
 
+        self.rate_label = tk.Label(bar, text="", fg=MUTED, bg=PANEL, font=("Courier", 9))
+        self.rate_label.pack(side=tk.RIGHT, padx=(3, 8))
+        self.speed_var = tk.StringVar(value=next(iter(SPEEDS)))
+        for label in reversed(SPEEDS):
+            tk.Radiobutton(
+                bar,
+                text=label,
+                variable=self.speed_var,
+                value=label,
+                command=lambda: self.worker.set_speed(SPEEDS[self.speed_var.get()]),
+                bg=PANEL,
+                fg=FG,
+                selectcolor=PANEL,
+                activebackground=PANEL,
+                activeforeground=CYAN,
+                font=("Helvetica", 9),
+            ).pack(side=tk.RIGHT)
+        tk.Label(bar, text="Speed:", fg=MUTED, bg=PANEL, font=("Helvetica", 9)).pack(side=tk.RIGHT, padx=(0, 2))
+
+        if isinstance(self.sim, SessionSimulator):
+            seek = tk.Frame(self, bg=PANEL)
+            seek.pack(fill=tk.X, padx=12)
+            tk.Label(seek, text="Recording:", fg=MUTED, bg=PANEL, font=("Helvetica", 9)).pack(side=tk.LEFT, padx=(8, 4))
+            self.seek_scale = tk.Scale(
+                seek,
+                from_=0.0,
+                to=max(self.sim.duration, 1.0),
+                resolution=0.1,
+                orient=tk.HORIZONTAL,
+                showvalue=False,
+                bg=PANEL,
+                fg=FG,
+                troughcolor=BORDER,
+                highlightthickness=0,
+                sliderrelief=tk.FLAT,
+            )
+            self.seek_scale.pack(side=tk.LEFT, fill=tk.X, expand=True, padx=(0, 8))
+            self.seek_scale.bind("<ButtonPress-1>", lambda _e: setattr(self, "_seeking", True))
+            self.seek_scale.bind("<ButtonRelease-1>", lambda _e: self._seek())
+
     def _build_log(self) -> None:
         log_frame = tk.Frame(self, bg=BG)
         log_frame.pack(fill=tk.BOTH, expand=True, padx=12, pady=(0, 10))
@@ -280,157 +359,278 @@ class PortGremlinVirtualLab(tk.Tk):
         self.log_text.tag_config("warn", foreground=ORANGE)
         self.log_text.tag_config("info", foreground=FG)
 
+    def _cmd(self, fn: Callable[..., Any], *args: Any) -> Callable[[], None]:
+        return lambda: self.worker.call(fn, *args)
+
     def _on_host_change(self) -> None:
         for os in HostOS:
             if os.value == self.host_os_var.get():
-                self.sim.set_host_os(os)
+                self.worker.call(self.sim.set_host_os, os)
                 break
 
-    def _on_sim_event(self, ev: SimEvent) -> None:
-        tag = ev.level if ev.level in ("error", "warn") else "info"
-        line = f"[{ev.source:6}] {ev.message}\n"
-        self.log_text.insert(tk.END, line, tag)
+    def _drain_events(self) -> None:
+        if not self._events:
+            return
+        # At max speed the engine can log far faster than a Text widget can
+        # take it; show only the newest lines of each frame.
+        batch = []
+        while self._events:
+            batch.append(self._events.popleft())
+        skipped = max(0, len(batch) - LOG_LINES_PER_FRAME)
+        if skipped:
+            self.log_text.insert(tk.END, f"[sim   ] ... {skipped} events\n", "warn")
+        for ev in batch[skipped:]:
+            tag = ev.level if ev.level in ("error", "warn") else "info"
+            self.log_text.insert(tk.END, f"[{ev.source:6}] {ev.message}\n", tag)
+        self.log_text.delete("1.0", f"end-{LOG_LINES_KEPT}l")
         self.log_text.see(tk.END)
 
     def _start(self) -> None:
-        self.sim.state.auto_cycle = True
-        self.sim.start()
+        self.worker.call(self.sim.start)
+        self.worker.call(self.sim.set_auto_cycle, True)
 
     def _pause(self) -> None:
-        self.sim.stop()
+        self.worker.call(self.sim.stop)
 
     def _reset(self) -> None:
-        self.sim.stop()
-        self.sim.reset()
+        self.worker.call(self.sim.stop)
+        self.worker.call(self.sim.reset)
         self.log_text.delete("1.0", tk.END)
 
-    def _schedule_tick(self) -> None:
-        self.sim.tick(0.05)
+    def _seek(self) -> None:
+        assert self.seek_scale is not None
+        self._seeking = False
+        self.worker.call(self.sim.seek, float(self.seek_scale.get()))
+
+    def _schedule_frame(self) -> None:
+        self._frame = self.worker.snapshot
+        self._drain_events()
         self._refresh_ui()
-        self._after_id = self.after(50, self._schedule_tick)
+        self._after_id = self.after(FRAME_MS, self._schedule_frame)
 
     def _refresh_ui(self) -> None:
-        st = self.sim.state
-
-        self.host_os_label.config(text=f"Detected: {st.host_os.value}", fg=HOST_COLORS.get(st.host_os, FG))
-        self.metric_labels["Pain"].config(text=f"{st.pain_score:.1f}", fg=RED if st.pain_score > 30 else FG)
-        self.metric_labels["Tolerance"].config(text=str(st.tolerance))
-        self.metric_labels["Errors"].config(text=str(st.host_errors))
-        self.metric_labels["Disconnects"].config(text=str(st.disconnects))
-        self.metric_labels["Enums"].config(text=str(st.enum_count))
-        self.pain_bar["value"] = st.pain_score
+        snap = self._frame
+        st = snap.state
+        rate = f"{snap.rate:.0f}×" if snap.rate >= 10 else f"{snap.rate:.1f}×"
+        self._set(self.rate_label, text=f"t={snap.virtual_time:9.1f}s  {rate if st.running else 'paused'}")
+        if self.seek_scale is not None and not self._seeking:
+            position = round(snap.virtual_time, 1)
+            if self._shown.get(self.seek_scale) != position:
+                self._shown[self.seek_scale] = position
+                self.seek_scale.set(position)
+
+        if st.revision != self._shown_revision:
+            self._shown_revision = st.revision
+            self._refresh_panels(st)
+        if st.devices_revision != self._shown_devices_revision:
+            self._shown_devices_revision = st.devices_revision
+            self._refresh_devices(st)
+        self._update_scene(st)
+
+    def _set(self, widget: tk.Widget, **kw: Any) -> None:
+        """widget.config(**kw), skipped when it already shows exactly that."""
+        if self._shown.get(widget) != kw:
+            self._shown[widget] = kw
+            widget.config(**kw)
+
+    def _refresh_panels(self, st: SimulationState) -> None:
+        self._set(self.host_os_label, text=f"Detected: {st.host_os.value}", fg=HOST_COLORS.get(st.host_os, FG))
+        self._set(self.metric_labels["Pain"], text=f"{st.pain_score:.1f}", fg=RED if st.pain_score > 30 else FG)
+        self._set(self.metric_labels["Tolerance"], text=str(st.tolerance))
+        self._set(self.metric_labels["Errors"], text=str(st.host_errors))
+        self._set(self.metric_labels["Disconnects"], text=str(st.disconnects))
+        self._set(self.metric_labels["Enums"], text=str(st.enum_count))
+        if self.pain_bar["value"] != st.pain_score:
+            self.pain_bar["value"] = st.pain_score
 
         color = PERSONA_COLORS.get(st.persona, FG)
-        self.persona_label.config(text=f"Persona: {st.persona.value}", fg=color)
-        self.brain_label.config(
+        self._set(self.persona_label, text=f"Persona: {st.persona.value}", fg=color)
+        self._set(
+            self.brain_label,
             text=f"Brain: {'ACTIVE — ' + st.brain_phase.value if st.brain_active else 'off'}",
             fg=PURPLE if st.brain_active else MUTED,
         )
-        self.evolve_label.config(
+        self._set(
+            self.evolve_label,
             text=f"Evolve: {'ACTIVE' if st.evolve_active else 'off'}",
             fg=CYAN if st.evolve_active else MUTED,
         )
         g = st.genome
-        self.genome_label.config(
-            text=f"gen={g.generation} fit={g.fitness} int={g.interval}ms mal={g.malformed}"
-        )
+        self._set(self.genome_label, text=f"gen={g.generation} fit={g.fitness} int={g.interval}ms mal={g.malformed}")
 
-        self.flag_labels["Auto cycle"].config(text="ON" if st.auto_cycle else "OFF", fg=GREEN if st.auto_cycle else MUTED)
-        self.flag_labels["Malformed"].config(text="ON" if st.malformed else "OFF", fg=RED if st.malformed else MUTED)
-        self.flag_labels["Contradiction"].config(
+        self._set(self.flag_labels["Auto cycle"], text="ON" if st.auto_cycle else "OFF", fg=GREEN if st.auto_cycle else MUTED)
+        self._set(self.flag_labels["Malformed"], text="ON" if st.malformed else "OFF", fg=RED if st.malformed else MUTED)
+        self._set(
+            self.flag_labels["Contradiction"],
             text=f"ON {st.pinned_vid:04X}:{st.pinned_pid:04X}" if st.contradiction else "OFF",
             fg=PURPLE if st.contradiction else MUTED,
         )
-        self.flag_labels["Interval"].config(text=f"{g.interval * 10}ms")
+        self._set(self.flag_labels["Interval"], text=f"{g.interval * 10}ms")
 
-        self.identity_label.config(
+        self._set(
+            self.identity_label,
             text=(
                 f"Class:  {st.device_class.value}\n"
                 f"VID:PID {st.vid:04X}:{st.pid:04X}\n"
                 f"Mfg:    {st.manufacturer}\n"
                 f"Product:{st.product}\n"
                 f"Cfg:    {st.config_latency_ms}ms  Resets: {st.reset_count}"
-            )
+            ),
         )
 
-        self.device_list.delete(0, tk.END)
-        for dev in st.host_devices[:16]:
+    def _refresh_devices(self, st: SimulationState) -> None:
+        rows = []
+        for dev in st.host_devices[:DEVICE_ROWS]:
             pin = "⚡" if dev.pinned else " "
-            self.device_list.insert(
-                tk.END,
-                f"{pin}{dev.vid:04X}:{dev.pid:04X} {dev.device_class.value[:4]} {dev.label[:18]}",
-            )
-
-        self._draw_scene()
-
-    def _draw_scene(self) -> None:
+            rows.append(f"{pin}{dev.vid:04X}:{dev.pid:04X} {dev.device_class.value[:4]} {dev.label[:18]}")
+        old = self._device_rows
+        if rows and len(rows) == min(len(old) + 1, DEVICE_ROWS) and rows[1:] == old[:len(rows) - 1]:
+            # The usual case: one new device at the top pushing the rest down.
+            if len(old) == DEVICE_ROWS:
+                self.device_list.delete(tk.END)
+            self.device_list.insert(0, rows[0])
+        else:
+            for i, row in enumerate(rows):
+                if i >= len(old):
+                    self.device_list.insert(tk.END, row)
+                elif old[i] != row:
+                    self.device_list.delete(i)
+                    self.device_list.insert(i, row)
+            if len(old) > len(rows):
+                self.device_list.delete(len(rows), tk.END)
+        self._device_rows = rows
+
+    def _build_scene(self) -> None:
+        """Create every canvas item once; frames only move and recolor them."""
+        c = self.canvas
+        items = self._scene
+        items["host_box"] = c.create_rectangle(0, 0, 0, 0, outline=BORDER, width=2)
+        items["host_title"] = c.create_text(0, 0, text="HOST", fill="white", font=("Helvetica", 11, "bold"))
+        items["host_os"] = c.create_text(0, 0, fill="white", font=("Helvetica", 9))
+        items["host_pain"] = c.create_text(0, 0, font=("Helvetica", 9))
+        items["host_cached"] = c.create_text(0, 0, fill="#ccc", font=("Helvetica", 8))
+        items["dev_box"] = c.create_rectangle(0, 0, 0, 0, fill="#1a2a1a", outline=GREEN, width=2)
+        items["dev_title"] = c.create_text(0, 0, text="LaunchPad", fill=GREEN, font=("Helvetica", 10, "bold"))
+        items["dev_chip"] = c.create_text(0, 0, text="TM4C123", fill="#aaa", font=("Helvetica", 8))
+        items["dev_persona"] = c.create_text(0, 0, font=("Helvetica", 9, "bold"))
+        items["dev_class"] = c.create_text(0, 0, fill=FG, font=("Helvetica", 8))
+        items["cable_bg"] = c.create_line(0, 0, 0, 0, fill="#333", width=6)
+        items["cable"] = c.create_line(0, 0, 0, 0, width=2)
+        for i in range(PACKETS):
+            items[f"packet{i}"] = c.create_oval(0, 0, 0, 0, outline="", state=tk.HIDDEN)
+        items["flash"] = c.create_oval(0, 0, 0, 0, outline=RED, width=2, state=tk.HIDDEN)
+        items["flash_text"] = c.create_text(0, 0, text="NEW", fill=RED, font=("Helvetica", 8, "bold"), state=tk.HIDDEN)
+        items["flash_id"] = c.create_text(0, 0, fill=RED, font=("Courier", 9, "bold"), state=tk.HIDDEN)
+        items["malformed"] = c.create_text(0, 0, text="⚠ MALFORMED DESCRIPTORS", fill=RED,
+                                           font=("Helvetica", 10, "bold"), state=tk.HIDDEN)
+        items["confusion"] = c.create_text(0, 0, text="⚡ DRIVER CONFUSION ACTIVE", fill=PURPLE,
+                                           font=("Helvetica", 9, "bold"), state=tk.HIDDEN)
+        items["brain"] = c.create_text(0, 0, fill=PURPLE, font=("Helvetica", 9, "bold"), state=tk.HIDDEN)
+
+    def _layout_scene(self) -> None:
         c = self.canvas
-        c.delete("all")
         w = c.winfo_width()
         h = c.winfo_height()
         if w < 10:
             return
-
-        st = self.sim.state
         host_x, host_y = w * 0.18, h * 0.5
         dev_x, dev_y = w * 0.82, h * 0.5
-
-        host_color = HOST_COLORS.get(st.host_os, "#333")
-        c.create_rectangle(host_x - 90, host_y - 70, host_x + 90, host_y + 70, fill=host_color, outline=BORDER, width=2)
-        c.create_text(host_x, host_y - 50, text="HOST", fill="white", font=("Helvetica", 11, "bold"))
-        c.create_text(host_x, host_y - 30, text=st.host_os.value, fill="white", font=("Helvetica", 9))
-        c.create_text(host_x, host_y, text=f"Pain {st.pain_score:.0f}", fill=RED if st.pain_score > 20 else "white", font=("Helvetica", 9))
-        c.create_text(host_x, host_y + 20, text=f"{len(st.host_devices)} cached", fill="#ccc", font=("Helvetica", 8))
-
-        c.create_rectangle(dev_x - 70, dev_y - 55, dev_x + 70, dev_y + 55, fill="#1a2a1a", outline=GREEN, width=2)
-        c.create_text(dev_x, dev_y - 35, text="LaunchPad", fill=GREEN, font=("Helvetica", 10, "bold"))
-        c.create_text(dev_x, dev_y - 15, text="TM4C123", fill="#aaa", font=("Helvetica", 8))
-        c.create_text(dev_x, dev_y + 5, text=st.persona.value, fill=PERSONA_COLORS.get(st.persona, FG), font=("Helvetica", 9, "bold"))
-        c.create_text(dev_x, dev_y + 25, text=st.device_class.value[:8], fill=FG, font=("Helvetica", 8))
-
-        cable_y = host_y
-        c.create_line(host_x + 90, cable_y, dev_x - 70, cable_y, fill="#333", width=6)
-        c.create_line(host_x + 90, cable_y, dev_x - 70, cable_y, fill=CYAN if st.running else "#222", width=2)
-
+        positions = {
+            "host_box": (host_x - 90, host_y - 70, host_x + 90, host_y + 70),
+            "host_title": (host_x, host_y - 50),
+            "host_os": (host_x, host_y - 30),
+            "host_pain": (host_x, host_y),
+            "host_cached": (host_x, host_y + 20),
+            "dev_box": (dev_x - 70, dev_y - 55, dev_x + 70, dev_y + 55),
+            "dev_title": (dev_x, dev_y - 35),
+            "dev_chip": (dev_x, dev_y - 15),
+            "dev_persona": (dev_x, dev_y + 5),
+            "dev_class": (dev_x, dev_y + 25),
+            "cable_bg": (host_x + 90, host_y, dev_x - 70, host_y),
+            "cable": (host_x + 90, host_y, dev_x - 70, host_y),
+            "flash": (host_x - 20, host_y - 90, host_x + 20, host_y - 60),
+            "flash_text": (host_x, host_y - 75),
+            "flash_id": (host_x, host_y + 50),
+            "malformed": (w / 2, 20),
+            "confusion": (w / 2, 38),
+            "brain": (w / 2, h - 20),
+        }
+        for name, xy in positions.items():
+            c.coords(self._scene[name], *xy)
+        self._cable = (host_x + 90, dev_x - 70, host_y)
+        self._update_scene(self._frame.state)
+
+    def _item(self, name: str, **kw: Any) -> None:
+        """itemconfig on a scene item, skipped when nothing would change."""
+        item = self._scene[name]
+        if self._item_shown.get(item) != kw:
+            self._item_shown[item] = kw
+            self.canvas.itemconfig(item, **kw)
+
+    def _update_scene(self, st: SimulationState) -> None:
+        if self._cable is None:
+            return
+        self._item("host_box", fill=HOST_COLORS.get(st.host_os, "#333"))
+        self._item("host_os", text=st.host_os.value)
+        self._item("host_pain", text=f"Pain {st.pain_score:.0f}", fill=RED if st.pain_score > 20 else "white")
+        self._item("host_cached", text=f"{len(st.host_devices)} cached")
+        persona_color = PERSONA_COLORS.get(st.persona, FG)
+        self._item("dev_persona", text=st.persona.value, fill=persona_color)
+        self._item("dev_class", text=st.device_class.value[:8])
+        self._item("cable", fill=CYAN if st.running else "#222")
+
+        x0, x1, y = self._cable
         if st.running:
-            phase = st.packet_phase
-            for i in range(3):
+            # Packets animate on the wall clock so they look the same at any sim speed.
+            phase = (time.monotonic() * PACKET_HZ) % 1.0
+            for i in range(PACKETS):
                 t = (phase + i * 0.33) % 1.0
-                px = (host_x + 90) + t * (dev_x - 70 - host_x - 90)
-                persona_color = PERSONA_COLORS.get(st.persona, CYAN)
-                c.create_oval(px - 5, cable_y - 5, px + 5, cable_y + 5, fill=persona_color, outline="")
+                px = x0 + t * (x1 - x0)
+                self.canvas.coords(self._scene[f"packet{i}"], px - 5, y - 5, px + 5, y + 5)
+                self._item(f"packet{i}", fill=PERSONA_COLORS.get(st.persona, CYAN), state=tk.NORMAL)
+        else:
+            for i in range(PACKETS):
+                self._item(f"packet{i}", state=tk.HIDDEN)
 
         flash_age = time.time() - st.last_enum_flash if st.last_enum_flash else 999
         if flash_age < 0.4:
-            alpha = 1.0 - flash_age / 0.4
-            glow = int(255 * alpha)
-            color = f"#{glow:02x}{glow//2:02x}44"
-            c.create_oval(host_x - 20, host_y - 90, host_x + 20, host_y - 60, fill=color, outline=RED, width=2)
-            c.create_text(host_x, host_y - 75, text="NEW", fill=RED, font=("Helvetica", 8, "bold"))
-            c.create_text(
-                host_x,
-                host_y + 50,
-                text=f"{st.vid:04X}:{st.pid:04X}",
-                fill=RED,
-                font=("Courier", 9, "bold"),
-            )
-
-        if st.malformed:
-            c.create_text(w / 2, 20, text="⚠ MALFORMED DESCRIPTORS", fill=RED, font=("Helvetica", 10, "bold"))
-        if st.contradiction:
-            c.create_text(w / 2, 38, text="⚡ DRIVER CONFUSION ACTIVE", fill=PURPLE, font=("Helvetica", 9, "bold"))
+            glow = int(255 * (1.0 - flash_age / 0.4))
+            self._item("flash", fill=f"#{glow:02x}{glow//2:02x}44", state=tk.NORMAL)
+            self._item("flash_text", state=tk.NORMAL)
+            self._item("flash_id", text=f"{st.vid:04X}:{st.pid:04X}", state=tk.NORMAL)
+        else:
+            for name in ("flash", "flash_text", "flash_id"):
+                self._item(name, state=tk.HIDDEN)
+
+        self._item("malformed", state=tk.NORMAL if st.malformed else tk.HIDDEN)
+        self._item("confusion", state=tk.NORMAL if st.contradiction else tk.HIDDEN)
         if st.brain_active:
-            c.create_text(w / 2, h - 20, text=f"BRAIN: {st.brain_phase.value.upper()}", fill=PURPLE, font=("Helvetica", 9, "bold"))
+            self._item("brain", text=f"BRAIN: {st.brain_phase.value.upper()}", state=tk.NORMAL)
+        else:
+            self._item("brain", state=tk.HIDDEN)
 
     def on_close(self) -> None:
         if self._after_id:
             self.after_cancel(self._after_id)
+        self.worker.stop()
         self.destroy()
 
 
 def main() -> int:
+    parser = argparse.ArgumentParser(description="PortGremlin Virtual Lab")
+    parser.add_argument("--engine", choices=["auto", "firmware", "python"], default="auto",
+                        help="device logic: firmware host build (default when built) or Python model")
+    parser.add_argument("--host-model", metavar="JSON",
+                        help="calibrated host models from portgremlin-calibrate.py")
+    parser.add_argument("--replay", metavar="SESSION",
+                        help="play back a session recorded with --record instead of simulating")
+    parser.add_argument("--lane", help="lane of --replay to show (default: the first)")
+    args = parser.parse_args()
     try:
-        app = PortGremlinVirtualLab()
+        app = PortGremlinVirtualLab(args.engine, args.host_model, args.replay, args.lane)
+    except (OSError, ValueError) as exc:
+        print(f"Cannot replay {args.replay}: {exc}", file=sys.stderr)
+        return 1
     except tk.TclError as exc:
         print(f"GUI unavailable: {exc}", file=sys.stderr)
         print("Install tkinter: sudo apt install python3-tk", file=sys.stderr)
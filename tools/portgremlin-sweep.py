@@ -0,0 +1,486 @@
+#!/usr/bin/env python3
+"""
+PortGremlin Sweep — tune Brain thresholds, persona intervals and
+choreography dwell times against a host model.
+
+Thousands of parameter sets (Latin hypercube, optionally refined by a
+Gaussian-process Bayesian optimizer) are evaluated as numpy arrays, one
+lane per (parameter set, replicate), split across all cores. Each lane
+runs one scenario from boot for --hours of wall time:
+
+  brain     Gremlin Brain: PROBE/Phantom -> ESCALATE/Storm -> CORRUPT/Chimera
+            -> CHAOS/Haunted, phases keyed on cumulative enumerations
+  redteam, stealth, blitz
+            the choreography scripts, steps keyed on dwell ticks
+
+Rather than stepping ticks, a lane jumps a whole segment at a time: inside
+one persona the host's per-enumeration error rate and rejection probability
+are constant, so the enumerations until the next rejection are geometric and
+the kernel errors over a run of them are Poisson. Every enumeration costs its
+interval plus --hold seconds (ReenumerateWithRandomVIDPID keeps D+ low for
+about 1 s inside the SysTick ISR), and every rejection --lockout seconds
+before the host talks to the port again. As on the device, a rejection
+de-escalates the Brain only until its next tick (StableEnums is cumulative)
+and ends the current choreography step.
+
+The host model is a portgremlin-calibrate.py fit (--host-model) or the
+simulator's built-in heuristics. --emit writes the winning values into
+usb_dev_keyboard/portgremlin_tuning.h.
+
+    python3 tools/portgremlin-sweep.py brain --host linux --samples 4000 --bayes 8
+    python3 tools/portgremlin-sweep.py blitz --no-intervals --emit usb_dev_keyboard/portgremlin_tuning.h
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import math
+import os
+import re
+import sys
+import time
+from dataclasses import dataclass
+from multiprocessing import Pool
+from typing import Optional
+
+try:
+    import numpy as np
+except ImportError:
+    print("Run ./setup.sh first to install dependencies.", file=sys.stderr)
+    sys.exit(1)
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from host_model import FAST_INTERVAL_TICKS, HostModel, feature_key, load_models
+from sim_engine import CYCLE_INTERVAL_MAX, CYCLE_INTERVAL_MIN, TICK_S, HostOS, builtin_host_model
+
+TUNING_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..",
+                             "usb_dev_keyboard", "portgremlin_tuning.h")
+
+# (malformed, contradiction) per persona, as set by PortGremlinPersonaApply().
+PERSONA_FLAGS = {
+    "PHANTOM": (False, False),
+    "MIMIC": (False, False),
+    "STORM": (False, False),
+    "CHIMERA": (True, False),
+    "HAUNTED": (True, True),
+}
+BRAIN_STAGES = [("PHANTOM", "PORTGREMLIN_PHANTOM_INTERVAL"),
+                ("STORM", "PORTGREMLIN_STORM_INTERVAL"),
+                ("CHIMERA", "PORTGREMLIN_CHIMERA_INTERVAL"),
+                ("HAUNTED", "PORTGREMLIN_BRAIN_CHAOS_INTERVAL")]
+CHOREO_SCRIPTS = {
+    "redteam": ("REDTEAM", ["PHANTOM", "MIMIC", "STORM", "CHIMERA", "HAUNTED"]),
+    "stealth": ("STEALTH", ["MIMIC", "PHANTOM", "MIMIC"]),
+    "blitz": ("BLITZ", ["STORM", "HAUNTED", "CHIMERA"]),
+}
+DWELL_MAX = 1000
+THRESHOLD_MAX = 400
+NEVER = np.iinfo(np.int64).max // 4
+
+HEADER_DEFINE_RE = re.compile(r"^#define\s+(PORTGREMLIN_\w+)\s+(\d+)", re.MULTILINE)
+
+
+@dataclass(frozen=True)
+class Dim:
+    """One searched dimension: a tuning macro, or a Brain threshold gap."""
+
+    name: str
+    lo: int
+    hi: int
+
+
+def read_tuning(path: str) -> dict[str, int]:
+    with open(path, encoding="utf-8") as f:
+        return {m.group(1): int(m.group(2)) for m in HEADER_DEFINE_RE.finditer(f.read())}
+
+
+def interval_macro(persona: str) -> str:
+    return f"PORTGREMLIN_{persona}_INTERVAL"
+
+
+class Scenario:
+    """Maps a parameter matrix onto per-lane stage tables."""
+
+    def __init__(self, name: str, base: dict[str, int], tune_intervals: bool) -> None:
+        self.name = name
+        self.base = base
+        if name == "brain":
+            self.personas = [p for p, _ in BRAIN_STAGES]
+            self.interval_macros = [m for _, m in BRAIN_STAGES]
+            dims = [Dim("PORTGREMLIN_BRAIN_ESCALATE_ENUMS", 1, THRESHOLD_MAX),
+                    Dim("corrupt_gap", 1, THRESHOLD_MAX),
+                    Dim("chaos_gap", 1, THRESHOLD_MAX)]
+        else:
+            tag, self.personas = CHOREO_SCRIPTS[name]
+            self.interval_macros = [interval_macro(p) for p in self.personas]
+            dims = [Dim(f"PORTGREMLIN_{tag}_DWELL_{i}", 1, DWELL_MAX) for i in range(len(self.personas))]
+        if tune_intervals:
+            for macro in dict.fromkeys(self.interval_macros):
+                dims.append(Dim(macro, CYCLE_INTERVAL_MIN, CYCLE_INTERVAL_MAX))
+        self.dims = dims
+
+    def default_row(self) -> np.ndarray:
+        b = self.base
+        row = []
+        for d in self.dims:
+            if d.name == "corrupt_gap":
+                row.append(b["PORTGREMLIN_BRAIN_CORRUPT_ENUMS"] - b["PORTGREMLIN_BRAIN_ESCALATE_ENUMS"])
+            elif d.name == "chaos_gap":
+                row.append(b["PORTGREMLIN_BRAIN_CHAOS_ENUMS"] - b["PORTGREMLIN_BRAIN_CORRUPT_ENUMS"])
+            else:
+                row.append(b[d.name])
+        return np.array(row, dtype=np.int64)
+
+    def values(self, row: np.ndarray) -> dict[str, int]:
+        """Header macros for one parameter row."""
+        out = {d.name: int(v) for d, v in zip(self.dims, row)}
+        if self.name == "brain":
+            esc = out["PORTGREMLIN_BRAIN_ESCALATE_ENUMS"]
+            out["PORTGREMLIN_BRAIN_CORRUPT_ENUMS"] = esc + out.pop("corrupt_gap")
+            out["PORTGREMLIN_BRAIN_CHAOS_ENUMS"] = out["PORTGREMLIN_BRAIN_CORRUPT_ENUMS"] + out.pop("chaos_gap")
+        return out
+
+    def column(self, rows: np.ndarray, macro: str) -> np.ndarray:
+        for i, d in enumerate(self.dims):
+            if d.name == macro:
+                return rows[:, i]
+        return np.full(len(rows), self.base[macro], dtype=np.int64)
+
+    def tables(self, rows: np.ndarray) -> tuple[np.ndarray, np.ndarray, bool]:
+        """(interval[set, stage], stage_end[set, stage], ends_by_enum_count)."""
+        interval = np.stack([self.column(rows, m) for m in self.interval_macros], axis=1)
+        if self.name == "brain":
+            esc = self.column(rows, "PORTGREMLIN_BRAIN_ESCALATE_ENUMS")
+            corrupt = esc + self.column(rows, "corrupt_gap")
+            chaos = corrupt + self.column(rows, "chaos_gap")
+            end = np.stack([esc, corrupt, chaos, np.full_like(esc, NEVER)], axis=1)
+            return interval, end, True
+        tag = CHOREO_SCRIPTS[self.name][0]
+        dwell = np.stack([self.column(rows, f"PORTGREMLIN_{tag}_DWELL_{i}")
+                          for i in range(len(self.personas))], axis=1)
+        # After the last step the script ends and its persona stays in force.
+        interval = np.concatenate([interval, interval[:, -1:]], axis=1)
+        dwell = np.concatenate([dwell, np.full((len(rows), 1), NEVER)], axis=1)
+        return interval, dwell, False
+
+
+@dataclass
+class HostRates:
+    """Per-enumeration kernel-error rate and rejection probability by feature key."""
+
+    errors: dict[str, float]
+    rejects: dict[str, float]
+
+    @classmethod
+    def from_model(cls, model: HostModel) -> HostRates:
+        keys = [feature_key(m, c, f) for m in (False, True) for c in (False, True) for f in (False, True)]
+        return cls({k: model.error_rate.get(k, model.error_rate.get("*", 0.0)) for k in keys},
+                   {k: model.disconnect_p.get(k, model.disconnect_p.get("*", 0.0)) for k in keys})
+
+    def lookup(self, personas: list[str], interval: np.ndarray) -> tuple[np.ndarray, np.ndarray]:
+        lam = np.zeros(interval.shape)
+        rej = np.zeros(interval.shape)
+        for s in range(interval.shape[1]):
+            mal, con = PERSONA_FLAGS[personas[min(s, len(personas) - 1)]]
+            for fast in (False, True):
+                sel = (interval[:, s] <= FAST_INTERVAL_TICKS) == fast
+                key = feature_key(mal, con, fast)
+                lam[sel, s] = self.errors[key]
+                rej[sel, s] = self.rejects[key]
+        return lam, rej
+
+
+def simulate(args: tuple) -> np.ndarray:
+    """Evaluate parameter rows; returns [enums/h, errors/h, rejections/h] per row."""
+    scenario, rates, rows, reps, hours, hold_s, lockout_s, seed = args
+    rng = np.random.default_rng(seed)
+    interval, end, by_count = scenario.tables(rows)
+    lam, rej = rates.lookup(scenario.personas, interval)
+    n_sets, n_stages = interval.shape
+    lane_set = np.repeat(np.arange(n_sets), reps)
+    lanes = len(lane_set)
+    horizon = hours * 3600.0
+
+    stage = np.zeros(lanes, dtype=np.int64)
+    stage_start = np.zeros(lanes, dtype=np.int64)
+    last = np.zeros(lanes, dtype=np.int64)
+    enums = np.zeros(lanes, dtype=np.int64)
+    errors = np.zeros(lanes, dtype=np.int64)
+    drops = np.zeros(lanes, dtype=np.int64)
+    active = np.ones(lanes, dtype=bool)
+
+    while active.any():
+        idx = np.flatnonzero(active)
+        s = np.minimum(stage[idx], n_stages - 1)
+        row = lane_set[idx]
+        iv = interval[row, s]
+        p = rej[row, s]
+
+        wall = last[idx] * TICK_S + enums[idx] * hold_s + drops[idx] * lockout_s
+        cap_h = np.floor(np.maximum(horizon - wall, 0.0) / (iv * TICK_S + hold_s)).astype(np.int64)
+        if by_count:
+            cap_s = np.maximum(end[row, s] - enums[idx], 0)
+        else:
+            stage_end = np.minimum(stage_start[idx] + end[row, s], NEVER)
+            cap_s = np.maximum((stage_end - last[idx]) // iv, 0)
+        k_cap = np.minimum(cap_h, cap_s)
+        k_rej = np.where(p > 0.0, rng.geometric(np.clip(p, 1e-12, 1.0)), NEVER)
+        k = np.minimum(k_cap, k_rej)
+
+        enums[idx] += k
+        last[idx] += k * iv
+        errors[idx] += rng.poisson(lam[row, s] * k)
+
+        rejected = k_rej <= k_cap
+        finished = ~rejected & (cap_h <= cap_s)
+        advance = ~rejected & ~finished
+        drops[idx[rejected]] += 1
+        if not by_count:
+            # A rejection leaves the main loop unpaced and ends the step at once.
+            stage_start[idx[rejected]] = last[idx[rejected]]
+            stage[idx[rejected]] += 1
+            stage_start[idx[advance]] = stage_end[advance]
+            last[idx[advance]] = stage_end[advance]
+        stage[idx[advance]] += 1
+        active[idx[finished]] = False
+
+    out = np.zeros((n_sets, 3))
+    for col, arr in enumerate((enums, errors, drops)):
+        out[:, col] = np.bincount(lane_set, weights=arr, minlength=n_sets) / (reps * hours)
+    return out
+
+
+def latin_hypercube(dims: list[Dim], n: int, rng: np.random.Generator) -> np.ndarray:
+    cols = []
+    for d in dims:
+        u = (rng.permutation(n) + rng.random(n)) / n
+        cols.append(np.rint(d.lo + u * (d.hi - d.lo)).astype(np.int64))
+    return np.stack(cols, axis=1)
+
+
+def evaluate(scenario: Scenario, rates: HostRates, rows: np.ndarray, args: argparse.Namespace,
+             pool: Optional[Pool], seed: int) -> np.ndarray:
+    chunks = np.array_split(rows, max(1, min(len(rows), args.jobs * 4)))
+    jobs = [(scenario, rates, c, args.reps, args.hours, args.hold, args.lockout, seed + i)
+            for i, c in enumerate(chunks) if len(c)]
+    parts = pool.map(simulate, jobs) if pool else [simulate(j) for j in jobs]
+    return np.concatenate(parts)
+
+
+def _erf(x: np.ndarray) -> np.ndarray:
+    return np.vectorize(math.erf)(x)
+
+
+def gp_suggest(dims: list[Dim], X: np.ndarray, y: np.ndarray, q: int,
+               rng: np.random.Generator, candidates: int = 4096) -> np.ndarray:
+    """Pick q new rows by expected improvement under an RBF Gaussian process."""
+    lo = np.array([d.lo for d in dims], dtype=float)
+    span = np.array([max(1, d.hi - d.lo) for d in dims], dtype=float)
+    Xn = (X - lo) / span
+    if len(Xn) > 600:
+        order = np.argsort(y)
+        keep = np.concatenate([order[-300:], rng.choice(order[:-300], 300, replace=False)])
+        Xn, y = Xn[keep], y[keep]
+    mu_y, sd_y = y.mean(), y.std() or 1.0
+    yn = (y - mu_y) / sd_y
+
+    def kernel(a: np.ndarray, b: np.ndarray, ls: float) -> np.ndarray:
+        d2 = ((a[:, None, :] - b[None, :, :]) ** 2).sum(-1)
+        return np.exp(-0.5 * d2 / ls ** 2)
+
+    best = None
+    for ls in (0.05, 0.1, 0.2, 0.4, 0.8):
+        K = kernel(Xn, Xn, ls) + 0.05 * np.eye(len(Xn))
+        try:
+            L = np.linalg.cholesky(K)
+        except np.linalg.LinAlgError:
+            continue
+        alpha = np.linalg.solve(L.T, np.linalg.solve(L, yn))
+        lml = -0.5 * yn @ alpha - np.log(np.diag(L)).sum()
+        if best is None or lml > best[0]:
+            best = (lml, ls, L, alpha)
+    if best is None:
+        return latin_hypercube(dims, q, rng)
+    _, ls, L, alpha = best
+
+    top = Xn[np.argmax(yn)]
+    cand = np.concatenate([rng.random((candidates // 2, len(dims))),
+                           np.clip(top + rng.normal(0, 0.05, (candidates - candidates // 2, len(dims))), 0, 1)])
+    Ks = kernel(cand, Xn, ls)
+    mu = Ks @ alpha
+    v = np.linalg.solve(L, Ks.T)
+    sigma = np.sqrt(np.maximum(1.0 - (v ** 2).sum(0), 1e-12))
+    z = (mu - yn.max()) / sigma
+    ei = (mu - yn.max()) * 0.5 * (1 + _erf(z / math.sqrt(2))) + sigma * np.exp(-0.5 * z ** 2) / math.sqrt(2 * math.pi)
+
+    picked: list[np.ndarray] = []
+    for i in np.argsort(-ei):
+        if all(np.abs(cand[i] - p).max() > 0.02 for p in picked):
+            picked.append(cand[i])
+            if len(picked) == q:
+                break
+    return np.rint(lo + np.array(picked) * span).astype(np.int64)
+
+
+def print_surface(scenario: Scenario, rows: np.ndarray, metric: np.ndarray, label: str,
+                  xi: int, yi: int, bins: int = 8) -> None:
+    dx, dy = scenario.dims[xi], scenario.dims[yi]
+    ex = np.linspace(dx.lo, dx.hi + 1, bins + 1)
+    ey = np.linspace(dy.lo, dy.hi + 1, bins + 1)
+    bx = np.clip(np.digitize(rows[:, xi], ex) - 1, 0, bins - 1)
+    by = np.clip(np.digitize(rows[:, yi], ey) - 1, 0, bins - 1)
+    total = np.zeros((bins, bins))
+    count = np.zeros((bins, bins))
+    np.add.at(total, (by, bx), metric)
+    np.add.at(count, (by, bx), 1)
+    grid = np.divide(total, count, out=np.full_like(total, np.nan), where=count > 0)
+    print(f"\n{label} (mean per hour): rows {dy.name}, columns {dx.name}")
+    print(" " * 12 + "".join(f"{int(ex[i]):>9}" for i in range(bins)))
+    for r in range(bins):
+        cells = "".join("        -" if np.isnan(v) else f"{v:9.0f}" for v in grid[r])
+        print(f"{int(ey[r]):>10}  {cells}")
+
+
+def emit_header(path: str, values: dict[str, int], provenance: list[str]) -> None:
+    v = values
+    lines = [
+        "#ifndef PORTGREMLIN_TUNING_H",
+        "#define PORTGREMLIN_TUNING_H",
+        "",
+        "/*",
+        " * Brain thresholds, persona cycle intervals and choreography dwell times.",
+        " * Generated by tools/portgremlin-sweep.py --emit; re-run the sweep rather",
+        " * than editing by hand.",
+        " *",
+    ]
+    lines += [f" * {p}" if p else " *" for p in provenance]
+    lines += [" */", "", "/* Brain: cumulative enumerations before each phase. */"]
+    for macro in ("PORTGREMLIN_BRAIN_ESCALATE_ENUMS", "PORTGREMLIN_BRAIN_CORRUPT_ENUMS",
+                  "PORTGREMLIN_BRAIN_CHAOS_ENUMS", "PORTGREMLIN_BRAIN_CHAOS_INTERVAL"):
+        lines.append(f"#define {macro:<38}{v[macro]}")
+    lines += ["", "/* Persona cycle intervals, in SysTicks. */"]
+    for persona in ("CHIMERA", "MIMIC", "STORM", "HAUNTED", "PHANTOM"):
+        lines.append(f"#define {interval_macro(persona):<38}{v[interval_macro(persona)]}")
+    lines += ["", "/* Choreography step dwell, in main-loop ticks. */"]
+    for tag, personas in CHOREO_SCRIPTS.values():
+        for i in range(len(personas)):
+            macro = f"PORTGREMLIN_{tag}_DWELL_{i}"
+            lines.append(f"#define {macro:<38}{v[macro]}")
+    lines += ["", "#endif", ""]
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines))
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Monte-Carlo sweep of PortGremlin tuning tables")
+    parser.add_argument("scenario", choices=["brain", *CHOREO_SCRIPTS])
+    parser.add_argument("--host", default="linux", choices=[h.name.lower() for h in HostOS])
+    parser.add_argument("--host-model", metavar="JSON", help="portgremlin-calibrate.py output")
+    parser.add_argument("--samples", type=int, default=2000, help="Latin-hypercube parameter sets")
+    parser.add_argument("--reps", type=int, default=16, help="replicates per parameter set")
+    parser.add_argument("--hours", type=float, default=1.0, help="simulated wall time per lane")
+    parser.add_argument("--hold", type=float, default=1.0, help="seconds each re-enumeration holds D+ low")
+    parser.add_argument("--lockout", type=float, default=1.0, help="seconds lost to each host rejection")
+    parser.add_argument("--objective", choices=["errors", "enums"], default="errors",
+                        help="maximize kernel errors/h (simulated findings) or enumerations/h")
+    parser.add_argument("--no-intervals", dest="intervals", action="store_false",
+                        help="keep persona intervals fixed (they are shared by every scenario)")
+    parser.add_argument("--bayes", type=int, default=0, metavar="ROUNDS",
+                        help="Bayesian-optimization rounds after the initial sweep")
+    parser.add_argument("--batch", type=int, default=64, help="parameter sets per Bayesian round")
+    parser.add_argument("--confirm", type=int, default=10, metavar="N",
+                        help="re-run the current table and the N best with 8x the replicates before picking")
+    parser.add_argument("--surface", metavar="X,Y", help="dimension indices for the printed surfaces")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--csv", metavar="PATH", help="write every evaluated set")
+    parser.add_argument("--header", default=TUNING_HEADER, help="current tuning header")
+    parser.add_argument("--emit", metavar="PATH", help="write the winning values as a C header")
+    args = parser.parse_args()
+
+    base = read_tuning(args.header)
+    scenario = Scenario(args.scenario, base, args.intervals)
+    host = HostOS[args.host.upper()]
+    if args.host_model:
+        models = load_models(args.host_model)
+        if args.host not in models:
+            print(f"{args.host_model} has no model for {args.host}", file=sys.stderr)
+            return 1
+        model, source = models[args.host], "calibrated"
+    else:
+        model, source = builtin_host_model(host), "built-in"
+    rates = HostRates.from_model(model)
+    rng = np.random.default_rng(args.seed)
+    obj = 1 if args.objective == "errors" else 0
+
+    rows = np.concatenate([scenario.default_row()[None, :],
+                           latin_hypercube(scenario.dims, args.samples, rng)])
+    t0 = time.perf_counter()
+    pool = Pool(args.jobs) if args.jobs > 1 else None
+    try:
+        metrics = evaluate(scenario, rates, rows, args, pool, args.seed)
+        for r in range(args.bayes):
+            new = gp_suggest(scenario.dims, rows, metrics[:, obj], args.batch, rng)
+            rows = np.concatenate([rows, new])
+            metrics = np.concatenate([metrics, evaluate(scenario, rates, new, args, pool,
+                                                        args.seed + 1000 * (r + 1))])
+            print(f"bayes round {r + 1}: best {metrics[:, obj].max():.1f}")
+    finally:
+        if pool:
+            pool.close()
+    wall = time.perf_counter() - t0
+    lanes = len(rows) * args.reps
+    print(f"{args.scenario} on {args.host} ({source} host model): {len(rows)} sets x {args.reps} reps "
+          f"x {args.hours:g} h in {wall:.1f}s ({lanes * args.hours / wall:.0f} lane-hours/s)")
+
+    names = [d.name.replace("PORTGREMLIN_", "") for d in scenario.dims]
+    print(f"\n{'enums/h':>9} {'errors/h':>9} {'rejects/h':>9}  " + " ".join(names))
+    order = np.argsort(-metrics[:, obj], kind="stable")
+    for i in [0] + [j for j in order[:10] if j != 0]:
+        tag = "  (current)" if i == 0 else ""
+        print(f"{metrics[i, 0]:9.0f} {metrics[i, 1]:9.1f} {metrics[i, 2]:9.2f}  "
+              + " ".join(str(v) for v in rows[i]) + tag)
+
+    if len(scenario.dims) >= 2:
+        xi, yi = (int(v) for v in args.surface.split(",")) if args.surface else (0, 1)
+        print_surface(scenario, rows, metrics[:, 0], "Throughput, enums", xi, yi)
+        print_surface(scenario, rows, metrics[:, 1], "Simulated findings, kernel errors", xi, yi)
+
+    if args.csv:
+        with open(args.csv, "w", newline="", encoding="utf-8") as f:
+            w = csv.writer(f)
+            w.writerow([d.name for d in scenario.dims] + ["enums_per_h", "errors_per_h", "rejects_per_h"])
+            for row, m in zip(rows, metrics):
+                w.writerow([int(v) for v in row] + [round(float(x), 3) for x in m])
+
+    win = int(order[0])
+    if args.confirm and win != 0:
+        # The best of thousands of noisy estimates is biased upward.
+        finalists = np.concatenate([[0], [j for j in order[:args.confirm] if j != 0]])
+        reps = args.reps
+        args.reps = reps * 8
+        confirmed = evaluate(scenario, rates, rows[finalists], args, None, args.seed + 7919)
+        args.reps = reps
+        win = int(finalists[np.argmax(confirmed[:, obj])])
+        metrics[finalists] = confirmed
+        print(f"\nConfirmed with {reps * 8} reps: current {confirmed[0, obj]:.1f}, "
+              f"best {confirmed[:, obj].max():.1f} {args.objective}/h")
+
+    if args.emit:
+        values = dict(base)
+        values.update(scenario.values(rows[win]))
+        gain = metrics[win, obj] / metrics[0, obj] - 1 if metrics[0, obj] else 0.0
+        emit_header(args.emit, values, [
+            f"Last sweep: {args.scenario} on {args.host} ({source} host model), objective",
+            f"{args.objective}/h, {len(rows)} sets x {args.reps} reps x {args.hours:g} h, hold {args.hold:g} s,",
+            f"lockout {args.lockout:g} s: {metrics[win, 0]:.0f} enums/h, {metrics[win, 1]:.1f} errors/h,",
+            f"{metrics[win, 2]:.2f} rejections/h ({gain:+.0%} over the previous table).",
+        ])
+        print(f"\nWinning {args.scenario} table written to {args.emit}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
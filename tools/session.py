@@ -0,0 +1,384 @@
+"""Recorded PortGremlin sessions: file format, reader and paced replay.
+
+A session is the stream Overwatch, the CLI and Gremlin Oracle see live:
+one JSON record per event, stamped with host CLOCK_MONOTONIC (`t`) and
+tagged with the lane and kind it came from:
+
+  lane     lane header: os, port, usb, host, wall (time.time() at start)
+  pg       device @PG record (`rec`)
+  line     plain device console line (`msg`)
+  cmd      command sent to the device (`cmd`)
+  kernel, journal, uevent
+           host-side messages (`msg`, `host_t`)
+
+Two encodings share that record schema. `.jsonl` is plain JSON lines (the
+original --events-log format). Anything else is PGSES1: a magic line
+followed by independent zlib blocks, each prefixed with its length, record
+count and first/last `t`. A block is flushed every BLOCK_RECORDS records or
+BLOCK_SECONDS, so a crash loses at most a few seconds, and a reader can
+find the block holding any time without inflating the ones before it.
+
+SessionPlayer replays a session into a live pipeline at 1x to 1000x (or
+flat out) and seeks. The pipelines are stateful, so seeking forward
+fast-forwards through the skipped records and seeking back restarts from
+the beginning; neither waits on the wall clock.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import struct
+import sys
+import threading
+import time
+import zlib
+from dataclasses import dataclass
+from typing import Any, Callable, Iterator, Optional
+
+MAGIC = b"PGSES1\n"
+BLOCK_HEADER = struct.Struct("<IIdd")   # payload bytes, records, t_first, t_last
+BLOCK_RECORDS = 512
+BLOCK_SECONDS = 2.0
+SPEED_MAX = 0.0                         # SessionPlayer speed: no pacing
+
+
+class SessionClock:
+    """Live sessions read the system clocks; replays substitute recorded time."""
+
+    def monotonic(self) -> float:
+        return time.monotonic()
+
+    def time(self) -> float:
+        return time.time()
+
+
+class ReplayClock(SessionClock):
+    def __init__(self, t0: float = 0.0, wall0: Optional[float] = None) -> None:
+        self.now = t0
+        self._offset = (wall0 - t0) if wall0 is not None else (time.time() - time.monotonic())
+
+    def monotonic(self) -> float:
+        return self.now
+
+    def time(self) -> float:
+        return self.now + self._offset
+
+
+class JsonlWriter:
+    """One JSON object per line, line-buffered."""
+
+    def __init__(self, path: str, clock: Optional[SessionClock] = None) -> None:
+        os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+        self.path = path
+        self.clock = clock or SessionClock()
+        self._f = open(path, "a", encoding="utf-8", buffering=1)
+        self._lock = threading.Lock()
+
+    def write(self, lane: str, kind: str, **fields: Any) -> None:
+        entry = {"t": round(self.clock.monotonic(), 6), "lane": lane, "k": kind}
+        entry.update(fields)
+        self.append(entry)
+
+    def append(self, entry: dict[str, Any]) -> None:
+        """Write an already-stamped record."""
+        line = json.dumps(entry, separators=(",", ":"))
+        with self._lock:
+            if not self._f.closed:
+                self._f.write(line + "\n")
+
+    def close(self) -> None:
+        with self._lock:
+            self._f.close()
+
+
+class SessionWriter(JsonlWriter):
+    """PGSES1: compressed blocks of JSON lines."""
+
+    def __init__(self, path: str, clock: Optional[SessionClock] = None) -> None:
+        os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+        self.path = path
+        self.clock = clock or SessionClock()
+        self._f = open(path, "ab")
+        if self._f.tell() == 0:
+            self._f.write(MAGIC)
+        self._lock = threading.Lock()
+        self._lines: list[bytes] = []
+        self._t_first = 0.0
+        self._t_last = 0.0
+        self._opened = 0.0
+
+    def append(self, entry: dict[str, Any]) -> None:
+        t = float(entry.get("t", 0.0))
+        line = json.dumps(entry, separators=(",", ":")).encode("utf-8")
+        now = time.monotonic()
+        with self._lock:
+            if self._f.closed:
+                return
+            if not self._lines:
+                self._t_first, self._t_last, self._opened = t, t, now
+            self._lines.append(line)
+            self._t_last = max(self._t_last, t)
+            if len(self._lines) >= BLOCK_RECORDS or now - self._opened >= BLOCK_SECONDS:
+                self._flush_block()
+
+    def _flush_block(self) -> None:
+        if not self._lines:
+            return
+        payload = zlib.compress(b"\n".join(self._lines), 6)
+        self._f.write(BLOCK_HEADER.pack(len(payload), len(self._lines), self._t_first, self._t_last))
+        self._f.write(payload)
+        self._f.flush()
+        self._lines = []
+
+    def flush(self) -> None:
+        with self._lock:
+            if not self._f.closed:
+                self._flush_block()
+
+    def close(self) -> None:
+        with self._lock:
+            if not self._f.closed:
+                self._flush_block()
+                self._f.close()
+
+
+def open_recorder(path: str, clock: Optional[SessionClock] = None) -> JsonlWriter:
+    if path.endswith(".jsonl"):
+        return JsonlWriter(path, clock)
+    return SessionWriter(path, clock)
+
+
+@dataclass(frozen=True)
+class Block:
+    offset: int
+    size: int
+    count: int
+    t_first: float
+    t_last: float
+
+
+class SessionReader:
+    """Reads either encoding; PGSES1 files are indexed by block on open."""
+
+    def __init__(self, path: str) -> None:
+        self.path = path
+        with open(path, "rb") as f:
+            self.compressed = f.read(len(MAGIC)) == MAGIC
+        self.blocks: list[Block] = []
+        self.truncated = False
+        if self.compressed:
+            self._index()
+            self.count = sum(b.count for b in self.blocks)
+            self.t0 = min((b.t_first for b in self.blocks), default=0.0)
+            self.t_end = max((b.t_last for b in self.blocks), default=self.t0)
+        else:
+            ts = [float(r.get("t", 0.0)) for r in self._jsonl(warn=False)]
+            self.count = len(ts)
+            self.t0 = min(ts, default=0.0)
+            self.t_end = max(ts, default=self.t0)
+
+    @property
+    def duration(self) -> float:
+        return self.t_end - self.t0
+
+    def _index(self) -> None:
+        size = os.path.getsize(self.path)
+        with open(self.path, "rb") as f:
+            offset = len(MAGIC)
+            while offset + BLOCK_HEADER.size <= size:
+                f.seek(offset)
+                length, count, t_first, t_last = BLOCK_HEADER.unpack(f.read(BLOCK_HEADER.size))
+                body = offset + BLOCK_HEADER.size
+                if body + length > size:
+                    break
+                self.blocks.append(Block(body, length, count, t_first, t_last))
+                offset = body + length
+            # A writer that died mid-block leaves a partial block behind.
+            self.truncated = offset != size
+
+    def _jsonl(self, warn: bool = True) -> Iterator[dict[str, Any]]:
+        with open(self.path, encoding="utf-8") as f:
+            for lineno, line in enumerate(f, 1):
+                line = line.strip()
+                if not line:
+                    continue
+                try:
+                    yield json.loads(line)
+                except json.JSONDecodeError:
+                    if warn:
+                        print(f"{self.path}:{lineno}: skipping malformed line", file=sys.stderr)
+
+    def records(self, start: Optional[float] = None) -> Iterator[dict[str, Any]]:
+        """Records in file order, from absolute time `start` on."""
+        if not self.compressed:
+            for rec in self._jsonl():
+                if start is None or float(rec.get("t", 0.0)) >= start:
+                    yield rec
+            return
+        with open(self.path, "rb") as f:
+            for block in self.blocks:
+                if start is not None and block.t_last < start:
+                    continue
+                f.seek(block.offset)
+                for line in zlib.decompress(f.read(block.size)).split(b"\n"):
+                    rec = json.loads(line)
+                    if start is None or float(rec.get("t", 0.0)) >= start:
+                        yield rec
+
+    def lanes(self) -> dict[str, dict[str, Any]]:
+        """Lane header records by lane name (lanes without one get an empty header)."""
+        out: dict[str, dict[str, Any]] = {}
+        for rec in self.records():
+            name = rec.get("lane", "")
+            if rec.get("k") == "lane":
+                out[name] = rec
+            else:
+                out.setdefault(name, {})
+        return out
+
+
+class SessionPlayer:
+    """Feeds a session's records to deliver() at `speed` times recorded pace.
+
+    Positions are seconds since the first record. restart() is called
+    before a backward seek replays from the top, and must reset whatever
+    deliver() has built up.
+    """
+
+    def __init__(self, reader: SessionReader, deliver: Callable[[dict[str, Any]], None],
+                 clock: Optional[ReplayClock] = None, speed: float = 1.0,
+                 restart: Optional[Callable[[], None]] = None) -> None:
+        self.reader = reader
+        self.deliver = deliver
+        self.clock = clock or ReplayClock(reader.t0)
+        self.restart = restart
+        self.speed = speed
+        self.paused = False
+        self.position = 0.0
+        self.finished = False
+        self._seek: Optional[float] = None
+        self._ff_until = -1.0
+        self._cv = threading.Condition()
+
+    @property
+    def duration(self) -> float:
+        return self.reader.duration
+
+    def seek(self, position: float) -> None:
+        with self._cv:
+            self._seek = max(0.0, min(position, self.duration))
+            self._cv.notify_all()
+
+    def set_speed(self, speed: float) -> None:
+        with self._cv:
+            self.speed = speed
+            self._cv.notify_all()
+
+    def set_paused(self, paused: bool) -> None:
+        with self._cv:
+            self.paused = paused
+            self._cv.notify_all()
+
+    def status(self) -> dict[str, Any]:
+        return {"position": round(self.position, 3), "duration": round(self.duration, 3),
+                "speed": self.speed, "paused": self.paused, "finished": self.finished}
+
+    def _take_seek(self) -> Optional[float]:
+        with self._cv:
+            target, self._seek = self._seek, None
+        return target
+
+    def _wait_until(self, position: float, stop: threading.Event) -> bool:
+        """Sleep until the playhead reaches `position`; False if interrupted by a seek."""
+        anchor_wall, anchor_pos = time.monotonic(), self.position
+        while not stop.is_set():
+            with self._cv:
+                if self._seek is not None:
+                    return False
+                speed, paused = self.speed, self.paused
+                if paused:
+                    self._cv.wait(0.1)
+                    anchor_wall, anchor_pos = time.monotonic(), self.position
+                    continue
+                if speed == SPEED_MAX:
+                    return True
+                head = anchor_pos + (time.monotonic() - anchor_wall) * speed
+                if head >= position:
+                    return True
+                self.position = head
+                self.clock.now = self.reader.t0 + head
+                self._cv.wait(min(0.05, (position - head) / speed))
+                if self.speed != speed:
+                    anchor_wall, anchor_pos = time.monotonic(), self.position
+        return False
+
+    def run(self, stop: threading.Event) -> None:
+        t0 = self.reader.t0
+        records = self.reader.records()
+        while not stop.is_set():
+            target = self._take_seek()
+            if target is not None:
+                if target < self.position:
+                    if self.restart is not None:
+                        self.restart()
+                    records = self.reader.records()
+                    self.position = 0.0
+                self._ff_until = target
+                self.finished = False
+
+            rec = next(records, None)
+            if rec is None:
+                self.finished = True
+                self.position = self.duration
+                with self._cv:
+                    while self._seek is None and not stop.is_set():
+                        self._cv.wait(0.2)
+                continue
+
+            pos = float(rec.get("t", t0)) - t0
+            if pos > self._ff_until and pos > self.position and not self._wait_until(pos, stop):
+                # A seek arrived while waiting: deliver this record unless it
+                # now lies behind the playhead, then honour the seek.
+                with self._cv:
+                    back = self._seek is not None and self._seek < pos
+                if back:
+                    continue
+            self.position = max(self.position, pos)
+            self.clock.now = t0 + self.position
+            self.deliver(rec)
+
+
+def main() -> int:
+    import argparse
+
+    parser = argparse.ArgumentParser(description="Inspect or convert PortGremlin session recordings")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    info = sub.add_parser("info", help="summarize sessions")
+    info.add_argument("paths", nargs="+")
+    conv = sub.add_parser("convert", help="re-encode (output format from its extension)")
+    conv.add_argument("src")
+    conv.add_argument("dst")
+    args = parser.parse_args()
+
+    if args.cmd == "convert":
+        writer = open_recorder(args.dst)
+        for rec in SessionReader(args.src).records():
+            writer.append(rec)
+        writer.close()
+        args.paths = [args.src, args.dst]
+    for path in args.paths:
+        reader = SessionReader(path)
+        kinds: dict[str, int] = {}
+        for rec in reader.records():
+            kinds[rec.get("k", "?")] = kinds.get(rec.get("k", "?"), 0) + 1
+        fmt = f"PGSES1, {len(reader.blocks)} blocks" if reader.compressed else "JSONL"
+        print(f"{path}: {fmt}{' (truncated)' if reader.truncated else ''}, "
+              f"{os.path.getsize(path) / 1024:.0f} KiB, {reader.count} records over {reader.duration:.1f} s, "
+              f"lanes {', '.join(sorted(reader.lanes())) or '-'}")
+        print("  " + " ".join(f"{k}={n}" for k, n in sorted(kinds.items())))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
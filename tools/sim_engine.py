@@ -1,13 +1,24 @@
-"""PortGremlin firmware behavior simulation engine."""
+"""PortGremlin firmware behavior simulation engine.
+
+Time is discrete-event: virtual time is an integer count of 10 ms SysTicks
+and everything that happens (auto-cycle enumerations, the host's connect,
+bus resets and SET_CONFIGURATION, rejections, genome mutations) is a heap
+entry at the exact tick it occurs. advance()/run_until() jump straight from
+one event to the next, so idle stretches cost nothing; tick(dt) is the
+wall-clock wrapper the GUI uses.
+"""
 
 from __future__ import annotations
 
+import heapq
 import random
 import time
 from dataclasses import dataclass, field, replace
 from enum import Enum, auto
 from typing import Callable, Optional
 
+from host_model import FAST_INTERVAL_TICKS, POOLED, HostModel, feature_key
+
 
 class HostOS(Enum):
     UNKNOWN = "Unknown"
@@ -79,8 +90,60 @@ MIMIC_VAULT: list[MimicProfile] = [
     MimicProfile(0x03F0, 0x094A, DeviceClass.PRINTER, "HP", "LaserJet Pro"),
 ]
 
+DEVICE_CLASSES = DeviceClass.all()
+
 KNOWN_VIDS = [0x046D, 0x045E, 0x05AC, 0x8087, 0x1D6B, 0x0BDA, 0x413C]
 
+# Firmware timing: SysTick is 10 ms and cycle intervals are in ticks
+# (PORTGREMLIN_CYCLE_INTERVAL_MIN/MAX in portgremlin_config.h).
+TICK_S = 0.01
+CYCLE_INTERVAL_MIN = 1
+CYCLE_INTERVAL_MAX = 100
+EVOLVE_MUTATE_EVERY = 25
+
+# Built-in host enumeration behavior: (SET_CONFIGURATION latency in ticks,
+# bus resets). A calibrated host model (--host-model) replaces these.
+HOST_LATENCY_TICKS = {
+    HostOS.WINDOWS: (18, 2),
+    HostOS.LINUX: (95, 0),
+    HostOS.MACOS: (45, 0),
+    HostOS.EMBEDDED: (120, 0),
+    HostOS.UNKNOWN: (60, 1),
+}
+
+
+
+def builtin_host_model(host: HostOS) -> HostModel:
+    """The built-in host heuristics expressed as a HostModel (for the sweep).
+
+    Rough per-enumeration equivalents of _host_pain/_host_rejects: malformed
+    descriptors fail to parse 40% of the time, a contradiction costs about
+    one driver-cache conflict, and the 8% rejection applies once pain > 3.
+    """
+    base, resets = HOST_LATENCY_TICKS[host]
+    lo, hi = max(1, base - 8), base + 8
+    latency = [(t, round((t - lo + 1) / (hi - lo + 1), 6)) for t in range(lo, hi + 1)]
+    errors = {POOLED: 0.0}
+    rejects = {POOLED: 0.0}
+    for key in ("-", "f", "m", "mf", "c", "cf", "mc", "mcf"):
+        errors[key] = 0.4 * ("m" in key) + 1.0 * ("c" in key)
+        pain = 2.5 * ("m" in key) + 4.0 * ("c" in key) + 1.0 * ("f" in key) + 0.5
+        rejects[key] = 0.08 if pain > 3 else 0.0
+    return HostModel(host.name.lower(), 0, latency, 0.0, [(resets, 0.85), (resets + 1, 0.15)],
+                     errors, rejects, [("usb core: descriptor parse error", 1.0)])
+
+
+# Discrete-event kinds. Bus events belong to one enumeration and are dropped
+# when the device re-enumerates first; cycle events are re-issued whenever
+# the cycle interval changes.
+EV_CYCLE = "cycle"
+EV_CONNECT = "connect"
+EV_RESET = "reset"
+EV_CONFIGURE = "configure"
+EV_DISCONNECT = "disconnect"
+EV_MUTATE = "mutate"
+BUS_EVENTS = (EV_CONNECT, EV_RESET, EV_CONFIGURE, EV_DISCONNECT)
+
 
 @dataclass
 class Genome:
@@ -139,43 +202,74 @@ class SimulationState:
     host_devices: list[HostDevice] = field(default_factory=list)
     events: list[SimEvent] = field(default_factory=list)
     running: bool = False
-    packet_phase: float = 0.0
     last_enum_flash: float = 0.0
+    # Dirty tracking for renderers: bumped whenever anything shown changes,
+    # and host_devices additionally bumps devices_revision.
+    revision: int = 0
+    devices_revision: int = 0
 
 
 class PortGremlinSimulator:
-    def __init__(self, on_event: Optional[Callable[[SimEvent], None]] = None) -> None:
+    def __init__(self, on_event: Optional[Callable[[SimEvent], None]] = None,
+                 seed: Optional[int] = None,
+                 host_models: Optional[dict[str, HostModel]] = None) -> None:
         self.state = SimulationState()
+        self.rng = random.Random(seed)
+        self.host = self.state.host_os
+        self.host_models = host_models or {}
         self._on_event = on_event
         self._class_index = 0
-        self._tick_accum = 0.0
         self._best_genome = Genome()
+        self._reset_clock()
+
+    def _reset_clock(self) -> None:
+        self.now = 0
+        self._tick_accum = 0.0
+        self._queue: list[tuple[int, int, str, int]] = []
+        self._seq = 0
+        self._bus_epoch = 0
+        self._cycle_epoch = 0
+        self._next_cycle: Optional[int] = None
+        self._last_cycle = 0
+        self._session_start = 0
+
+    @property
+    def virtual_time(self) -> float:
+        return self.now * TICK_S
 
     def log(self, source: str, message: str, level: str = "info") -> None:
         ev = SimEvent(time.time(), source, message, level)
+        self.state.revision += 1
         self.state.events.append(ev)
         if len(self.state.events) > 500:
-            self.state.events = self.state.events[-500:]
+            del self.state.events[:-500]
         if self._on_event:
             self._on_event(ev)
 
     def set_host_os(self, host: HostOS) -> None:
+        self.host = host
         self.state.host_os = host
         self.log("oracle", f"Host set to {host.value}")
 
-    def _host_latency_profile(self) -> tuple[int, int]:
-        profiles = {
-            HostOS.WINDOWS: (18, 2),
-            HostOS.LINUX: (95, 0),
-            HostOS.MACOS: (45, 0),
-            HostOS.EMBEDDED: (120, 0),
-            HostOS.UNKNOWN: (60, 1),
-        }
-        base, resets = profiles[self.state.host_os]
-        return base + random.randint(-8, 8), resets + (1 if random.random() < 0.15 else 0)
+    def _host_model(self) -> Optional[HostModel]:
+        return self.host_models.get(self.host.name.lower())
+
+    def _host_key(self) -> str:
+        st = self.state
+        return feature_key(st.malformed, st.contradiction,
+                           self._cycle_interval_ticks() <= FAST_INTERVAL_TICKS)
+
+    def _host_latency_profile(self) -> tuple[Optional[int], int]:
+        """Return (latency in ticks or None if never configured, bus resets)."""
+        model = self._host_model()
+        if model is not None:
+            return model.sample_latency(self.rng), model.sample_resets(self.rng)
+        base, resets = HOST_LATENCY_TICKS[self.host]
+        return (max(1, base + self.rng.randint(-8, 8)),
+                resets + (1 if self.rng.random() < 0.15 else 0))
 
     def classify_host(self) -> None:
-        lat = self.state.config_latency_ms
+        lat = self.state.config_latency_ms // 10
         rst = self.state.reset_count
         if rst >= 2:
             detected = HostOS.WINDOWS
@@ -188,19 +282,19 @@ class PortGremlinSimulator:
         else:
             detected = HostOS.EMBEDDED
         self.state.host_os = detected
-        self.log("oracle", f"Host classified: {detected.value} (cfg={lat}ms, resets={rst})")
+        self.log("oracle", f"Host classified: {detected.value} (cfg={lat} ticks, resets={rst})")
 
     def _random_vid_pid(self) -> tuple[int, int]:
         st = self.state
         if st.contradiction and st.pinned_vid:
             return st.pinned_vid, st.pinned_pid
-        if st.malformed and random.random() < 0.3:
-            return random.choice([0x0000, 0xFFFF]), random.choice([0x0000, 0xFFFF])
+        if st.malformed:
+            return self.rng.choice([0x0000, 0xFFFF]), self.rng.choice([0x0000, 0xFFFF])
         if st.persona in (Persona.MIMIC, Persona.PHANTOM) or st.genome.real_vid:
-            vid = random.choice(KNOWN_VIDS)
+            vid = self.rng.choice(KNOWN_VIDS)
         else:
-            vid = random.randint(0x1000, 0xFFFF)
-        pid = random.randint(0x0001, 0xFFFE)
+            vid = self.rng.randint(0x1000, 0xFFFE)
+        pid = self.rng.randint(0x0001, 0xFFFE)
         return vid, pid
 
     def _apply_persona_config(self, persona: Persona) -> None:
@@ -212,15 +306,15 @@ class PortGremlinSimulator:
         elif persona == Persona.MIMIC:
             st.auto_cycle, st.malformed = True, False
             st.genome.interval = 15
-            self.deploy_mimic(random.randint(0, len(MIMIC_VAULT) - 1))
+            self.deploy_mimic(self.rng.randint(0, len(MIMIC_VAULT) - 1))
         elif persona == Persona.STORM:
             st.auto_cycle, st.malformed = True, False
             st.genome.interval = 1
         elif persona == Persona.HAUNTED:
             st.auto_cycle, st.malformed = True, True
             st.contradiction = True
-            st.pinned_vid = random.randint(0x1000, 0xFFFF)
-            st.pinned_pid = random.randint(0x1000, 0xFFFF)
+            st.pinned_vid = self.rng.randint(0x1000, 0xFFFE)
+            st.pinned_pid = self.rng.randint(0x1000, 0xFFFE)
             st.genome.interval = 4
         elif persona == Persona.PHANTOM:
             st.auto_cycle, st.malformed = True, False
@@ -262,6 +356,7 @@ class PortGremlinSimulator:
         st.evolve_active = not st.evolve_active
         if st.evolve_active:
             st.brain_active = False
+            self._apply_genome()
             self.log("evolve", f"Genetic engine ACTIVE (gen {st.genome.generation})")
         else:
             self.log("evolve", "Genetic engine off")
@@ -280,26 +375,40 @@ class PortGremlinSimulator:
         st = self.state
         st.contradiction = not st.contradiction
         if st.contradiction:
-            st.pinned_vid = random.randint(0x1000, 0xFFFF)
-            st.pinned_pid = random.randint(0x1000, 0xFFFF)
+            st.pinned_vid = self.rng.randint(0x1000, 0xFFFE)
+            st.pinned_pid = self.rng.randint(0x1000, 0xFFFE)
             self.log("device", f"Driver confusion ON {st.pinned_vid:04X}:{st.pinned_pid:04X}")
         else:
             self.log("device", "Driver confusion OFF")
 
-    def _mutate_genome(self) -> None:
-        g = self.state.genome
-        g.generation += 1
-        field = random.randint(0, 3)
+    def _apply_genome(self) -> None:
+        """Mirror of GenomeToConfig(): a contradiction genome re-pins the identity."""
+        st = self.state
+        g = st.genome
+        st.malformed = g.malformed
+        st.auto_cycle = True
+        st.contradiction = g.contradiction
+        if g.contradiction:
+            st.pinned_vid = self.rng.randint(0x1000, 0xFFFE)
+            st.pinned_pid = self.rng.randint(0x1000, 0xFFFE)
+
+    def _mutate_genome(self, from_best: bool = False) -> None:
+        st = self.state
+        generation = st.genome.generation + 1
+        if from_best:
+            st.genome = replace(self._best_genome)
+        g = st.genome
+        g.generation = generation
+        field = self.rng.randint(0, 3)
         if field == 0:
-            g.interval = random.randint(1, 20)
+            g.interval = self.rng.randint(CYCLE_INTERVAL_MIN, CYCLE_INTERVAL_MAX)
         elif field == 1:
             g.malformed = not g.malformed
         elif field == 2:
             g.real_vid = not g.real_vid
         else:
             g.contradiction = not g.contradiction
-        if g.fitness > self._best_genome.fitness:
-            self._best_genome = replace(g)
+        self._apply_genome()
         self.log("evolve", f"Genome mutated → gen={g.generation} int={g.interval} mal={g.malformed}")
 
     def _brain_tick(self) -> None:
@@ -325,15 +434,26 @@ class PortGremlinSimulator:
             st.genome.interval = 1
             self.log("brain", "Maximum chaos — HAUNTED", "warn")
 
-    def _host_react(self) -> None:
+    def _cycle_interval_ticks(self) -> int:
+        return self.state.genome.interval
+
+    def _host_pain(self) -> float:
+        """Host-side reaction to the identity just enumerated (shared with cosim)."""
         st = self.state
         pain = 0.0
-        if st.malformed:
+        model = self._host_model()
+        if model is not None:
+            errors = model.sample_errors(self.rng, self._host_key())
+            for _ in range(errors):
+                st.host_errors += 1
+                self.log("kernel", model.sample_message(self.rng), "error")
+            pain += 2.5 * errors
+        elif st.malformed:
             pain += 2.5
-            if random.random() < 0.4:
+            if self.rng.random() < 0.4:
                 st.host_errors += 1
                 self.log("kernel", "usb core: descriptor parse error", "error")
-        if st.contradiction:
+        if st.contradiction and model is None:
             for dev in st.host_devices:
                 if dev.pinned and dev.vid == st.pinned_vid and dev.pid == st.pinned_pid:
                     if dev.device_class != st.device_class:
@@ -345,54 +465,85 @@ class PortGremlinSimulator:
                             f"({dev.device_class.value} vs {st.device_class.value})",
                             "error",
                         )
-        if st.genome.interval <= 2:
+        if self._cycle_interval_ticks() <= 2:
             pain += 1.0
         if st.enum_count > 100:
             pain += 0.5
         st.pain_score = min(100.0, st.pain_score * 0.95 + pain)
+        return pain
+
+    def _host_rejects(self, pain: float) -> bool:
+        model = self._host_model()
+        if model is not None:
+            return model.rejects(self.rng, self._host_key())
+        return pain > 3 and self.rng.random() < 0.08
+
+    def _host_react(self) -> None:
+        st = self.state
+        pain = self._host_pain()
         st.tolerance = max(0, min(100, st.tolerance - int(pain * 2)))
-        if pain > 3 and random.random() < 0.08:
-            st.disconnects += 1
-            self.log("host", "Host disconnected device (stack rejection)", "warn")
-            if st.evolve_active:
-                self._mutate_genome()
-            if st.brain_active and st.brain_phase.value not in ("Idle", "Probe"):
-                st.brain_phase = BrainPhase.PROBE
-                self._apply_persona_config(Persona.PHANTOM)
-                self.log("brain", "De-escalating to PROBE")
+        self._host_enumerate(pain)
+
+    def _host_enumerate(self, pain: float) -> None:
+        """Schedule the host's side of the enumeration that just started.
+
+        A rejected device is dropped as soon as its descriptors are read;
+        otherwise the host connects, issues its bus resets and configures
+        after its latency (a calibrated host may never configure). Anything still pending from the previous
+        enumeration is abandoned, as on a real bus.
+        """
+        self._bus_epoch += 1
+        if self._host_rejects(pain):
+            self._schedule(1, EV_DISCONNECT)
+            return
+        latency, resets = self._host_latency_profile()
+        self._schedule(1, EV_CONNECT)
+        for i in range(resets):
+            self._schedule(2 + i, EV_RESET)
+        if latency is not None:
+            self._schedule(max(latency, resets + 2), EV_CONFIGURE)
+
+    def _host_disconnect(self) -> None:
+        st = self.state
+        st.disconnects += 1
+        self.log("host", "Host disconnected device (stack rejection)", "warn")
+        if st.evolve_active:
+            self._mutate_genome(from_best=True)
+        if st.brain_active and st.brain_phase.value not in ("Idle", "Probe"):
+            st.brain_phase = BrainPhase.PROBE
+            self._apply_persona_config(Persona.PHANTOM)
+            self.log("brain", "De-escalating to PROBE")
 
     def enumerate(self) -> None:
         st = self.state
-        if st.persona == Persona.MIMIC and random.random() < 0.5:
-            self.deploy_mimic(random.randint(0, len(MIMIC_VAULT) - 1))
+        if st.persona == Persona.MIMIC and self.rng.random() < 0.5:
+            self.deploy_mimic(self.rng.randint(0, len(MIMIC_VAULT) - 1))
         else:
             st.vid, st.pid = self._random_vid_pid()
             if st.contradiction:
                 st.vid, st.pid = st.pinned_vid, st.pinned_pid
-            classes = DeviceClass.all()
+            classes = DEVICE_CLASSES
             if st.auto_cycle:
                 self._class_index = (self._class_index + 1) % len(classes)
                 st.device_class = classes[self._class_index]
             st.product = f"{st.device_class.value} Device"
             if st.malformed:
-                st.manufacturer = random.choice(["", "ZZZZ", "\xff\xfe"])
+                st.manufacturer = self.rng.choice(["", "ZZZZ", "\xff\xfe"])
 
         st.enum_count += 1
         st.last_enum_flash = time.time()
-        lat, rst = self._host_latency_profile()
-        st.config_latency_ms = lat
-        st.reset_count = rst
-        if st.enum_count == 1 or st.enum_count % 7 == 0:
-            self.classify_host()
 
         label = f"{st.manufacturer} {st.product}"[:28]
         pinned = st.contradiction
         host_dev = HostDevice(st.vid, st.pid, st.device_class, label, pinned)
         st.host_devices.insert(0, host_dev)
-        st.host_devices = st.host_devices[:24]
+        del st.host_devices[24:]
+        st.devices_revision += 1
 
         if st.evolve_active:
-            st.genome.fitness += 1
+            st.genome.fitness += 2
+            if st.genome.fitness > self._best_genome.fitness:
+                self._best_genome = replace(st.genome)
 
         self._host_react()
         self._brain_tick()
@@ -402,26 +553,95 @@ class PortGremlinSimulator:
             f"[{st.persona.value}]",
         )
 
+    # -- discrete-event core -------------------------------------------------
+
+    def _schedule(self, delay_ticks: int, kind: str) -> None:
+        epoch = self._cycle_epoch if kind == EV_CYCLE else self._bus_epoch
+        self._seq += 1
+        heapq.heappush(self._queue, (self.now + delay_ticks, self._seq, kind, epoch))
+
+    def _pop_due(self, until: int):
+        """Yield the live events due at or before `until`, moving the clock to each."""
+        queue = self._queue
+        while queue and queue[0][0] <= until:
+            when, _seq, kind, epoch = heapq.heappop(queue)
+            if kind == EV_CYCLE:
+                if epoch != self._cycle_epoch:
+                    continue
+            elif kind in BUS_EVENTS and epoch != self._bus_epoch:
+                continue
+            self.now = max(self.now, when)
+            yield kind
+
+    def _cycling(self) -> bool:
+        st = self.state
+        return st.running and (st.auto_cycle or st.brain_active or st.evolve_active)
+
+    def _reschedule_cycle(self) -> None:
+        """Keep exactly one live cycle event, `interval` ticks after the last one."""
+        if not self._cycling():
+            if self._next_cycle is not None:
+                self._cycle_epoch += 1
+                self._next_cycle = None
+            return
+        if self._next_cycle is None:
+            self._last_cycle = self.now
+        due = max(self._last_cycle + self._cycle_interval_ticks(), self.now + 1)
+        if due != self._next_cycle:
+            self._cycle_epoch += 1
+            self._next_cycle = due
+            self._schedule(due - self.now, EV_CYCLE)
+
+    def _dispatch(self, kind: str) -> None:
+        st = self.state
+        if kind == EV_CYCLE:
+            self._last_cycle = self.now
+            self._next_cycle = None
+            self.enumerate()
+            if st.evolve_active and st.enum_count % EVOLVE_MUTATE_EVERY == 0:
+                self._schedule(0, EV_MUTATE)
+        elif kind == EV_CONNECT:
+            self._session_start = self.now
+            st.reset_count = 0
+        elif kind == EV_RESET:
+            st.reset_count += 1
+        elif kind == EV_CONFIGURE:
+            st.config_latency_ms = (self.now - self._session_start) * 10
+            self.classify_host()
+        elif kind == EV_DISCONNECT:
+            self._host_disconnect()
+        elif kind == EV_MUTATE and st.evolve_active:
+            self._mutate_genome()
+
+    def advance(self, ticks: int) -> None:
+        """Process every event in the next `ticks` SysTicks, in time order."""
+        end = self.now + ticks
+        self._reschedule_cycle()
+        for kind in self._pop_due(end):
+            self._dispatch(kind)
+            self._reschedule_cycle()
+            self.state.revision += 1
+        self.now = max(self.now, end)
+
+    def run_until(self, seconds: float) -> None:
+        """Advance virtual time to `seconds` since start (or reset)."""
+        self.advance(max(0, int(seconds / TICK_S + 1e-9) - self.now))
+
     def tick(self, dt: float) -> None:
         st = self.state
         if not st.running:
             return
-        st.packet_phase = (st.packet_phase + dt * 3) % 1.0
         for dev in st.host_devices:
             dev.age += dt
-        if not st.auto_cycle and not st.brain_active and not st.evolve_active:
-            return
-        interval = st.genome.interval * 0.05
-        if st.evolve_active:
-            st.malformed = st.genome.malformed
-            st.contradiction = st.genome.contradiction
-            interval = st.genome.interval * 0.05
         self._tick_accum += dt
-        if self._tick_accum >= interval:
-            self._tick_accum = 0.0
-            self.enumerate()
-            if st.evolve_active and st.enum_count % 25 == 0:
-                self._mutate_genome()
+        ticks = int(self._tick_accum / TICK_S + 1e-9)
+        if ticks:
+            self._tick_accum -= ticks * TICK_S
+            self.advance(ticks)
+
+    def set_auto_cycle(self, enabled: bool) -> None:
+        self.state.auto_cycle = enabled
+        self.state.revision += 1
 
     def start(self) -> None:
         self.state.running = True
@@ -432,7 +652,10 @@ class PortGremlinSimulator:
         self.log("sim", "Simulation paused")
 
     def reset(self) -> None:
-        self.state = SimulationState(host_os=self.state.host_os)
+        old = self.state
+        self.state = SimulationState(host_os=self.host, revision=old.revision + 1,
+                                     devices_revision=old.devices_revision + 1)
         self._class_index = 0
-        self._tick_accum = 0.0
+        self._best_genome = Genome()
+        self._reset_clock()
         self.log("sim", "Simulation reset")
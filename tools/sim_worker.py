@@ -0,0 +1,116 @@
+"""Run a simulator on its own thread at a selectable speed.
+
+The Virtual Lab used to tick the engine from the Tk main loop, so the
+simulation ran no faster than real time and stalled whenever the UI did.
+SimWorker owns the simulator instead: the UI queues commands with call()
+(they run on the worker between steps, so the engine is only ever touched
+by one thread) and reads `snapshot`, an immutable copy of the state that
+the worker republishes at the UI frame rate by swapping one reference.
+"""
+
+from __future__ import annotations
+
+import queue
+import threading
+import time
+from dataclasses import dataclass, replace
+from typing import Any, Callable, Optional
+
+from sim_engine import PortGremlinSimulator, SimulationState
+
+# Menu label -> simulated seconds per wall second; 0 runs flat out.
+SPEEDS = {"1×": 1.0, "10×": 10.0, "100×": 100.0, "1000×": 1000.0, "max": 0.0}
+STEP_S = 0.01          # wall time between steps when paced
+MAX_SLICE_S = 0.5      # simulated time per step when running flat out
+PUBLISH_HZ = 60.0
+
+
+@dataclass(frozen=True)
+class SimSnapshot:
+    """One published view of the simulator; never mutated after publish."""
+
+    state: SimulationState
+    virtual_time: float
+    rate: float          # achieved simulated seconds per wall second
+    speed: float
+
+
+def _copy_state(st: SimulationState, prev: Optional[SimulationState] = None) -> SimulationState:
+    """Copy st for publishing, reusing prev (or its device list) if unchanged."""
+    if prev is not None and prev.revision == st.revision:
+        return prev
+    if prev is not None and prev.devices_revision == st.devices_revision:
+        devices = prev.host_devices
+    else:
+        devices = [replace(d) for d in st.host_devices]
+    return replace(st, genome=replace(st.genome), host_devices=devices, events=[])
+
+
+class SimWorker(threading.Thread):
+    def __init__(self, sim: PortGremlinSimulator, speed: float = 1.0) -> None:
+        super().__init__(name="sim-worker", daemon=True)
+        self.sim = sim
+        self.speed = speed
+        self._commands: queue.SimpleQueue[tuple[Callable[..., Any], tuple]] = queue.SimpleQueue()
+        self._wake = threading.Event()
+        self._halt = threading.Event()
+        self._rate = 0.0
+        self.snapshot = SimSnapshot(_copy_state(sim.state), sim.virtual_time, 0.0, speed)
+
+    def call(self, fn: Callable[..., Any], *args: Any) -> None:
+        """Run fn(*args) on the worker thread before its next step."""
+        self._commands.put((fn, args))
+        self._wake.set()
+
+    def set_speed(self, speed: float) -> None:
+        self.call(setattr, self, "speed", speed)
+
+    def stop(self, timeout: Optional[float] = 2.0) -> None:
+        self._halt.set()
+        self._wake.set()
+        if self.is_alive():
+            self.join(timeout)
+
+    def _drain(self) -> None:
+        while True:
+            try:
+                fn, args = self._commands.get_nowait()
+            except queue.Empty:
+                return
+            fn(*args)
+
+    def _publish(self) -> None:
+        self.snapshot = SimSnapshot(_copy_state(self.sim.state, self.snapshot.state),
+                                    self.sim.virtual_time, self._rate, self.speed)
+
+    def run(self) -> None:
+        last = time.monotonic()
+        next_publish = last
+        rate_t, rate_v = last, self.sim.virtual_time
+        while not self._halt.is_set():
+            self._drain()
+            now = time.monotonic()
+            if not self.sim.state.running:
+                self._rate = 0.0
+                self._publish()
+                self._wake.wait(1.0 / PUBLISH_HZ)
+                self._wake.clear()
+                last = rate_t = time.monotonic()
+                rate_v = self.sim.virtual_time
+                continue
+
+            if self.speed > 0.0:
+                self.sim.tick((now - last) * self.speed)
+            else:
+                self.sim.tick(MAX_SLICE_S)
+            last = now
+
+            if now >= next_publish:
+                if now - rate_t >= 0.5:
+                    self._rate = (self.sim.virtual_time - rate_v) / (now - rate_t)
+                    rate_t, rate_v = now, self.sim.virtual_time
+                self._publish()
+                next_publish = now + 1.0 / PUBLISH_HZ
+            if self.speed > 0.0:
+                self._wake.wait(STEP_S)
+                self._wake.clear()
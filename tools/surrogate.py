@@ -0,0 +1,399 @@
+#!/usr/bin/env python3
+"""
+Surrogate model of genome outcomes, for screening Evolve candidates.
+
+Every genome the firmware's Evolve engine breeds costs real enumerations
+before its fitness is known, including ones the host rejects outright.
+This module learns which genomes pay off and lets Overwatch replace a
+poor candidate (`portgremlin-overwatch.py --surrogate`) before the
+hardware spends time on it.
+
+An episode is one genome on the bus: from its `evolve` record to the
+next. Its outcome is points per minute, on the scale the firmware's
+bandit uses (portgremlin_bandit.h):
+- 4 for each SET_CONFIGURATION the host completed
+- 1 for each kernel error
+- 64 for each new finding signature
+- minus 8 for each disconnect
+
+The model regresses log(1 + points/min) on a few genome features by
+Bayesian linear regression. The features are interval bands, each flag,
+and each descriptor mutator, which only acts on malformed enumerations.
+Episodes are weighted by their length, so a generation cut short counts
+for little. Candidates are ranked by the upper confidence bound
+mean + kappa*sd, so genomes the model knows little about still get tried.
+
+Episodes come from recorded sessions (the session store that
+`--record` builds) and, live, from each Overwatch lane. Pure Python, so
+Overwatch keeps its pyserial-only footprint.
+
+    python3 tools/surrogate.py reports/*.pgses --os linux
+    python3 tools/portgremlin-overwatch.py --os linux --surrogate reports/*.pgses \\
+        --record reports/linux-2.pgses
+"""
+
+from __future__ import annotations
+
+import argparse
+import math
+import os
+import sys
+from collections import OrderedDict
+from dataclasses import dataclass, field
+from typing import Any, Iterable, Optional
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from host_model import FAST_INTERVAL_TICKS
+from session import SessionReader
+from triage import normalize
+
+# PORTGREMLIN_CYCLE_INTERVAL_MIN/MAX and MUTATE_NUM_OPS in the firmware.
+INTERVAL_MIN = 1
+INTERVAL_MAX = 100
+MUTATORS = ("length", "field", "count", "nesting", "short", "report")
+
+# Points per event, as PORTGREMLIN_BANDIT_PTS_* (kernel errors stand in for uevents).
+PTS_CONFIG = 4
+PTS_ERROR = 1
+PTS_FINDING = 64
+PTS_DISCONNECT = 8
+
+MIN_EPISODE_S = 5.0
+WEIGHT_CAP_S = 120.0
+PRIOR_PRECISION = 1.0
+MIN_EPISODES = 8
+KAPPA = 1.0
+# How much better (in log points/min) the best candidate must look.
+MARGIN = 0.15
+INTERVAL_GRID = (1, 2, 3, 5, 8, 13, 20, 30, 50, 75, 100)
+KERNEL_SOURCES = ("kernel", "journal")
+DEDUPE_WINDOW = 512
+
+
+@dataclass(frozen=True)
+class Genome:
+    interval: int
+    malformed: int = 0
+    real_vid: int = 1
+    contradiction: int = 0
+    mutations: int = 0
+
+    @classmethod
+    def from_record(cls, rec: dict[str, Any]) -> Genome:
+        return cls(int(rec.get("int", 0)), int(rec.get("mal", 0)), int(rec.get("rv", 0)),
+                   int(rec.get("con", 0)), int(rec.get("mut", 0)))
+
+    def command(self) -> str:
+        return (f"!gen {self.interval:x} {self.malformed:x} {self.real_vid:x} "
+                f"{self.contradiction:x} {self.mutations:x}")
+
+    def label(self) -> str:
+        flags = "".join(c for c, on in (("m", self.malformed), ("v", self.real_vid),
+                                          ("c", self.contradiction)) if on) or "-"
+        return f"int={self.interval} {flags} mut={self.mutations:02x}"
+
+    def neighbours(self) -> list[Genome]:
+        """Every genome one firmware mutation away (MutateGenome), on a coarse interval grid."""
+        out = [Genome(i, self.malformed, self.real_vid, self.contradiction, self.mutations)
+               for i in INTERVAL_GRID if i != self.interval]
+        out.append(Genome(self.interval, self.malformed ^ 1, self.real_vid, self.contradiction,
+                          self.mutations))
+        out.append(Genome(self.interval, self.malformed, self.real_vid ^ 1, self.contradiction,
+                          self.mutations))
+        out.append(Genome(self.interval, self.malformed, self.real_vid, self.contradiction ^ 1,
+                          self.mutations))
+        out += [Genome(self.interval, self.malformed, self.real_vid, self.contradiction,
+                       self.mutations ^ (1 << b)) for b in range(len(MUTATORS))]
+        return out
+
+
+FEATURES = ("bias", "fast", "int<=10", "int<=30", "log int", "malformed", "real vid",
+            "contradiction", "mal*con") + tuple(f"mut:{m}" for m in MUTATORS)
+
+
+def features(g: Genome) -> list[float]:
+    mal = float(g.malformed != 0)
+    row = [
+        1.0,
+        float(g.interval <= FAST_INTERVAL_TICKS),
+        float(g.interval <= 10),
+        float(g.interval <= 30),
+        math.log(max(g.interval, 1)) / math.log(INTERVAL_MAX),
+        mal,
+        float(g.real_vid != 0),
+        float(g.contradiction != 0),
+        mal * float(g.contradiction != 0),
+    ]
+    row += [mal * float(g.mutations >> b & 1) for b in range(len(MUTATORS))]
+    return row
+
+
+@dataclass
+class Episode:
+    genome: Genome
+    seconds: float
+    configs: int = 0
+    errors: int = 0
+    findings: int = 0
+    disconnects: int = 0
+    os: Optional[str] = None
+
+    @property
+    def points(self) -> int:
+        return (self.configs * PTS_CONFIG + self.errors * PTS_ERROR +
+                self.findings * PTS_FINDING - self.disconnects * PTS_DISCONNECT)
+
+    @property
+    def score(self) -> float:
+        return math.log1p(max(self.points, 0) * 60.0 / self.seconds)
+
+    @property
+    def weight(self) -> float:
+        return min(self.seconds, WEIGHT_CAP_S) / WEIGHT_CAP_S
+
+
+@dataclass
+class EpisodeTracker:
+    """Splits one lane's stream into episodes at each `evolve` record.
+
+    dmesg and journalctl both deliver each kernel line. A line is counted
+    once, keyed like TriageDB.record by host time and normalized text, so
+    live lanes and recorded sessions score on the same scale.
+    """
+
+    os: Optional[str] = None
+    genome: Optional[Genome] = None
+    start: float = 0.0
+    configs: int = 0
+    errors: int = 0
+    findings: int = 0
+    disconnects: int = 0
+    recent: OrderedDict = field(default_factory=OrderedDict, repr=False)
+
+    def on_device(self, rec: dict[str, Any], t: float) -> Optional[Episode]:
+        etype = rec.get("e", "")
+        if etype == "evolve":
+            episode = self.close(t)
+            self.genome, self.start = Genome.from_record(rec), t
+            self.configs = self.errors = self.findings = self.disconnects = 0
+            return episode
+        if etype == "host":
+            self.configs += 1
+        elif etype == "disconnect":
+            self.disconnects += 1
+        return None
+
+    def on_error(self, message: str, host_t: Optional[float]) -> bool:
+        """Count one kernel line; False if it is the other source's copy of a counted one."""
+        if host_t is not None:
+            key = (round(host_t, 6), normalize(message))
+            if key in self.recent:
+                return False
+            self.recent[key] = None
+            if len(self.recent) > DEDUPE_WINDOW:
+                self.recent.popitem(last=False)
+        self.errors += 1
+        return True
+
+    def on_finding(self) -> None:
+        self.findings += 1
+
+    def close(self, t: float) -> Optional[Episode]:
+        """The running episode up to `t`, if it lasted long enough to judge."""
+        if self.genome is None or t - self.start < MIN_EPISODE_S:
+            return None
+        return Episode(self.genome, t - self.start, self.configs, self.errors,
+                       self.findings, self.disconnects, self.os)
+
+
+def _cholesky(a: list[list[float]]) -> list[list[float]]:
+    n = len(a)
+    low = [[0.0] * n for _ in range(n)]
+    for i in range(n):
+        for j in range(i + 1):
+            s = a[i][j] - sum(low[i][k] * low[j][k] for k in range(j))
+            low[i][j] = math.sqrt(max(s, 1e-12)) if i == j else s / low[j][j]
+    return low
+
+
+def _solve(low: list[list[float]], b: list[float]) -> list[float]:
+    """x with L L^T x = b."""
+    n = len(b)
+    y = [0.0] * n
+    for i in range(n):
+        y[i] = (b[i] - sum(low[i][k] * y[k] for k in range(i))) / low[i][i]
+    x = [0.0] * n
+    for i in reversed(range(n)):
+        x[i] = (y[i] - sum(low[k][i] * x[k] for k in range(i + 1, n))) / low[i][i]
+    return x
+
+
+@dataclass
+class Surrogate:
+    """Bayesian linear regression of episode score on genome features."""
+
+    kappa: float = KAPPA
+    episodes: list[Episode] = field(default_factory=list)
+
+    def __post_init__(self) -> None:
+        self._mean: list[float] = [0.0] * len(FEATURES)
+        self._chol: Optional[list[list[float]]] = None
+        self._noise = 1.0
+        if self.episodes:
+            self.fit()
+
+    def __len__(self) -> int:
+        return len(self.episodes)
+
+    def add(self, episode: Episode) -> None:
+        self.episodes.append(episode)
+        self.fit()
+
+    def fit(self) -> None:
+        n = len(FEATURES)
+        a = [[PRIOR_PRECISION if i == j and i else 0.0 for j in range(n)] for i in range(n)]
+        a[0][0] = 1e-6
+        b = [0.0] * n
+        rows = [(features(e.genome), e.score, e.weight) for e in self.episodes]
+        for x, y, w in rows:
+            for i in range(n):
+                b[i] += w * x[i] * y
+                for j in range(i + 1):
+                    a[i][j] += w * x[i] * x[j]
+        for i in range(n):
+            for j in range(i):
+                a[j][i] = a[i][j]
+        self._chol = _cholesky(a)
+        self._mean = _solve(self._chol, b)
+        total = sum(w for _, _, w in rows)
+        if total > 0:
+            sse = sum(w * (y - self._dot(x)) ** 2 for x, y, w in rows)
+            self._noise = max(sse / total, 0.01)
+
+    def _dot(self, x: list[float]) -> float:
+        return sum(m * v for m, v in zip(self._mean, x))
+
+    def predict(self, genome: Genome) -> tuple[float, float]:
+        """Posterior mean and standard deviation of the score."""
+        x = features(genome)
+        if self._chol is None:
+            return 0.0, math.sqrt(self._noise / PRIOR_PRECISION)
+        spread = sum(v * u for v, u in zip(x, _solve(self._chol, x)))
+        return self._dot(x), math.sqrt(self._noise * max(spread, 0.0))
+
+    def ucb(self, genome: Genome) -> float:
+        mean, sd = self.predict(genome)
+        return mean + self.kappa * sd
+
+    def candidates(self, seed: Optional[Genome] = None, top: int = 4) -> list[Genome]:
+        """Neighbours of the best genomes seen so far, best UCB first."""
+        seen = {e.genome for e in self.episodes}
+        parents = sorted(seen, key=lambda g: self.predict(g)[0], reverse=True)[:top]
+        if seed is not None:
+            parents.append(seed)
+        pool = set(parents)
+        for g in parents:
+            pool.update(g.neighbours())
+        return sorted(pool, key=self.ucb, reverse=True)
+
+    def screen(self, candidate: Genome) -> Optional[Genome]:
+        """A better genome to run instead of `candidate`, or None to keep it."""
+        if len(self.episodes) < MIN_EPISODES:
+            return None
+        best = self.candidates(candidate)[0]
+        if best == candidate or self.ucb(best) - self.ucb(candidate) < MARGIN:
+            return None
+        return best
+
+    @property
+    def residual_sd(self) -> float:
+        return math.sqrt(self._noise)
+
+    def coefficients(self) -> list[tuple[str, float, float]]:
+        if self._chol is None:
+            return []
+        out = []
+        for i, name in enumerate(FEATURES):
+            unit = [1.0 if j == i else 0.0 for j in range(len(FEATURES))]
+            out.append((name, self._mean[i], math.sqrt(self._noise * _solve(self._chol, unit)[i])))
+        return out
+
+
+def episodes_from_session(path: str) -> list[Episode]:
+    """Every judged episode in a recorded session, across its lanes.
+
+    A finding is the first occurrence of a normalized kernel message in
+    the recording, as triage.py would have bucketed it live.
+    """
+    entries = list(SessionReader(path).records())
+    trackers: dict[str, EpisodeTracker] = {}
+    templates: set[str] = set()
+    episodes: list[Episode] = []
+    last_t = 0.0
+    for e in entries:
+        name = e.get("lane", "")
+        tracker = trackers.setdefault(name, EpisodeTracker())
+        kind = e.get("k")
+        last_t = float(e.get("t", last_t))
+        if kind == "lane":
+            tracker.os = e.get("os") or None
+        elif kind == "pg" and isinstance(e.get("rec"), dict):
+            episode = tracker.on_device(e["rec"], last_t)
+            if episode is not None:
+                episodes.append(episode)
+        elif kind in KERNEL_SOURCES:
+            if not tracker.on_error(e.get("msg", ""), e.get("host_t")):
+                continue
+            template = normalize(e.get("msg", ""))
+            if template not in templates:
+                templates.add(template)
+                tracker.on_finding()
+    for tracker in trackers.values():
+        episode = tracker.close(last_t)
+        if episode is not None:
+            episodes.append(episode)
+    return episodes
+
+
+def load_episodes(paths: Iterable[str], host: Optional[str] = None) -> list[Episode]:
+    """Episodes from every session in `paths`; with `host`, only lanes labelled that OS or unlabelled."""
+    episodes = []
+    for path in paths:
+        try:
+            episodes += episodes_from_session(path)
+        except OSError as exc:
+            print(f"{path}: {exc}", file=sys.stderr)
+    if host:
+        episodes = [e for e in episodes if e.os in (None, host)]
+    return episodes
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Fit the genome surrogate from recorded sessions")
+    parser.add_argument("logs", nargs="+", help="Recorded sessions (PGSES1 or JSONL)")
+    parser.add_argument("--os", dest="host", help="Only lanes labelled with this OS (and unlabelled ones)")
+    parser.add_argument("--top", type=int, default=10, help="Candidates to list")
+    parser.add_argument("--kappa", type=float, default=KAPPA, help="Exploration weight of the ranking")
+    args = parser.parse_args()
+
+    episodes = load_episodes(args.logs, args.host)
+    if not episodes:
+        print("No episodes of at least "
+              f"{MIN_EPISODE_S:g} s found; were the sessions recorded with Evolve on?", file=sys.stderr)
+        return 1
+    model = Surrogate(args.kappa, episodes)
+    hours = sum(e.seconds for e in episodes) / 3600
+    print(f"{len(episodes)} episodes over {hours:.2f} h, {len({e.genome for e in episodes})} genomes, "
+          f"residual sd {model.residual_sd:.2f}")
+    for name, mean, sd in model.coefficients():
+        print(f"  {name:<14}{mean:+7.3f} ± {sd:.3f}")
+    print(f"{'genome':<28}{'pts/min':>9}{'ucb':>8}")
+    for g in model.candidates(top=8)[:args.top]:
+        mean, _ = model.predict(g)
+        print(f"{g.label():<28}{math.expm1(mean):>9.1f}{model.ucb(g):>8.2f}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,166 @@
+"""Kernel-finding triage: signature bucketing and deduplication of host errors.
+
+Kernel USB messages are normalized (timestamps, addresses, port paths,
+identities and counters stripped) so that one descriptor bug repeated ten
+thousand times lands in a single bucket with a hit count, first-seen time
+and the identity/genome that triggered it first.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import re
+import threading
+import time
+from collections import OrderedDict
+from dataclasses import dataclass, field
+from typing import Any, Callable, Optional
+
+from correlate import Attribution
+
+_NORMALIZERS: list[tuple[re.Pattern[str], str]] = [
+    (re.compile(r"^\s*\[\s*\d+\.\d+\]\s*"), ""),
+    (re.compile(r"^\w{3}\s+\d+\s+[\d:]+\s+\S+\s+kernel:\s*"), ""),
+    # journalctl -o short-monotonic, once its [seconds] stamp is split off.
+    (re.compile(r"^\S+\s+kernel:\s*"), ""),
+    (re.compile(r"((?:Product|Manufacturer|SerialNumber):)\s*.*$"), r"\1 <str>"),
+    # hid-generic's "... Keyboard [<manufacturer> <product>] on usb-...".
+    (re.compile(r"\[[^\]]*\]"), "[<str>]"),
+    (re.compile(r"idVendor=[0-9a-fA-F]{4},\s*idProduct=[0-9a-fA-F]{4}"), "idVendor=<id>, idProduct=<id>"),
+    # HID device names (bus:vid:pid.instance) before the bare vid:pid rule eats half of one.
+    (re.compile(r"\b[0-9a-fA-F]{4}:[0-9a-fA-F]{4}:[0-9a-fA-F]{4}\.[0-9a-fA-F]{4}\b"), "<hid>"),
+    (re.compile(r"\b[0-9a-fA-F]{4}:[0-9a-fA-F]{4}\b"), "<vid:pid>"),
+    (re.compile(r"\b[0-9a-fA-F]{4}:[0-9a-fA-F]{2}:[0-9a-fA-F]{2}\.\d\b"), "<pci>"),
+    (re.compile(r"\b\d+-\d+(?:\.\d+)*(?::\d+\.\d+)?\b"), "<port>"),
+    (re.compile(r"\b0x[0-9a-fA-F]+\b"), "<hex>"),
+    (re.compile(r"\b[0-9a-fA-F]{8,16}\b"), "<addr>"),
+    (re.compile(r"(?<![-\w<])\d+\b"), "N"),
+    (re.compile(r"\s+"), " "),
+]
+
+
+def normalize(message: str) -> str:
+    out = message
+    for pattern, repl in _NORMALIZERS:
+        out = pattern.sub(repl, out)
+    return out.strip()
+
+
+def signature(template: str) -> str:
+    return hashlib.sha1(template.encode("utf-8", "replace")).hexdigest()[:12]
+
+
+@dataclass
+class FindingBucket:
+    signature: str
+    template: str
+    sample: str
+    first_seen: float
+    last_seen: float
+    hits: int = 1
+    identity: Optional[dict[str, Any]] = None
+    lag_ms: Optional[float] = None
+    sources: set[str] = field(default_factory=set)
+    trail: list[dict[str, Any]] = field(default_factory=list)
+    lanes: set[str] = field(default_factory=set)
+
+    def to_dict(self) -> dict[str, Any]:
+        return {
+            "signature": self.signature,
+            "template": self.template,
+            "sample": self.sample,
+            "first_seen": self.first_seen,
+            "last_seen": self.last_seen,
+            "hits": self.hits,
+            "identity": self.identity,
+            "lag_ms": None if self.lag_ms is None else round(self.lag_ms, 1),
+            "sources": sorted(self.sources),
+            "lanes": sorted(self.lanes),
+            "trail": self.trail,
+        }
+
+
+class TriageDB:
+    """Thread-safe finding buckets keyed by normalized kernel signature."""
+
+    def __init__(self, dedupe_window: int = 512, clock: Callable[[], float] = time.time) -> None:
+        self._lock = threading.Lock()
+        self._clock = clock
+        self._buckets: dict[str, FindingBucket] = {}
+        self._recent: OrderedDict[tuple[float, str], None] = OrderedDict()
+        self._dedupe_window = dedupe_window
+        self.total_hits = 0
+
+    def __len__(self) -> int:
+        with self._lock:
+            return len(self._buckets)
+
+    def record(self, message: str, source: str = "kernel", host_t: Optional[float] = None,
+               identity: Optional[dict[str, Any]] = None,
+               lag_ms: Optional[float] = None,
+               trail: Optional[list[dict[str, Any]]] = None,
+               lane: Optional[str] = None) -> tuple[FindingBucket, bool]:
+        """Add one kernel message; returns its bucket and whether it is new."""
+        template = normalize(message)
+        sig = signature(template)
+        now = self._clock()
+        with self._lock:
+            if host_t is not None:
+                # dmesg and journalctl report the same line; count it once.
+                key = (round(host_t, 6), template)
+                if key in self._recent:
+                    return self._buckets[sig], False
+                self._recent[key] = None
+                if len(self._recent) > self._dedupe_window:
+                    self._recent.popitem(last=False)
+
+            self.total_hits += 1
+            bucket = self._buckets.get(sig)
+            if bucket is not None:
+                bucket.hits += 1
+                bucket.last_seen = now
+                bucket.sources.add(source)
+                if lane:
+                    bucket.lanes.add(lane)
+                return bucket, False
+            bucket = FindingBucket(sig, template, message[:240], now, now,
+                                   identity=identity, lag_ms=lag_ms, sources={source},
+                                   trail=trail or [], lanes={lane} if lane else set())
+            self._buckets[sig] = bucket
+            return bucket, True
+
+    def record_attribution(self, att: Attribution,
+                           trail: Optional[list[dict[str, Any]]] = None,
+                           lane: Optional[str] = None) -> tuple[FindingBucket, bool]:
+        identity = att.enum.to_dict() if att.enum else None
+        return self.record(att.event.message, att.event.source, att.event.host_t,
+                           identity, att.lag_ms, trail, lane)
+
+    def findings(self) -> list[FindingBucket]:
+        with self._lock:
+            buckets = list(self._buckets.values())
+        return sorted(buckets, key=lambda b: (-b.hits, b.first_seen))
+
+    def to_list(self, limit: Optional[int] = None) -> list[dict[str, Any]]:
+        return [b.to_dict() for b in self.findings()[:limit]]
+
+    def to_markdown(self) -> str:
+        rows = self.findings()
+        lines = [
+            "# PortGremlin unique findings",
+            "",
+            f"{len(rows)} unique signatures from {self.total_hits} kernel messages.",
+            "",
+            "| Signature | Hits | First seen | Lanes | Trigger | Template |",
+            "|---|---:|---|---|---|---|",
+        ]
+        for b in rows:
+            first = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(b.first_seen))
+            trig = "n/a"
+            if b.identity:
+                idt = b.identity
+                trig = f"{idt['vid']}:{idt['pid']} {idt['cls']} gen {idt['gen']}"
+            template = b.template.replace("|", "\\|")
+            lanes = ", ".join(sorted(b.lanes)) or "-"
+            lines.append(f"| `{b.signature}` | {b.hits} | {first} | {lanes} | {trig} | {template} |")
+        return "\n".join(lines) + "\n"
@@ -0,0 +1,14 @@
+/*
+ * Host stand-in for TivaWare driverlib/interrupt.h. The harness is single
+ * threaded, so masking only reports the (always clear) previous state.
+ */
+
+#ifndef __DRIVERLIB_INTERRUPT_H__
+#define __DRIVERLIB_INTERRUPT_H__
+
+#include <stdbool.h>
+
+bool IntMasterDisable(void);
+bool IntMasterEnable(void);
+
+#endif
@@ -0,0 +1,6 @@
+/* Host stand-in for TivaWare driverlib/rom_map.h; nothing is in ROM here. */
+
+#ifndef __DRIVERLIB_ROM_MAP_H__
+#define __DRIVERLIB_ROM_MAP_H__
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Host stand-in for TivaWare driverlib/uart.h. Received characters come
+ * from the queue filled by PortGremlinHostInput().
+ */
+
+#ifndef __DRIVERLIB_UART_H__
+#define __DRIVERLIB_UART_H__
+
+#include <stdint.h>
+
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base);
+
+#endif
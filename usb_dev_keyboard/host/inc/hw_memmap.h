@@ -0,0 +1,9 @@
+/* Host stand-in for TivaWare inc/hw_memmap.h. */
+
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+#define UART0_BASE                  0x4000C000
+#define USB0_BASE                   0x40050000
+
+#endif
@@ -0,0 +1,676 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "portgremlin_host.h"
+#include "portgremlin_config.h"
+#include "portgremlin_vidpid.h"
+#include "portgremlin_strings.h"
+#include "portgremlin_uart.h"
+#include "portgremlin_oracle.h"
+#include "portgremlin_persona.h"
+#include "portgremlin_telemetry.h"
+#include "portgremlin_evolve.h"
+#include "portgremlin_sof.h"
+#include "portgremlin_mutate.h"
+#include "portgremlin_descriptors.h"
+#include "portgremlin_health.h"
+#include "portgremlin_stack.h"
+#include "portgremlin_bandit.h"
+#include "usb_keyb_structs.h"
+#include "usblib/usblib.h"
+#include "utils/uartstdio.h"
+
+#define HOST_OUT_BYTES  65536
+#define HOST_IN_BYTES   256
+
+/* The simulated core clock; the host's frame clock runs exactly at 1 kHz. */
+#define HOST_CYCLES_PER_SECOND  80000000U
+#define HOST_CYCLES_PER_FRAME   (HOST_CYCLES_PER_SECOND / 1000U)
+
+volatile uint32_t g_ui32SysTickCount;
+DeviceType g_eCurrentDevice = DEVICE_KEYBOARD;
+VIDPIDDeviceType g_eCurrentDeviceType = VIDPID_TYPE_KEYBOARD;
+void *g_pActiveDevice = NULL;
+
+static volatile bool g_bConnected;
+static uint32_t g_ui32TickCounter;
+static uint32_t g_ui32Cycles;
+static uint32_t g_ui32Frame;
+static bool g_bBusActive;
+static uint32_t g_ui32ResetFrames;
+
+static char g_pcOut[HOST_OUT_BYTES];
+static uint32_t g_ui32OutLen;
+
+static char g_pcIn[HOST_IN_BYTES];
+static uint32_t g_ui32InHead;
+static uint32_t g_ui32InTail;
+
+static uint64_t g_ui64RandNext = 1;
+static uint32_t g_ui32MutateOps;
+static uint32_t g_ui32Seed;
+
+
+/*
+ * The Makefile maps rand()/srand() here so each loaded copy of the library
+ * has its own generator. Same LCG as newlib, so a given seed walks the same
+ * sequence as the firmware image.
+ */
+void PortGremlinHostSrand(unsigned int uiSeed)
+{
+    g_ui64RandNext = uiSeed;
+}
+
+int PortGremlinHostRand(void)
+{
+    g_ui64RandNext = g_ui64RandNext * 6364136223846793005ULL + 1U;
+    return (int)((g_ui64RandNext >> 32) & 0x7FFFFFFFU);
+}
+
+int UARTwrite(const char *pcBuf, uint32_t ui32Len)
+{
+    if (ui32Len > HOST_OUT_BYTES - g_ui32OutLen)
+    {
+        ui32Len = HOST_OUT_BYTES - g_ui32OutLen;
+    }
+    memcpy(g_pcOut + g_ui32OutLen, pcBuf, ui32Len);
+    g_ui32OutLen += ui32Len;
+    return (int)ui32Len;
+}
+
+void UARTvprintf(const char *pcString, va_list vaArgP)
+{
+    char pcLine[256];
+    int iLen = vsnprintf(pcLine, sizeof(pcLine), pcString, vaArgP);
+
+    if (iLen < 0)
+    {
+        return;
+    }
+    if (iLen >= (int)sizeof(pcLine))
+    {
+        iLen = (int)sizeof(pcLine) - 1;
+    }
+    UARTwrite(pcLine, (uint32_t)iLen);
+}
+
+void UARTprintf(const char *pcString, ...)
+{
+    va_list vaArgP;
+
+    va_start(vaArgP, pcString);
+    UARTvprintf(pcString, vaArgP);
+    va_end(vaArgP);
+}
+
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base)
+{
+    char cChar;
+
+    (void)ui32Base;
+    if (g_ui32InHead == g_ui32InTail)
+    {
+        return -1;
+    }
+    cChar = g_pcIn[g_ui32InTail];
+    g_ui32InTail = (g_ui32InTail + 1U) % HOST_IN_BYTES;
+    return (int32_t)(uint8_t)cChar;
+}
+
+bool IntMasterDisable(void)
+{
+    return false;
+}
+
+bool IntMasterEnable(void)
+{
+    return false;
+}
+
+uint32_t PortGremlinCycleCount(void)
+{
+    return g_ui32Cycles;
+}
+
+static uint32_t HostDeviceEvent(uint32_t ui32Event)
+{
+    PortGremlinOracleOnEvent(ui32Event);
+
+    switch (ui32Event)
+    {
+        case USB_EVENT_CONNECTED:
+            g_bConnected = true;
+            g_bBusActive = true;
+            break;
+
+        case USB_EVENT_DISCONNECTED:
+            g_bConnected = false;
+            g_bBusActive = false;
+            break;
+
+        case USB_EVENT_RESET:
+            g_ui32ResetFrames = PORTGREMLIN_SOF_FRAMES_PER_TICK;
+            break;
+
+        default:
+            break;
+    }
+    return 0;
+}
+
+uint32_t KeyboardHandler(void *pvCBData, uint32_t ui32Event,
+                         uint32_t ui32MsgData, void *pvMsgData)
+{
+    (void)pvCBData;
+    (void)ui32MsgData;
+    (void)pvMsgData;
+    return HostDeviceEvent(ui32Event);
+}
+
+uint32_t AudioHandler(void *pvCBData, uint32_t ui32Event,
+                      uint32_t ui32MsgParam, void *pvMsgData)
+{
+    (void)pvCBData;
+    (void)ui32MsgParam;
+    (void)pvMsgData;
+    return HostDeviceEvent(ui32Event);
+}
+
+uint32_t GamepadHandler(void *pvCBData, uint32_t ui32Event,
+                        uint32_t ui32MsgParam, void *pvMsgData)
+{
+    (void)pvCBData;
+    (void)ui32MsgParam;
+    (void)pvMsgData;
+    return HostDeviceEvent(ui32Event);
+}
+
+uint32_t MIDIHandler(void *pvCBData, uint32_t ui32Event,
+                     uint32_t ui32MsgParam, void *pvMsgData)
+{
+    (void)pvCBData;
+    (void)ui32MsgParam;
+    (void)pvMsgData;
+    return HostDeviceEvent(ui32Event);
+}
+
+uint32_t PrinterHandler(void *pvCBData, uint32_t ui32Event,
+                        uint32_t ui32MsgParam, void *pvMsgData)
+{
+    (void)pvCBData;
+    (void)ui32MsgParam;
+    (void)pvMsgData;
+    return HostDeviceEvent(ui32Event);
+}
+
+static void *HostDeviceForType(VIDPIDDeviceType eType)
+{
+    switch (eType)
+    {
+        case VIDPID_TYPE_KEYBOARD:
+            return &g_sKeyboardDevice;
+        case VIDPID_TYPE_AUDIO:
+            return &g_sAudioDevice;
+        case VIDPID_TYPE_GAMEPAD:
+            return &g_sGamepadDevice;
+        case VIDPID_TYPE_MIDI:
+            return &g_sMIDIDevice;
+        case VIDPID_TYPE_PRINTER:
+            return &g_sPrinterDevice;
+        default:
+            return NULL;
+    }
+}
+
+static void HostDeviceIdentity(DeviceType eDevice, PortGremlinHostState *psState,
+                               const uint8_t * const **pppui8Strings)
+{
+    switch (eDevice)
+    {
+        case DEVICE_KEYBOARD:
+            psState->ui32VID = g_sKeyboardDevice.ui16VID;
+            psState->ui32PID = g_sKeyboardDevice.ui16PID;
+            psState->ui32MaxPowermA = g_sKeyboardDevice.ui16MaxPowermA;
+            psState->ui32PwrAttributes = g_sKeyboardDevice.ui8PwrAttributes;
+            *pppui8Strings = g_ppui8StringDescriptorsKeyboard;
+            break;
+        case DEVICE_AUDIO:
+            psState->ui32VID = g_sAudioDevice.ui16VID;
+            psState->ui32PID = g_sAudioDevice.ui16PID;
+            psState->ui32MaxPowermA = g_sAudioDevice.ui16MaxPowermA;
+            psState->ui32PwrAttributes = g_sAudioDevice.ui8PwrAttributes;
+            *pppui8Strings = g_ppui8StringDescriptorsAudio;
+            break;
+        case DEVICE_GAMEPAD:
+            psState->ui32VID = g_sGamepadDevice.ui16VID;
+            psState->ui32PID = g_sGamepadDevice.ui16PID;
+            psState->ui32MaxPowermA = g_sGamepadDevice.ui16MaxPowermA;
+            psState->ui32PwrAttributes = g_sGamepadDevice.ui8PwrAttributes;
+            *pppui8Strings = g_ppui8StringDescriptorsGamepad;
+            break;
+        case DEVICE_MIDI:
+            psState->ui32VID = g_sMIDIDevice.ui16VID;
+            psState->ui32PID = g_sMIDIDevice.ui16PID;
+            psState->ui32MaxPowermA = g_sMIDIDevice.ui16MaxPowermA;
+            psState->ui32PwrAttributes = g_sMIDIDevice.ui8PwrAttributes;
+            *pppui8Strings = g_ppui8StringDescriptorsMIDI;
+            break;
+        case DEVICE_PRINTER:
+            psState->ui32VID = g_sPrinterDevice.ui16VID;
+            psState->ui32PID = g_sPrinterDevice.ui16PID;
+            psState->ui32MaxPowermA = g_sPrinterDevice.ui16MaxPowermA;
+            psState->ui32PwrAttributes = g_sPrinterDevice.ui8PwrAttributes;
+            *pppui8Strings = g_ppui8StringDescriptorsPrinter;
+            break;
+        default:
+            *pppui8Strings = NULL;
+            break;
+    }
+}
+
+/* Lossy UTF-16LE string descriptor to ASCII for display. */
+static void HostDescriptorText(const uint8_t *pui8Desc, char *pcOut, uint32_t ui32Max)
+{
+    uint32_t ui32Chars = 0;
+    uint32_t ui32Pos;
+
+    if (pui8Desc && pui8Desc[0] >= 2U)
+    {
+        for (ui32Pos = 2; ui32Pos + 1U < pui8Desc[0] && ui32Chars < ui32Max - 1U;
+             ui32Pos += 2)
+        {
+            uint8_t ui8Char = pui8Desc[ui32Pos];
+            pcOut[ui32Chars++] = (ui8Char >= 0x20U && ui8Char < 0x7FU &&
+                                  pui8Desc[ui32Pos + 1U] == 0U) ? (char)ui8Char : '?';
+        }
+    }
+    pcOut[ui32Chars] = '\0';
+}
+
+/*
+ * Mirrors MutateDescriptors() on the current class's descriptor set, with
+ * VID/PID and power patched in as usblib and ClassDeviceInit() do.
+ */
+static void HostMutateDescriptors(void)
+{
+    const PortGremlinSettings *psSettings = PortGremlinConfigCurrent();
+    const PortGremlinClassDescriptors *psDesc = PortGremlinDescriptorsFor(g_eCurrentDevice);
+    const PortGremlinDescSet *psSet;
+    PortGremlinHostState sIdentity;
+    const uint8_t * const *ppui8Strings;
+    uint8_t pui8Device[PORTGREMLIN_DESC_DEVICE_LEN];
+    uint8_t *pui8Config = PortGremlinMutateConfigSlot();
+
+    g_ui32MutateOps = 0;
+    if (!psSettings->bMalformedMode || psSettings->ui8MutateOps == 0U || !psDesc ||
+        psDesc->ui16ConfigLen > PORTGREMLIN_MUTATE_CONFIG_BYTES)
+    {
+        return;
+    }
+
+    HostDeviceIdentity(g_eCurrentDevice, &sIdentity, &ppui8Strings);
+    PortGremlinDescriptorsDevice(g_eCurrentDevice, (uint16_t)sIdentity.ui32VID,
+                                 (uint16_t)sIdentity.ui32PID, pui8Device);
+    PortGremlinDescriptorsConfigHeader(g_eCurrentDevice, (uint16_t)sIdentity.ui32MaxPowermA,
+                                       (uint8_t)sIdentity.ui32PwrAttributes, pui8Config);
+    memcpy(pui8Config + PORTGREMLIN_DESC_CONFIG_LEN,
+           psDesc->pui8Config + PORTGREMLIN_DESC_CONFIG_LEN,
+           psDesc->ui16ConfigLen - PORTGREMLIN_DESC_CONFIG_LEN);
+    if (!PortGremlinMutateLoad(pui8Device, pui8Config, psDesc->ui16ConfigLen,
+                               psDesc->pui8Report, psDesc->ui16ReportLen))
+    {
+        return;
+    }
+    psSet = PortGremlinMutateApply(psSettings->ui8MutateOps);
+    g_ui32MutateOps = psSet ? psSet->ui32Ops : 0U;
+}
+
+/* Mirrors ReenumerateWithRandomVIDPID() without the USB controller calls. */
+static void HostReenumerate(VIDPIDDeviceType eType)
+{
+    void *pDevice = HostDeviceForType(eType);
+    PortGremlinHostState sIdentity;
+    const uint8_t * const *ppui8Strings;
+
+    UARTprintf("Re-enumerating USB with new identity...\n\r");
+
+    PortGremlinRandomizeIdentity(g_eCurrentDevice);
+
+    if (pDevice)
+    {
+        PortGremlinRandomizeVIDPID(pDevice, eType);
+        HostMutateDescriptors();
+        HostDeviceIdentity(g_eCurrentDevice, &sIdentity, &ppui8Strings);
+        UARTprintf("New VID: 0x%04X, PID: 0x%04X\n\r", sIdentity.ui32VID, sIdentity.ui32PID);
+    }
+    else
+    {
+        UARTprintf("Unknown device type for re-enumeration.\n\r");
+    }
+
+    g_sConfig.ui32EnumCount++;
+    PortGremlinTelemetryCurrentIdentity();
+    PortGremlinOracleOnEnumerate();
+    PortGremlinEvolveTick();
+    PortGremlinHealthOnConnect();
+}
+
+/* Mirrors CycleDeviceType() without the USB controller calls. */
+static void HostCycleDeviceType(void)
+{
+    DeviceType eNext = PortGremlinNextEnabledDevice(g_eCurrentDevice);
+
+    if (eNext == g_eCurrentDevice && !PortGremlinConfigCurrent()->bClassEnabled[g_eCurrentDevice])
+    {
+        UARTprintf("No enabled device classes.\n\r");
+        return;
+    }
+
+    g_eCurrentDevice = eNext;
+    g_eCurrentDeviceType = PortGremlinDeviceVIDPIDType(g_eCurrentDevice);
+    PortGremlinRandomizeIdentity(g_eCurrentDevice);
+    UARTprintf("Switching to %s...\n", PortGremlinDeviceName(g_eCurrentDevice));
+
+    switch (g_eCurrentDevice)
+    {
+        case DEVICE_KEYBOARD:
+            g_sKeyboardDevice = g_sKeyboardTemplate;
+            break;
+        case DEVICE_AUDIO:
+            g_sAudioDevice = g_sAudioTemplate;
+            break;
+        case DEVICE_PRINTER:
+            g_sPrinterDevice = g_sPrinterTemplate;
+            break;
+        case DEVICE_MIDI:
+            g_sMIDIDevice = g_sMIDITemplate;
+            break;
+        case DEVICE_GAMEPAD:
+            g_sGamepadDevice = g_sGamepadTemplate;
+            break;
+        default:
+            break;
+    }
+    g_pActiveDevice = HostDeviceForType(g_eCurrentDeviceType);
+    PortGremlinRandomizeVIDPID(g_pActiveDevice, g_eCurrentDeviceType);
+    HostMutateDescriptors();
+
+    g_sConfig.ui32CycleCount++;
+    PortGremlinHealthOnConnect();
+}
+
+/*
+ * One SysTick of core cycles. While the host is driving the bus each 1 ms
+ * of it ends in a SOF, as PortGremlinUSBIntHandler() would see it, except
+ * for the 10 ms of SE0 that follow a bus reset.
+ */
+static void HostFrames(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < PORTGREMLIN_SOF_FRAMES_PER_TICK; i++)
+    {
+        g_ui32Cycles += HOST_CYCLES_PER_FRAME;
+        if (!g_bBusActive)
+        {
+            continue;
+        }
+        g_ui32Frame = (g_ui32Frame + 1U) & 0x7FFU;
+        if (g_ui32ResetFrames != 0U)
+        {
+            g_ui32ResetFrames--;
+            continue;
+        }
+        PortGremlinSofObserve(g_ui32Frame);
+    }
+}
+
+/* Mirrors SysTickIntHandler(). */
+static void HostSysTick(void)
+{
+    PortGremlinSettings sSettings;
+
+    g_ui32SysTickCount++;
+
+    PortGremlinHealthTick(false);
+
+    PortGremlinConfigRead(&sSettings);
+    if (!sSettings.bAutoCycle)
+    {
+        return;
+    }
+
+    g_ui32TickCounter++;
+    if (g_ui32TickCounter < sSettings.ui32CycleIntervalTicks)
+    {
+        return;
+    }
+    g_ui32TickCounter = 0;
+
+    if (!sSettings.bClassEnabled[g_eCurrentDevice])
+    {
+        g_eCurrentDevice = PortGremlinNextEnabledDevice(g_eCurrentDevice);
+        g_eCurrentDeviceType = PortGremlinDeviceVIDPIDType(g_eCurrentDevice);
+    }
+
+    HostReenumerate(g_eCurrentDeviceType);
+    g_eCurrentDevice = PortGremlinNextEnabledDevice(g_eCurrentDevice);
+    g_eCurrentDeviceType = PortGremlinDeviceVIDPIDType(g_eCurrentDevice);
+}
+
+/* One pass of the connected main loop, which the firmware paces to SysTick. */
+static void HostMainLoopPass(void)
+{
+    PortGremlinUARTPoll();
+    PortGremlinBrainTick();
+    PortGremlinBanditTick();
+    PortGremlinChoreoTick();
+    PortGremlinEvolveTick();
+
+    if (g_sConfig.bForceCycle)
+    {
+        g_sConfig.bForceCycle = false;
+        HostCycleDeviceType();
+    }
+    else if (g_sConfig.bForceReenum)
+    {
+        g_sConfig.bForceReenum = false;
+        HostReenumerate(g_eCurrentDeviceType);
+    }
+    PortGremlinHealthService();
+    PortGremlinStackService();
+}
+
+/* Mirrors the firmware's main() up to the main loop, as after a reset. */
+static void HostBoot(bool bPowerOn)
+{
+    g_ui32SysTickCount = 0;
+    g_ui32TickCounter = 0;
+    g_bBusActive = false;
+    g_ui32ResetFrames = 0;
+    g_ui32MutateOps = 0;
+    g_bConnected = false;
+
+    PortGremlinHostSrand(g_ui32Seed);
+
+    PortGremlinConfigInit();
+    PortGremlinOracleInit();
+    PortGremlinPersonaInit();
+    PortGremlinTelemetryInit();
+    PortGremlinEvolveInit();
+    PortGremlinBanditInit();
+    PortGremlinSofInit(HOST_CYCLES_PER_SECOND);
+    UsbKeybStructsInit();
+    PortGremlinHealthInit(bPowerOn, false);
+    PortGremlinStackInit();
+
+    g_sKeyboardDevice = g_sKeyboardTemplate;
+    g_eCurrentDevice = DEVICE_KEYBOARD;
+    g_eCurrentDeviceType = VIDPID_TYPE_KEYBOARD;
+    g_pActiveDevice = &g_sKeyboardDevice;
+    PortGremlinRandomizeIdentity(DEVICE_KEYBOARD);
+    PortGremlinRandomizeVIDPID(&g_sKeyboardDevice, VIDPID_TYPE_KEYBOARD);
+    PortGremlinHealthOnConnect();
+}
+
+/* A controller reset detaches from the bus until the host resets it again. */
+void PortGremlinHealthResetUSB(void)
+{
+    UARTprintf("No progress; resetting the USB controller...\n\r");
+    g_bConnected = false;
+    g_bBusActive = false;
+    PortGremlinHealthOnConnect();
+}
+
+void PortGremlinHealthResetSystem(void)
+{
+    HostBoot(false);
+}
+
+/* The library runs on the caller's stack; there is no MCU SRAM to report. */
+void PortGremlinStackLayout(PortGremlinMemLayout *psLayout)
+{
+    memset(psLayout, 0, sizeof(*psLayout));
+}
+
+void PortGremlinHostInit(uint32_t ui32Seed)
+{
+    g_ui32Cycles = 0;
+    g_ui32Frame = 0;
+    g_ui32OutLen = 0;
+    g_ui32InHead = 0;
+    g_ui32InTail = 0;
+    g_ui32Seed = ui32Seed;
+
+    HostBoot(true);
+}
+
+/*
+ * Advance up to ui32Ticks SysTicks, running one main-loop pass after each.
+ * Returns early, after the tick that produced it, on any (re-)enumeration
+ * so the caller can put the host's reaction at the right time.
+ */
+uint32_t PortGremlinHostRun(uint32_t ui32Ticks)
+{
+    uint32_t ui32Ran = 0;
+
+    while (ui32Ran < ui32Ticks)
+    {
+        uint32_t ui32Enums = g_sConfig.ui32EnumCount + g_sConfig.ui32CycleCount;
+
+        HostFrames();
+        HostSysTick();
+        HostMainLoopPass();
+        ui32Ran++;
+
+        if (g_sConfig.ui32EnumCount + g_sConfig.ui32CycleCount != ui32Enums)
+        {
+            break;
+        }
+    }
+    return ui32Ran;
+}
+
+void PortGremlinHostInput(const char *pcChars, uint32_t ui32Len)
+{
+    while (ui32Len--)
+    {
+        uint32_t ui32Next = (g_ui32InHead + 1U) % HOST_IN_BYTES;
+
+        if (ui32Next == g_ui32InTail)
+        {
+            return;
+        }
+        g_pcIn[g_ui32InHead] = *pcChars++;
+        g_ui32InHead = ui32Next;
+    }
+}
+
+uint32_t PortGremlinHostOutput(char *pcBuf, uint32_t ui32Max)
+{
+    uint32_t ui32Len = g_ui32OutLen < ui32Max ? g_ui32OutLen : ui32Max;
+
+    memcpy(pcBuf, g_pcOut, ui32Len);
+    memmove(g_pcOut, g_pcOut + ui32Len, g_ui32OutLen - ui32Len);
+    g_ui32OutLen -= ui32Len;
+    return ui32Len;
+}
+
+void PortGremlinHostConnect(void)
+{
+    HostDeviceEvent(USB_EVENT_CONNECTED);
+}
+
+void PortGremlinHostBusReset(void)
+{
+    HostDeviceEvent(USB_EVENT_RESET);
+}
+
+void PortGremlinHostConfigure(void)
+{
+    HostDeviceEvent(USB_EVENT_CONFIG_SET);
+}
+
+void PortGremlinHostDisconnect(void)
+{
+    HostDeviceEvent(USB_EVENT_DISCONNECTED);
+}
+
+void PortGremlinHostSnapshot(PortGremlinHostState *psState)
+{
+    const uint8_t * const *ppui8Strings;
+    PortGremlinSettings sSettings;
+    PortGremlinHealthTotals sTotals;
+
+    memset(psState, 0, sizeof(*psState));
+    psState->ui32Tick = g_ui32SysTickCount;
+    psState->ui32EnumCount = g_sConfig.ui32EnumCount;
+    psState->ui32CycleCount = g_sConfig.ui32CycleCount;
+    psState->ui32Device = (uint32_t)g_eCurrentDevice;
+    HostDeviceIdentity(g_eCurrentDevice, psState, &ppui8Strings);
+    psState->ui32ConfigVersion = PortGremlinConfigRead(&sSettings);
+    psState->ui32Flags = PortGremlinConfigFlagsOf(&sSettings);
+    psState->ui32IntervalTicks = sSettings.ui32CycleIntervalTicks;
+    psState->ui32Connected = g_bConnected;
+    psState->ui32Persona = (uint32_t)g_ePersona;
+    psState->ui32Host = (uint32_t)g_sOracle.eHost;
+    psState->ui32BrainActive = g_sOracle.bBrainActive;
+    psState->ui32BrainPhase = (uint32_t)g_sOracle.eBrainPhase;
+    psState->ui32Tolerance = g_sOracle.ui32ToleranceScore;
+    psState->ui32StableEnums = g_sOracle.ui32StableEnums;
+    psState->ui32Disconnects = g_sOracle.ui32Disconnects;
+    psState->ui32Resets = g_sOracle.ui32ResetCount;
+    psState->ui32ConfigLatencyTicks = g_sOracle.ui32ConfigLatencyTicks;
+    psState->ui32ConfigLatencyFrames = g_sOracle.ui32ConfigLatencyFrames;
+    psState->ui32PinnedVID = sSettings.ui16PinnedVID;
+    psState->ui32PinnedPID = sSettings.ui16PinnedPID;
+    psState->ui32EvolveActive = g_bEvolveActive;
+    psState->ui32Generation = g_ui32EvolveGeneration;
+    psState->ui32GenomeInterval = g_sGenome.ui8Interval;
+    psState->ui32GenomeMalformed = g_sGenome.ui8Malformed;
+    psState->ui32GenomeRealVid = g_sGenome.ui8RealVid;
+    psState->ui32GenomeContradiction = g_sGenome.ui8Contradiction;
+    psState->ui32GenomeFitness = g_sGenome.ui32Fitness;
+    psState->ui32GenomeMutations = g_sGenome.ui8Mutations;
+    psState->ui32MutateOps = g_ui32MutateOps;
+    PortGremlinHealthTotalsGet(&sTotals);
+    psState->ui32Boots = sTotals.ui32Boots;
+    psState->ui32UsbResets = sTotals.ui32UsbResets;
+    psState->ui32FullResets = sTotals.ui32FullResets;
+    psState->ui32DowntimeTicks = sTotals.ui32DowntimeTicks;
+    psState->ui32BanditActive = g_sBandit.bActive;
+    psState->ui32BanditRounds = g_sBandit.ui32Rounds;
+    if (ppui8Strings)
+    {
+        HostDescriptorText(ppui8Strings[1], psState->pcManufacturer,
+                           sizeof(psState->pcManufacturer));
+        HostDescriptorText(ppui8Strings[2], psState->pcProduct, sizeof(psState->pcProduct));
+    }
+}
+
+uint32_t PortGremlinHostStateSize(void)
+{
+    return sizeof(PortGremlinHostState);
+}
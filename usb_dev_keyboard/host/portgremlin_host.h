@@ -0,0 +1,71 @@
+#ifndef PORTGREMLIN_HOST_H
+#define PORTGREMLIN_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "portgremlin_strings.h"
+
+/*
+ * Host-native harness around the portable PortGremlin modules, built as
+ * libportgremlin_host.so by "make host" and driven from tools/cosim.py.
+ * Time only advances through PortGremlinHostRun(), one 10 ms SysTick at a
+ * time, and the USB host is whoever calls the bus event functions.
+ */
+
+typedef struct
+{
+    uint32_t ui32Tick;
+    uint32_t ui32EnumCount;
+    uint32_t ui32CycleCount;
+    uint32_t ui32Device;
+    uint32_t ui32VID;
+    uint32_t ui32PID;
+    uint32_t ui32MaxPowermA;
+    uint32_t ui32PwrAttributes;
+    uint32_t ui32Flags;
+    uint32_t ui32IntervalTicks;
+    uint32_t ui32Connected;
+    uint32_t ui32Persona;
+    uint32_t ui32Host;
+    uint32_t ui32BrainActive;
+    uint32_t ui32BrainPhase;
+    uint32_t ui32Tolerance;
+    uint32_t ui32StableEnums;
+    uint32_t ui32Disconnects;
+    uint32_t ui32Resets;
+    uint32_t ui32ConfigLatencyTicks;
+    uint32_t ui32PinnedVID;
+    uint32_t ui32PinnedPID;
+    uint32_t ui32EvolveActive;
+    uint32_t ui32Generation;
+    uint32_t ui32GenomeInterval;
+    uint32_t ui32GenomeMalformed;
+    uint32_t ui32GenomeRealVid;
+    uint32_t ui32GenomeContradiction;
+    uint32_t ui32GenomeFitness;
+    uint32_t ui32ConfigVersion;
+    uint32_t ui32ConfigLatencyFrames;
+    uint32_t ui32GenomeMutations;
+    uint32_t ui32MutateOps;
+    uint32_t ui32Boots;
+    uint32_t ui32UsbResets;
+    uint32_t ui32FullResets;
+    uint32_t ui32DowntimeTicks;
+    uint32_t ui32BanditActive;
+    uint32_t ui32BanditRounds;
+    char pcManufacturer[PORTGREMLIN_STRING_MAX_CHARS + 1];
+    char pcProduct[PORTGREMLIN_STRING_MAX_CHARS + 1];
+} PortGremlinHostState;
+
+void PortGremlinHostInit(uint32_t ui32Seed);
+uint32_t PortGremlinHostRun(uint32_t ui32Ticks);
+void PortGremlinHostInput(const char *pcChars, uint32_t ui32Len);
+uint32_t PortGremlinHostOutput(char *pcBuf, uint32_t ui32Max);
+void PortGremlinHostConnect(void);
+void PortGremlinHostBusReset(void);
+void PortGremlinHostConfigure(void);
+void PortGremlinHostDisconnect(void);
+void PortGremlinHostSnapshot(PortGremlinHostState *psState);
+uint32_t PortGremlinHostStateSize(void);
+
+#endif
@@ -0,0 +1,30 @@
+/*
+ * Host stand-in for TivaWare usblib/device/usbdhidkeyb.h. The leading
+ * fields match the real tUSBDHIDKeyboardDevice so the template initializers
+ * in portgremlin_strings.c compile unchanged.
+ */
+
+#ifndef __USBDHIDKEYB_H__
+#define __USBDHIDKEYB_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usblib/usblib.h"
+
+typedef uint32_t (*tUSBCallback)(void *pvCBData, uint32_t ui32Event,
+                                 uint32_t ui32MsgParam, void *pvMsgData);
+
+typedef struct
+{
+    uint16_t ui16VID;
+    uint16_t ui16PID;
+    uint16_t ui16MaxPowermA;
+    uint8_t ui8PwrAttributes;
+    tUSBCallback pfnCallback;
+    void *pvCBData;
+    const uint8_t * const *ppui8StringDescriptors;
+    uint32_t ui32NumStringDescriptors;
+}
+tUSBDHIDKeyboardDevice;
+
+#endif
@@ -0,0 +1,9 @@
+/* Host stand-in for TivaWare usblib/usb-ids.h. */
+
+#ifndef __USBIDS_H__
+#define __USBIDS_H__
+
+#define USB_VID_TI_1CBE             0x1CBE
+#define USB_PID_KEYBOARD            0x0001
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * Host stand-in for TivaWare usblib/usblib.h: only the event codes and
+ * descriptor constants the portable PortGremlin modules use.
+ */
+
+#ifndef __USBLIB_H__
+#define __USBLIB_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define USB_EVENT_CONNECTED         0x0000
+#define USB_EVENT_DISCONNECTED      0x0001
+#define USB_EVENT_RX_AVAILABLE      0x0002
+#define USB_EVENT_TX_COMPLETE       0x0005
+#define USB_EVENT_SUSPEND           0x0007
+#define USB_EVENT_RESUME            0x0008
+#define USB_EVENT_RESET             0x0020
+#define USB_EVENT_CONFIG_SET        0x0021
+
+#define USB_DTYPE_STRING            3
+#define USB_LANG_EN_US              0x0409
+#define USBShort(ui16Value)         ((ui16Value) & 0xff), ((ui16Value) >> 8)
+
+#define USB_CONF_ATTR_SELF_PWR      0xC0
+#define USB_CONF_ATTR_BUS_PWR       0x80
+#define USB_CONF_ATTR_RWAKE         0xA0
+
+#endif
@@ -0,0 +1,16 @@
+/*
+ * Host stand-in for TivaWare utils/uartstdio.h. UARTprintf output is
+ * captured by portgremlin_host.c and drained with PortGremlinHostOutput().
+ */
+
+#ifndef __UARTSTDIO_H__
+#define __UARTSTDIO_H__
+
+#include <stdarg.h>
+#include <stdint.h>
+
+void UARTprintf(const char *pcString, ...);
+void UARTvprintf(const char *pcString, va_list vaArgP);
+int UARTwrite(const char *pcBuf, uint32_t ui32Len);
+
+#endif
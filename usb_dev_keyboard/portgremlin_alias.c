@@ -0,0 +1,107 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "portgremlin_alias.h"
+#include "portgremlin_telemetry.h"
+#include "portgremlin_alias_table.h"
+
+#define ALIAS_COUNT     (sizeof(g_psAliases) / sizeof(g_psAliases[0]))
+#define ALIAS_WALK_LEN  (sizeof(g_pui16AliasWalk) / sizeof(g_pui16AliasWalk[0]))
+
+static uint32_t g_ui32AliasCursor;
+
+static uint32_t AliasClassBit(VIDPIDDeviceType eType)
+{
+    switch (eType)
+    {
+        case VIDPID_TYPE_KEYBOARD:
+            return 1U << DEVICE_KEYBOARD;
+        case VIDPID_TYPE_AUDIO:
+            return 1U << DEVICE_AUDIO;
+        case VIDPID_TYPE_PRINTER:
+            return 1U << DEVICE_PRINTER;
+        case VIDPID_TYPE_MIDI:
+            return 1U << DEVICE_MIDI;
+        case VIDPID_TYPE_GAMEPAD:
+            return 1U << DEVICE_GAMEPAD;
+        default:
+            return 0;
+    }
+}
+
+uint32_t PortGremlinAliasCount(void)
+{
+    return ALIAS_COUNT;
+}
+
+uint32_t PortGremlinAliasCursor(void)
+{
+    return g_ui32AliasCursor;
+}
+
+bool PortGremlinAliasRewind(uint32_t ui32Pos)
+{
+    if (ui32Pos >= ALIAS_WALK_LEN)
+    {
+        return false;
+    }
+    g_ui32AliasCursor = ui32Pos;
+    return true;
+}
+
+/*
+ * Takes the next identity in walk order that binds for eType, skipping the
+ * ones that only bind for other classes. Returns false, leaving the cursor
+ * where it was, if none does.
+ */
+bool PortGremlinAliasNext(VIDPIDDeviceType eType, uint16_t *pui16VID, uint16_t *pui16PID)
+{
+    uint32_t ui32Bit = AliasClassBit(eType);
+    uint32_t ui32Pos = g_ui32AliasCursor;
+
+    for (uint32_t i = 0; i < ALIAS_WALK_LEN; i++)
+    {
+        const PortGremlinAlias *psAlias = &g_psAliases[g_pui16AliasWalk[ui32Pos]];
+        uint32_t ui32Step = ui32Pos;
+
+        ui32Pos = ui32Pos + 1U < ALIAS_WALK_LEN ? ui32Pos + 1U : 0U;
+        if (psAlias->ui8Classes & ui32Bit)
+        {
+            g_ui32AliasCursor = ui32Pos;
+            *pui16VID = psAlias->ui16VID;
+            *pui16PID = psAlias->ui16PID;
+            PortGremlinTelemetryAlias(ui32Step, psAlias->ui16VID, psAlias->ui16PID,
+                                      g_ppcAliasModules[psAlias->ui16Module]);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *PortGremlinAliasDriver(uint16_t ui16VID, uint16_t ui16PID)
+{
+    uint32_t ui32Key = ((uint32_t)ui16VID << 16) | ui16PID;
+    uint32_t ui32Lo = 0;
+    uint32_t ui32Hi = ALIAS_COUNT;
+
+    while (ui32Lo < ui32Hi)
+    {
+        uint32_t ui32Mid = (ui32Lo + ui32Hi) / 2U;
+        const PortGremlinAlias *psAlias = &g_psAliases[ui32Mid];
+        uint32_t ui32Entry = ((uint32_t)psAlias->ui16VID << 16) | psAlias->ui16PID;
+
+        if (ui32Entry == ui32Key)
+        {
+            return g_ppcAliasModules[psAlias->ui16Module];
+        }
+        if (ui32Entry < ui32Key)
+        {
+            ui32Lo = ui32Mid + 1U;
+        }
+        else
+        {
+            ui32Hi = ui32Mid;
+        }
+    }
+    return NULL;
+}
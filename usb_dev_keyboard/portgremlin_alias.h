@@ -0,0 +1,33 @@
+#ifndef PORTGREMLIN_ALIAS_H
+#define PORTGREMLIN_ALIAS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_keyb_structs.h"
+
+/*
+ * Driver-matching identities compiled from a lab host's modules.alias by
+ * tools/portgremlin-aliasgen.py into portgremlin_alias_table.h. With the
+ * alias walk on, every enumeration takes the next identity in the table's
+ * walk order that binds a driver for the class being presented; the walk
+ * is round-robin over modules, so consecutive enumerations reach different
+ * driver probe paths. PortGremlinAliasDriver() answers which module an
+ * identity binds, by binary search over the VID/PID-sorted table.
+ */
+
+typedef struct
+{
+    uint16_t ui16VID;
+    uint16_t ui16PID;
+    uint16_t ui16Module;
+    /* Bit n set if DeviceType n binds this module as presented. */
+    uint8_t ui8Classes;
+} PortGremlinAlias;
+
+uint32_t PortGremlinAliasCount(void);
+uint32_t PortGremlinAliasCursor(void);
+bool PortGremlinAliasRewind(uint32_t ui32Pos);
+bool PortGremlinAliasNext(VIDPIDDeviceType eType, uint16_t *pui16VID, uint16_t *pui16PID);
+const char *PortGremlinAliasDriver(uint16_t ui16VID, uint16_t ui16PID);
+
+#endif
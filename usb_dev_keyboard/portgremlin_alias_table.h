@@ -0,0 +1,43 @@
+#ifndef PORTGREMLIN_ALIAS_TABLE_H
+#define PORTGREMLIN_ALIAS_TABLE_H
+
+/*
+ * USB identities that bind a kernel driver on the lab host, for the
+ * alias walk. Generated by tools/portgremlin-aliasgen.py --emit; re-run it
+ * against the host's modules.alias rather than editing by hand.
+ *
+ * Hand-picked defaults, not yet generated from a lab host: USB serial,
+ * network and DVB adapters whose drivers match on VID/PID alone.
+ */
+
+static const char * const g_ppcAliasModules[] =
+{
+    "ath9k_htc", "ch341", "cp210x", "dm9601", "dvb_usb_rtl28xxu", "ftdi_sio", "pl2303",
+    "rt2800usb",
+};
+
+/* Sorted by VID, then PID. Classes: bit n set if DeviceType n binds. */
+static const PortGremlinAlias g_psAliases[] =
+{
+    { 0x0403, 0x6001, 5, 0x1F },
+    { 0x0403, 0x6010, 5, 0x1F },
+    { 0x0403, 0x6014, 5, 0x1F },
+    { 0x0403, 0x6015, 5, 0x1F },
+    { 0x0557, 0x2008, 6, 0x1F },
+    { 0x067B, 0x2303, 6, 0x1F },
+    { 0x0BDA, 0x2838, 4, 0x1F },
+    { 0x0CF3, 0x9271, 0, 0x1F },
+    { 0x0FE6, 0x9700, 3, 0x1F },
+    { 0x10C4, 0xEA60, 2, 0x1F },
+    { 0x148F, 0x5370, 7, 0x1F },
+    { 0x1A86, 0x5523, 1, 0x1F },
+    { 0x1A86, 0x7523, 1, 0x1F },
+};
+
+/* Walk order: round-robin over the modules. */
+static const uint16_t g_pui16AliasWalk[] =
+{
+    0, 5, 9, 12, 7, 10, 8, 6, 1, 4, 11, 2, 3,
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "portgremlin_bandit.h"
+#include "portgremlin_oracle.h"
+#include "portgremlin_persona.h"
+#include "portgremlin_evolve.h"
+#include "portgremlin_telemetry.h"
+#include "usblib/usblib.h"
+#include "utils/uartstdio.h"
+
+#define BANDIT_Q8       256U
+/* ln 2 in Q8. */
+#define BANDIT_LN2_Q8   177U
+
+BanditStats g_sBandit;
+
+static const GremlinPersona g_peBanditArms[PORTGREMLIN_BANDIT_ARMS] =
+{
+    PERSONA_PHANTOM,
+    PERSONA_MIMIC,
+    PERSONA_STORM,
+    PERSONA_CHIMERA,
+    PERSONA_HAUNTED,
+};
+
+/* The round in progress; the counters are bumped from the USB ISR. */
+static volatile BanditRound g_sBanditRound;
+static bool g_bBanditRoundOpen;
+static uint32_t g_ui32BanditRoundStart;
+
+static uint32_t BanditSqrt(uint32_t ui32X)
+{
+    uint32_t ui32Root = 0;
+    uint32_t ui32Bit = 1UL << 30;
+
+    while (ui32Bit > ui32X)
+    {
+        ui32Bit >>= 2;
+    }
+    while (ui32Bit != 0U)
+    {
+        if (ui32X >= ui32Root + ui32Bit)
+        {
+            ui32X -= ui32Root + ui32Bit;
+            ui32Root = (ui32Root >> 1) + ui32Bit;
+        }
+        else
+        {
+            ui32Root >>= 1;
+        }
+        ui32Bit >>= 2;
+    }
+    return ui32Root;
+}
+
+/* Natural log of a Q8 value, in Q8; the mantissa is interpolated linearly. */
+static uint32_t BanditLn(uint32_t ui32X)
+{
+    uint32_t ui32Msb = 8;
+
+    if (ui32X <= BANDIT_Q8)
+    {
+        return 0;
+    }
+    while ((ui32X >> (ui32Msb + 1U)) != 0U)
+    {
+        ui32Msb++;
+    }
+    return ((((ui32Msb - 8U) << 8) + ((ui32X - (1UL << ui32Msb)) >> (ui32Msb - 8U))) *
+            BANDIT_LN2_Q8) >> 8;
+}
+
+static uint32_t BanditMean(const BanditArm *psArm)
+{
+    return psArm->ui32Pulls ? psArm->ui32Reward * BANDIT_Q8 / psArm->ui32Pulls : 0U;
+}
+
+/* Mean reward plus the exploration bonus sqrt(2 ln N / n), all Q8. */
+static uint32_t BanditIndex(const BanditArm *psArm, uint32_t ui32LnTotal)
+{
+    uint32_t ui32Bonus;
+
+    if (psArm->ui32Pulls == 0U)
+    {
+        return UINT32_MAX;
+    }
+    ui32Bonus = BanditSqrt(2U * ui32LnTotal * BANDIT_Q8 * BANDIT_Q8 / psArm->ui32Pulls);
+    return BanditMean(psArm) + ui32Bonus * PORTGREMLIN_BANDIT_EXPLORE / BANDIT_Q8;
+}
+
+static uint32_t BanditLnTotal(void)
+{
+    uint32_t ui32Total = 0;
+
+    for (uint32_t i = 0; i < PORTGREMLIN_BANDIT_ARMS; i++)
+    {
+        ui32Total += g_sBandit.psArms[i].ui32Pulls;
+    }
+    return BanditLn(ui32Total);
+}
+
+static uint32_t BanditChoose(void)
+{
+    uint32_t ui32LnTotal = BanditLnTotal();
+    uint32_t ui32Best = 0;
+    uint32_t ui32BestIndex = 0;
+
+    for (uint32_t i = 0; i < PORTGREMLIN_BANDIT_ARMS; i++)
+    {
+        uint32_t ui32Index = BanditIndex(&g_sBandit.psArms[i], ui32LnTotal);
+
+        if (i == 0U || ui32Index > ui32BestIndex)
+        {
+            ui32Best = i;
+            ui32BestIndex = ui32Index;
+        }
+    }
+    return ui32Best;
+}
+
+static uint32_t BanditReward(const BanditRound *psRound)
+{
+    uint32_t ui32Gain = psRound->ui32Configs * PORTGREMLIN_BANDIT_PTS_CONFIG +
+                        psRound->ui32Uevents * PORTGREMLIN_BANDIT_PTS_UEVENT +
+                        psRound->ui32Signatures * PORTGREMLIN_BANDIT_PTS_SIG;
+    uint32_t ui32Cost = psRound->ui32Disconnects * PORTGREMLIN_BANDIT_PTS_DISC;
+
+    if (ui32Cost >= ui32Gain)
+    {
+        return 0;
+    }
+    ui32Gain -= ui32Cost;
+    if (ui32Gain >= PORTGREMLIN_BANDIT_FULL)
+    {
+        return BANDIT_Q8;
+    }
+    return ui32Gain * BANDIT_Q8 / PORTGREMLIN_BANDIT_FULL;
+}
+
+static void BanditOpenRound(void)
+{
+    g_sBandit.ui32Arm = BanditChoose();
+    memset((void *)&g_sBanditRound, 0, sizeof(g_sBanditRound));
+    g_ui32BanditRoundStart = g_ui32SysTickCount;
+    g_bBanditRoundOpen = true;
+    PortGremlinPersonaApply(g_peBanditArms[g_sBandit.ui32Arm]);
+}
+
+static void BanditCloseRound(void)
+{
+    BanditRound sRound = g_sBanditRound;
+    BanditArm *psArm = &g_sBandit.psArms[g_sBandit.ui32Arm];
+    uint32_t ui32Reward = BanditReward(&sRound);
+    const char *pcArm = PortGremlinPersonaName(g_peBanditArms[g_sBandit.ui32Arm]);
+
+    for (uint32_t i = 0; i < PORTGREMLIN_BANDIT_ARMS; i++)
+    {
+        BanditArm *psDecay = &g_sBandit.psArms[i];
+
+        psDecay->ui32Pulls = psDecay->ui32Pulls * PORTGREMLIN_BANDIT_DISCOUNT / BANDIT_Q8;
+        psDecay->ui32Reward = psDecay->ui32Reward * PORTGREMLIN_BANDIT_DISCOUNT / BANDIT_Q8;
+    }
+    psArm->ui32Pulls += BANDIT_Q8;
+    psArm->ui32Reward += ui32Reward;
+    psArm->ui32Rounds++;
+    g_sBandit.ui32Rounds++;
+    g_bBanditRoundOpen = false;
+
+    UARTprintf("[BANDIT] %s round %u: reward %u/256, mean %u\n\r",
+               pcArm, g_sBandit.ui32Rounds, ui32Reward, BanditMean(psArm));
+    PortGremlinTelemetryBandit(pcArm, ui32Reward, BanditMean(psArm), psArm->ui32Pulls, &sRound);
+}
+
+void PortGremlinBanditInit(void)
+{
+    memset(&g_sBandit, 0, sizeof(g_sBandit));
+    g_bBanditRoundOpen = false;
+}
+
+/* Takes over from the Brain, the genetic engine and any choreography. */
+void PortGremlinBanditStart(void)
+{
+    g_sOracle.bBrainActive = false;
+    g_sOracle.eBrainPhase = BRAIN_IDLE;
+    PortGremlinChoreoStop();
+    if (g_bEvolveActive)
+    {
+        PortGremlinEvolveToggle();
+    }
+
+    g_sBandit.bActive = true;
+    g_bBanditRoundOpen = false;
+    UARTprintf("[BANDIT] Persona scheduler ACTIVE (%u rounds so far)\n\r", g_sBandit.ui32Rounds);
+}
+
+/* The round in progress is dropped; its arm keeps what it had. */
+void PortGremlinBanditStop(void)
+{
+    if (g_sBandit.bActive)
+    {
+        UARTprintf("[BANDIT] Persona scheduler off\n\r");
+    }
+    g_sBandit.bActive = false;
+    g_bBanditRoundOpen = false;
+}
+
+/* From the USB event path, in interrupt context. */
+void PortGremlinBanditOnEvent(uint32_t ui32Event)
+{
+    if (!g_bBanditRoundOpen)
+    {
+        return;
+    }
+
+    if (ui32Event == USB_EVENT_CONFIG_SET)
+    {
+        g_sBanditRound.ui32Configs++;
+    }
+    else if (ui32Event == USB_EVENT_DISCONNECTED)
+    {
+        g_sBanditRound.ui32Disconnects++;
+    }
+}
+
+/* Host-side findings since the last report, credited to the current round. */
+void PortGremlinBanditFeedback(uint32_t ui32Signatures, uint32_t ui32Uevents)
+{
+    if (!g_bBanditRoundOpen)
+    {
+        return;
+    }
+    g_sBanditRound.ui32Signatures += ui32Signatures;
+    g_sBanditRound.ui32Uevents += ui32Uevents;
+}
+
+void PortGremlinBanditTick(void)
+{
+    if (!g_sBandit.bActive)
+    {
+        return;
+    }
+
+    if (g_bBanditRoundOpen)
+    {
+        if (g_ui32SysTickCount - g_ui32BanditRoundStart < PORTGREMLIN_BANDIT_ROUND_TICKS)
+        {
+            return;
+        }
+        BanditCloseRound();
+    }
+    BanditOpenRound();
+}
+
+void PortGremlinBanditDump(void)
+{
+    uint32_t ui32LnTotal = BanditLnTotal();
+
+    PortGremlinTelemetryBanditStatus(g_sBandit.bActive,
+                                     PortGremlinPersonaName(g_peBanditArms[g_sBandit.ui32Arm]),
+                                     g_sBandit.ui32Rounds,
+                                     g_bBanditRoundOpen ? g_ui32SysTickCount - g_ui32BanditRoundStart
+                                                        : 0U);
+    for (uint32_t i = 0; i < PORTGREMLIN_BANDIT_ARMS; i++)
+    {
+        const BanditArm *psArm = &g_sBandit.psArms[i];
+
+        PortGremlinTelemetryBanditArm(PortGremlinPersonaName(g_peBanditArms[i]), psArm,
+                                      BanditMean(psArm), BanditIndex(psArm, ui32LnTotal));
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef PORTGREMLIN_BANDIT_H
+#define PORTGREMLIN_BANDIT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Bandit scheduler, the alternative to the Brain's fixed ladder. Each
+ * attack persona is an arm, played for a round of
+ * PORTGREMLIN_BANDIT_ROUND_TICKS. A round scores points for what the host
+ * gave back during it:
+ * - SET_CONFIGURATIONs, i.e. enumerations the host completed
+ * - uevents and new kernel-error signatures, reported by the host tools
+ *   with !fb
+ * - host-initiated disconnects, which cost points
+ *
+ * Points are clamped to 0..256, which is 1.0 in Q8.
+ *
+ * The next arm is chosen by discounted UCB1. Every round all statistics
+ * decay by PORTGREMLIN_BANDIT_DISCOUNT/256, so a strategy that stops
+ * paying off on this host loses its lead within a few rounds. An arm that
+ * has not been played for a while is tried again. Counts and sums are Q8
+ * integers; the exploration term uses a Q8 natural log (log2 with a
+ * linearly interpolated mantissa, times ln 2) and an integer square root.
+ */
+
+#define PORTGREMLIN_BANDIT_ARMS         5
+#ifndef PORTGREMLIN_BANDIT_ROUND_TICKS
+#define PORTGREMLIN_BANDIT_ROUND_TICKS  1000
+#endif
+#define PORTGREMLIN_BANDIT_DISCOUNT     240
+/* UCB exploration weight, Q8. */
+#define PORTGREMLIN_BANDIT_EXPLORE      256
+
+/* Points per event in a round; 256 points is a full reward. */
+#define PORTGREMLIN_BANDIT_PTS_CONFIG   4
+#define PORTGREMLIN_BANDIT_PTS_UEVENT   1
+#define PORTGREMLIN_BANDIT_PTS_SIG      64
+#define PORTGREMLIN_BANDIT_PTS_DISC     8
+#define PORTGREMLIN_BANDIT_FULL         256
+
+typedef struct
+{
+    /* Discounted rounds played and reward earned, both Q8. */
+    uint32_t ui32Pulls;
+    uint32_t ui32Reward;
+    uint32_t ui32Rounds;
+} BanditArm;
+
+/* What the host gave back during one round. */
+typedef struct
+{
+    uint32_t ui32Configs;
+    uint32_t ui32Disconnects;
+    uint32_t ui32Signatures;
+    uint32_t ui32Uevents;
+} BanditRound;
+
+typedef struct
+{
+    bool bActive;
+    uint32_t ui32Arm;
+    uint32_t ui32Rounds;
+    BanditArm psArms[PORTGREMLIN_BANDIT_ARMS];
+} BanditStats;
+
+extern BanditStats g_sBandit;
+
+void PortGremlinBanditInit(void);
+void PortGremlinBanditStart(void);
+void PortGremlinBanditStop(void);
+void PortGremlinBanditOnEvent(uint32_t ui32Event);
+void PortGremlinBanditFeedback(uint32_t ui32Signatures, uint32_t ui32Uevents);
+void PortGremlinBanditTick(void);
+void PortGremlinBanditDump(void);
+
+#endif
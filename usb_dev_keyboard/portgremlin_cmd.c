@@ -0,0 +1,502 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portgremlin_cmd.h"
+#include "portgremlin_config.h"
+#include "portgremlin_oracle.h"
+#include "portgremlin_persona.h"
+#include "portgremlin_mimic.h"
+#include "portgremlin_evolve.h"
+#include "portgremlin_vidpid.h"
+#include "portgremlin_telemetry.h"
+#include "portgremlin_sof.h"
+#include "portgremlin_mutate.h"
+#include "portgremlin_alias.h"
+#include "portgremlin_health.h"
+#include "portgremlin_stack.h"
+#include "portgremlin_bandit.h"
+#ifdef PORTGREMLIN_PROFILE
+#include "portgremlin_profile.h"
+#endif
+#include "usb_keyb_structs.h"
+
+typedef bool (*CmdHandler)(uint32_t ui32Argc, const uint32_t *pui32Argv);
+
+typedef struct
+{
+    const char *pcVerb;
+    CmdHandler pfnHandler;
+} CmdEntry;
+
+static char g_pcCmdLine[PORTGREMLIN_CMD_MAX_CHARS + 1];
+static uint32_t g_ui32CmdLen;
+static bool g_bCmdActive;
+static bool g_bCmdOverflow;
+
+static bool ParseHex(const char **ppcStr, uint32_t *pui32Value)
+{
+    const char *pcStr = *ppcStr;
+    uint32_t ui32Value = 0;
+    uint32_t ui32Digits = 0;
+
+    while (*pcStr == ' ')
+    {
+        pcStr++;
+    }
+
+    for (; *pcStr && *pcStr != ' '; pcStr++, ui32Digits++)
+    {
+        char c = *pcStr;
+        uint32_t ui32Nibble;
+
+        if (c >= '0' && c <= '9')
+        {
+            ui32Nibble = (uint32_t)(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            ui32Nibble = (uint32_t)(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            ui32Nibble = (uint32_t)(c - 'A' + 10);
+        }
+        else
+        {
+            return false;
+        }
+
+        if (ui32Digits >= 8U)
+        {
+            return false;
+        }
+        ui32Value = (ui32Value << 4) | ui32Nibble;
+    }
+
+    *ppcStr = pcStr;
+    *pui32Value = ui32Value;
+    return ui32Digits > 0U;
+}
+
+static bool CmdPing(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    (void)pui32Argv;
+    return ui32Argc == 0U;
+}
+
+static bool CmdConfig(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc != 1U)
+    {
+        return false;
+    }
+    PortGremlinConfigSetFlags(pui32Argv[0]);
+    return true;
+}
+
+static bool CmdIdentity(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc == 0U)
+    {
+        PortGremlinConfigBegin()->bIdentityLocked = false;
+        PortGremlinConfigCommit();
+        return true;
+    }
+    if (ui32Argc != 3U || pui32Argv[0] > 0xFFFFU || pui32Argv[1] > 0xFFFFU ||
+        pui32Argv[2] >= (uint32_t)NUM_DEVICE_TYPES)
+    {
+        return false;
+    }
+
+    PortGremlinSetPinnedVIDPID((uint16_t)pui32Argv[0], (uint16_t)pui32Argv[1]);
+    g_eCurrentDevice = (DeviceType)pui32Argv[2];
+    g_eCurrentDeviceType = PortGremlinDeviceVIDPIDType(g_eCurrentDevice);
+    return true;
+}
+
+static bool CmdPower(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    PortGremlinSettings *psSettings;
+
+    if (ui32Argc == 0U)
+    {
+        PortGremlinConfigBegin()->bPowerPinned = false;
+        PortGremlinConfigCommit();
+        return true;
+    }
+    if (ui32Argc != 2U || pui32Argv[0] > 0xFFFFU || pui32Argv[1] > 0xFFU)
+    {
+        return false;
+    }
+
+    psSettings = PortGremlinConfigBegin();
+    psSettings->ui16PinnedPowermA = (uint16_t)pui32Argv[0];
+    psSettings->ui8PinnedPwrAttributes = (uint8_t)pui32Argv[1];
+    psSettings->bPowerPinned = true;
+    PortGremlinConfigCommit();
+    return true;
+}
+
+static bool CmdGo(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    (void)pui32Argv;
+    if (ui32Argc != 0U)
+    {
+        return false;
+    }
+    g_sConfig.bForceReenum = true;
+    return true;
+}
+
+static bool CmdSeed(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc != 1U)
+    {
+        return false;
+    }
+    srand((unsigned int)pui32Argv[0]);
+    return true;
+}
+
+static bool CmdPersona(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc != 1U || pui32Argv[0] >= (uint32_t)PERSONA_NUM)
+    {
+        return false;
+    }
+    PortGremlinPersonaApply((GremlinPersona)pui32Argv[0]);
+    return true;
+}
+
+static bool CmdMimic(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc != 1U || pui32Argv[0] >= PortGremlinMimicCount())
+    {
+        return false;
+    }
+    return PortGremlinMimicApply(pui32Argv[0], NULL);
+}
+
+static bool CmdClasses(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc != 1U)
+    {
+        return false;
+    }
+    return PortGremlinConfigSetClassMask(pui32Argv[0]);
+}
+
+static bool CmdGenome(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    AttackGenome sGenome;
+
+    if ((ui32Argc != 4U && ui32Argc != 5U) ||
+        pui32Argv[0] < PORTGREMLIN_CYCLE_INTERVAL_MIN ||
+        pui32Argv[0] > PORTGREMLIN_CYCLE_INTERVAL_MAX ||
+        pui32Argv[1] > 1U || pui32Argv[2] > 1U || pui32Argv[3] > 1U ||
+        (ui32Argc == 5U && pui32Argv[4] > PORTGREMLIN_MUTATE_ALL))
+    {
+        return false;
+    }
+
+    sGenome.ui8Interval = (uint8_t)pui32Argv[0];
+    sGenome.ui8Malformed = (uint8_t)pui32Argv[1];
+    sGenome.ui8RealVid = (uint8_t)pui32Argv[2];
+    sGenome.ui8Contradiction = (uint8_t)pui32Argv[3];
+    sGenome.ui8Mutations = ui32Argc == 5U ? (uint8_t)pui32Argv[4] : 0U;
+    sGenome.ui32Fitness = 0;
+    PortGremlinEvolveSet(&sGenome);
+    return true;
+}
+
+/* !mut MASK: the descriptor mutators malformed enumerations apply, outside Evolve. */
+static bool CmdMutate(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc != 1U || pui32Argv[0] > PORTGREMLIN_MUTATE_ALL)
+    {
+        return false;
+    }
+    PortGremlinConfigBegin()->ui8MutateOps = (uint8_t)pui32Argv[0];
+    PortGremlinConfigCommit();
+    return true;
+}
+
+static bool CmdTelemetry(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc != 1U || pui32Argv[0] > 1U)
+    {
+        return false;
+    }
+    g_bTelemetryEnabled = pui32Argv[0] != 0U;
+    return true;
+}
+
+/* !sof dumps the SOF gap and latency histograms, !sof 0 clears them. */
+static bool CmdSof(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc == 0U)
+    {
+        PortGremlinSofDump();
+        return true;
+    }
+    if (ui32Argc != 1U || pui32Argv[0] != 0U)
+    {
+        return false;
+    }
+    PortGremlinSofClear();
+    return true;
+}
+
+/* !hl reports recoveries, downtime and duty cycle, !hl 0 starts them over. */
+static bool CmdHealth(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc == 0U)
+    {
+        PortGremlinHealthDump();
+        return true;
+    }
+    if (ui32Argc != 1U || pui32Argv[0] != 0U)
+    {
+        return false;
+    }
+    PortGremlinHealthClear();
+    return true;
+}
+
+/* !bnd reports the bandit's arms, !bnd 1 starts the scheduler, !bnd 0 stops it. */
+static bool CmdBandit(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc == 0U)
+    {
+        PortGremlinBanditDump();
+        return true;
+    }
+    if (ui32Argc != 1U || pui32Argv[0] > 1U)
+    {
+        return false;
+    }
+    if (pui32Argv[0] != 0U)
+    {
+        PortGremlinBanditStart();
+    }
+    else
+    {
+        PortGremlinBanditStop();
+    }
+    return true;
+}
+
+/* !fb SIGS [UEVENTS]: host-side findings since the last !fb, for the bandit. */
+static bool CmdFeedback(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc == 0U || ui32Argc > 2U)
+    {
+        return false;
+    }
+    PortGremlinBanditFeedback(pui32Argv[0], ui32Argc > 1U ? pui32Argv[1] : 0U);
+    return true;
+}
+
+/* !mem reports the stack high-water mark and the static SRAM budget. */
+static bool CmdMemory(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    (void)pui32Argv;
+
+    if (ui32Argc != 0U)
+    {
+        return false;
+    }
+    PortGremlinStackDump();
+    return true;
+}
+
+/*
+ * !ali reports the alias table size and walk position, !ali POS moves the
+ * walk there, !ali VID PID names the driver that identity binds.
+ */
+static bool CmdAlias(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc == 0U)
+    {
+        PortGremlinTelemetryAliasStatus(PortGremlinAliasCount(), PortGremlinAliasCursor());
+        return true;
+    }
+    if (ui32Argc == 1U)
+    {
+        return PortGremlinAliasRewind(pui32Argv[0]);
+    }
+    if (ui32Argc != 2U || pui32Argv[0] > 0xFFFFU || pui32Argv[1] > 0xFFFFU)
+    {
+        return false;
+    }
+    PortGremlinTelemetryAliasDriver((uint16_t)pui32Argv[0], (uint16_t)pui32Argv[1],
+                                    PortGremlinAliasDriver((uint16_t)pui32Argv[0],
+                                                           (uint16_t)pui32Argv[1]));
+    return true;
+}
+
+#ifdef PORTGREMLIN_PROFILE
+/* !prof dumps the table, !prof HZ clears it and samples at HZ, !prof 0 stops. */
+static bool CmdProfile(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    if (ui32Argc == 0U)
+    {
+        PortGremlinProfileDump();
+        return true;
+    }
+    if (ui32Argc != 1U)
+    {
+        return false;
+    }
+    if (pui32Argv[0] == 0U)
+    {
+        PortGremlinProfileStop();
+        return true;
+    }
+    return PortGremlinProfileStart(pui32Argv[0]);
+}
+#endif
+
+static bool CmdStop(uint32_t ui32Argc, const uint32_t *pui32Argv)
+{
+    PortGremlinSettings *psSettings;
+
+    (void)pui32Argv;
+    if (ui32Argc != 0U)
+    {
+        return false;
+    }
+
+    g_sOracle.bBrainActive = false;
+    g_sOracle.eBrainPhase = BRAIN_IDLE;
+    PortGremlinChoreoStop();
+    PortGremlinBanditStop();
+    if (g_bEvolveActive)
+    {
+        PortGremlinEvolveToggle();
+    }
+    g_ePersona = PERSONA_MANUAL;
+    psSettings = PortGremlinConfigBegin();
+    psSettings->bAutoCycle = false;
+    psSettings->ui8MutateOps = 0;
+    PortGremlinConfigCommit();
+    return true;
+}
+
+static const CmdEntry g_psCmdTable[] =
+{
+    { "ping", CmdPing },
+    { "cfg", CmdConfig },
+    { "id", CmdIdentity },
+    { "pwr", CmdPower },
+    { "go", CmdGo },
+    { "seed", CmdSeed },
+    { "per", CmdPersona },
+    { "mim", CmdMimic },
+    { "cls", CmdClasses },
+    { "gen", CmdGenome },
+    { "mut", CmdMutate },
+    { "tlm", CmdTelemetry },
+    { "sof", CmdSof },
+    { "ali", CmdAlias },
+    { "hl", CmdHealth },
+    { "mem", CmdMemory },
+    { "bnd", CmdBandit },
+    { "fb", CmdFeedback },
+#ifdef PORTGREMLIN_PROFILE
+    { "prof", CmdProfile },
+#endif
+    { "stop", CmdStop },
+};
+
+void PortGremlinCmdExecute(const char *pcLine)
+{
+    char pcVerb[8];
+    uint32_t pui32Argv[PORTGREMLIN_CMD_MAX_ARGS];
+    uint32_t ui32Argc = 0;
+    uint32_t ui32VerbLen = 0;
+    const CmdEntry *psEntry = NULL;
+
+    while (*pcLine && *pcLine != ' ' && ui32VerbLen < sizeof(pcVerb) - 1U)
+    {
+        pcVerb[ui32VerbLen++] = *pcLine++;
+    }
+    pcVerb[ui32VerbLen] = '\0';
+
+    /* Only table verbs are echoed; raw input could break the ack's JSON. */
+    for (uint32_t i = 0; i < sizeof(g_psCmdTable) / sizeof(CmdEntry); i++)
+    {
+        if (strcmp(pcVerb, g_psCmdTable[i].pcVerb) == 0)
+        {
+            psEntry = &g_psCmdTable[i];
+            break;
+        }
+    }
+    if (!psEntry)
+    {
+        PortGremlinTelemetryAck("?", false);
+        return;
+    }
+
+    while (*pcLine)
+    {
+        while (*pcLine == ' ')
+        {
+            pcLine++;
+        }
+        if (!*pcLine)
+        {
+            break;
+        }
+        if (ui32Argc >= PORTGREMLIN_CMD_MAX_ARGS ||
+            !ParseHex(&pcLine, &pui32Argv[ui32Argc]))
+        {
+            PortGremlinTelemetryAck(psEntry->pcVerb, false);
+            return;
+        }
+        ui32Argc++;
+    }
+
+    PortGremlinTelemetryAck(psEntry->pcVerb, psEntry->pfnHandler(ui32Argc, pui32Argv));
+}
+
+bool PortGremlinCmdFeed(char cChar)
+{
+    if (!g_bCmdActive)
+    {
+        if (cChar != PORTGREMLIN_CMD_START)
+        {
+            return false;
+        }
+        g_bCmdActive = true;
+        g_bCmdOverflow = false;
+        g_ui32CmdLen = 0;
+        return true;
+    }
+
+    if (cChar == '\r' || cChar == '\n')
+    {
+        g_bCmdActive = false;
+        g_pcCmdLine[g_ui32CmdLen] = '\0';
+        if (g_bCmdOverflow)
+        {
+            PortGremlinTelemetryAck("", false);
+        }
+        else
+        {
+            PortGremlinCmdExecute(g_pcCmdLine);
+        }
+        return true;
+    }
+
+    if (g_ui32CmdLen < PORTGREMLIN_CMD_MAX_CHARS)
+    {
+        g_pcCmdLine[g_ui32CmdLen++] = cChar;
+    }
+    else
+    {
+        g_bCmdOverflow = true;
+    }
+    return true;
+}
@@ -0,0 +1,14 @@
+#ifndef PORTGREMLIN_CMD_H
+#define PORTGREMLIN_CMD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PORTGREMLIN_CMD_START       '!'
+#define PORTGREMLIN_CMD_MAX_CHARS   48
+#define PORTGREMLIN_CMD_MAX_ARGS    5
+
+bool PortGremlinCmdFeed(char cChar);
+void PortGremlinCmdExecute(const char *pcLine);
+
+#endif
@@ -1,33 +1,122 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "driverlib/interrupt.h"
 #include "portgremlin_config.h"
 
 PortGremlinConfig g_sConfig;
 
+/*
+ * Two copies of the settings; the published one is sBuf[version & 1]. A
+ * writer only ever fills the other copy, so a reader is disturbed only if
+ * two commits land while it copies, and the version check catches that.
+ * Writers mask interrupts to keep one another out (an ISR may apply a
+ * persona while the main loop is mid-update); readers never do.
+ */
+static PortGremlinSettings g_psConfigBuf[2];
+static volatile uint32_t g_ui32ConfigVersion;
+static uint32_t g_ui32ConfigDepth;
+static bool g_bConfigWasMasked;
+
+/* Keeps the compiler from moving settings accesses across version accesses. */
+#define CONFIG_BARRIER()    __asm volatile("" ::: "memory")
+
 void PortGremlinConfigInit(void)
 {
-    g_sConfig.bAutoCycle = true;
-    g_sConfig.bMalformedMode = false;
-    g_sConfig.bRandomStrings = true;
-    g_sConfig.bRealVIDPID = false;
-    g_sConfig.ui32CycleIntervalTicks = PORTGREMLIN_CYCLE_INTERVAL_DEF;
+    PortGremlinSettings *psSettings = &g_psConfigBuf[0];
+
+    memset(g_psConfigBuf, 0, sizeof(g_psConfigBuf));
+    psSettings->bAutoCycle = true;
+    psSettings->bRandomStrings = true;
+    psSettings->ui32CycleIntervalTicks = PORTGREMLIN_CYCLE_INTERVAL_DEF;
+    for (int i = 0; i < (int)NUM_DEVICE_TYPES; i++)
+    {
+        psSettings->bClassEnabled[i] = true;
+    }
+    g_ui32ConfigVersion = 0;
+    g_ui32ConfigDepth = 0;
+
     g_sConfig.bForceCycle = false;
     g_sConfig.bForceReenum = false;
     g_sConfig.ui32EnumCount = 0;
     g_sConfig.ui32CycleCount = 0;
+}
 
-    for (int i = 0; i < (int)NUM_DEVICE_TYPES; i++)
+/* Copies one coherent version of the settings; returns its number. */
+uint32_t PortGremlinConfigRead(PortGremlinSettings *psSettings)
+{
+    uint32_t ui32Version;
+
+    do
+    {
+        ui32Version = g_ui32ConfigVersion;
+        CONFIG_BARRIER();
+        memcpy(psSettings, &g_psConfigBuf[ui32Version & 1U], sizeof(*psSettings));
+        CONFIG_BARRIER();
+    } while (ui32Version != g_ui32ConfigVersion);
+
+    return ui32Version;
+}
+
+const PortGremlinSettings *PortGremlinConfigCurrent(void)
+{
+    return &g_psConfigBuf[g_ui32ConfigVersion & 1U];
+}
+
+uint32_t PortGremlinConfigVersion(void)
+{
+    return g_ui32ConfigVersion;
+}
+
+/*
+ * Returns the spare copy, primed with the published settings. Nested
+ * Begin/Commit pairs (a persona that applies a mimic) fold into the
+ * outermost one.
+ */
+PortGremlinSettings *PortGremlinConfigBegin(void)
+{
+    bool bWasMasked = IntMasterDisable();
+    uint32_t ui32Version = g_ui32ConfigVersion;
+
+    if (g_ui32ConfigDepth++ == 0U)
+    {
+        g_bConfigWasMasked = bWasMasked;
+        memcpy(&g_psConfigBuf[(ui32Version + 1U) & 1U], &g_psConfigBuf[ui32Version & 1U],
+               sizeof(PortGremlinSettings));
+    }
+    return &g_psConfigBuf[(ui32Version + 1U) & 1U];
+}
+
+/* Publishes the spare copy, unless nothing in it changed. */
+void PortGremlinConfigCommit(void)
+{
+    uint32_t ui32Version = g_ui32ConfigVersion;
+
+    if (--g_ui32ConfigDepth != 0U)
+    {
+        return;
+    }
+
+    if (memcmp(&g_psConfigBuf[0], &g_psConfigBuf[1], sizeof(PortGremlinSettings)) != 0)
+    {
+        CONFIG_BARRIER();
+        g_ui32ConfigVersion = ui32Version + 1U;
+    }
+    if (!g_bConfigWasMasked)
     {
-        g_sConfig.bClassEnabled[i] = true;
+        IntMasterEnable();
     }
 }
 
 DeviceType PortGremlinNextEnabledDevice(DeviceType eCurrent)
 {
+    const PortGremlinSettings *psSettings = PortGremlinConfigCurrent();
     DeviceType eNext = eCurrent;
 
     for (int i = 0; i < (int)NUM_DEVICE_TYPES; i++)
     {
         eNext = (DeviceType)(((int)eNext + 1) % (int)NUM_DEVICE_TYPES);
-        if (g_sConfig.bClassEnabled[eNext])
+        if (psSettings->bClassEnabled[eNext])
         {
             return eNext;
         }
@@ -48,3 +137,110 @@ const char *PortGremlinDeviceName(DeviceType eDevice)
         default:              return "Unknown";
     }
 }
+
+VIDPIDDeviceType PortGremlinDeviceVIDPIDType(DeviceType eDevice)
+{
+    switch (eDevice)
+    {
+        case DEVICE_KEYBOARD: return VIDPID_TYPE_KEYBOARD;
+        case DEVICE_AUDIO:    return VIDPID_TYPE_AUDIO;
+        case DEVICE_PRINTER:  return VIDPID_TYPE_PRINTER;
+        case DEVICE_MIDI:     return VIDPID_TYPE_MIDI;
+        case DEVICE_GAMEPAD:  return VIDPID_TYPE_GAMEPAD;
+        default:              return VIDPID_TYPE_GENERIC;
+    }
+}
+
+uint32_t PortGremlinConfigFlags(void)
+{
+    PortGremlinSettings sSettings;
+
+    PortGremlinConfigRead(&sSettings);
+    return PortGremlinConfigFlagsOf(&sSettings);
+}
+
+uint32_t PortGremlinConfigFlagsOf(const PortGremlinSettings *psSettings)
+{
+    uint32_t ui32Flags = 0;
+
+    if (psSettings->bMalformedMode)
+    {
+        ui32Flags |= PORTGREMLIN_FLAG_MALFORMED;
+    }
+    if (psSettings->bContradictionMode)
+    {
+        ui32Flags |= PORTGREMLIN_FLAG_CONTRADICTION;
+    }
+    if (psSettings->bRealVIDPID)
+    {
+        ui32Flags |= PORTGREMLIN_FLAG_REAL_VID;
+    }
+    if (psSettings->bRandomStrings)
+    {
+        ui32Flags |= PORTGREMLIN_FLAG_RAND_STRINGS;
+    }
+    if (psSettings->bPowerPinned)
+    {
+        ui32Flags |= PORTGREMLIN_FLAG_POWER_PINNED;
+    }
+    if (psSettings->bAutoCycle)
+    {
+        ui32Flags |= PORTGREMLIN_FLAG_AUTO_CYCLE;
+    }
+    if (psSettings->bAliasWalk)
+    {
+        ui32Flags |= PORTGREMLIN_FLAG_ALIAS_WALK;
+    }
+
+    return ui32Flags;
+}
+
+void PortGremlinConfigSetFlags(uint32_t ui32Flags)
+{
+    PortGremlinSettings *psSettings = PortGremlinConfigBegin();
+
+    psSettings->bMalformedMode = (ui32Flags & PORTGREMLIN_FLAG_MALFORMED) != 0;
+    psSettings->bContradictionMode = (ui32Flags & PORTGREMLIN_FLAG_CONTRADICTION) != 0;
+    psSettings->bRealVIDPID = (ui32Flags & PORTGREMLIN_FLAG_REAL_VID) != 0;
+    psSettings->bRandomStrings = (ui32Flags & PORTGREMLIN_FLAG_RAND_STRINGS) != 0;
+    psSettings->bPowerPinned = (ui32Flags & PORTGREMLIN_FLAG_POWER_PINNED) != 0;
+    psSettings->bAutoCycle = (ui32Flags & PORTGREMLIN_FLAG_AUTO_CYCLE) != 0;
+    psSettings->bAliasWalk = (ui32Flags & PORTGREMLIN_FLAG_ALIAS_WALK) != 0;
+    PortGremlinConfigCommit();
+}
+
+uint32_t PortGremlinConfigClassMask(void)
+{
+    PortGremlinSettings sSettings;
+    uint32_t ui32Mask = 0;
+
+    PortGremlinConfigRead(&sSettings);
+    for (int i = 0; i < (int)NUM_DEVICE_TYPES; i++)
+    {
+        if (sSettings.bClassEnabled[i])
+        {
+            ui32Mask |= 1U << i;
+        }
+    }
+
+    return ui32Mask;
+}
+
+/* Bit n enables DeviceType n. At least one known class must stay enabled. */
+bool PortGremlinConfigSetClassMask(uint32_t ui32Mask)
+{
+    if (ui32Mask == 0U || (ui32Mask >> NUM_DEVICE_TYPES) != 0U)
+    {
+        return false;
+    }
+
+    PortGremlinSettings *psSettings = PortGremlinConfigBegin();
+
+    for (int i = 0; i < (int)NUM_DEVICE_TYPES; i++)
+    {
+        psSettings->bClassEnabled[i] = (ui32Mask & (1U << i)) != 0U;
+    }
+    PortGremlinConfigCommit();
+
+    return true;
+}
@@ -9,14 +9,47 @@
 #define PORTGREMLIN_CYCLE_INTERVAL_MAX  100
 #define PORTGREMLIN_CYCLE_INTERVAL_DEF  5
 
+#define PORTGREMLIN_FLAG_MALFORMED      0x01
+#define PORTGREMLIN_FLAG_CONTRADICTION  0x02
+#define PORTGREMLIN_FLAG_REAL_VID       0x04
+#define PORTGREMLIN_FLAG_RAND_STRINGS   0x08
+#define PORTGREMLIN_FLAG_POWER_PINNED   0x10
+#define PORTGREMLIN_FLAG_AUTO_CYCLE     0x20
+#define PORTGREMLIN_FLAG_ALIAS_WALK     0x40
+
+/*
+ * Everything that shapes an enumeration. Personas, Evolve and the command
+ * channel change several of these at once while SysTick and the USB
+ * callbacks enumerate, so the settings are published as a whole: writers
+ * fill the spare copy between PortGremlinConfigBegin() and
+ * PortGremlinConfigCommit(), which bumps the version; readers take a
+ * snapshot with PortGremlinConfigRead() and retry if the version moved.
+ * One field on its own can be read through PortGremlinConfigCurrent().
+ */
+typedef struct
+{
+    bool bAutoCycle;
+    bool bMalformedMode;
+    /* MutateOp bits for the descriptor arena; used while bMalformedMode. */
+    uint8_t ui8MutateOps;
+    bool bRandomStrings;
+    bool bRealVIDPID;
+    /* Identities from the driver-match alias table (portgremlin_alias.c). */
+    bool bAliasWalk;
+    uint32_t ui32CycleIntervalTicks;
+    bool bClassEnabled[NUM_DEVICE_TYPES];
+    bool bPowerPinned;
+    uint16_t ui16PinnedPowermA;
+    uint8_t ui8PinnedPwrAttributes;
+    bool bContradictionMode;
+    bool bIdentityLocked;
+    uint16_t ui16PinnedVID;
+    uint16_t ui16PinnedPID;
+} PortGremlinSettings;
+
+/* Requests and counters; single words, written without a snapshot. */
 typedef struct
 {
-    volatile bool bAutoCycle;
-    volatile bool bMalformedMode;
-    volatile bool bRandomStrings;
-    volatile bool bRealVIDPID;
-    volatile uint32_t ui32CycleIntervalTicks;
-    volatile bool bClassEnabled[NUM_DEVICE_TYPES];
     volatile bool bForceCycle;
     volatile bool bForceReenum;
     volatile uint32_t ui32EnumCount;
@@ -26,7 +59,18 @@ typedef struct
 extern PortGremlinConfig g_sConfig;
 
 void PortGremlinConfigInit(void);
+uint32_t PortGremlinConfigRead(PortGremlinSettings *psSettings);
+const PortGremlinSettings *PortGremlinConfigCurrent(void);
+uint32_t PortGremlinConfigVersion(void);
+PortGremlinSettings *PortGremlinConfigBegin(void);
+void PortGremlinConfigCommit(void);
 DeviceType PortGremlinNextEnabledDevice(DeviceType eCurrent);
 const char *PortGremlinDeviceName(DeviceType eDevice);
+VIDPIDDeviceType PortGremlinDeviceVIDPIDType(DeviceType eDevice);
+uint32_t PortGremlinConfigFlags(void);
+uint32_t PortGremlinConfigFlagsOf(const PortGremlinSettings *psSettings);
+void PortGremlinConfigSetFlags(uint32_t ui32Flags);
+uint32_t PortGremlinConfigClassMask(void);
+bool PortGremlinConfigSetClassMask(uint32_t ui32Mask);
 
 #endif
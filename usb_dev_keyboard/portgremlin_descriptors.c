@@ -0,0 +1,254 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "portgremlin_descriptors.h"
+
+#define DTYPE_DEVICE            0x01
+#define DTYPE_CONFIGURATION     0x02
+#define DTYPE_INTERFACE         0x04
+#define DTYPE_ENDPOINT          0x05
+#define DTYPE_HID               0x21
+#define DTYPE_HID_REPORT        0x22
+#define DTYPE_CS_INTERFACE      0x24
+#define DTYPE_CS_ENDPOINT       0x25
+
+#define CLASS_AUDIO             0x01
+#define CLASS_PRINTER           0x07
+#define CLASS_HID               0x03
+#define SUBCLASS_AUDIOCONTROL   0x01
+#define SUBCLASS_AUDIOSTREAMING 0x02
+#define SUBCLASS_MIDISTREAMING  0x03
+
+#define EP_ISOC_ADAPTIVE        0x09
+#define EP_BULK                 0x02
+#define EP_INT                  0x03
+
+/*
+ * Descriptor builders. DESC_BYTES() sizes a byte list at compile time, so
+ * every container below carries the exact length of what follows it.
+ */
+#define DESC_BYTES(...)         sizeof((const uint8_t[]){ __VA_ARGS__ })
+#define DESC_SHORT(x)           (uint8_t)((x) & 0xFF), (uint8_t)(((x) >> 8) & 0xFF)
+#define DESC_3BYTE(x)           DESC_SHORT(x), (uint8_t)(((x) >> 16) & 0xFF)
+
+#define DESC_DEVICE(ui16BcdDevice) \
+    PORTGREMLIN_DESC_DEVICE_LEN, DTYPE_DEVICE, DESC_SHORT(0x0110), 0, 0, 0, 64, \
+    DESC_SHORT(0), DESC_SHORT(0), DESC_SHORT(ui16BcdDevice), 1, 2, 3, 1
+
+#define DESC_CONFIG(ui8Interfaces, ui8String, ...) \
+    PORTGREMLIN_DESC_CONFIG_LEN, DTYPE_CONFIGURATION, \
+    DESC_SHORT(PORTGREMLIN_DESC_CONFIG_LEN + DESC_BYTES(__VA_ARGS__)), \
+    ui8Interfaces, 1, ui8String, 0xC0, 250, __VA_ARGS__
+
+#define DESC_INTERFACE(ui8Num, ui8Alt, ui8Endpoints, ui8Class, ui8Sub, ui8Proto, ui8String) \
+    9, DTYPE_INTERFACE, ui8Num, ui8Alt, ui8Endpoints, ui8Class, ui8Sub, ui8Proto, ui8String
+
+#define DESC_ENDPOINT(ui8Addr, ui8Attr, ui16MaxPacket, ui8Interval) \
+    7, DTYPE_ENDPOINT, ui8Addr, ui8Attr, DESC_SHORT(ui16MaxPacket), ui8Interval
+
+/* Audio 1.0 endpoints carry bRefresh and bSynchAddress. */
+#define DESC_AUDIO_ENDPOINT(ui8Addr, ui8Attr, ui16MaxPacket, ui8Interval) \
+    9, DTYPE_ENDPOINT, ui8Addr, ui8Attr, DESC_SHORT(ui16MaxPacket), ui8Interval, 0, 0
+
+#define DESC_HID(ui16ReportLen) \
+    9, DTYPE_HID, DESC_SHORT(0x0111), 0, 1, DTYPE_HID_REPORT, DESC_SHORT(ui16ReportLen)
+
+/* Audio 1.0 class-specific AudioControl header over one streaming interface. */
+#define DESC_AC_HEADER(ui8Streaming, ...) \
+    9, DTYPE_CS_INTERFACE, 0x01, DESC_SHORT(0x0100), DESC_SHORT(9 + DESC_BYTES(__VA_ARGS__)), \
+    1, ui8Streaming, __VA_ARGS__
+
+/* MIDI 1.0 class-specific MIDIStreaming header; the total covers the endpoints. */
+#define DESC_MS_HEADER(...) \
+    7, DTYPE_CS_INTERFACE, 0x01, DESC_SHORT(0x0100), DESC_SHORT(7 + DESC_BYTES(__VA_ARGS__)), \
+    __VA_ARGS__
+
+#define DESC_MIDI_IN_JACK(ui8Type, ui8ID) \
+    6, DTYPE_CS_INTERFACE, 0x02, ui8Type, ui8ID, 0
+
+#define DESC_MIDI_OUT_JACK(ui8Type, ui8ID, ui8Source) \
+    9, DTYPE_CS_INTERFACE, 0x03, ui8Type, ui8ID, 1, ui8Source, 1, 0
+
+#define DESC_MIDI_ENDPOINT(ui8Jack) \
+    5, DTYPE_CS_ENDPOINT, 0x01, 1, ui8Jack
+
+#define MIDI_JACK_EMBEDDED      0x01
+#define MIDI_JACK_EXTERNAL      0x02
+
+/*
+ * Keyboard: usblib's boot keyboard, one interrupt IN endpoint.
+ */
+static const uint8_t g_pui8KeyboardReport[] =
+{
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7,
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01,
+    0x75, 0x08, 0x81, 0x01, 0x95, 0x05, 0x75, 0x01, 0x05, 0x08, 0x19, 0x01,
+    0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01, 0x95, 0x06,
+    0x75, 0x08, 0x15, 0x00, 0x25, 0x65, 0x05, 0x07, 0x19, 0x00, 0x29, 0x65,
+    0x81, 0x00, 0xC0
+};
+
+static const uint8_t g_pui8KeyboardDevice[] = { DESC_DEVICE(0x0100) };
+
+static const uint8_t g_pui8KeyboardConfig[] =
+{
+    DESC_CONFIG(1, 5,
+        DESC_INTERFACE(0, 0, 1, CLASS_HID, 0x01, 0x01, 4),
+        DESC_HID(sizeof(g_pui8KeyboardReport)),
+        DESC_ENDPOINT(0x81, EP_INT, 8, 10))
+};
+
+/*
+ * Audio: a 48 kHz 16-bit stereo speaker. USB streaming input terminal to
+ * speaker output terminal, and a streaming interface whose alternate 1
+ * opens an adaptive isochronous OUT endpoint.
+ */
+static const uint8_t g_pui8AudioDevice[] = { DESC_DEVICE(0x0100) };
+
+static const uint8_t g_pui8AudioConfig[] =
+{
+    DESC_CONFIG(2, 0,
+        DESC_INTERFACE(0, 0, 0, CLASS_AUDIO, SUBCLASS_AUDIOCONTROL, 0, 0),
+        DESC_AC_HEADER(1,
+            12, DTYPE_CS_INTERFACE, 0x02, 1, DESC_SHORT(0x0101), 0, 2,
+                DESC_SHORT(0x0003), 0, 0,
+            9, DTYPE_CS_INTERFACE, 0x03, 2, DESC_SHORT(0x0301), 0, 1, 0),
+        DESC_INTERFACE(1, 0, 0, CLASS_AUDIO, SUBCLASS_AUDIOSTREAMING, 0, 0),
+        DESC_INTERFACE(1, 1, 1, CLASS_AUDIO, SUBCLASS_AUDIOSTREAMING, 0, 0),
+        7, DTYPE_CS_INTERFACE, 0x01, 1, 1, DESC_SHORT(0x0001),
+        11, DTYPE_CS_INTERFACE, 0x02, 0x01, 2, 2, 16, 1, DESC_3BYTE(48000),
+        DESC_AUDIO_ENDPOINT(0x01, EP_ISOC_ADAPTIVE, 192, 1),
+        7, DTYPE_CS_ENDPOINT, 0x01, 0, 0, DESC_SHORT(0))
+};
+
+/*
+ * MIDI: one embedded and one external jack each way, bulk endpoints on
+ * both sides, behind the empty AudioControl interface MIDI 1.0 requires.
+ */
+static const uint8_t g_pui8MIDIDevice[] = { DESC_DEVICE(0x0100) };
+
+static const uint8_t g_pui8MIDIConfig[] =
+{
+    DESC_CONFIG(2, 0,
+        DESC_INTERFACE(0, 0, 0, CLASS_AUDIO, SUBCLASS_AUDIOCONTROL, 0, 0),
+        9, DTYPE_CS_INTERFACE, 0x01, DESC_SHORT(0x0100), DESC_SHORT(9), 1, 1,
+        DESC_INTERFACE(1, 0, 2, CLASS_AUDIO, SUBCLASS_MIDISTREAMING, 0, 0),
+        DESC_MS_HEADER(
+            DESC_MIDI_IN_JACK(MIDI_JACK_EMBEDDED, 1),
+            DESC_MIDI_IN_JACK(MIDI_JACK_EXTERNAL, 2),
+            DESC_MIDI_OUT_JACK(MIDI_JACK_EMBEDDED, 3, 2),
+            DESC_MIDI_OUT_JACK(MIDI_JACK_EXTERNAL, 4, 1),
+            DESC_AUDIO_ENDPOINT(0x02, EP_BULK, 64, 0),
+            DESC_MIDI_ENDPOINT(1),
+            DESC_AUDIO_ENDPOINT(0x82, EP_BULK, 64, 0),
+            DESC_MIDI_ENDPOINT(3)))
+};
+
+/*
+ * Printer: bidirectional (protocol 2), bulk OUT for the job and bulk IN
+ * for status, answering GET_DEVICE_ID with a PCL/PJL laser.
+ */
+static const uint8_t g_pui8PrinterDevice[] = { DESC_DEVICE(0x0100) };
+
+static const uint8_t g_pui8PrinterConfig[] =
+{
+    DESC_CONFIG(1, 0,
+        DESC_INTERFACE(0, 0, 2, CLASS_PRINTER, 0x01, 0x02, 0),
+        DESC_ENDPOINT(0x01, EP_BULK, 64, 0),
+        DESC_ENDPOINT(0x81, EP_BULK, 64, 0))
+};
+
+#define PRINTER_DEVICE_ID \
+    'M', 'F', 'G', ':', 'P', 'o', 'r', 't', 'G', 'r', 'e', 'm', 'l', 'i', 'n', ';', \
+    'M', 'D', 'L', ':', 'L', 'P', '-', '1', ';', \
+    'C', 'M', 'D', ':', 'P', 'C', 'L', ',', 'P', 'J', 'L', ';', \
+    'C', 'L', 'S', ':', 'P', 'R', 'I', 'N', 'T', 'E', 'R', ';'
+
+/* GET_DEVICE_ID answers with a big-endian length that counts itself. */
+static const uint8_t g_pui8PrinterDeviceID[] =
+{
+    (uint8_t)((2 + DESC_BYTES(PRINTER_DEVICE_ID)) >> 8),
+    (uint8_t)((2 + DESC_BYTES(PRINTER_DEVICE_ID)) & 0xFF),
+    PRINTER_DEVICE_ID
+};
+
+/*
+ * Gamepad: 16 buttons and four signed 8-bit axes (X, Y, Z, Rz) in a 6-byte
+ * input report on one interrupt IN endpoint.
+ */
+static const uint8_t g_pui8GamepadReport[] =
+{
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x10, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x10, 0x81, 0x02,
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35,
+    0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x04, 0x81, 0x02,
+    0xC0
+};
+
+static const uint8_t g_pui8GamepadDevice[] = { DESC_DEVICE(0x0100) };
+
+static const uint8_t g_pui8GamepadConfig[] =
+{
+    DESC_CONFIG(1, 0,
+        DESC_INTERFACE(0, 0, 1, CLASS_HID, 0, 0, 0),
+        DESC_HID(sizeof(g_pui8GamepadReport)),
+        DESC_ENDPOINT(0x81, EP_INT, 8, 10))
+};
+
+#define DESC_SET(pcName, pui8Device, pui8Config, pui8Report, ui16ReportLen, pui8ID, ui16IDLen) \
+    { pcName, pui8Device, pui8Config, sizeof(pui8Config), pui8Report, ui16ReportLen, \
+      pui8ID, ui16IDLen }
+
+const PortGremlinClassDescriptors g_psPortGremlinDescriptors[NUM_DEVICE_TYPES] =
+{
+    [DEVICE_KEYBOARD] = DESC_SET("Keyboard", g_pui8KeyboardDevice, g_pui8KeyboardConfig,
+                                 g_pui8KeyboardReport, sizeof(g_pui8KeyboardReport), NULL, 0),
+    [DEVICE_AUDIO] = DESC_SET("Audio", g_pui8AudioDevice, g_pui8AudioConfig,
+                              NULL, 0, NULL, 0),
+    [DEVICE_PRINTER] = DESC_SET("Printer", g_pui8PrinterDevice, g_pui8PrinterConfig,
+                                NULL, 0, g_pui8PrinterDeviceID, sizeof(g_pui8PrinterDeviceID)),
+    [DEVICE_MIDI] = DESC_SET("MIDI", g_pui8MIDIDevice, g_pui8MIDIConfig,
+                             NULL, 0, NULL, 0),
+    [DEVICE_GAMEPAD] = DESC_SET("Gamepad", g_pui8GamepadDevice, g_pui8GamepadConfig,
+                                g_pui8GamepadReport, sizeof(g_pui8GamepadReport), NULL, 0),
+};
+
+const PortGremlinClassDescriptors *PortGremlinDescriptorsFor(DeviceType eDevice)
+{
+    if ((uint32_t)eDevice >= (uint32_t)NUM_DEVICE_TYPES)
+    {
+        return NULL;
+    }
+    return &g_psPortGremlinDescriptors[eDevice];
+}
+
+void PortGremlinDescriptorsDevice(DeviceType eDevice, uint16_t ui16VID, uint16_t ui16PID,
+                                  uint8_t *pui8Out)
+{
+    const PortGremlinClassDescriptors *psDesc = PortGremlinDescriptorsFor(eDevice);
+
+    if (!psDesc)
+    {
+        return;
+    }
+    memcpy(pui8Out, psDesc->pui8Device, PORTGREMLIN_DESC_DEVICE_LEN);
+    pui8Out[8] = (uint8_t)(ui16VID & 0xFF);
+    pui8Out[9] = (uint8_t)(ui16VID >> 8);
+    pui8Out[10] = (uint8_t)(ui16PID & 0xFF);
+    pui8Out[11] = (uint8_t)(ui16PID >> 8);
+}
+
+void PortGremlinDescriptorsConfigHeader(DeviceType eDevice, uint16_t ui16MaxPowermA,
+                                        uint8_t ui8PwrAttributes, uint8_t *pui8Out)
+{
+    const PortGremlinClassDescriptors *psDesc = PortGremlinDescriptorsFor(eDevice);
+
+    if (!psDesc)
+    {
+        return;
+    }
+    memcpy(pui8Out, psDesc->pui8Config, PORTGREMLIN_DESC_CONFIG_LEN);
+    pui8Out[7] = ui8PwrAttributes;
+    pui8Out[8] = (uint8_t)(ui16MaxPowermA > 510U ? 255U : ui16MaxPowermA / 2U);
+}
@@ -0,0 +1,50 @@
+#ifndef PORTGREMLIN_DESCRIPTORS_H
+#define PORTGREMLIN_DESCRIPTORS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_keyb_structs.h"
+
+/*
+ * Complete descriptor sets for every device class, laid out at compile
+ * time by the macro tables in portgremlin_descriptors.c and kept in flash.
+ * Lengths, wTotalLength and the class-specific totals are all computed by
+ * the compiler, so adding an endpoint or a jack never needs a hand count.
+ *
+ * Audio, MIDI, Printer and Gamepad are served from these tables by the
+ * firmware's generic class driver. The Keyboard entry mirrors what usblib's
+ * HID keyboard driver builds for itself; the firmware leaves that one to
+ * usblib and the host harness uses it in usblib's place.
+ *
+ * Only the device descriptor and the 9-byte configuration header change
+ * per enumeration (VID/PID and power); PortGremlinDescriptorsDevice() and
+ * PortGremlinDescriptorsConfigHeader() patch RAM copies of those, and the
+ * configuration body is served straight from flash.
+ */
+
+#define PORTGREMLIN_DESC_DEVICE_LEN     18
+#define PORTGREMLIN_DESC_CONFIG_LEN     9
+
+typedef struct
+{
+    const char *pcName;
+    const uint8_t *pui8Device;
+    const uint8_t *pui8Config;
+    uint16_t ui16ConfigLen;
+    /* HID report descriptor, or NULL for non-HID classes. */
+    const uint8_t *pui8Report;
+    uint16_t ui16ReportLen;
+    /* IEEE 1284 device ID with its big-endian length prefix, or NULL. */
+    const uint8_t *pui8DeviceID;
+    uint16_t ui16DeviceIDLen;
+} PortGremlinClassDescriptors;
+
+extern const PortGremlinClassDescriptors g_psPortGremlinDescriptors[NUM_DEVICE_TYPES];
+
+const PortGremlinClassDescriptors *PortGremlinDescriptorsFor(DeviceType eDevice);
+void PortGremlinDescriptorsDevice(DeviceType eDevice, uint16_t ui16VID, uint16_t ui16PID,
+                                  uint8_t *pui8Out);
+void PortGremlinDescriptorsConfigHeader(DeviceType eDevice, uint16_t ui16MaxPowermA,
+                                        uint8_t ui8PwrAttributes, uint8_t *pui8Out);
+
+#endif
@@ -3,6 +3,8 @@
 #include "portgremlin_config.h"
 #include "portgremlin_oracle.h"
 #include "portgremlin_telemetry.h"
+#include "portgremlin_mutate.h"
+#include "portgremlin_bandit.h"
 #include "utils/uartstdio.h"
 
 bool g_bEvolveActive = false;
@@ -19,7 +21,7 @@ static uint8_t RandByte(void)
 
 static void MutateGenome(AttackGenome *psGenome)
 {
-    switch (RandByte() % 4)
+    switch (RandByte() % 5)
     {
         case 0:
             psGenome->ui8Interval = (uint8_t)(PORTGREMLIN_CYCLE_INTERVAL_MIN +
@@ -32,6 +34,9 @@ static void MutateGenome(AttackGenome *psGenome)
         case 2:
             psGenome->ui8RealVid ^= 1;
             break;
+        case 3:
+            psGenome->ui8Mutations ^= (uint8_t)(1U << (RandByte() % MUTATE_NUM_OPS));
+            break;
         default:
             psGenome->ui8Contradiction ^= 1;
             break;
@@ -40,24 +45,28 @@ static void MutateGenome(AttackGenome *psGenome)
 
 static void GenomeToConfig(const AttackGenome *psGenome)
 {
-    g_sConfig.ui32CycleIntervalTicks = psGenome->ui8Interval;
-    g_sConfig.bMalformedMode = psGenome->ui8Malformed != 0;
-    g_sConfig.bRealVIDPID = psGenome->ui8RealVid != 0;
-    g_sConfig.bRandomStrings = true;
-    g_sConfig.bAutoCycle = true;
+    PortGremlinSettings *psSettings = PortGremlinConfigBegin();
+
+    psSettings->ui32CycleIntervalTicks = psGenome->ui8Interval;
+    psSettings->bMalformedMode = psGenome->ui8Malformed != 0;
+    psSettings->ui8MutateOps = psGenome->ui8Mutations;
+    psSettings->bRealVIDPID = psGenome->ui8RealVid != 0;
+    psSettings->bRandomStrings = true;
+    psSettings->bAutoCycle = true;
 
     if (psGenome->ui8Contradiction)
     {
-        g_sOracle.bContradictionMode = true;
-        g_sOracle.bIdentityLocked = true;
-        g_sOracle.ui16PinnedVID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
-        g_sOracle.ui16PinnedPID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
+        psSettings->bContradictionMode = true;
+        psSettings->bIdentityLocked = true;
+        psSettings->ui16PinnedVID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
+        psSettings->ui16PinnedPID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
     }
     else
     {
-        g_sOracle.bContradictionMode = false;
-        g_sOracle.bIdentityLocked = false;
+        psSettings->bContradictionMode = false;
+        psSettings->bIdentityLocked = false;
     }
+    PortGremlinConfigCommit();
 }
 
 void PortGremlinEvolveInit(void)
@@ -70,6 +79,7 @@ void PortGremlinEvolveInit(void)
     g_sGenome.ui8Malformed = 0;
     g_sGenome.ui8RealVid = 1;
     g_sGenome.ui8Contradiction = 0;
+    g_sGenome.ui8Mutations = 0;
     g_sGenome.ui32Fitness = 0;
     g_sBestGenome = g_sGenome;
 }
@@ -80,6 +90,7 @@ void PortGremlinEvolveToggle(void)
     if (g_bEvolveActive)
     {
         g_sOracle.bBrainActive = false;
+        PortGremlinBanditStop();
         PortGremlinEvolveApply();
         UARTprintf("[EVOLVE] Genetic attack engine ACTIVE (gen %u)\n\r",
                    g_ui32EvolveGeneration);
@@ -93,11 +104,22 @@ void PortGremlinEvolveToggle(void)
 void PortGremlinEvolveApply(void)
 {
     GenomeToConfig(&g_sGenome);
-    PortGremlinTelemetryEvolve(g_ui32EvolveGeneration, g_sGenome.ui32Fitness);
-    UARTprintf("[EVOLVE] interval=%u mal=%u vid=%u contra=%u fit=%u\n\r",
+    PortGremlinTelemetryEvolve(g_ui32EvolveGeneration, &g_sGenome);
+    UARTprintf("[EVOLVE] interval=%u mal=%u vid=%u contra=%u mut=%02x fit=%u\n\r",
                g_sGenome.ui8Interval, g_sGenome.ui8Malformed,
                g_sGenome.ui8RealVid, g_sGenome.ui8Contradiction,
-               g_sGenome.ui32Fitness);
+               g_sGenome.ui8Mutations, g_sGenome.ui32Fitness);
+}
+
+/* Start a new generation from a genome chosen by the host. */
+void PortGremlinEvolveSet(const AttackGenome *psGenome)
+{
+    g_ui32EvolveGeneration++;
+    g_sGenome = *psGenome;
+    g_sGenome.ui32Fitness = 0;
+    g_sBestGenome = g_sGenome;
+    g_ui32EnumsSinceMutate = 0;
+    PortGremlinEvolveApply();
 }
 
 void PortGremlinEvolveReward(void)
@@ -10,6 +10,7 @@ typedef struct
     uint8_t ui8Malformed;
     uint8_t ui8RealVid;
     uint8_t ui8Contradiction;
+    uint8_t ui8Mutations;
     uint32_t ui32Fitness;
 } AttackGenome;
 
@@ -20,6 +21,7 @@ extern uint32_t g_ui32EvolveGeneration;
 void PortGremlinEvolveInit(void);
 void PortGremlinEvolveToggle(void);
 void PortGremlinEvolveApply(void);
+void PortGremlinEvolveSet(const AttackGenome *psGenome);
 void PortGremlinEvolveReward(void);
 void PortGremlinEvolvePunish(void);
 void PortGremlinEvolveTick(void);
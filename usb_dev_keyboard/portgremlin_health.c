@@ -0,0 +1,343 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portgremlin_health.h"
+#include "portgremlin_config.h"
+#include "portgremlin_oracle.h"
+#include "portgremlin_persona.h"
+#include "portgremlin_evolve.h"
+#include "portgremlin_bandit.h"
+#include "portgremlin_telemetry.h"
+#include "usblib/usblib.h"
+#include "utils/uartstdio.h"
+
+#define HEALTH_CHECKPOINT_MAGIC     0x50474850U     /* "PGHP" */
+
+/*
+ * What survives a reset. Lives in .noinit, which the startup code neither
+ * loads nor clears; the magic, size and checksum tell a checkpoint from
+ * power-on garbage.
+ */
+typedef struct
+{
+    uint32_t ui32Magic;
+    uint32_t ui32Size;
+    PortGremlinSettings sSettings;
+    uint32_t ui32Persona;
+    uint32_t ui32EvolveActive;
+    AttackGenome sGenome;
+    uint32_t ui32Generation;
+    uint32_t ui32EnumCount;
+    uint32_t ui32CycleCount;
+    BanditStats sBandit;
+    PortGremlinHealthTotals sTotals;
+    uint32_t ui32Failures;
+    /* Outage open at the reset, its length so far and its cause. */
+    uint32_t ui32Outage;
+    uint32_t ui32OutageTicks;
+    uint32_t ui32OutageCause;
+    /* HEALTH_STALL_WATCHDOG if the watchdog NMI wrote this checkpoint. */
+    uint32_t ui32ResetCause;
+    uint32_t ui32Check;
+} HealthCheckpoint;
+
+typedef struct
+{
+    /* Uptime holds the ticks of earlier boots; this boot's are added on read. */
+    PortGremlinHealthTotals sTotals;
+    uint32_t ui32Failures;
+    volatile bool bArmed;
+    uint32_t ui32ArmTick;
+    bool bTxBusy;
+    uint32_t ui32TxSince;
+    volatile HealthStall ePending;
+    bool bOutage;
+    uint32_t ui32OutageStart;
+    uint32_t ui32OutageCarry;
+    HealthStall eOutageCause;
+    uint32_t ui32LastService;
+    uint32_t ui32LastCheckpoint;
+} HealthState;
+
+static HealthCheckpoint g_sHealthCheckpoint __attribute__((section(".noinit")));
+static HealthState g_sHealth;
+
+static const char * const g_ppcStallNames[HEALTH_STALL_NUM] =
+{
+    "none",
+    "connect",
+    "tx",
+    "wdog"
+};
+
+/* FNV-1a over everything before the checksum. */
+static uint32_t HealthChecksum(const HealthCheckpoint *psCheckpoint)
+{
+    const uint8_t *pui8Byte = (const uint8_t *)psCheckpoint;
+    uint32_t ui32Hash = 0x811C9DC5U;
+
+    for (uint32_t i = 0; i < offsetof(HealthCheckpoint, ui32Check); i++)
+    {
+        ui32Hash = (ui32Hash ^ pui8Byte[i]) * 0x01000193U;
+    }
+    return ui32Hash;
+}
+
+static uint32_t HealthDeadline(void)
+{
+    uint32_t ui32Shift = g_sHealth.ui32Failures < PORTGREMLIN_HEALTH_BACKOFF_MAX
+                             ? g_sHealth.ui32Failures : PORTGREMLIN_HEALTH_BACKOFF_MAX;
+
+    return (uint32_t)PORTGREMLIN_HEALTH_CONNECT_TICKS << ui32Shift;
+}
+
+static void HealthOpenOutage(HealthStall eStall, uint32_t ui32Since)
+{
+    if (!g_sHealth.bOutage)
+    {
+        g_sHealth.bOutage = true;
+        g_sHealth.ui32OutageStart = ui32Since;
+        g_sHealth.ui32OutageCarry = 0;
+        g_sHealth.eOutageCause = eStall;
+    }
+}
+
+static void HealthWrite(HealthStall eResetCause)
+{
+    HealthCheckpoint *psCheckpoint = &g_sHealthCheckpoint;
+
+    psCheckpoint->ui32Magic = HEALTH_CHECKPOINT_MAGIC;
+    psCheckpoint->ui32Size = sizeof(*psCheckpoint);
+    PortGremlinConfigRead(&psCheckpoint->sSettings);
+    psCheckpoint->ui32Persona = (uint32_t)g_ePersona;
+    psCheckpoint->ui32EvolveActive = g_bEvolveActive;
+    psCheckpoint->sGenome = g_sGenome;
+    psCheckpoint->ui32Generation = g_ui32EvolveGeneration;
+    psCheckpoint->ui32EnumCount = g_sConfig.ui32EnumCount;
+    psCheckpoint->ui32CycleCount = g_sConfig.ui32CycleCount;
+    psCheckpoint->sBandit = g_sBandit;
+    psCheckpoint->sTotals = g_sHealth.sTotals;
+    psCheckpoint->sTotals.ui32UptimeTicks += g_ui32SysTickCount;
+    psCheckpoint->ui32Failures = g_sHealth.ui32Failures;
+    psCheckpoint->ui32Outage = g_sHealth.bOutage;
+    psCheckpoint->ui32OutageTicks = g_sHealth.bOutage
+        ? g_sHealth.ui32OutageCarry + (g_ui32SysTickCount - g_sHealth.ui32OutageStart) : 0U;
+    psCheckpoint->ui32OutageCause = (uint32_t)g_sHealth.eOutageCause;
+    psCheckpoint->ui32ResetCause = (uint32_t)eResetCause;
+    psCheckpoint->ui32Check = HealthChecksum(psCheckpoint);
+    g_sHealth.ui32LastCheckpoint = g_ui32SysTickCount;
+}
+
+/*
+ * Called once at boot, after the other modules' Init, with the platform's
+ * reset cause. Restores the last checkpoint if there is a valid one and
+ * returns true; after a power-on, or with no checkpoint, starts afresh.
+ */
+bool PortGremlinHealthInit(bool bPowerOn, bool bWatchdogReset)
+{
+    HealthCheckpoint *psCheckpoint = &g_sHealthCheckpoint;
+    PortGremlinSettings *psSettings;
+    bool bBitten;
+
+    memset(&g_sHealth, 0, sizeof(g_sHealth));
+
+    if (bPowerOn ||
+        psCheckpoint->ui32Magic != HEALTH_CHECKPOINT_MAGIC ||
+        psCheckpoint->ui32Size != sizeof(*psCheckpoint) ||
+        psCheckpoint->ui32Check != HealthChecksum(psCheckpoint) ||
+        psCheckpoint->ui32Persona >= (uint32_t)PERSONA_NUM ||
+        psCheckpoint->sBandit.ui32Arm >= PORTGREMLIN_BANDIT_ARMS)
+    {
+        g_sHealth.sTotals.ui32Boots = 1;
+        HealthWrite(HEALTH_STALL_NONE);
+        return false;
+    }
+
+    psSettings = PortGremlinConfigBegin();
+    *psSettings = psCheckpoint->sSettings;
+    PortGremlinConfigCommit();
+    g_ePersona = (GremlinPersona)psCheckpoint->ui32Persona;
+    g_bEvolveActive = psCheckpoint->ui32EvolveActive != 0U;
+    g_sGenome = psCheckpoint->sGenome;
+    g_ui32EvolveGeneration = psCheckpoint->ui32Generation;
+    g_sConfig.ui32EnumCount = psCheckpoint->ui32EnumCount;
+    g_sConfig.ui32CycleCount = psCheckpoint->ui32CycleCount;
+    g_sBandit = psCheckpoint->sBandit;
+
+    g_sHealth.sTotals = psCheckpoint->sTotals;
+    g_sHealth.sTotals.ui32Boots++;
+    g_sHealth.ui32Failures = psCheckpoint->ui32Failures;
+    if (psCheckpoint->ui32Outage)
+    {
+        g_sHealth.bOutage = true;
+        g_sHealth.ui32OutageCarry = psCheckpoint->ui32OutageTicks;
+        g_sHealth.eOutageCause = (HealthStall)psCheckpoint->ui32OutageCause;
+    }
+
+    /* A second-stage watchdog reset, with no NMI to record it. */
+    bBitten = psCheckpoint->ui32ResetCause == (uint32_t)HEALTH_STALL_WATCHDOG;
+    if (bWatchdogReset && !bBitten)
+    {
+        g_sHealth.sTotals.ui32WatchdogResets++;
+        g_sHealth.ui32Failures++;
+        HealthOpenOutage(HEALTH_STALL_WATCHDOG, 0);
+        bBitten = true;
+    }
+    if (bBitten)
+    {
+        PortGremlinTelemetryRecovery(g_ppcStallNames[HEALTH_STALL_WATCHDOG], "full",
+                                     g_sHealth.ui32Failures);
+    }
+
+    /* Else every boot replays the identities of the one before. */
+    srand((unsigned int)rand() ^ (g_sHealth.sTotals.ui32Boots * 0x9E3779B9U));
+
+    UARTprintf("Resumed from checkpoint (boot %u, gen %u, %u enums)\n\r",
+               g_sHealth.sTotals.ui32Boots, g_ui32EvolveGeneration, g_sConfig.ui32EnumCount);
+    HealthWrite(HEALTH_STALL_NONE);
+    return true;
+}
+
+/* Called after every USBDevConnect(); arms the connect deadline. */
+void PortGremlinHealthOnConnect(void)
+{
+    if (!g_sHealth.bArmed)
+    {
+        g_sHealth.ui32ArmTick = g_ui32SysTickCount;
+        g_sHealth.bArmed = true;
+    }
+}
+
+/* Any bus event from the host is a sign of life, and ends an outage. */
+void PortGremlinHealthOnEvent(uint32_t ui32Event)
+{
+    uint32_t ui32Down;
+
+    if (ui32Event != USB_EVENT_CONNECTED && ui32Event != USB_EVENT_RESET &&
+        ui32Event != USB_EVENT_CONFIG_SET)
+    {
+        return;
+    }
+
+    g_sHealth.bArmed = false;
+    g_sHealth.ui32Failures = 0;
+    if (!g_sHealth.bOutage)
+    {
+        return;
+    }
+
+    ui32Down = g_sHealth.ui32OutageCarry + (g_ui32SysTickCount - g_sHealth.ui32OutageStart);
+    g_sHealth.bOutage = false;
+    g_sHealth.sTotals.ui32Outages++;
+    g_sHealth.sTotals.ui32DowntimeTicks += ui32Down;
+    PortGremlinTelemetryRecovered(g_ppcStallNames[g_sHealth.eOutageCause], ui32Down,
+                                  g_sHealth.sTotals.ui32DowntimeTicks);
+}
+
+/* SysTick: flags a stall for the main loop to act on. */
+void PortGremlinHealthTick(bool bTxBusy)
+{
+    uint32_t ui32Now = g_ui32SysTickCount;
+
+    if (!bTxBusy)
+    {
+        g_sHealth.bTxBusy = false;
+    }
+    else if (!g_sHealth.bTxBusy)
+    {
+        g_sHealth.bTxBusy = true;
+        g_sHealth.ui32TxSince = ui32Now;
+    }
+
+    if (g_sHealth.ePending != HEALTH_STALL_NONE)
+    {
+        return;
+    }
+
+    if (g_sHealth.bArmed && ui32Now - g_sHealth.ui32ArmTick >= HealthDeadline())
+    {
+        HealthOpenOutage(HEALTH_STALL_CONNECT, g_sHealth.ui32ArmTick);
+        g_sHealth.ePending = HEALTH_STALL_CONNECT;
+    }
+    else if (g_sHealth.bTxBusy && ui32Now - g_sHealth.ui32TxSince >= PORTGREMLIN_HEALTH_TX_TICKS)
+    {
+        HealthOpenOutage(HEALTH_STALL_TX, g_sHealth.ui32TxSince);
+        g_sHealth.ePending = HEALTH_STALL_TX;
+    }
+}
+
+/* Main loop: checkpoints, and carries out the recovery SysTick asked for. */
+void PortGremlinHealthService(void)
+{
+    HealthStall eStall = g_sHealth.ePending;
+
+    g_sHealth.ui32LastService = g_ui32SysTickCount;
+    if (g_ui32SysTickCount - g_sHealth.ui32LastCheckpoint >= PORTGREMLIN_HEALTH_CHECKPOINT_TICKS)
+    {
+        HealthWrite(HEALTH_STALL_NONE);
+    }
+
+    if (eStall == HEALTH_STALL_NONE)
+    {
+        return;
+    }
+
+    g_sHealth.bArmed = false;
+    g_sHealth.bTxBusy = false;
+    g_sHealth.ui32Failures++;
+
+    if (g_sHealth.ui32Failures % PORTGREMLIN_HEALTH_FULL_EVERY == 0U)
+    {
+        g_sHealth.sTotals.ui32FullResets++;
+        PortGremlinTelemetryRecovery(g_ppcStallNames[eStall], "full", g_sHealth.ui32Failures);
+        g_sHealth.ePending = HEALTH_STALL_NONE;
+        HealthWrite(eStall);
+        PortGremlinHealthResetSystem();
+        return;
+    }
+
+    g_sHealth.sTotals.ui32UsbResets++;
+    PortGremlinTelemetryRecovery(g_ppcStallNames[eStall], "usb", g_sHealth.ui32Failures);
+    g_sHealth.ePending = HEALTH_STALL_NONE;
+    PortGremlinHealthResetUSB();
+}
+
+/*
+ * From the watchdog NMI: the main loop has not been serviced for a whole
+ * watchdog period. The outage runs from its last pass.
+ */
+void PortGremlinHealthOnWatchdog(void)
+{
+    g_sHealth.sTotals.ui32WatchdogResets++;
+    g_sHealth.ui32Failures++;
+    HealthOpenOutage(HEALTH_STALL_WATCHDOG, g_sHealth.ui32LastService);
+    HealthWrite(HEALTH_STALL_WATCHDOG);
+}
+
+void PortGremlinHealthTotalsGet(PortGremlinHealthTotals *psTotals)
+{
+    *psTotals = g_sHealth.sTotals;
+    psTotals->ui32UptimeTicks += g_ui32SysTickCount;
+}
+
+/* Starts the totals over, as if from power-on, without resetting. */
+void PortGremlinHealthClear(void)
+{
+    memset(&g_sHealth.sTotals, 0, sizeof(g_sHealth.sTotals));
+    g_sHealth.sTotals.ui32Boots = 1;
+    /* Uptime is reported as this plus the tick count, so start it at zero. */
+    g_sHealth.sTotals.ui32UptimeTicks = 0U - g_ui32SysTickCount;
+    g_sHealth.ui32Failures = 0;
+    g_sHealth.bOutage = false;
+    HealthWrite(HEALTH_STALL_NONE);
+}
+
+void PortGremlinHealthDump(void)
+{
+    PortGremlinHealthTotals sTotals;
+
+    PortGremlinHealthTotalsGet(&sTotals);
+    PortGremlinTelemetryHealth(&sTotals, g_sHealth.bOutage);
+}
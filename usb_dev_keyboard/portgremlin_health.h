@@ -0,0 +1,73 @@
+#ifndef PORTGREMLIN_HEALTH_H
+#define PORTGREMLIN_HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Health supervisor. SysTick calls PortGremlinHealthTick(), which watches
+ * for two ways a campaign stalls without crashing: no bus event (reset,
+ * CONNECTED or SET_CONFIGURATION) within PORTGREMLIN_HEALTH_CONNECT_TICKS
+ * of the first USBDevConnect since the last one, and a keyboard report
+ * stuck in flight. The main loop's PortGremlinHealthService() answers a
+ * stall with a USB controller reset, and every third consecutive stall
+ * with a full reset; each failed recovery doubles the deadline, so a lab
+ * host that is simply switched off is not reset into the ground.
+ *
+ * Hard wedges (usblib or the controller hanging inside an ISR or a
+ * Term/Init call) are left to the hardware watchdog, which the platform
+ * feeds from the main loop. The campaign state is checkpointed into RAM
+ * the startup code does not clear, every PORTGREMLIN_HEALTH_CHECKPOINT_TICKS
+ * and just before any reset, so a reboot resumes with the same settings,
+ * persona, genome, bandit statistics and counters.
+ *
+ * Every outage is timed from the last sign of life to the first bus event
+ * after recovery. `rec` records report the recovery taken, `recd` the
+ * outage it closed, and !hl the totals and duty cycle across boots.
+ */
+
+#define PORTGREMLIN_HEALTH_CONNECT_TICKS    300
+#define PORTGREMLIN_HEALTH_TX_TICKS         100
+#define PORTGREMLIN_HEALTH_CHECKPOINT_TICKS 100
+/* Deadlines double per failed recovery, up to this many times. */
+#define PORTGREMLIN_HEALTH_BACKOFF_MAX      5
+/* Every Nth consecutive recovery is a full reset rather than a USB reset. */
+#define PORTGREMLIN_HEALTH_FULL_EVERY       3
+/* First watchdog timeout; the hardware resets on the second. */
+#define PORTGREMLIN_HEALTH_WATCHDOG_MS      3000
+
+typedef enum
+{
+    HEALTH_STALL_NONE = 0,
+    HEALTH_STALL_CONNECT,
+    HEALTH_STALL_TX,
+    HEALTH_STALL_WATCHDOG,
+    HEALTH_STALL_NUM
+} HealthStall;
+
+typedef struct
+{
+    uint32_t ui32Boots;
+    uint32_t ui32UsbResets;
+    uint32_t ui32FullResets;
+    uint32_t ui32WatchdogResets;
+    uint32_t ui32Outages;
+    uint32_t ui32DowntimeTicks;
+    uint32_t ui32UptimeTicks;
+} PortGremlinHealthTotals;
+
+/* Provided by the platform. PortGremlinHealthResetSystem() need not return. */
+void PortGremlinHealthResetUSB(void);
+void PortGremlinHealthResetSystem(void);
+
+bool PortGremlinHealthInit(bool bPowerOn, bool bWatchdogReset);
+void PortGremlinHealthOnConnect(void);
+void PortGremlinHealthOnEvent(uint32_t ui32Event);
+void PortGremlinHealthTick(bool bTxBusy);
+void PortGremlinHealthService(void);
+void PortGremlinHealthOnWatchdog(void);
+void PortGremlinHealthTotalsGet(PortGremlinHealthTotals *psTotals);
+void PortGremlinHealthClear(void);
+void PortGremlinHealthDump(void);
+
+#endif
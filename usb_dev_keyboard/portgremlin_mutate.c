@@ -0,0 +1,736 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portgremlin_mutate.h"
+#include "portgremlin_telemetry.h"
+
+#define DTYPE_DEVICE            0x01
+#define DTYPE_CONFIGURATION     0x02
+#define DTYPE_INTERFACE         0x04
+#define DTYPE_ENDPOINT          0x05
+#define DTYPE_HID               0x21
+
+#define DEVICE_DESC_LEN         18
+#define CONFIG_DESC_LEN         9
+#define HID_DESC_LEN            9
+
+#define ARENA_DEVICE            (g_pui8Arena)
+#define ARENA_CONFIG            (g_pui8Arena + PORTGREMLIN_MUTATE_DEVICE_BYTES)
+#define ARENA_REPORT            (ARENA_CONFIG + PORTGREMLIN_MUTATE_CONFIG_BYTES)
+
+/* HID report items touched by MUTATE_OP_REPORT (prefix byte, 1-byte data). */
+#define HID_ITEM_COLLECTION     0xA1
+#define HID_ITEM_END_COLLECTION 0xC0
+#define HID_ITEM_REPORT_SIZE    0x75
+#define HID_ITEM_REPORT_COUNT   0x95
+#define HID_ITEM_LOGICAL_MIN    0x15
+#define HID_ITEM_LOGICAL_MAX    0x25
+#define HID_ITEM_LONG           0xFE
+#define HID_MAX_ITEMS           64
+
+typedef struct
+{
+    uint16_t ui16Offset;
+    uint8_t ui8Len;
+    uint8_t ui8Type;
+} DescSpan;
+
+/* A field worth lying about, by descriptor type, with its boundary values. */
+typedef struct
+{
+    uint8_t ui8Type;
+    uint8_t ui8Offset;
+    uint8_t ui8Width;
+    uint16_t pui16Values[4];
+} MutateFieldSpec;
+
+static const MutateFieldSpec g_psMutateFields[] =
+{
+    { DTYPE_DEVICE, 2, 2, { 0x0000, 0x0110, 0x0300, 0xFFFF } },     /* bcdUSB */
+    { DTYPE_DEVICE, 4, 1, { 0x00, 0x09, 0xEF, 0xFF } },             /* bDeviceClass */
+    { DTYPE_DEVICE, 7, 1, { 0, 7, 9, 255 } },                       /* bMaxPacketSize0 */
+    { DTYPE_DEVICE, 14, 1, { 0x00, 0x20, 0x7F, 0xFF } },            /* iManufacturer */
+    { DTYPE_DEVICE, 17, 1, { 0, 2, 8, 255 } },                      /* bNumConfigurations */
+    { DTYPE_CONFIGURATION, 5, 1, { 0, 2, 0x80, 0xFF } },            /* bConfigurationValue */
+    { DTYPE_CONFIGURATION, 7, 1, { 0x00, 0x40, 0x7F, 0xFF } },      /* bmAttributes */
+    { DTYPE_CONFIGURATION, 8, 1, { 0, 1, 0xFA, 0xFF } },            /* bMaxPower */
+    { DTYPE_INTERFACE, 2, 1, { 1, 7, 0x80, 0xFF } },                /* bInterfaceNumber */
+    { DTYPE_INTERFACE, 3, 1, { 1, 0x80, 0xFE, 0xFF } },             /* bAlternateSetting */
+    { DTYPE_INTERFACE, 5, 1, { 0x00, 0x08, 0x09, 0xFF } },          /* bInterfaceClass */
+    { DTYPE_INTERFACE, 6, 1, { 0x00, 0x01, 0x02, 0xFF } },          /* bInterfaceSubClass */
+    { DTYPE_INTERFACE, 7, 1, { 0x00, 0x02, 0x03, 0xFF } },          /* bInterfaceProtocol */
+    { DTYPE_ENDPOINT, 2, 1, { 0x00, 0x80, 0x0F, 0x8F } },           /* bEndpointAddress */
+    { DTYPE_ENDPOINT, 3, 1, { 0x00, 0x01, 0x0D, 0xFF } },           /* bmAttributes */
+    { DTYPE_ENDPOINT, 4, 2, { 0x0000, 0x0001, 0x07FF, 0xFFFF } },   /* wMaxPacketSize */
+    { DTYPE_ENDPOINT, 6, 1, { 0x00, 0x01, 0x10, 0xFF } },           /* bInterval */
+    { DTYPE_HID, 2, 2, { 0x0000, 0x0001, 0x0200, 0xFFFF } },        /* bcdHID */
+    { DTYPE_HID, 4, 1, { 0x00, 0x21, 0x35, 0xFF } },                /* bCountryCode */
+    { DTYPE_HID, 6, 1, { 0x00, 0x21, 0x23, 0xFF } },                /* bDescriptorType */
+};
+
+#define NUM_MUTATE_FIELDS   (sizeof(g_psMutateFields) / sizeof(g_psMutateFields[0]))
+
+/* Descriptor types MUTATE_OP_NESTING drops into the middle of a config. */
+static const uint8_t g_pui8StrayTypes[] = { 0x00, 0x0B, 0x24, 0x25, 0xFF };
+
+static const char * const g_ppcMutateOpNames[MUTATE_NUM_OPS] =
+{
+    "length",
+    "field",
+    "count",
+    "nesting",
+    "short",
+    "report"
+};
+
+/*
+ * Device, config and report slots back to back. The device descriptor is
+ * answered with its own bLength, so the arena must outlast 255 bytes from
+ * its start.
+ */
+static uint8_t g_pui8Arena[PORTGREMLIN_MUTATE_DEVICE_BYTES + PORTGREMLIN_MUTATE_CONFIG_BYTES +
+                           PORTGREMLIN_MUTATE_REPORT_BYTES];
+
+static uint8_t g_pui8PristineDevice[DEVICE_DESC_LEN];
+static uint8_t g_pui8PristineConfig[PORTGREMLIN_MUTATE_CONFIG_BYTES];
+static uint8_t g_pui8PristineReport[PORTGREMLIN_MUTATE_REPORT_BYTES];
+static uint32_t g_ui32PristineConfigLen;
+static uint32_t g_ui32PristineReportLen;
+static bool g_bMutateLoaded;
+
+static uint32_t g_ui32ConfigLen;
+static uint32_t g_ui32ReportLen;
+static uint32_t g_ui32ReportServe;
+static DescSpan g_psDescs[PORTGREMLIN_MUTATE_MAX_DESCS];
+static uint32_t g_ui32NumDescs;
+static PortGremlinDescSet g_sDescSet;
+
+static uint32_t MutateRand(uint32_t ui32Range)
+{
+    return ui32Range ? (uint32_t)rand() % ui32Range : 0U;
+}
+
+static void PutShort(uint8_t *pui8Data, uint16_t ui16Value)
+{
+    pui8Data[0] = (uint8_t)(ui16Value & 0xFF);
+    pui8Data[1] = (uint8_t)(ui16Value >> 8);
+}
+
+/* Walks the bLength chain of the arena config; stops at the first bad link. */
+static void ParseConfig(void)
+{
+    uint32_t ui32Offset = 0;
+
+    g_ui32NumDescs = 0;
+    while (ui32Offset + 2U <= g_ui32ConfigLen && g_ui32NumDescs < PORTGREMLIN_MUTATE_MAX_DESCS)
+    {
+        uint8_t ui8Len = ARENA_CONFIG[ui32Offset];
+
+        if (ui8Len < 2U || ui32Offset + ui8Len > g_ui32ConfigLen)
+        {
+            break;
+        }
+        g_psDescs[g_ui32NumDescs].ui16Offset = (uint16_t)ui32Offset;
+        g_psDescs[g_ui32NumDescs].ui8Len = ui8Len;
+        g_psDescs[g_ui32NumDescs].ui8Type = ARENA_CONFIG[ui32Offset + 1U];
+        g_ui32NumDescs++;
+        ui32Offset += ui8Len;
+    }
+}
+
+static uint32_t CountType(uint8_t ui8Type)
+{
+    uint32_t ui32Count = (ui8Type == DTYPE_DEVICE) ? 1U : 0U;
+
+    for (uint32_t i = 0; i < g_ui32NumDescs; i++)
+    {
+        if (g_psDescs[i].ui8Type == ui8Type)
+        {
+            ui32Count++;
+        }
+    }
+    return ui32Count;
+}
+
+/* The nth descriptor of a type: its bytes and length, or NULL. */
+static uint8_t *FindType(uint8_t ui8Type, uint32_t ui32Nth, uint32_t *pui32Len)
+{
+    if (ui8Type == DTYPE_DEVICE)
+    {
+        *pui32Len = DEVICE_DESC_LEN;
+        return ARENA_DEVICE;
+    }
+    for (uint32_t i = 0; i < g_ui32NumDescs; i++)
+    {
+        if (g_psDescs[i].ui8Type == ui8Type && ui32Nth-- == 0U)
+        {
+            *pui32Len = g_psDescs[i].ui8Len;
+            return ARENA_CONFIG + g_psDescs[i].ui16Offset;
+        }
+    }
+    return NULL;
+}
+
+static uint8_t *FirstHIDDescriptor(void)
+{
+    uint32_t ui32Len;
+    uint8_t *pui8HID = FindType(DTYPE_HID, 0, &ui32Len);
+
+    return (pui8HID && ui32Len >= HID_DESC_LEN) ? pui8HID : NULL;
+}
+
+static void SetReportServe(uint32_t ui32Len)
+{
+    uint8_t *pui8HID = FirstHIDDescriptor();
+
+    if (ui32Len > PORTGREMLIN_MUTATE_REPORT_BYTES)
+    {
+        ui32Len = PORTGREMLIN_MUTATE_REPORT_BYTES;
+    }
+    g_ui32ReportServe = ui32Len;
+    if (pui8HID)
+    {
+        PutShort(pui8HID + 7, (uint16_t)ui32Len);
+    }
+}
+
+/* --- configuration structure --- */
+
+static bool MutateNesting(void)
+{
+    uint8_t pui8Out[PORTGREMLIN_MUTATE_CONFIG_BYTES];
+    uint32_t ui32Out = 0;
+    uint32_t ui32Victim;
+    uint32_t ui32Kind = MutateRand(4);
+    uint32_t ui32Copies = 1;
+
+    if (g_ui32NumDescs < 3U)
+    {
+        return false;
+    }
+    /* Never the configuration descriptor itself. */
+    ui32Victim = 1U + MutateRand(g_ui32NumDescs - 2U);
+    if (ui32Kind == 1U)
+    {
+        ui32Copies = 2U + MutateRand(6);
+    }
+
+    for (uint32_t i = 0; i < g_ui32NumDescs; i++)
+    {
+        uint32_t ui32Index = i;
+        uint32_t ui32Repeat = 1;
+
+        if (ui32Kind == 0U && i == ui32Victim)
+        {
+            /* Swap with the next one, e.g. an endpoint ahead of its interface. */
+            ui32Index = i + 1U;
+        }
+        else if (ui32Kind == 0U && i == ui32Victim + 1U)
+        {
+            ui32Index = ui32Victim;
+        }
+        else if (i == ui32Victim)
+        {
+            ui32Repeat = (ui32Kind == 1U) ? ui32Copies : (ui32Kind == 2U) ? 0U : 1U;
+        }
+
+        while (ui32Repeat--)
+        {
+            const DescSpan *psSpan = &g_psDescs[ui32Index];
+
+            if (ui32Out + psSpan->ui8Len > sizeof(pui8Out))
+            {
+                break;
+            }
+            memcpy(pui8Out + ui32Out, ARENA_CONFIG + psSpan->ui16Offset, psSpan->ui8Len);
+            ui32Out += psSpan->ui8Len;
+        }
+
+        if (ui32Kind == 3U && i == ui32Victim)
+        {
+            uint32_t ui32Stray = 2U + MutateRand(7);
+
+            if (ui32Out + ui32Stray <= sizeof(pui8Out))
+            {
+                pui8Out[ui32Out] = (uint8_t)ui32Stray;
+                pui8Out[ui32Out + 1U] = g_pui8StrayTypes[MutateRand(sizeof(g_pui8StrayTypes))];
+                for (uint32_t j = 2; j < ui32Stray; j++)
+                {
+                    pui8Out[ui32Out + j] = (uint8_t)rand();
+                }
+                ui32Out += ui32Stray;
+            }
+        }
+    }
+
+    /* Keep whatever followed the last parsed descriptor. */
+    if (g_ui32NumDescs != 0U)
+    {
+        const DescSpan *psLast = &g_psDescs[g_ui32NumDescs - 1U];
+        uint32_t ui32Tail = g_ui32ConfigLen - (psLast->ui16Offset + psLast->ui8Len);
+
+        if (ui32Out + ui32Tail <= sizeof(pui8Out))
+        {
+            memcpy(pui8Out + ui32Out, ARENA_CONFIG + psLast->ui16Offset + psLast->ui8Len, ui32Tail);
+            ui32Out += ui32Tail;
+        }
+    }
+
+    memset(ARENA_CONFIG, 0, PORTGREMLIN_MUTATE_CONFIG_BYTES);
+    memcpy(ARENA_CONFIG, pui8Out, ui32Out);
+    g_ui32ConfigLen = ui32Out;
+    PutShort(ARENA_CONFIG + 2, (uint16_t)ui32Out);
+    ParseConfig();
+    return true;
+}
+
+static bool MutateCount(void)
+{
+    uint32_t ui32Interfaces = 0;
+    uint32_t ui32Len;
+    uint8_t *pui8Desc;
+
+    switch (MutateRand(4))
+    {
+        case 0:
+        {
+            static const int16_t pi16Deltas[] = { -1, 1, -9, 0x100 };
+
+            PutShort(ARENA_CONFIG + 2, MutateRand(4) == 0U ?
+                     (uint16_t)(MutateRand(2) ? 0xFFFF : CONFIG_DESC_LEN) :
+                     (uint16_t)(g_ui32ConfigLen + pi16Deltas[MutateRand(4)]));
+            return true;
+        }
+
+        case 1:
+            for (uint32_t i = 0; i < g_ui32NumDescs; i++)
+            {
+                if (g_psDescs[i].ui8Type == DTYPE_INTERFACE &&
+                    g_psDescs[i].ui8Len > 3U && ARENA_CONFIG[g_psDescs[i].ui16Offset + 3U] == 0U)
+                {
+                    ui32Interfaces++;
+                }
+            }
+            ARENA_CONFIG[4] = (uint8_t)(MutateRand(2) ? ui32Interfaces + 1U :
+                                        (MutateRand(2) ? 0U : 0xFFU));
+            return true;
+
+        case 2:
+            for (uint32_t i = 0; i < g_ui32NumDescs; i++)
+            {
+                uint32_t ui32Endpoints = 0;
+
+                if (g_psDescs[i].ui8Type != DTYPE_INTERFACE || g_psDescs[i].ui8Len < 5U)
+                {
+                    continue;
+                }
+                for (uint32_t j = i + 1U; j < g_ui32NumDescs &&
+                     g_psDescs[j].ui8Type != DTYPE_INTERFACE; j++)
+                {
+                    ui32Endpoints += g_psDescs[j].ui8Type == DTYPE_ENDPOINT;
+                }
+                ARENA_CONFIG[g_psDescs[i].ui16Offset + 4U] =
+                    (uint8_t)(MutateRand(2) ? ui32Endpoints + 1U + MutateRand(3) : 0U);
+                return true;
+            }
+            return false;
+
+        default:
+            pui8Desc = FindType(DTYPE_DEVICE, 0, &ui32Len);
+            pui8Desc[17] = (uint8_t)(MutateRand(2) ? 0U : 2U);
+            return true;
+    }
+}
+
+static bool MutateField(void)
+{
+    for (uint32_t ui32Try = 0; ui32Try < 8U; ui32Try++)
+    {
+        const MutateFieldSpec *psField = &g_psMutateFields[MutateRand(NUM_MUTATE_FIELDS)];
+        uint32_t ui32Count = CountType(psField->ui8Type);
+        uint32_t ui32Len;
+        uint8_t *pui8Desc;
+        uint16_t ui16Value;
+
+        if (ui32Count == 0U)
+        {
+            continue;
+        }
+        pui8Desc = FindType(psField->ui8Type, MutateRand(ui32Count), &ui32Len);
+        if (!pui8Desc || psField->ui8Offset + psField->ui8Width > ui32Len)
+        {
+            continue;
+        }
+
+        ui16Value = psField->pui16Values[MutateRand(4)];
+        if (psField->ui8Width == 2U)
+        {
+            PutShort(pui8Desc + psField->ui8Offset, ui16Value);
+        }
+        else
+        {
+            pui8Desc[psField->ui8Offset] = (uint8_t)ui16Value;
+        }
+        return true;
+    }
+    return false;
+}
+
+static bool MutateLength(void)
+{
+    uint32_t ui32Pick = MutateRand(g_ui32NumDescs + 1U);
+    uint8_t *pui8Desc;
+    uint8_t ui8Len;
+
+    pui8Desc = (ui32Pick == g_ui32NumDescs) ? ARENA_DEVICE :
+               ARENA_CONFIG + g_psDescs[ui32Pick].ui16Offset;
+    ui8Len = pui8Desc[0];
+
+    switch (MutateRand(6))
+    {
+        case 0:  pui8Desc[0] = 0;                      break;
+        case 1:  pui8Desc[0] = 1;                      break;
+        case 2:  pui8Desc[0] = 2;                      break;
+        case 3:  pui8Desc[0] = (uint8_t)(ui8Len - 1U); break;
+        case 4:  pui8Desc[0] = (uint8_t)(ui8Len + 1U); break;
+        default: pui8Desc[0] = 0xFF;                   break;
+    }
+    return true;
+}
+
+/* Answers that disagree with the lengths the descriptors declare. */
+static bool MutateShort(void)
+{
+    bool bReport = g_sDescSet.pui8HIDDescriptor != NULL && MutateRand(2) != 0U;
+    bool bLonger = MutateRand(2) != 0U;
+
+    if (bReport)
+    {
+        if (bLonger)
+        {
+            SetReportServe(g_ui32ReportLen + 1U + MutateRand(32));
+        }
+        else if (g_ui32ReportLen > 1U)
+        {
+            SetReportServe(1U + MutateRand(g_ui32ReportLen - 1U));
+        }
+        return true;
+    }
+
+    if (bLonger)
+    {
+        g_sDescSet.ui32ConfigServe = g_ui32ConfigLen + 1U + MutateRand(32);
+        if (g_sDescSet.ui32ConfigServe > PORTGREMLIN_MUTATE_CONFIG_BYTES)
+        {
+            g_sDescSet.ui32ConfigServe = PORTGREMLIN_MUTATE_CONFIG_BYTES;
+        }
+    }
+    else if (g_ui32ConfigLen > CONFIG_DESC_LEN)
+    {
+        /* Sometimes the bare configuration descriptor, as if the rest never came. */
+        g_sDescSet.ui32ConfigServe = MutateRand(4) == 0U ? CONFIG_DESC_LEN :
+            CONFIG_DESC_LEN + MutateRand(g_ui32ConfigLen - CONFIG_DESC_LEN);
+    }
+    return true;
+}
+
+/* --- HID report descriptor --- */
+
+/* Offsets of the report's items; long items count as one. */
+static uint32_t ParseReport(uint16_t *pui16Items)
+{
+    uint32_t ui32Offset = 0;
+    uint32_t ui32Items = 0;
+
+    while (ui32Offset < g_ui32ReportLen && ui32Items < HID_MAX_ITEMS)
+    {
+        uint8_t ui8Prefix = ARENA_REPORT[ui32Offset];
+        uint32_t ui32Size;
+
+        if (ui8Prefix == HID_ITEM_LONG && ui32Offset + 1U < g_ui32ReportLen)
+        {
+            ui32Size = 3U + ARENA_REPORT[ui32Offset + 1U];
+        }
+        else
+        {
+            ui32Size = 1U + ((ui8Prefix & 3U) == 3U ? 4U : (ui8Prefix & 3U));
+        }
+        pui16Items[ui32Items++] = (uint16_t)ui32Offset;
+        ui32Offset += ui32Size;
+    }
+    return ui32Items;
+}
+
+static bool ReportInsert(uint32_t ui32Offset, const uint8_t *pui8Bytes, uint32_t ui32Len)
+{
+    if (g_ui32ReportLen + ui32Len > PORTGREMLIN_MUTATE_REPORT_BYTES)
+    {
+        return false;
+    }
+    memmove(ARENA_REPORT + ui32Offset + ui32Len, ARENA_REPORT + ui32Offset,
+            g_ui32ReportLen - ui32Offset);
+    memcpy(ARENA_REPORT + ui32Offset, pui8Bytes, ui32Len);
+    g_ui32ReportLen += ui32Len;
+    return true;
+}
+
+/* The nth item with a given prefix, or -1. */
+static int32_t ReportFind(const uint16_t *pui16Items, uint32_t ui32Items, uint8_t ui8Prefix,
+                          bool bLast)
+{
+    int32_t i32Found = -1;
+
+    for (uint32_t i = 0; i < ui32Items; i++)
+    {
+        if (ARENA_REPORT[pui16Items[i]] == ui8Prefix)
+        {
+            i32Found = (int32_t)i;
+            if (!bLast)
+            {
+                break;
+            }
+        }
+    }
+    return i32Found;
+}
+
+/* Overwrites an item's first data byte, unless the item was cut off before it. */
+static bool ReportSetData(uint32_t ui32Offset, uint8_t ui8Value)
+{
+    if (ui32Offset + 1U >= g_ui32ReportLen)
+    {
+        return false;
+    }
+    ARENA_REPORT[ui32Offset + 1U] = ui8Value;
+    return true;
+}
+
+static bool MutateReport(void)
+{
+    uint16_t pui16Items[HID_MAX_ITEMS];
+    uint32_t ui32Items = ParseReport(pui16Items);
+    uint8_t pui8Bytes[48];
+    int32_t i32Item;
+    uint32_t ui32Offset;
+    bool bEdited;
+
+    if (ui32Items == 0U)
+    {
+        return false;
+    }
+
+    switch (MutateRand(7))
+    {
+        case 0:
+            /* Unbalanced: the last End Collection goes missing. */
+            i32Item = ReportFind(pui16Items, ui32Items, HID_ITEM_END_COLLECTION, true);
+            if (i32Item < 0)
+            {
+                return false;
+            }
+            ui32Offset = pui16Items[i32Item];
+            memmove(ARENA_REPORT + ui32Offset, ARENA_REPORT + ui32Offset + 1U,
+                    g_ui32ReportLen - ui32Offset - 1U);
+            g_ui32ReportLen--;
+            ARENA_REPORT[g_ui32ReportLen] = 0;
+            return true;
+
+        case 1:
+        {
+            /* Collections nested deeper than any parser's stack expects. */
+            uint32_t ui32Depth = 8U + MutateRand(16);
+
+            i32Item = ReportFind(pui16Items, ui32Items, HID_ITEM_COLLECTION, false);
+            ui32Offset = i32Item < 0 ? 0U : pui16Items[i32Item];
+            for (uint32_t i = 0; i < ui32Depth; i++)
+            {
+                pui8Bytes[2U * i] = HID_ITEM_COLLECTION;
+                pui8Bytes[2U * i + 1U] = (uint8_t)MutateRand(3);
+            }
+            return ReportInsert(ui32Offset, pui8Bytes, 2U * ui32Depth);
+        }
+
+        case 2:
+            /* Report Size or Count at its extremes. */
+            i32Item = ReportFind(pui16Items, ui32Items,
+                                 MutateRand(2) ? HID_ITEM_REPORT_SIZE : HID_ITEM_REPORT_COUNT, false);
+            if (i32Item < 0)
+            {
+                return false;
+            }
+            return ReportSetData(pui16Items[i32Item], (uint8_t)(MutateRand(2) ? 0x00 : 0xFF));
+
+        case 3:
+            /* An item whose size bits lie, so everything after it misparses. */
+            ui32Offset = pui16Items[MutateRand(ui32Items)];
+            if (ARENA_REPORT[ui32Offset] == HID_ITEM_LONG)
+            {
+                return false;
+            }
+            ARENA_REPORT[ui32Offset] ^= (uint8_t)(1U + MutateRand(3));
+            return true;
+
+        case 4:
+            /* Logical Minimum above Logical Maximum. */
+            bEdited = false;
+            i32Item = ReportFind(pui16Items, ui32Items, HID_ITEM_LOGICAL_MIN, false);
+            if (i32Item >= 0)
+            {
+                bEdited = ReportSetData(pui16Items[i32Item], 0x7F);
+            }
+            i32Item = ReportFind(pui16Items, ui32Items, HID_ITEM_LOGICAL_MAX, false);
+            if (i32Item >= 0)
+            {
+                bEdited = ReportSetData(pui16Items[i32Item], 0x80) || bEdited;
+            }
+            return bEdited;
+
+        case 5:
+            /* A long item that claims more data than the descriptor holds. */
+            pui8Bytes[0] = HID_ITEM_LONG;
+            pui8Bytes[1] = 0xFF;
+            pui8Bytes[2] = (uint8_t)rand();
+            return ReportInsert(pui16Items[MutateRand(ui32Items)], pui8Bytes, 3);
+
+        default:
+            /* More End Collections than Collections. */
+            memset(pui8Bytes, HID_ITEM_END_COLLECTION, 4);
+            return ReportInsert(g_ui32ReportLen, pui8Bytes, 1U + MutateRand(4));
+    }
+}
+
+uint8_t *PortGremlinMutateConfigSlot(void)
+{
+    return g_pui8PristineConfig;
+}
+
+bool PortGremlinMutateLoad(const uint8_t *pui8Device, const uint8_t *pui8Config,
+                           uint32_t ui32ConfigLen, const uint8_t *pui8Report,
+                           uint32_t ui32ReportLen)
+{
+    g_bMutateLoaded = false;
+    if (!pui8Device || !pui8Config || ui32ConfigLen < CONFIG_DESC_LEN ||
+        ui32ConfigLen > PORTGREMLIN_MUTATE_CONFIG_BYTES ||
+        ui32ReportLen > PORTGREMLIN_MUTATE_REPORT_BYTES)
+    {
+        return false;
+    }
+
+    memcpy(g_pui8PristineDevice, pui8Device, DEVICE_DESC_LEN);
+    if (pui8Config != g_pui8PristineConfig)
+    {
+        memcpy(g_pui8PristineConfig, pui8Config, ui32ConfigLen);
+    }
+    g_ui32PristineConfigLen = ui32ConfigLen;
+    g_ui32PristineReportLen = pui8Report ? ui32ReportLen : 0U;
+    if (g_ui32PristineReportLen)
+    {
+        memcpy(g_pui8PristineReport, pui8Report, g_ui32PristineReportLen);
+    }
+    g_bMutateLoaded = true;
+    return true;
+}
+
+/*
+ * One to three edits, each by an operator drawn from ui32OpMask, applied
+ * structure first: nesting and report edits move bytes and are reparsed,
+ * field and count edits keep lengths, and length and short edits come last
+ * because nothing after them could parse the result.
+ */
+const PortGremlinDescSet *PortGremlinMutateApply(uint32_t ui32OpMask)
+{
+    static const MutateOp peOrder[MUTATE_NUM_OPS] =
+    {
+        MUTATE_OP_NESTING, MUTATE_OP_REPORT, MUTATE_OP_COUNT,
+        MUTATE_OP_FIELD, MUTATE_OP_LENGTH, MUTATE_OP_SHORT
+    };
+    uint32_t pui32Edits[MUTATE_NUM_OPS] = { 0 };
+    uint32_t ui32Enabled = 0;
+    uint32_t ui32Draws;
+
+    if (!g_bMutateLoaded)
+    {
+        return NULL;
+    }
+
+    memset(g_pui8Arena, 0, sizeof(g_pui8Arena));
+    memcpy(ARENA_DEVICE, g_pui8PristineDevice, DEVICE_DESC_LEN);
+    memcpy(ARENA_CONFIG, g_pui8PristineConfig, g_ui32PristineConfigLen);
+    memcpy(ARENA_REPORT, g_pui8PristineReport, g_ui32PristineReportLen);
+    g_ui32ConfigLen = g_ui32PristineConfigLen;
+    g_ui32ReportLen = g_ui32PristineReportLen;
+    ParseConfig();
+
+    memset(&g_sDescSet, 0, sizeof(g_sDescSet));
+    g_sDescSet.pui8Device = ARENA_DEVICE;
+    g_sDescSet.pui8Config = ARENA_CONFIG;
+    g_sDescSet.pui8Report = ARENA_REPORT;
+
+    ui32OpMask &= PORTGREMLIN_MUTATE_ALL;
+    for (uint32_t i = 0; i < MUTATE_NUM_OPS; i++)
+    {
+        ui32Enabled += (ui32OpMask >> i) & 1U;
+    }
+    ui32Draws = ui32Enabled ? 1U + MutateRand(3) : 0U;
+    while (ui32Draws--)
+    {
+        uint32_t ui32Pick = MutateRand(ui32Enabled);
+
+        for (uint32_t i = 0; i < MUTATE_NUM_OPS; i++)
+        {
+            if ((ui32OpMask & (1U << i)) && ui32Pick-- == 0U)
+            {
+                pui32Edits[i]++;
+                break;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < MUTATE_NUM_OPS; i++)
+    {
+        MutateOp eOp = peOrder[i];
+
+        if (eOp == MUTATE_OP_LENGTH)
+        {
+            /* Last point where the HID descriptor can still be found. */
+            g_sDescSet.pui8HIDDescriptor = FirstHIDDescriptor();
+            g_sDescSet.ui32ConfigServe = g_ui32ConfigLen;
+            SetReportServe(g_ui32ReportLen);
+        }
+
+        while (pui32Edits[eOp])
+        {
+            bool bApplied;
+
+            pui32Edits[eOp]--;
+            switch (eOp)
+            {
+                case MUTATE_OP_NESTING: bApplied = MutateNesting(); break;
+                case MUTATE_OP_REPORT:  bApplied = MutateReport();  break;
+                case MUTATE_OP_COUNT:   bApplied = MutateCount();   break;
+                case MUTATE_OP_FIELD:   bApplied = MutateField();   break;
+                case MUTATE_OP_LENGTH:  bApplied = MutateLength();  break;
+                default:                bApplied = MutateShort();   break;
+            }
+            if (bApplied)
+            {
+                g_sDescSet.ui32Ops |= 1U << eOp;
+                g_sDescSet.ui32Edits++;
+            }
+        }
+    }
+    g_sDescSet.ui32ReportServe = g_ui32ReportServe;
+
+    PortGremlinTelemetryMutate(&g_sDescSet);
+    return &g_sDescSet;
+}
+
+const char *PortGremlinMutateOpName(MutateOp eOp)
+{
+    if (eOp >= MUTATE_NUM_OPS)
+    {
+        return "unknown";
+    }
+    return g_ppcMutateOpNames[eOp];
+}
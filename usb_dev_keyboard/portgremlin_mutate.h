@@ -0,0 +1,63 @@
+#ifndef PORTGREMLIN_MUTATE_H
+#define PORTGREMLIN_MUTATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Structure-aware descriptor mutation. PortGremlinMutateLoad() takes the
+ * device, configuration and HID report descriptors the class driver just
+ * built; PortGremlinMutateApply() copies them into a RAM arena, parses
+ * them and applies the operators in its mask. The firmware then points
+ * usblib at the arena, so every GET_DESCRIPTOR of that enumeration is
+ * answered from the mutated copy.
+ *
+ * Served lengths never run past the arena: the device descriptor is
+ * answered with bLength bytes and the arena is longer than 255 bytes, and
+ * the config and report answers are capped to their slots.
+ */
+
+#define PORTGREMLIN_MUTATE_DEVICE_BYTES     32
+#define PORTGREMLIN_MUTATE_CONFIG_BYTES     256
+#define PORTGREMLIN_MUTATE_REPORT_BYTES     192
+#define PORTGREMLIN_MUTATE_MAX_DESCS        24
+
+typedef enum
+{
+    MUTATE_OP_LENGTH = 0,   /* bLength of one descriptor wrong */
+    MUTATE_OP_FIELD,        /* one typed field set to a boundary value */
+    MUTATE_OP_COUNT,        /* wTotalLength / bNumInterfaces / bNumEndpoints disagree */
+    MUTATE_OP_NESTING,      /* descriptors reordered, duplicated, dropped or inserted */
+    MUTATE_OP_SHORT,        /* answers shorter or longer than the descriptor says */
+    MUTATE_OP_REPORT,       /* HID report items: collections, sizes, counts */
+    MUTATE_NUM_OPS
+} MutateOp;
+
+#define PORTGREMLIN_MUTATE_ALL      ((1U << MUTATE_NUM_OPS) - 1U)
+
+typedef struct
+{
+    const uint8_t *pui8Device;
+    const uint8_t *pui8Config;
+    uint32_t ui32ConfigServe;
+    const uint8_t *pui8Report;
+    uint32_t ui32ReportServe;
+    /* The first HID descriptor inside pui8Config, or NULL if there is none. */
+    const uint8_t *pui8HIDDescriptor;
+    uint32_t ui32Ops;
+    uint32_t ui32Edits;
+} PortGremlinDescSet;
+
+/*
+ * The pristine configuration slot PortGremlinMutateLoad() copies into. A
+ * caller may assemble the descriptor here and pass this pointer back, so
+ * no second 256-byte copy ends up on its (possibly interrupt) stack.
+ */
+uint8_t *PortGremlinMutateConfigSlot(void);
+bool PortGremlinMutateLoad(const uint8_t *pui8Device, const uint8_t *pui8Config,
+                           uint32_t ui32ConfigLen, const uint8_t *pui8Report,
+                           uint32_t ui32ReportLen);
+const PortGremlinDescSet *PortGremlinMutateApply(uint32_t ui32OpMask);
+const char *PortGremlinMutateOpName(MutateOp eOp);
+
+#endif
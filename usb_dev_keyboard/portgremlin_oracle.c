@@ -1,8 +1,12 @@
 #include "portgremlin_oracle.h"
 #include "portgremlin_persona.h"
 #include "portgremlin_config.h"
+#include "portgremlin_tuning.h"
 #include "portgremlin_telemetry.h"
 #include "portgremlin_evolve.h"
+#include "portgremlin_sof.h"
+#include "portgremlin_health.h"
+#include "portgremlin_bandit.h"
 #include "utils/uartstdio.h"
 #include "usblib/usblib.h"
 
@@ -31,12 +35,9 @@ void PortGremlinOracleInit(void)
     g_sOracle.eHost = HOST_UNKNOWN;
     g_sOracle.eBrainPhase = BRAIN_IDLE;
     g_sOracle.bBrainActive = false;
-    g_sOracle.bContradictionMode = false;
-    g_sOracle.bIdentityLocked = false;
-    g_sOracle.ui16PinnedVID = 0;
-    g_sOracle.ui16PinnedPID = 0;
     g_sOracle.ui32ResetCount = 0;
     g_sOracle.ui32ConfigLatencyTicks = 0;
+    g_sOracle.ui32ConfigLatencyFrames = 0;
     g_sOracle.ui32StableEnums = 0;
     g_sOracle.ui32Disconnects = 0;
     g_sOracle.ui32ToleranceScore = 0;
@@ -63,10 +64,17 @@ const char *PortGremlinBrainPhaseName(BrainPhase ePhase)
     return g_ppcBrainNames[ePhase];
 }
 
+/* Thresholds are in SysTicks; with SOFs flowing, frames give the same in 1 ms steps. */
 static void OracleClassifyHost(void)
 {
     uint32_t ui32Latency = g_sOracle.ui32ConfigLatencyTicks;
 
+    if (g_sOracle.ui32ConfigLatencyFrames != 0U)
+    {
+        ui32Latency = (g_sOracle.ui32ConfigLatencyFrames + PORTGREMLIN_SOF_FRAMES_PER_TICK / 2U) /
+                      PORTGREMLIN_SOF_FRAMES_PER_TICK;
+    }
+
     if (g_sOracle.ui32ResetCount >= 2U)
     {
         g_sOracle.eHost = HOST_WINDOWS;
@@ -92,9 +100,10 @@ static void OracleClassifyHost(void)
         g_sOracle.eHost = HOST_LINUX;
     }
 
-    UARTprintf("[ORACLE] Host classified: %s (cfg=%u ticks, resets=%u)\n\r",
+    UARTprintf("[ORACLE] Host classified: %s (cfg=%u ticks/%u frames, resets=%u)\n\r",
                PortGremlinHostName(g_sOracle.eHost),
                g_sOracle.ui32ConfigLatencyTicks,
+               g_sOracle.ui32ConfigLatencyFrames,
                g_sOracle.ui32ResetCount);
     PortGremlinTelemetryHost(g_sOracle.eHost, g_sOracle.ui32ConfigLatencyTicks,
                              g_sOracle.ui32ResetCount);
@@ -102,6 +111,11 @@ static void OracleClassifyHost(void)
 
 void PortGremlinOracleOnEvent(uint32_t ui32Event)
 {
+    uint32_t ui32Frames = PortGremlinSofOnEvent(ui32Event);
+
+    PortGremlinHealthOnEvent(ui32Event);
+    PortGremlinBanditOnEvent(ui32Event);
+
     switch (ui32Event)
     {
         case USB_EVENT_CONNECTED:
@@ -110,12 +124,14 @@ void PortGremlinOracleOnEvent(uint32_t ui32Event)
             g_sOracle.ui32SessionStartTick = g_ui32SysTickCount;
             g_sOracle.ui32ResetCount = 0;
             g_sOracle.ui32ConfigLatencyTicks = 0;
+            g_sOracle.ui32ConfigLatencyFrames = 0;
             break;
 
         case USB_EVENT_CONFIG_SET:
             g_sOracle.bConfigSet = true;
             g_sOracle.ui32ConfigLatencyTicks =
                 g_ui32SysTickCount - g_sOracle.ui32SessionStartTick;
+            g_sOracle.ui32ConfigLatencyFrames = ui32Frames;
             OracleClassifyHost();
             if (g_ePersona == PERSONA_SPECTRE)
             {
@@ -187,7 +203,7 @@ void PortGremlinBrainTick(void)
             break;
 
         case BRAIN_PROBE:
-            if (g_sOracle.ui32StableEnums >= 15U)
+            if (g_sOracle.ui32StableEnums >= PORTGREMLIN_BRAIN_ESCALATE_ENUMS)
             {
                 g_sOracle.eBrainPhase = BRAIN_ESCALATE;
                 PortGremlinPersonaApply(PERSONA_STORM);
@@ -197,7 +213,7 @@ void PortGremlinBrainTick(void)
             break;
 
         case BRAIN_ESCALATE:
-            if (g_sOracle.ui32StableEnums >= 40U)
+            if (g_sOracle.ui32StableEnums >= PORTGREMLIN_BRAIN_CORRUPT_ENUMS)
             {
                 g_sOracle.eBrainPhase = BRAIN_CORRUPT;
                 PortGremlinPersonaApply(PERSONA_CHIMERA);
@@ -207,11 +223,15 @@ void PortGremlinBrainTick(void)
             break;
 
         case BRAIN_CORRUPT:
-            if (g_sOracle.ui32StableEnums >= 80U)
+            if (g_sOracle.ui32StableEnums >= PORTGREMLIN_BRAIN_CHAOS_ENUMS)
             {
+                /* One version: never HAUNTED at its own interval. */
+                PortGremlinSettings *psSettings = PortGremlinConfigBegin();
+
                 g_sOracle.eBrainPhase = BRAIN_CHAOS;
                 PortGremlinPersonaApply(PERSONA_HAUNTED);
-                g_sConfig.ui32CycleIntervalTicks = PORTGREMLIN_CYCLE_INTERVAL_MIN;
+                psSettings->ui32CycleIntervalTicks = PORTGREMLIN_BRAIN_CHAOS_INTERVAL;
+                PortGremlinConfigCommit();
                 PortGremlinTelemetryBrain(BRAIN_CHAOS, g_sOracle.ui32ToleranceScore);
                 UARTprintf("[BRAIN] Maximum chaos - HAUNTED persona engaged\n\r");
             }
@@ -224,20 +244,25 @@ void PortGremlinBrainTick(void)
 
 void PortGremlinOraclePrintReport(void)
 {
+    PortGremlinSettings sSettings;
+
+    PortGremlinConfigRead(&sSettings);
     UARTprintf("\n\r=== ORACLE REPORT ===\n\r");
     UARTprintf("Host profile:  %s\n\r", PortGremlinHostName(g_sOracle.eHost));
     UARTprintf("Brain:         %s (%s)\n\r",
                g_sOracle.bBrainActive ? "ACTIVE" : "off",
                PortGremlinBrainPhaseName(g_sOracle.eBrainPhase));
-    UARTprintf("Contradiction: %s", g_sOracle.bContradictionMode ? "ON" : "OFF");
-    if (g_sOracle.bContradictionMode)
+    UARTprintf("Contradiction: %s", sSettings.bContradictionMode ? "ON" : "OFF");
+    if (sSettings.bContradictionMode)
     {
-        UARTprintf(" (VID=0x%04X PID=0x%04X)", g_sOracle.ui16PinnedVID, g_sOracle.ui16PinnedPID);
+        UARTprintf(" (VID=0x%04X PID=0x%04X)", sSettings.ui16PinnedVID, sSettings.ui16PinnedPID);
     }
     UARTprintf("\n\r");
     UARTprintf("Config latency:%u ticks (%u ms)\n\r",
                g_sOracle.ui32ConfigLatencyTicks,
                g_sOracle.ui32ConfigLatencyTicks * 10U);
+    UARTprintf("Config frames: %u  SOF drift: %d ppm\n\r",
+               g_sOracle.ui32ConfigLatencyFrames, PortGremlinSofDriftPpm());
     UARTprintf("USB resets:    %u\n\r", g_sOracle.ui32ResetCount);
     UARTprintf("Stable enums:  %u\n\r", g_sOracle.ui32StableEnums);
     UARTprintf("Disconnects:   %u\n\r", g_sOracle.ui32Disconnects);
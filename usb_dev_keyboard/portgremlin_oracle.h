@@ -27,12 +27,9 @@ typedef struct
     volatile HostProfile eHost;
     volatile BrainPhase eBrainPhase;
     volatile bool bBrainActive;
-    volatile bool bContradictionMode;
-    volatile bool bIdentityLocked;
-    volatile uint16_t ui16PinnedVID;
-    volatile uint16_t ui16PinnedPID;
     volatile uint32_t ui32ResetCount;
     volatile uint32_t ui32ConfigLatencyTicks;
+    volatile uint32_t ui32ConfigLatencyFrames;
     volatile uint32_t ui32StableEnums;
     volatile uint32_t ui32Disconnects;
     volatile uint32_t ui32ToleranceScore;
@@ -3,7 +3,9 @@
 #include "portgremlin_oracle.h"
 #include "portgremlin_mimic.h"
 #include "portgremlin_config.h"
+#include "portgremlin_tuning.h"
 #include "portgremlin_telemetry.h"
+#include "portgremlin_bandit.h"
 #include "utils/uartstdio.h"
 
 GremlinPersona g_ePersona = PERSONA_MANUAL;
@@ -16,25 +18,25 @@ typedef struct
 
 static const ChoreoStep g_psChoreoRedTeam[] =
 {
-    { PERSONA_PHANTOM, 80 },
-    { PERSONA_MIMIC, 40 },
-    { PERSONA_STORM, 20 },
-    { PERSONA_CHIMERA, 15 },
-    { PERSONA_HAUNTED, 10 },
+    { PERSONA_PHANTOM, PORTGREMLIN_REDTEAM_DWELL_0 },
+    { PERSONA_MIMIC, PORTGREMLIN_REDTEAM_DWELL_1 },
+    { PERSONA_STORM, PORTGREMLIN_REDTEAM_DWELL_2 },
+    { PERSONA_CHIMERA, PORTGREMLIN_REDTEAM_DWELL_3 },
+    { PERSONA_HAUNTED, PORTGREMLIN_REDTEAM_DWELL_4 },
 };
 
 static const ChoreoStep g_psChoreoStealth[] =
 {
-    { PERSONA_MIMIC, 120 },
-    { PERSONA_PHANTOM, 60 },
-    { PERSONA_MIMIC, 60 },
+    { PERSONA_MIMIC, PORTGREMLIN_STEALTH_DWELL_0 },
+    { PERSONA_PHANTOM, PORTGREMLIN_STEALTH_DWELL_1 },
+    { PERSONA_MIMIC, PORTGREMLIN_STEALTH_DWELL_2 },
 };
 
 static const ChoreoStep g_psChoreoBlitz[] =
 {
-    { PERSONA_STORM, 10 },
-    { PERSONA_HAUNTED, 5 },
-    { PERSONA_CHIMERA, 5 },
+    { PERSONA_STORM, PORTGREMLIN_BLITZ_DWELL_0 },
+    { PERSONA_HAUNTED, PORTGREMLIN_BLITZ_DWELL_1 },
+    { PERSONA_CHIMERA, PORTGREMLIN_BLITZ_DWELL_2 },
 };
 
 typedef struct
@@ -87,6 +89,10 @@ const char *PortGremlinPersonaName(GremlinPersona ePersona)
 
 void PortGremlinPersonaApply(GremlinPersona ePersona)
 {
+    PortGremlinSettings *psSettings = PortGremlinConfigBegin();
+    uint16_t ui16VID;
+    uint16_t ui16PID;
+
     g_ePersona = ePersona;
 
     switch (ePersona)
@@ -95,66 +101,64 @@ void PortGremlinPersonaApply(GremlinPersona ePersona)
             break;
 
         case PERSONA_CHIMERA:
-            g_sOracle.bIdentityLocked = false;
-            g_sConfig.bAutoCycle = true;
-            g_sConfig.bMalformedMode = true;
-            g_sConfig.bRandomStrings = true;
-            g_sConfig.bRealVIDPID = true;
-            g_sConfig.ui32CycleIntervalTicks = 3;
-            g_sOracle.bContradictionMode = false;
+            psSettings->bIdentityLocked = false;
+            psSettings->bAutoCycle = true;
+            psSettings->bMalformedMode = true;
+            psSettings->bRandomStrings = true;
+            psSettings->bRealVIDPID = true;
+            psSettings->ui32CycleIntervalTicks = PORTGREMLIN_CHIMERA_INTERVAL;
+            psSettings->bContradictionMode = false;
             break;
 
         case PERSONA_MIMIC:
-            g_sOracle.bIdentityLocked = false;
-            g_sConfig.bAutoCycle = true;
-            g_sConfig.bMalformedMode = false;
-            g_sConfig.bRandomStrings = false;
-            g_sConfig.bRealVIDPID = true;
-            g_sConfig.ui32CycleIntervalTicks = 15;
-            g_sOracle.bContradictionMode = false;
+            psSettings->bIdentityLocked = false;
+            psSettings->bAutoCycle = true;
+            psSettings->bMalformedMode = false;
+            psSettings->bRandomStrings = false;
+            psSettings->bRealVIDPID = true;
+            psSettings->ui32CycleIntervalTicks = PORTGREMLIN_MIMIC_INTERVAL;
+            psSettings->bContradictionMode = false;
             PortGremlinMimicApply(rand() % PortGremlinMimicCount(), NULL);
             break;
 
         case PERSONA_STORM:
-            g_sOracle.bIdentityLocked = false;
-            g_sConfig.bAutoCycle = true;
-            g_sConfig.bMalformedMode = false;
-            g_sConfig.bRandomStrings = true;
-            g_sConfig.bRealVIDPID = false;
-            g_sConfig.ui32CycleIntervalTicks = PORTGREMLIN_CYCLE_INTERVAL_MIN;
-            g_sOracle.bContradictionMode = false;
+            psSettings->bIdentityLocked = false;
+            psSettings->bAutoCycle = true;
+            psSettings->bMalformedMode = false;
+            psSettings->bRandomStrings = true;
+            psSettings->bRealVIDPID = false;
+            psSettings->ui32CycleIntervalTicks = PORTGREMLIN_STORM_INTERVAL;
+            psSettings->bContradictionMode = false;
             for (int i = 0; i < (int)NUM_DEVICE_TYPES; i++)
             {
-                g_sConfig.bClassEnabled[i] = true;
+                psSettings->bClassEnabled[i] = true;
             }
             break;
 
         case PERSONA_HAUNTED:
-            g_sConfig.bAutoCycle = true;
-            g_sConfig.bMalformedMode = true;
-            g_sConfig.bRandomStrings = false;
-            g_sConfig.bRealVIDPID = false;
-            g_sConfig.ui32CycleIntervalTicks = 4;
-            g_sOracle.bContradictionMode = true;
-            g_sOracle.ui16PinnedVID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
-            g_sOracle.ui16PinnedPID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
-            UARTprintf("[HAUNTED] Contradiction lock VID=0x%04X PID=0x%04X\n\r",
-                       g_sOracle.ui16PinnedVID, g_sOracle.ui16PinnedPID);
+            psSettings->bAutoCycle = true;
+            psSettings->bMalformedMode = true;
+            psSettings->bRandomStrings = false;
+            psSettings->bRealVIDPID = false;
+            psSettings->ui32CycleIntervalTicks = PORTGREMLIN_HAUNTED_INTERVAL;
+            psSettings->bContradictionMode = true;
+            psSettings->ui16PinnedVID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
+            psSettings->ui16PinnedPID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
             break;
 
         case PERSONA_PHANTOM:
-            g_sOracle.bIdentityLocked = false;
-            g_sConfig.bAutoCycle = true;
-            g_sConfig.bMalformedMode = false;
-            g_sConfig.bRandomStrings = false;
-            g_sConfig.bRealVIDPID = true;
-            g_sConfig.ui32CycleIntervalTicks = 50;
-            g_sOracle.bContradictionMode = false;
+            psSettings->bIdentityLocked = false;
+            psSettings->bAutoCycle = true;
+            psSettings->bMalformedMode = false;
+            psSettings->bRandomStrings = false;
+            psSettings->bRealVIDPID = true;
+            psSettings->ui32CycleIntervalTicks = PORTGREMLIN_PHANTOM_INTERVAL;
+            psSettings->bContradictionMode = false;
             break;
 
         case PERSONA_SPECTRE:
-            g_sConfig.bAutoCycle = true;
-            g_sOracle.bContradictionMode = false;
+            psSettings->bAutoCycle = true;
+            psSettings->bContradictionMode = false;
             PortGremlinPersonaForHost();
             break;
 
@@ -162,6 +166,14 @@ void PortGremlinPersonaApply(GremlinPersona ePersona)
             break;
     }
 
+    ui16VID = psSettings->ui16PinnedVID;
+    ui16PID = psSettings->ui16PinnedPID;
+    PortGremlinConfigCommit();
+
+    if (ePersona == PERSONA_HAUNTED)
+    {
+        UARTprintf("[HAUNTED] Contradiction lock VID=0x%04X PID=0x%04X\n\r", ui16VID, ui16PID);
+    }
     UARTprintf("[PERSONA] %s engaged\n\r", PortGremlinPersonaName(ePersona));
     PortGremlinTelemetryPersona(ePersona);
 }
@@ -212,6 +224,7 @@ void PortGremlinChoreoStart(uint32_t ui32ScriptId)
     g_sChoreo.ui32StepIndex = 0;
     g_sChoreo.ui32StepTicks = 0;
     g_sOracle.bBrainActive = false;
+    PortGremlinBanditStop();
 
     UARTprintf("[CHOREO] Starting '%s'\n\r", g_psChoreoScripts[ui32ScriptId].pcName);
     PortGremlinPersonaApply(g_psChoreoScripts[ui32ScriptId].psSteps[0].ePersona);
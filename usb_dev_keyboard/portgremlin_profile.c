@@ -0,0 +1,199 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "utils/uartstdio.h"
+#include "portgremlin_profile.h"
+#include "portgremlin_oracle.h"
+
+#define PROFILE_PAIRS_PER_LINE  12
+#define PROFILE_ROM_REGION      0x01000000U
+
+/* Lower than the sampler, so it can see inside the USB, UART and SysTick ISRs. */
+#define PROFILE_ISR_PRIORITY    0x20
+
+extern uint32_t __text_end;
+
+void PortGremlinProfileSample(const uint32_t *pui32Frame, uint32_t ui32ExcReturn);
+
+static uint16_t g_pui16ProfileBuckets[PORTGREMLIN_PROFILE_BUCKETS];
+static uint32_t g_ui32ProfileShift;
+static uint32_t g_ui32ProfileHz;
+static volatile uint32_t g_ui32ProfileSamples;
+static volatile uint32_t g_ui32ProfileIsr;
+static volatile uint32_t g_ui32ProfileRom;
+static volatile uint32_t g_ui32ProfileOther;
+static volatile uint32_t g_ui32ProfileHalvings;
+
+static void ProfileClear(void)
+{
+    for (uint32_t i = 0; i < PORTGREMLIN_PROFILE_BUCKETS; i++)
+    {
+        g_pui16ProfileBuckets[i] = 0;
+    }
+    g_ui32ProfileSamples = 0;
+    g_ui32ProfileIsr = 0;
+    g_ui32ProfileRom = 0;
+    g_ui32ProfileOther = 0;
+    g_ui32ProfileHalvings = 0;
+}
+
+/* Keeps relative weights when a bucket saturates instead of clipping it. */
+static void ProfileHalve(void)
+{
+    for (uint32_t i = 0; i < PORTGREMLIN_PROFILE_BUCKETS; i++)
+    {
+        g_pui16ProfileBuckets[i] >>= 1;
+    }
+    g_ui32ProfileIsr >>= 1;
+    g_ui32ProfileRom >>= 1;
+    g_ui32ProfileOther >>= 1;
+    g_ui32ProfileHalvings++;
+}
+
+/*
+ * Timer1A vector. Finds the exception frame on whichever stack was active
+ * when the timer fired and tail-calls the sampler, which returns straight
+ * to the interrupted code.
+ */
+__attribute__((naked))
+void PortGremlinProfileIntHandler(void)
+{
+    __asm volatile(
+        "    tst   lr, #4\n"
+        "    ite   eq\n"
+        "    mrseq r0, msp\n"
+        "    mrsne r0, psp\n"
+        "    mov   r1, lr\n"
+        "    b     PortGremlinProfileSample\n");
+}
+
+__attribute__((used))
+void PortGremlinProfileSample(const uint32_t *pui32Frame, uint32_t ui32ExcReturn)
+{
+    uint32_t ui32PC = pui32Frame[6];
+
+    MAP_TimerIntClear(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+    g_ui32ProfileSamples++;
+
+    /* EXC_RETURN bit 3 clear: the timer preempted another handler. */
+    if ((ui32ExcReturn & 0x8U) == 0U)
+    {
+        g_ui32ProfileIsr++;
+    }
+
+    if (ui32PC < (uint32_t)&__text_end)
+    {
+        uint32_t ui32Bucket = ui32PC >> g_ui32ProfileShift;
+
+        if (g_pui16ProfileBuckets[ui32Bucket] == 0xFFFFU)
+        {
+            ProfileHalve();
+        }
+        g_pui16ProfileBuckets[ui32Bucket]++;
+    }
+    else if ((ui32PC & 0xFF000000U) == PROFILE_ROM_REGION)
+    {
+        g_ui32ProfileRom++;
+    }
+    else
+    {
+        g_ui32ProfileOther++;
+    }
+}
+
+void PortGremlinProfileInit(void)
+{
+    g_ui32ProfileShift = 2;
+    while (((uint32_t)&__text_end >> g_ui32ProfileShift) >= PORTGREMLIN_PROFILE_BUCKETS)
+    {
+        g_ui32ProfileShift++;
+    }
+
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    MAP_TimerConfigure(TIMER1_BASE, TIMER_CFG_PERIODIC);
+    MAP_TimerIntEnable(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+
+    MAP_IntPrioritySet(INT_TIMER1A, 0x00);
+    MAP_IntPrioritySet(INT_USB0, PROFILE_ISR_PRIORITY);
+    MAP_IntPrioritySet(INT_UART0, PROFILE_ISR_PRIORITY);
+    MAP_IntPrioritySet(FAULT_SYSTICK, PROFILE_ISR_PRIORITY);
+    MAP_IntEnable(INT_TIMER1A);
+
+    PortGremlinProfileStart(PORTGREMLIN_PROFILE_HZ);
+}
+
+bool PortGremlinProfileStart(uint32_t ui32Hz)
+{
+    if (ui32Hz == 0U || ui32Hz > PORTGREMLIN_PROFILE_MAX_HZ)
+    {
+        return false;
+    }
+
+    MAP_TimerDisable(TIMER1_BASE, TIMER_A);
+    ProfileClear();
+    g_ui32ProfileHz = ui32Hz;
+    MAP_TimerLoadSet(TIMER1_BASE, TIMER_A, MAP_SysCtlClockGet() / ui32Hz - 1U);
+    MAP_TimerEnable(TIMER1_BASE, TIMER_A);
+    return true;
+}
+
+void PortGremlinProfileStop(void)
+{
+    MAP_TimerDisable(TIMER1_BASE, TIMER_A);
+    g_ui32ProfileHz = 0;
+}
+
+/*
+ * Emits one "prof" header and then the non-zero buckets as "pb" records of
+ * space-separated hex index:count pairs. Sampling pauses for the dump so
+ * the table and the totals agree; the TX buffer is drained between lines
+ * because the buffered UART drops what does not fit.
+ */
+void PortGremlinProfileDump(void)
+{
+    uint32_t ui32Pairs = 0;
+
+    MAP_TimerDisable(TIMER1_BASE, TIMER_A);
+
+    UARTprintf("@PG{\"e\":\"prof\",\"hz\":%u,\"shift\":%u,\"end\":%u,\"s\":%u,"
+               "\"isr\":%u,\"rom\":%u,\"other\":%u,\"hv\":%u,\"t\":%u}\n\r",
+               g_ui32ProfileHz, g_ui32ProfileShift, (uint32_t)&__text_end,
+               g_ui32ProfileSamples, g_ui32ProfileIsr, g_ui32ProfileRom,
+               g_ui32ProfileOther, g_ui32ProfileHalvings, g_ui32SysTickCount);
+    UARTFlushTx(false);
+
+    for (uint32_t i = 0; i < PORTGREMLIN_PROFILE_BUCKETS; i++)
+    {
+        if (g_pui16ProfileBuckets[i] == 0U)
+        {
+            continue;
+        }
+        if (ui32Pairs == 0U)
+        {
+            UARTprintf("@PG{\"e\":\"pb\",\"d\":\"");
+        }
+        UARTprintf(ui32Pairs ? " %x:%x" : "%x:%x", i, g_pui16ProfileBuckets[i]);
+        if (++ui32Pairs == PROFILE_PAIRS_PER_LINE)
+        {
+            UARTprintf("\"}\n\r");
+            UARTFlushTx(false);
+            ui32Pairs = 0;
+        }
+    }
+    if (ui32Pairs != 0U)
+    {
+        UARTprintf("\"}\n\r");
+        UARTFlushTx(false);
+    }
+
+    if (g_ui32ProfileHz != 0U)
+    {
+        MAP_TimerEnable(TIMER1_BASE, TIMER_A);
+    }
+}
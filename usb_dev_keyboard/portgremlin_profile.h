@@ -0,0 +1,26 @@
+#ifndef PORTGREMLIN_PROFILE_H
+#define PORTGREMLIN_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Sampling profiler, built with `make PROFILE=1`. Timer1A samples the
+ * stacked PC into a table of 16-bit counters covering .text; !prof dumps
+ * it as @PG "prof"/"pb" records for tools/portgremlin-profile.py.
+ */
+
+#ifndef PORTGREMLIN_PROFILE_BUCKETS
+#define PORTGREMLIN_PROFILE_BUCKETS     1024
+#endif
+
+/* Prime, so the sampler does not phase-lock with SysTick (100 Hz) or SOF. */
+#define PORTGREMLIN_PROFILE_HZ          1009
+#define PORTGREMLIN_PROFILE_MAX_HZ      20000
+
+void PortGremlinProfileInit(void);
+bool PortGremlinProfileStart(uint32_t ui32Hz);
+void PortGremlinProfileStop(void);
+void PortGremlinProfileDump(void);
+
+#endif
@@ -0,0 +1,245 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "portgremlin_sof.h"
+#include "portgremlin_oracle.h"
+#include "portgremlin_telemetry.h"
+#include "usblib/usblib.h"
+
+/* The USB frame number is 11 bits. */
+#define SOF_FRAME_MASK          0x7FFU
+
+/*
+ * The cycle counter wraps in under a minute at 80 MHz; gaps longer than
+ * this many SysTicks are timed in ticks instead.
+ */
+#define SOF_CYCLE_SPAN_TICKS    2000U
+
+typedef struct
+{
+    uint32_t ui32Frames;
+    uint32_t ui32LastFrame;
+    uint32_t ui32LastCycle;
+    uint32_t ui32LastTick;
+    bool bRunning;
+
+    /* Pending bus event to charge the next gap to, and when it happened. */
+    bool bGapOpen;
+    SofGapKind eGapKind;
+    uint32_t ui32MarkCycle;
+    uint32_t ui32MarkTick;
+
+    uint32_t ui32WindowFrames;
+    uint32_t ui32WindowCycle;
+    int32_t i32DriftPpm;
+    int32_t i32DriftMin;
+    int32_t i32DriftMax;
+    bool bDriftValid;
+
+    uint32_t ui32SessionFrame;
+    uint32_t ui32ConfigFrames;
+
+    uint32_t pui32Gaps[SOF_GAP_NUM][PORTGREMLIN_SOF_HIST_BINS];
+    uint32_t pui32Config[PORTGREMLIN_SOF_HIST_BINS];
+} SofState;
+
+static SofState g_sSof;
+static uint32_t g_ui32CyclesPerSecond;
+static uint32_t g_ui32CyclesPerFrame;
+
+static const char * const g_ppcGapNames[SOF_GAP_NUM] =
+{
+    "reset",
+    "suspend",
+    "idle"
+};
+
+/* Bin 0 holds 0, bin n holds [2^(n-1), 2^n), the last bin everything above. */
+static void SofHistAdd(uint32_t *pui32Bins, uint32_t ui32Value)
+{
+    uint32_t ui32Bin = 0;
+
+    while (ui32Value != 0U && ui32Bin < PORTGREMLIN_SOF_HIST_BINS - 1U)
+    {
+        ui32Value >>= 1;
+        ui32Bin++;
+    }
+    pui32Bins[ui32Bin]++;
+}
+
+static uint32_t SofMicroseconds(uint32_t ui32FromCycle, uint32_t ui32FromTick,
+                                uint32_t ui32NowCycle)
+{
+    uint32_t ui32Ticks = g_ui32SysTickCount - ui32FromTick;
+
+    if (ui32Ticks >= SOF_CYCLE_SPAN_TICKS || g_ui32CyclesPerSecond < 1000000U)
+    {
+        return ui32Ticks * PORTGREMLIN_SOF_FRAMES_PER_TICK * 1000U;
+    }
+    return (ui32NowCycle - ui32FromCycle) / (g_ui32CyclesPerSecond / 1000000U);
+}
+
+static void SofWindowRestart(uint32_t ui32Cycle)
+{
+    g_sSof.ui32WindowFrames = 0;
+    g_sSof.ui32WindowCycle = ui32Cycle;
+}
+
+static void SofDriftUpdate(uint32_t ui32Cycle)
+{
+    int64_t i64Expected = (int64_t)g_sSof.ui32WindowFrames * g_ui32CyclesPerFrame;
+    int64_t i64Actual = (int64_t)(uint32_t)(ui32Cycle - g_sSof.ui32WindowCycle);
+    int32_t i32Ppm = (int32_t)(((i64Actual - i64Expected) * 1000000) / i64Expected);
+
+    g_sSof.i32DriftPpm = i32Ppm;
+    if (!g_sSof.bDriftValid || i32Ppm < g_sSof.i32DriftMin)
+    {
+        g_sSof.i32DriftMin = i32Ppm;
+    }
+    if (!g_sSof.bDriftValid || i32Ppm > g_sSof.i32DriftMax)
+    {
+        g_sSof.i32DriftMax = i32Ppm;
+    }
+    g_sSof.bDriftValid = true;
+    SofWindowRestart(ui32Cycle);
+}
+
+static void SofCloseGap(SofGapKind eKind, uint32_t ui32Us)
+{
+    SofHistAdd(g_sSof.pui32Gaps[eKind], ui32Us / 1000U);
+    PortGremlinTelemetrySofGap(g_ppcGapNames[eKind], ui32Us);
+}
+
+void PortGremlinSofInit(uint32_t ui32CyclesPerSecond)
+{
+    g_ui32CyclesPerSecond = ui32CyclesPerSecond;
+    g_ui32CyclesPerFrame = ui32CyclesPerSecond / 1000U;
+    PortGremlinSofClear();
+}
+
+void PortGremlinSofClear(void)
+{
+    memset(&g_sSof, 0, sizeof(g_sSof));
+}
+
+/* Called from the USB0 interrupt with the current frame number. */
+void PortGremlinSofObserve(uint32_t ui32Frame)
+{
+    uint32_t ui32Cycle = PortGremlinCycleCount();
+    uint32_t ui32Delta;
+    uint32_t ui32Elapsed;
+
+    ui32Frame &= SOF_FRAME_MASK;
+    if (!g_sSof.bRunning)
+    {
+        if (g_sSof.bGapOpen)
+        {
+            SofCloseGap(g_sSof.eGapKind,
+                        SofMicroseconds(g_sSof.ui32MarkCycle, g_sSof.ui32MarkTick, ui32Cycle));
+            g_sSof.bGapOpen = false;
+        }
+        g_sSof.bRunning = true;
+        g_sSof.ui32Frames++;
+        SofWindowRestart(ui32Cycle);
+    }
+    else
+    {
+        /* Endpoint interrupts land within a frame; only new frames count. */
+        ui32Delta = (ui32Frame - g_sSof.ui32LastFrame) & SOF_FRAME_MASK;
+        if (ui32Delta == 0U)
+        {
+            return;
+        }
+        ui32Elapsed = ui32Cycle - g_sSof.ui32LastCycle;
+        g_sSof.ui32Frames += ui32Delta;
+
+        if (g_sSof.bGapOpen ||
+            g_ui32SysTickCount - g_sSof.ui32LastTick >= SOF_CYCLE_SPAN_TICKS ||
+            ui32Elapsed > ui32Delta * g_ui32CyclesPerFrame + g_ui32CyclesPerFrame / 2U)
+        {
+            SofCloseGap(g_sSof.bGapOpen ? g_sSof.eGapKind : SOF_GAP_IDLE,
+                        SofMicroseconds(g_sSof.ui32LastCycle, g_sSof.ui32LastTick, ui32Cycle));
+            g_sSof.bGapOpen = false;
+            SofWindowRestart(ui32Cycle);
+        }
+        else
+        {
+            g_sSof.ui32WindowFrames += ui32Delta;
+            if (g_sSof.ui32WindowFrames >= PORTGREMLIN_SOF_DRIFT_FRAMES &&
+                g_ui32CyclesPerFrame != 0U)
+            {
+                SofDriftUpdate(ui32Cycle);
+            }
+        }
+    }
+
+    g_sSof.ui32LastFrame = ui32Frame;
+    g_sSof.ui32LastCycle = ui32Cycle;
+    g_sSof.ui32LastTick = g_ui32SysTickCount;
+}
+
+/*
+ * Bus events from the Oracle. Resets and suspends open a gap that the next
+ * SOF closes. Returns the SOFs from CONNECTED to SET_CONFIGURATION on
+ * USB_EVENT_CONFIG_SET, 0 otherwise.
+ */
+uint32_t PortGremlinSofOnEvent(uint32_t ui32Event)
+{
+    switch (ui32Event)
+    {
+        case USB_EVENT_CONNECTED:
+            g_sSof.ui32SessionFrame = g_sSof.ui32Frames;
+            g_sSof.ui32ConfigFrames = 0;
+            break;
+
+        case USB_EVENT_RESET:
+        case USB_EVENT_SUSPEND:
+            if (!g_sSof.bGapOpen)
+            {
+                g_sSof.bGapOpen = true;
+                g_sSof.eGapKind = ui32Event == USB_EVENT_RESET ? SOF_GAP_RESET : SOF_GAP_SUSPEND;
+                g_sSof.ui32MarkCycle = PortGremlinCycleCount();
+                g_sSof.ui32MarkTick = g_ui32SysTickCount;
+            }
+            break;
+
+        case USB_EVENT_CONFIG_SET:
+            g_sSof.ui32ConfigFrames = g_sSof.ui32Frames - g_sSof.ui32SessionFrame;
+            SofHistAdd(g_sSof.pui32Config, g_sSof.ui32ConfigFrames);
+            PortGremlinTelemetrySof(g_sSof.ui32ConfigFrames, g_sSof.i32DriftPpm,
+                                    g_sSof.ui32Frames);
+            return g_sSof.ui32ConfigFrames;
+
+        case USB_EVENT_DISCONNECTED:
+            g_sSof.bRunning = false;
+            g_sSof.bGapOpen = false;
+            break;
+
+        default:
+            break;
+    }
+    return 0;
+}
+
+uint32_t PortGremlinSofFrames(void)
+{
+    return g_sSof.ui32Frames;
+}
+
+int32_t PortGremlinSofDriftPpm(void)
+{
+    return g_sSof.i32DriftPpm;
+}
+
+void PortGremlinSofDump(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < SOF_GAP_NUM; i++)
+    {
+        PortGremlinTelemetrySofHist(g_ppcGapNames[i], "ms", g_sSof.pui32Gaps[i]);
+    }
+    PortGremlinTelemetrySofHist("config", "frames", g_sSof.pui32Config);
+    PortGremlinTelemetrySofDrift(g_sSof.ui32Frames, g_sSof.i32DriftPpm,
+                                 g_sSof.i32DriftMin, g_sSof.i32DriftMax);
+}
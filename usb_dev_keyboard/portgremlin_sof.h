@@ -0,0 +1,41 @@
+#ifndef PORTGREMLIN_SOF_H
+#define PORTGREMLIN_SOF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Host frame clock. The USB0 vector hands every frame number it sees to
+ * PortGremlinSofObserve(), which stamps it with PortGremlinCycleCount().
+ * From that the module keeps the SOF count, the host frame period against
+ * the local crystal (ppm), the silent gaps around bus resets and suspends,
+ * and the reset-to-SET_CONFIGURATION latency in whole frames. Gaps and
+ * latencies go into log2 histograms that !sof dumps.
+ */
+
+#define PORTGREMLIN_SOF_HIST_BINS       16
+#define PORTGREMLIN_SOF_FRAMES_PER_TICK 10
+
+/* Frames per drift measurement. */
+#define PORTGREMLIN_SOF_DRIFT_FRAMES    1024
+
+typedef enum
+{
+    SOF_GAP_RESET = 0,
+    SOF_GAP_SUSPEND,
+    SOF_GAP_IDLE,
+    SOF_GAP_NUM
+} SofGapKind;
+
+/* Provided by the platform: a free-running 32-bit cycle counter. */
+uint32_t PortGremlinCycleCount(void);
+
+void PortGremlinSofInit(uint32_t ui32CyclesPerSecond);
+void PortGremlinSofObserve(uint32_t ui32Frame);
+uint32_t PortGremlinSofOnEvent(uint32_t ui32Event);
+uint32_t PortGremlinSofFrames(void);
+int32_t PortGremlinSofDriftPpm(void);
+void PortGremlinSofClear(void);
+void PortGremlinSofDump(void);
+
+#endif
@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "portgremlin_stack.h"
+#include "portgremlin_oracle.h"
+#include "portgremlin_telemetry.h"
+
+typedef struct
+{
+    PortGremlinMemLayout sLayout;
+    /* Deepest word found dirty so far; words below it still hold paint. */
+    const uint32_t *pui32Mark;
+    /* High-water at the last `stk` record, so each new low is reported once. */
+    uint32_t ui32Reported;
+    uint32_t ui32LastCheck;
+} StackState;
+
+static StackState g_sStack;
+
+/* Walks up from the base to the first dirty word, stopping at the last mark. */
+static void StackScan(void)
+{
+    const uint32_t *pui32Word = g_sStack.sLayout.pui32StackBase;
+
+    while (pui32Word < g_sStack.pui32Mark && *pui32Word == PORTGREMLIN_STACK_PAINT)
+    {
+        pui32Word++;
+    }
+    g_sStack.pui32Mark = pui32Word;
+}
+
+void PortGremlinStackInit(void)
+{
+    PortGremlinStackLayout(&g_sStack.sLayout);
+    g_sStack.pui32Mark = g_sStack.sLayout.pui32StackTop;
+    g_sStack.ui32Reported = 0;
+    g_sStack.ui32LastCheck = g_ui32SysTickCount;
+    StackScan();
+}
+
+uint32_t PortGremlinStackSize(void)
+{
+    return (uint32_t)((uintptr_t)g_sStack.sLayout.pui32StackTop -
+                      (uintptr_t)g_sStack.sLayout.pui32StackBase);
+}
+
+uint32_t PortGremlinStackHighWater(void)
+{
+    StackScan();
+    return (uint32_t)((uintptr_t)g_sStack.sLayout.pui32StackTop - (uintptr_t)g_sStack.pui32Mark);
+}
+
+/* Main loop: rescans now and then and reports each new low in the margin. */
+void PortGremlinStackService(void)
+{
+    uint32_t ui32Size;
+    uint32_t ui32Used;
+
+    if (g_ui32SysTickCount - g_sStack.ui32LastCheck < PORTGREMLIN_STACK_CHECK_TICKS)
+    {
+        return;
+    }
+    g_sStack.ui32LastCheck = g_ui32SysTickCount;
+
+    ui32Size = PortGremlinStackSize();
+    ui32Used = PortGremlinStackHighWater();
+    if (ui32Used <= g_sStack.ui32Reported || ui32Size - ui32Used >= PORTGREMLIN_STACK_WARN_BYTES)
+    {
+        return;
+    }
+    g_sStack.ui32Reported = ui32Used;
+    PortGremlinTelemetryStack(ui32Used, ui32Size);
+}
+
+void PortGremlinStackDump(void)
+{
+    const PortGremlinMemLayout *psLayout = &g_sStack.sLayout;
+
+    PortGremlinTelemetryMemory(PortGremlinStackHighWater(), PortGremlinStackSize(),
+                               psLayout->ui32Data, psLayout->ui32Bss,
+                               psLayout->ui32NoInit, psLayout->ui32Free);
+}
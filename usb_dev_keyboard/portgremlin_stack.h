@@ -0,0 +1,49 @@
+#ifndef PORTGREMLIN_STACK_H
+#define PORTGREMLIN_STACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Stack and SRAM headroom. Everything (main loop, usblib callbacks,
+ * UARTprintf's varargs, the ISRs) runs on the one __stack_size stack the
+ * linker script reserves above .noinit. The startup code paints the unused
+ * part of it with PORTGREMLIN_STACK_PAINT before main(); the deepest word
+ * no longer holding the paint is the high-water mark since reset.
+ *
+ * PortGremlinStackService() rescans from the main loop every
+ * PORTGREMLIN_STACK_CHECK_TICKS. Each scan stops at the previous mark, so it
+ * only ever reads the headroom that is left. A `stk` record goes out when
+ * the margin first drops below PORTGREMLIN_STACK_WARN_BYTES, and again
+ * every time it drops further. !mem reports the stack and the static SRAM
+ * budget; tools/portgremlin-memmap.py breaks the static part down by module.
+ */
+
+#define PORTGREMLIN_STACK_PAINT         0xC5C5C5C5U
+#define PORTGREMLIN_STACK_CHECK_TICKS   50
+#ifndef PORTGREMLIN_STACK_WARN_BYTES
+#define PORTGREMLIN_STACK_WARN_BYTES    256
+#endif
+
+typedef struct
+{
+    /* Lowest word of the stack, and one past its highest. */
+    uint32_t *pui32StackBase;
+    uint32_t *pui32StackTop;
+    /* Static SRAM, in bytes; free is what lies above the stack. */
+    uint32_t ui32Data;
+    uint32_t ui32Bss;
+    uint32_t ui32NoInit;
+    uint32_t ui32Free;
+} PortGremlinMemLayout;
+
+/* Provided by the platform. */
+void PortGremlinStackLayout(PortGremlinMemLayout *psLayout);
+
+void PortGremlinStackInit(void);
+void PortGremlinStackService(void);
+uint32_t PortGremlinStackHighWater(void);
+uint32_t PortGremlinStackSize(void);
+void PortGremlinStackDump(void);
+
+#endif
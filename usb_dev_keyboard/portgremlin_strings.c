@@ -202,7 +202,7 @@ void SetSerialNumberString(uint32_t ui32Value)
         g_pui8SerialNumberString[2 + i * 2] = ui8Char;
     }
 
-    if (g_sConfig.bMalformedMode && (rand() % 2))
+    if (PortGremlinConfigCurrent()->bMalformedMode && (rand() % 2))
     {
         CorruptString(g_pui8SerialNumberString);
     }
@@ -291,6 +291,8 @@ void PortGremlinSetIdentityStrings(const char *pcManufacturer, const char *pcPro
 
 void PortGremlinRandomizeIdentity(DeviceType eDevice)
 {
+    PortGremlinSettings sSettings;
+
     if (g_ePersona == PERSONA_MIMIC)
     {
         PortGremlinMimicApply(rand() % PortGremlinMimicCount(), NULL);
@@ -298,7 +300,8 @@ void PortGremlinRandomizeIdentity(DeviceType eDevice)
         return;
     }
 
-    if (g_sConfig.bRandomStrings)
+    PortGremlinConfigRead(&sSettings);
+    if (sSettings.bRandomStrings)
     {
         BuildRandomString(g_pui8ManufacturerString, STR_BUF_CHARS);
         BuildRandomString(ProductBufferForDevice(eDevice), STR_BUF_CHARS);
@@ -310,7 +313,7 @@ void PortGremlinRandomizeIdentity(DeviceType eDevice)
 
     SetSerialNumberString((uint32_t)(rand() ^ (rand() << 16)));
 
-    if (g_sConfig.bMalformedMode)
+    if (sSettings.bMalformedMode)
     {
         if (rand() % 2)
         {
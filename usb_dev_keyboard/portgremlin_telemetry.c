@@ -1,6 +1,8 @@
 #include <stdbool.h>
 #include "portgremlin_telemetry.h"
 #include "portgremlin_config.h"
+#include "portgremlin_evolve.h"
+#include "portgremlin_sof.h"
 #include "usb_keyb_structs.h"
 #include "usblib/device/usbdhidkeyb.h"
 #include "utils/uartstdio.h"
@@ -25,20 +27,27 @@ void PortGremlinTelemetryHost(HostProfile eHost, uint32_t ui32Latency, uint32_t
         return;
     }
 
-    UARTprintf("@PG{\"e\":\"host\",\"os\":\"%s\",\"lat\":%u,\"rst\":%u}\n\r",
-               PortGremlinHostName(eHost), ui32Latency, ui32Resets);
+    UARTprintf("@PG{\"e\":\"host\",\"os\":\"%s\",\"lat\":%u,\"rst\":%u,\"t\":%u}\n\r",
+               PortGremlinHostName(eHost), ui32Latency, ui32Resets, g_ui32SysTickCount);
 }
 
-void PortGremlinTelemetryEnum(uint16_t ui16VID, uint16_t ui16PID, const char *pcClass)
+void PortGremlinTelemetryEnum(uint16_t ui16VID, uint16_t ui16PID, uint16_t ui16MaxPowermA,
+                              uint8_t ui8PwrAttributes, const char *pcClass)
 {
+    PortGremlinSettings sSettings;
+    uint32_t ui32Version;
+
     if (!g_bTelemetryEnabled)
     {
         return;
     }
 
+    ui32Version = PortGremlinConfigRead(&sSettings);
     UARTprintf("@PG{\"e\":\"enum\",\"vid\":\"%04X\",\"pid\":\"%04X\",\"cls\":\"%s\","
-               "\"n\":%u}\n\r",
-               ui16VID, ui16PID, pcClass, g_sConfig.ui32EnumCount);
+               "\"n\":%u,\"gen\":%u,\"f\":%u,\"cv\":%u,\"mw\":%u,\"pa\":%u,\"t\":%u}\n\r",
+               ui16VID, ui16PID, pcClass, g_sConfig.ui32EnumCount,
+               g_ui32EvolveGeneration, PortGremlinConfigFlagsOf(&sSettings), ui32Version,
+               ui16MaxPowermA, ui8PwrAttributes, g_ui32SysTickCount);
 }
 
 void PortGremlinTelemetryPersona(GremlinPersona ePersona)
@@ -48,8 +57,8 @@ void PortGremlinTelemetryPersona(GremlinPersona ePersona)
         return;
     }
 
-    UARTprintf("@PG{\"e\":\"persona\",\"name\":\"%s\"}\n\r",
-               PortGremlinPersonaName(ePersona));
+    UARTprintf("@PG{\"e\":\"persona\",\"name\":\"%s\",\"t\":%u}\n\r",
+               PortGremlinPersonaName(ePersona), g_ui32SysTickCount);
 }
 
 void PortGremlinTelemetryBrain(BrainPhase ePhase, uint32_t ui32Tolerance)
@@ -59,8 +68,8 @@ void PortGremlinTelemetryBrain(BrainPhase ePhase, uint32_t ui32Tolerance)
         return;
     }
 
-    UARTprintf("@PG{\"e\":\"brain\",\"phase\":\"%s\",\"tol\":%u}\n\r",
-               PortGremlinBrainPhaseName(ePhase), ui32Tolerance);
+    UARTprintf("@PG{\"e\":\"brain\",\"phase\":\"%s\",\"tol\":%u,\"t\":%u}\n\r",
+               PortGremlinBrainPhaseName(ePhase), ui32Tolerance, g_ui32SysTickCount);
 }
 
 void PortGremlinTelemetryDisconnect(uint32_t ui32Total)
@@ -70,49 +79,243 @@ void PortGremlinTelemetryDisconnect(uint32_t ui32Total)
         return;
     }
 
-    UARTprintf("@PG{\"e\":\"disconnect\",\"total\":%u}\n\r", ui32Total);
+    UARTprintf("@PG{\"e\":\"disconnect\",\"total\":%u,\"t\":%u}\n\r",
+               ui32Total, g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryEvolve(uint32_t ui32Gen, const AttackGenome *psGenome)
+{
+    if (!g_bTelemetryEnabled)
+    {
+        return;
+    }
+
+    UARTprintf("@PG{\"e\":\"evolve\",\"gen\":%u,\"fit\":%u,\"int\":%u,\"mal\":%u,"
+               "\"rv\":%u,\"con\":%u,\"mut\":%u,\"t\":%u}\n\r",
+               ui32Gen, psGenome->ui32Fitness, psGenome->ui8Interval,
+               psGenome->ui8Malformed, psGenome->ui8RealVid,
+               psGenome->ui8Contradiction, psGenome->ui8Mutations, g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetrySof(uint32_t ui32ConfigFrames, int32_t i32DriftPpm, uint32_t ui32Frames)
+{
+    if (!g_bTelemetryEnabled)
+    {
+        return;
+    }
+
+    UARTprintf("@PG{\"e\":\"sof\",\"cfgf\":%u,\"ppm\":%d,\"n\":%u,\"t\":%u}\n\r",
+               ui32ConfigFrames, i32DriftPpm, ui32Frames, g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetrySofGap(const char *pcKind, uint32_t ui32Us)
+{
+    if (!g_bTelemetryEnabled)
+    {
+        return;
+    }
+
+    UARTprintf("@PG{\"e\":\"sofgap\",\"k\":\"%s\",\"us\":%u,\"t\":%u}\n\r",
+               pcKind, ui32Us, g_ui32SysTickCount);
+}
+
+/* Answers to !sof, so like acks they ignore the telemetry toggle. */
+void PortGremlinTelemetrySofHist(const char *pcKind, const char *pcUnit, const uint32_t *pui32Bins)
+{
+    uint32_t i;
+
+    UARTprintf("@PG{\"e\":\"sofh\",\"k\":\"%s\",\"u\":\"%s\",\"h\":[", pcKind, pcUnit);
+    for (i = 0; i < PORTGREMLIN_SOF_HIST_BINS; i++)
+    {
+        UARTprintf(i ? ",%u" : "%u", pui32Bins[i]);
+    }
+    UARTprintf("],\"t\":%u}\n\r", g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetrySofDrift(uint32_t ui32Frames, int32_t i32Ppm, int32_t i32Min,
+                                  int32_t i32Max)
+{
+    UARTprintf("@PG{\"e\":\"sofd\",\"n\":%u,\"ppm\":%d,\"min\":%d,\"max\":%d,\"t\":%u}\n\r",
+               ui32Frames, i32Ppm, i32Min, i32Max, g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryMutate(const PortGremlinDescSet *psSet)
+{
+    if (!g_bTelemetryEnabled)
+    {
+        return;
+    }
+
+    UARTprintf("@PG{\"e\":\"mut\",\"ops\":%u,\"ed\":%u,\"dl\":%u,\"cl\":%u,\"tl\":%u,"
+               "\"rl\":%u,\"t\":%u}\n\r",
+               psSet->ui32Ops, psSet->ui32Edits, psSet->pui8Device[0], psSet->ui32ConfigServe,
+               psSet->pui8Config[2] | (psSet->pui8Config[3] << 8), psSet->ui32ReportServe,
+               g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryAlias(uint32_t ui32Pos, uint16_t ui16VID, uint16_t ui16PID,
+                               const char *pcDriver)
+{
+    if (!g_bTelemetryEnabled)
+    {
+        return;
+    }
+
+    UARTprintf("@PG{\"e\":\"ali\",\"i\":%u,\"vid\":\"%04X\",\"pid\":\"%04X\",\"drv\":\"%s\","
+               "\"t\":%u}\n\r",
+               ui32Pos, ui16VID, ui16PID, pcDriver, g_ui32SysTickCount);
+}
+
+/* Answers to !ali, so like acks they ignore the telemetry toggle. */
+void PortGremlinTelemetryAliasStatus(uint32_t ui32Count, uint32_t ui32Pos)
+{
+    UARTprintf("@PG{\"e\":\"alis\",\"n\":%u,\"i\":%u,\"t\":%u}\n\r",
+               ui32Count, ui32Pos, g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryAliasDriver(uint16_t ui16VID, uint16_t ui16PID, const char *pcDriver)
+{
+    UARTprintf("@PG{\"e\":\"alid\",\"vid\":\"%04X\",\"pid\":\"%04X\",\"drv\":\"%s\",\"t\":%u}\n\r",
+               ui16VID, ui16PID, pcDriver ? pcDriver : "", g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryRecovery(const char *pcWhy, const char *pcAction, uint32_t ui32Try)
+{
+    if (!g_bTelemetryEnabled)
+    {
+        return;
+    }
+
+    UARTprintf("@PG{\"e\":\"rec\",\"why\":\"%s\",\"act\":\"%s\",\"try\":%u,\"t\":%u}\n\r",
+               pcWhy, pcAction, ui32Try, g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryRecovered(const char *pcWhy, uint32_t ui32DownTicks,
+                                   uint32_t ui32TotalDownTicks)
+{
+    if (!g_bTelemetryEnabled)
+    {
+        return;
+    }
+
+    UARTprintf("@PG{\"e\":\"recd\",\"why\":\"%s\",\"dn\":%u,\"tot\":%u,\"t\":%u}\n\r",
+               pcWhy, ui32DownTicks, ui32TotalDownTicks, g_ui32SysTickCount);
 }
 
-void PortGremlinTelemetryEvolve(uint32_t ui32Gen, uint32_t ui32Fitness)
+/* Answer to !hl, so like acks it ignores the telemetry toggle. */
+void PortGremlinTelemetryHealth(const PortGremlinHealthTotals *psTotals, bool bOutage)
+{
+    uint32_t ui32Up = psTotals->ui32UptimeTicks;
+    uint32_t ui32Down = psTotals->ui32DowntimeTicks < ui32Up ? psTotals->ui32DowntimeTicks : ui32Up;
+    uint32_t ui32PerMille = ui32Up / 1000U;
+    uint32_t ui32Duty = ui32PerMille ? (ui32Up - ui32Down) / ui32PerMille : 1000U;
+
+    UARTprintf("@PG{\"e\":\"hl\",\"boot\":%u,\"usb\":%u,\"full\":%u,\"wd\":%u,\"out\":%u,"
+               "\"dn\":%u,\"up\":%u,\"duty\":%u,\"open\":%u,\"t\":%u}\n\r",
+               psTotals->ui32Boots, psTotals->ui32UsbResets, psTotals->ui32FullResets,
+               psTotals->ui32WatchdogResets, psTotals->ui32Outages, ui32Down, ui32Up,
+               ui32Duty > 1000U ? 1000U : ui32Duty, bOutage ? 1U : 0U, g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryBandit(const char *pcArm, uint32_t ui32Reward, uint32_t ui32Mean,
+                                uint32_t ui32Pulls, const BanditRound *psRound)
+{
+    if (!g_bTelemetryEnabled)
+    {
+        return;
+    }
+
+    UARTprintf("@PG{\"e\":\"bnd\",\"arm\":\"%s\",\"r\":%u,\"mu\":%u,\"n\":%u,\"cfg\":%u,"
+               "\"dis\":%u,\"sig\":%u,\"uev\":%u,\"t\":%u}\n\r",
+               pcArm, ui32Reward, ui32Mean, ui32Pulls, psRound->ui32Configs,
+               psRound->ui32Disconnects, psRound->ui32Signatures, psRound->ui32Uevents,
+               g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryBanditStatus(bool bActive, const char *pcArm, uint32_t ui32Rounds,
+                                      uint32_t ui32RoundTicks)
+{
+    UARTprintf("@PG{\"e\":\"bnds\",\"on\":%u,\"arm\":\"%s\",\"k\":%u,\"in\":%u,\"t\":%u}\n\r",
+               bActive ? 1U : 0U, pcArm, ui32Rounds, ui32RoundTicks, g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryBanditArm(const char *pcArm, const BanditArm *psArm, uint32_t ui32Mean,
+                                   uint32_t ui32Index)
+{
+    UARTprintf("@PG{\"e\":\"bnda\",\"arm\":\"%s\",\"n\":%u,\"mu\":%u,\"ucb\":%u,"
+               "\"k\":%u,\"t\":%u}\n\r",
+               pcArm, psArm->ui32Pulls, ui32Mean, ui32Index, psArm->ui32Rounds, g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryStack(uint32_t ui32Used, uint32_t ui32Size)
 {
     if (!g_bTelemetryEnabled)
     {
         return;
     }
 
-    UARTprintf("@PG{\"e\":\"evolve\",\"gen\":%u,\"fit\":%u}\n\r", ui32Gen, ui32Fitness);
+    UARTprintf("@PG{\"e\":\"stk\",\"hw\":%u,\"sz\":%u,\"mg\":%u,\"t\":%u}\n\r",
+               ui32Used, ui32Size, ui32Size - ui32Used, g_ui32SysTickCount);
+}
+
+void PortGremlinTelemetryMemory(uint32_t ui32StackUsed, uint32_t ui32StackSize, uint32_t ui32Data,
+                                uint32_t ui32Bss, uint32_t ui32NoInit, uint32_t ui32Free)
+{
+    UARTprintf("@PG{\"e\":\"mem\",\"hw\":%u,\"sz\":%u,\"mg\":%u,\"data\":%u,\"bss\":%u,"
+               "\"ni\":%u,\"free\":%u,\"t\":%u}\n\r",
+               ui32StackUsed, ui32StackSize, ui32StackSize - ui32StackUsed, ui32Data, ui32Bss,
+               ui32NoInit, ui32Free, g_ui32SysTickCount);
 }
 
 void PortGremlinTelemetryCurrentIdentity(void)
 {
     uint16_t ui16VID = 0;
     uint16_t ui16PID = 0;
+    uint16_t ui16MaxPowermA = 0;
+    uint8_t ui8PwrAttributes = 0;
 
     switch (g_eCurrentDevice)
     {
         case DEVICE_KEYBOARD:
             ui16VID = g_sKeyboardDevice.ui16VID;
             ui16PID = g_sKeyboardDevice.ui16PID;
+            ui16MaxPowermA = g_sKeyboardDevice.ui16MaxPowermA;
+            ui8PwrAttributes = g_sKeyboardDevice.ui8PwrAttributes;
             break;
         case DEVICE_AUDIO:
             ui16VID = g_sAudioDevice.ui16VID;
             ui16PID = g_sAudioDevice.ui16PID;
+            ui16MaxPowermA = g_sAudioDevice.ui16MaxPowermA;
+            ui8PwrAttributes = g_sAudioDevice.ui8PwrAttributes;
             break;
         case DEVICE_GAMEPAD:
             ui16VID = g_sGamepadDevice.ui16VID;
             ui16PID = g_sGamepadDevice.ui16PID;
+            ui16MaxPowermA = g_sGamepadDevice.ui16MaxPowermA;
+            ui8PwrAttributes = g_sGamepadDevice.ui8PwrAttributes;
             break;
         case DEVICE_MIDI:
             ui16VID = g_sMIDIDevice.ui16VID;
             ui16PID = g_sMIDIDevice.ui16PID;
+            ui16MaxPowermA = g_sMIDIDevice.ui16MaxPowermA;
+            ui8PwrAttributes = g_sMIDIDevice.ui8PwrAttributes;
             break;
         case DEVICE_PRINTER:
             ui16VID = g_sPrinterDevice.ui16VID;
             ui16PID = g_sPrinterDevice.ui16PID;
+            ui16MaxPowermA = g_sPrinterDevice.ui16MaxPowermA;
+            ui8PwrAttributes = g_sPrinterDevice.ui8PwrAttributes;
             break;
         default:
             break;
     }
 
-    PortGremlinTelemetryEnum(ui16VID, ui16PID, PortGremlinDeviceName(g_eCurrentDevice));
+    PortGremlinTelemetryEnum(ui16VID, ui16PID, ui16MaxPowermA, ui8PwrAttributes,
+                             PortGremlinDeviceName(g_eCurrentDevice));
+}
+
+void PortGremlinTelemetryAck(const char *pcVerb, bool bOk)
+{
+    UARTprintf("@PG{\"e\":\"ack\",\"cmd\":\"%s\",\"ok\":%u,\"t\":%u}\n\r",
+               pcVerb, bOk ? 1U : 0U, g_ui32SysTickCount);
 }
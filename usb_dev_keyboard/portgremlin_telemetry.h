@@ -5,17 +5,46 @@
 #include <stdbool.h>
 #include "portgremlin_oracle.h"
 #include "portgremlin_persona.h"
+#include "portgremlin_evolve.h"
+#include "portgremlin_mutate.h"
+#include "portgremlin_health.h"
+#include "portgremlin_bandit.h"
 
 extern bool g_bTelemetryEnabled;
 
 void PortGremlinTelemetryInit(void);
 void PortGremlinTelemetryToggle(void);
 void PortGremlinTelemetryHost(HostProfile eHost, uint32_t ui32Latency, uint32_t ui32Resets);
-void PortGremlinTelemetryEnum(uint16_t ui16VID, uint16_t ui16PID, const char *pcClass);
+void PortGremlinTelemetryEnum(uint16_t ui16VID, uint16_t ui16PID, uint16_t ui16MaxPowermA,
+                              uint8_t ui8PwrAttributes, const char *pcClass);
 void PortGremlinTelemetryPersona(GremlinPersona ePersona);
 void PortGremlinTelemetryBrain(BrainPhase ePhase, uint32_t ui32Tolerance);
 void PortGremlinTelemetryDisconnect(uint32_t ui32Total);
-void PortGremlinTelemetryEvolve(uint32_t ui32Gen, uint32_t ui32Fitness);
+void PortGremlinTelemetryEvolve(uint32_t ui32Gen, const AttackGenome *psGenome);
+void PortGremlinTelemetrySof(uint32_t ui32ConfigFrames, int32_t i32DriftPpm, uint32_t ui32Frames);
+void PortGremlinTelemetrySofGap(const char *pcKind, uint32_t ui32Us);
+void PortGremlinTelemetrySofHist(const char *pcKind, const char *pcUnit, const uint32_t *pui32Bins);
+void PortGremlinTelemetrySofDrift(uint32_t ui32Frames, int32_t i32Ppm, int32_t i32Min,
+                                  int32_t i32Max);
+void PortGremlinTelemetryMutate(const PortGremlinDescSet *psSet);
+void PortGremlinTelemetryAlias(uint32_t ui32Pos, uint16_t ui16VID, uint16_t ui16PID,
+                               const char *pcDriver);
+void PortGremlinTelemetryAliasStatus(uint32_t ui32Count, uint32_t ui32Pos);
+void PortGremlinTelemetryAliasDriver(uint16_t ui16VID, uint16_t ui16PID, const char *pcDriver);
+void PortGremlinTelemetryRecovery(const char *pcWhy, const char *pcAction, uint32_t ui32Try);
+void PortGremlinTelemetryRecovered(const char *pcWhy, uint32_t ui32DownTicks,
+                                   uint32_t ui32TotalDownTicks);
+void PortGremlinTelemetryHealth(const PortGremlinHealthTotals *psTotals, bool bOutage);
+void PortGremlinTelemetryBandit(const char *pcArm, uint32_t ui32Reward, uint32_t ui32Mean,
+                                uint32_t ui32Pulls, const BanditRound *psRound);
+void PortGremlinTelemetryBanditStatus(bool bActive, const char *pcArm, uint32_t ui32Rounds,
+                                      uint32_t ui32RoundTicks);
+void PortGremlinTelemetryBanditArm(const char *pcArm, const BanditArm *psArm, uint32_t ui32Mean,
+                                   uint32_t ui32Index);
+void PortGremlinTelemetryStack(uint32_t ui32Used, uint32_t ui32Size);
+void PortGremlinTelemetryMemory(uint32_t ui32StackUsed, uint32_t ui32StackSize, uint32_t ui32Data,
+                                uint32_t ui32Bss, uint32_t ui32NoInit, uint32_t ui32Free);
 void PortGremlinTelemetryCurrentIdentity(void);
+void PortGremlinTelemetryAck(const char *pcVerb, bool bOk);
 
 #endif
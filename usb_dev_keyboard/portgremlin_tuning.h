@@ -0,0 +1,38 @@
+#ifndef PORTGREMLIN_TUNING_H
+#define PORTGREMLIN_TUNING_H
+
+/*
+ * Brain thresholds, persona cycle intervals and choreography dwell times.
+ * Generated by tools/portgremlin-sweep.py --emit; re-run the sweep rather
+ * than editing by hand.
+ *
+ * Hand-picked defaults, not yet swept.
+ */
+
+/* Brain: cumulative enumerations before each phase. */
+#define PORTGREMLIN_BRAIN_ESCALATE_ENUMS      15
+#define PORTGREMLIN_BRAIN_CORRUPT_ENUMS       40
+#define PORTGREMLIN_BRAIN_CHAOS_ENUMS         80
+#define PORTGREMLIN_BRAIN_CHAOS_INTERVAL      1
+
+/* Persona cycle intervals, in SysTicks. */
+#define PORTGREMLIN_CHIMERA_INTERVAL          3
+#define PORTGREMLIN_MIMIC_INTERVAL            15
+#define PORTGREMLIN_STORM_INTERVAL            1
+#define PORTGREMLIN_HAUNTED_INTERVAL          4
+#define PORTGREMLIN_PHANTOM_INTERVAL          50
+
+/* Choreography step dwell, in main-loop ticks. */
+#define PORTGREMLIN_REDTEAM_DWELL_0           80
+#define PORTGREMLIN_REDTEAM_DWELL_1           40
+#define PORTGREMLIN_REDTEAM_DWELL_2           20
+#define PORTGREMLIN_REDTEAM_DWELL_3           15
+#define PORTGREMLIN_REDTEAM_DWELL_4           10
+#define PORTGREMLIN_STEALTH_DWELL_0           120
+#define PORTGREMLIN_STEALTH_DWELL_1           60
+#define PORTGREMLIN_STEALTH_DWELL_2           60
+#define PORTGREMLIN_BLITZ_DWELL_0             10
+#define PORTGREMLIN_BLITZ_DWELL_1             5
+#define PORTGREMLIN_BLITZ_DWELL_2             5
+
+#endif
@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include "inc/hw_memmap.h"
 #include "driverlib/rom_map.h"
 #include "driverlib/uart.h"
@@ -11,6 +12,9 @@
 #include "portgremlin_mimic.h"
 #include "portgremlin_telemetry.h"
 #include "portgremlin_evolve.h"
+#include "portgremlin_cmd.h"
+#include "portgremlin_stack.h"
+#include "portgremlin_bandit.h"
 #include "usb_keyb_structs.h"
 
 static void PrintOnOff(bool bValue)
@@ -25,10 +29,12 @@ void PortGremlinUARTPrintHelp(void)
     UARTprintf("  h  - help          s  - status\n\r");
     UARTprintf("  a  - auto cycle    m  - malformed mode\n\r");
     UARTprintf("  r  - real VID DB    t  - random strings\n\r");
+    UARTprintf("  w  - driver alias walk\n\r");
     UARTprintf("  1-5- toggle class  +/- - interval\n\r");
     UARTprintf("  c  - force cycle    e  - re-enumerate\n\r");
     UARTprintf("--- ORACLE (novel) ---\n\r");
     UARTprintf("  b  - Gremlin Brain (autonomous escalation)\n\r");
+    UARTprintf("  n  - bandit persona scheduler (UCB)\n\r");
     UARTprintf("  p  - next attack persona\n\r");
     UARTprintf("  o  - oracle host fingerprint report\n\r");
     UARTprintf("  d  - driver confusion (same VID, diff class)\n\r");
@@ -39,25 +45,45 @@ void PortGremlinUARTPrintHelp(void)
     UARTprintf("  g  - genetic evolution engine\n\r");
     UARTprintf("  x  - overdrive (brain+evolve+choreo+telemetry)\n\r");
     UARTprintf("  l  - toggle JSON telemetry stream\n\r");
+    UARTprintf("--- Framed (host tools) ---\n\r");
+    UARTprintf("  !ping  !stop  !go  !cfg F  !seed S  !per N  !mim N  !sof [0]\n\r");
+    UARTprintf("  !id [VID PID CLS]  !pwr [MA ATTR]   (hex args)\n\r");
+    UARTprintf("  !cls MASK  !gen INT MAL RV CON [MUT]  !tlm 0|1\n\r");
+    UARTprintf("  !ali [POS | VID PID]   (walk status / rewind / driver lookup)\n\r");
+    UARTprintf("  !hl [0]   (recoveries, downtime, duty cycle / clear)\n\r");
+    UARTprintf("  !mem   (stack high-water, static SRAM)\n\r");
+    UARTprintf("  !bnd [0|1]  !fb SIGS [UEV]   (bandit arms / stop, start / host feedback)\n\r");
+#ifdef PORTGREMLIN_PROFILE
+    UARTprintf("  !prof [HZ]   (dump / restart sampling, 0 stops)\n\r");
+#endif
     UARTprintf("=====================================\n\r");
 }
 
 void PortGremlinUARTPrintStatus(void)
 {
+    PortGremlinSettings sSettings;
+    uint32_t ui32Version = PortGremlinConfigRead(&sSettings);
+
     UARTprintf("\n\r--- PortGremlin Status ---\n\r");
     UARTprintf("Device:      %s\n\r", PortGremlinDeviceName(g_eCurrentDevice));
-    UARTprintf("Auto cycle:  "); PrintOnOff(g_sConfig.bAutoCycle);
-    UARTprintf("Malformed:   "); PrintOnOff(g_sConfig.bMalformedMode);
-    UARTprintf("Real VID:    "); PrintOnOff(g_sConfig.bRealVIDPID);
-    UARTprintf("Rand strings:"); PrintOnOff(g_sConfig.bRandomStrings);
+    UARTprintf("Auto cycle:  "); PrintOnOff(sSettings.bAutoCycle);
+    UARTprintf("Malformed:   "); PrintOnOff(sSettings.bMalformedMode);
+    UARTprintf("Mutators:    0x%02x\n\r", sSettings.ui8MutateOps);
+    UARTprintf("Real VID:    "); PrintOnOff(sSettings.bRealVIDPID);
+    UARTprintf("Alias walk:  "); PrintOnOff(sSettings.bAliasWalk);
+    UARTprintf("Rand strings:"); PrintOnOff(sSettings.bRandomStrings);
     UARTprintf("Interval:    %u ticks (%u ms)\n\r",
-               g_sConfig.ui32CycleIntervalTicks,
-               g_sConfig.ui32CycleIntervalTicks * 10U);
+               sSettings.ui32CycleIntervalTicks,
+               sSettings.ui32CycleIntervalTicks * 10U);
     UARTprintf("Enums:       %u  Cycles: %u\n\r",
                g_sConfig.ui32EnumCount, g_sConfig.ui32CycleCount);
+    UARTprintf("Config ver:  %u\n\r", ui32Version);
     UARTprintf("Persona:     %s\n\r", PortGremlinPersonaName(g_ePersona));
+    UARTprintf("Stack:       %u/%u bytes\n\r",
+               PortGremlinStackHighWater(), PortGremlinStackSize());
     UARTprintf("Telemetry:   "); PrintOnOff(g_bTelemetryEnabled);
     UARTprintf("Evolution:   "); PrintOnOff(g_bEvolveActive);
+    UARTprintf("Bandit:      "); PrintOnOff(g_sBandit.bActive);
     if (g_bEvolveActive)
     {
         UARTprintf("  gen=%u fit=%u\n\r", g_ui32EvolveGeneration, g_sGenome.ui32Fitness);
@@ -66,24 +92,57 @@ void PortGremlinUARTPrintStatus(void)
     for (int i = 0; i < (int)NUM_DEVICE_TYPES; i++)
     {
         UARTprintf("%s=%s ", PortGremlinDeviceName((DeviceType)i),
-                   g_sConfig.bClassEnabled[i] ? "Y" : "N");
+                   sSettings.bClassEnabled[i] ? "Y" : "N");
     }
     UARTprintf("\n\r--------------------------\n\r");
 }
 
 static void ToggleClass(DeviceType eDevice)
 {
-    g_sConfig.bClassEnabled[eDevice] = !g_sConfig.bClassEnabled[eDevice];
+    PortGremlinSettings *psSettings = PortGremlinConfigBegin();
+
+    psSettings->bClassEnabled[eDevice] = !psSettings->bClassEnabled[eDevice];
+    PortGremlinConfigCommit();
+
     UARTprintf("%s: ", PortGremlinDeviceName(eDevice));
-    PrintOnOff(g_sConfig.bClassEnabled[eDevice]);
+    PrintOnOff(PortGremlinConfigCurrent()->bClassEnabled[eDevice]);
+}
+
+static void StepInterval(int32_t i32Step)
+{
+    PortGremlinSettings *psSettings = PortGremlinConfigBegin();
+    uint32_t ui32Old = psSettings->ui32CycleIntervalTicks;
+    uint32_t ui32New = ui32Old;
+
+    if (i32Step < 0 && ui32Old > PORTGREMLIN_CYCLE_INTERVAL_MIN)
+    {
+        ui32New = ui32Old - 1U;
+    }
+    else if (i32Step > 0 && ui32Old < PORTGREMLIN_CYCLE_INTERVAL_MAX)
+    {
+        ui32New = ui32Old + 1U;
+    }
+    psSettings->ui32CycleIntervalTicks = ui32New;
+    PortGremlinConfigCommit();
+
+    if (ui32New != ui32Old)
+    {
+        UARTprintf("Interval: %u ticks (%u ms)\n\r", ui32New, ui32New * 10U);
+    }
 }
 
 void PortGremlinUARTPoll(void)
 {
+    PortGremlinSettings *psSettings;
     int32_t i32Char;
 
     while ((i32Char = UARTCharGetNonBlocking(UART0_BASE)) >= 0)
     {
+        if (PortGremlinCmdFeed((char)i32Char))
+        {
+            continue;
+        }
+
         switch (i32Char)
         {
             case 'h':
@@ -98,30 +157,47 @@ void PortGremlinUARTPoll(void)
 
             case 'a':
             case 'A':
-                g_sConfig.bAutoCycle = !g_sConfig.bAutoCycle;
+                psSettings = PortGremlinConfigBegin();
+                psSettings->bAutoCycle = !psSettings->bAutoCycle;
+                PortGremlinConfigCommit();
                 UARTprintf("Auto cycle: ");
-                PrintOnOff(g_sConfig.bAutoCycle);
+                PrintOnOff(PortGremlinConfigCurrent()->bAutoCycle);
                 break;
 
             case 'm':
             case 'M':
-                g_sConfig.bMalformedMode = !g_sConfig.bMalformedMode;
+                psSettings = PortGremlinConfigBegin();
+                psSettings->bMalformedMode = !psSettings->bMalformedMode;
+                PortGremlinConfigCommit();
                 UARTprintf("Malformed mode: ");
-                PrintOnOff(g_sConfig.bMalformedMode);
+                PrintOnOff(PortGremlinConfigCurrent()->bMalformedMode);
                 break;
 
             case 'r':
             case 'R':
-                g_sConfig.bRealVIDPID = !g_sConfig.bRealVIDPID;
+                psSettings = PortGremlinConfigBegin();
+                psSettings->bRealVIDPID = !psSettings->bRealVIDPID;
+                PortGremlinConfigCommit();
                 UARTprintf("Real VID database: ");
-                PrintOnOff(g_sConfig.bRealVIDPID);
+                PrintOnOff(PortGremlinConfigCurrent()->bRealVIDPID);
+                break;
+
+            case 'w':
+            case 'W':
+                psSettings = PortGremlinConfigBegin();
+                psSettings->bAliasWalk = !psSettings->bAliasWalk;
+                PortGremlinConfigCommit();
+                UARTprintf("Driver alias walk: ");
+                PrintOnOff(PortGremlinConfigCurrent()->bAliasWalk);
                 break;
 
             case 't':
             case 'T':
-                g_sConfig.bRandomStrings = !g_sConfig.bRandomStrings;
+                psSettings = PortGremlinConfigBegin();
+                psSettings->bRandomStrings = !psSettings->bRandomStrings;
+                PortGremlinConfigCommit();
                 UARTprintf("Random strings: ");
-                PrintOnOff(g_sConfig.bRandomStrings);
+                PrintOnOff(PortGremlinConfigCurrent()->bRandomStrings);
                 break;
 
             case '1':
@@ -142,24 +218,12 @@ void PortGremlinUARTPoll(void)
 
             case '+':
             case '=':
-                if (g_sConfig.ui32CycleIntervalTicks > PORTGREMLIN_CYCLE_INTERVAL_MIN)
-                {
-                    g_sConfig.ui32CycleIntervalTicks--;
-                    UARTprintf("Interval: %u ticks (%u ms)\n\r",
-                               g_sConfig.ui32CycleIntervalTicks,
-                               g_sConfig.ui32CycleIntervalTicks * 10U);
-                }
+                StepInterval(-1);
                 break;
 
             case '-':
             case '_':
-                if (g_sConfig.ui32CycleIntervalTicks < PORTGREMLIN_CYCLE_INTERVAL_MAX)
-                {
-                    g_sConfig.ui32CycleIntervalTicks++;
-                    UARTprintf("Interval: %u ticks (%u ms)\n\r",
-                               g_sConfig.ui32CycleIntervalTicks,
-                               g_sConfig.ui32CycleIntervalTicks * 10U);
-                }
+                StepInterval(1);
                 break;
 
             case 'c':
@@ -181,6 +245,7 @@ void PortGremlinUARTPoll(void)
                 {
                     g_sOracle.eBrainPhase = BRAIN_IDLE;
                     PortGremlinChoreoStop();
+                    PortGremlinBanditStop();
                     UARTprintf("Gremlin Brain: ACTIVE\n\r");
                 }
                 else
@@ -190,6 +255,18 @@ void PortGremlinUARTPoll(void)
                 }
                 break;
 
+            case 'n':
+            case 'N':
+                if (g_sBandit.bActive)
+                {
+                    PortGremlinBanditStop();
+                }
+                else
+                {
+                    PortGremlinBanditStart();
+                }
+                break;
+
             case 'p':
             case 'P':
                 PortGremlinPersonaNext();
@@ -202,21 +279,33 @@ void PortGremlinUARTPoll(void)
 
             case 'd':
             case 'D':
-                g_sOracle.bContradictionMode = !g_sOracle.bContradictionMode;
-                if (g_sOracle.bContradictionMode)
+            {
+                bool bOn;
+
+                psSettings = PortGremlinConfigBegin();
+                bOn = !psSettings->bContradictionMode;
+
+                psSettings->bContradictionMode = bOn;
+                psSettings->bIdentityLocked = bOn;
+                if (bOn)
+                {
+                    psSettings->ui16PinnedVID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
+                    psSettings->ui16PinnedPID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
+                }
+                PortGremlinConfigCommit();
+
+                if (bOn)
                 {
-                    g_sOracle.ui16PinnedVID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
-                    g_sOracle.ui16PinnedPID = (uint16_t)(0x1000 + (rand() % 0xEFFF));
-                    g_sOracle.bIdentityLocked = true;
                     UARTprintf("Driver confusion ON VID=0x%04X PID=0x%04X\n\r",
-                               g_sOracle.ui16PinnedVID, g_sOracle.ui16PinnedPID);
+                               PortGremlinConfigCurrent()->ui16PinnedVID,
+                               PortGremlinConfigCurrent()->ui16PinnedPID);
                 }
                 else
                 {
-                    g_sOracle.bIdentityLocked = false;
                     UARTprintf("Driver confusion OFF\n\r");
                 }
                 break;
+            }
 
             case 'v':
             case 'V':
@@ -241,6 +330,7 @@ void PortGremlinUARTPoll(void)
             case 'x':
             case 'X':
                 g_bTelemetryEnabled = true;
+                PortGremlinBanditStop();
                 g_sOracle.bBrainActive = true;
                 g_sOracle.eBrainPhase = BRAIN_IDLE;
                 if (!g_bEvolveActive)
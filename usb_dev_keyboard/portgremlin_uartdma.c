@@ -0,0 +1,380 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_uart.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
+#include "utils/uartstdio.h"
+#include "portgremlin_uartdma.h"
+
+#define UART_DMA_MASK           (PORTGREMLIN_UART_DMA_RING - 1U)
+#define UART_DMA_CHANNEL        UDMA_CHANNEL_UART0TX
+#define UART_DMA_CHUNK          64
+
+/* Formatting stops here; numbers are at most 10 digits plus a sign. */
+#define UART_DMA_MAX_WIDTH      16
+
+static uint8_t g_pui8UartDmaRing[PORTGREMLIN_UART_DMA_RING];
+
+/*
+ * Free-running indices: [tail, queued) belongs to the µDMA, [queued, head)
+ * is waiting for a free control structure.
+ */
+static volatile uint32_t g_ui32UartDmaHead;
+static volatile uint32_t g_ui32UartDmaTail;
+static uint32_t g_ui32UartDmaQueued;
+
+/* Bytes armed in the primary (0) and alternate (1) structures. */
+static uint32_t g_pui32UartDmaSpan[2];
+
+/* The structure holding the oldest armed span. */
+static uint32_t g_ui32UartDmaNext;
+
+static tDMAControlTable g_psUartDmaTable[64] __attribute__((aligned(1024)));
+
+static uint32_t UartDmaSelect(uint32_t ui32Struct)
+{
+    return UART_DMA_CHANNEL | (ui32Struct ? UDMA_ALT_SELECT : UDMA_PRI_SELECT);
+}
+
+/* Hands the next contiguous run of queued text to one control structure. */
+static bool UartDmaArm(uint32_t ui32Struct)
+{
+    uint32_t ui32Offset = g_ui32UartDmaQueued & UART_DMA_MASK;
+    uint32_t ui32Len = g_ui32UartDmaHead - g_ui32UartDmaQueued;
+
+    if (ui32Len > PORTGREMLIN_UART_DMA_RING - ui32Offset)
+    {
+        ui32Len = PORTGREMLIN_UART_DMA_RING - ui32Offset;
+    }
+    if (ui32Len > PORTGREMLIN_UART_DMA_MAX_SPAN)
+    {
+        ui32Len = PORTGREMLIN_UART_DMA_MAX_SPAN;
+    }
+    if (ui32Len == 0U)
+    {
+        return false;
+    }
+
+    MAP_uDMAChannelTransferSet(UartDmaSelect(ui32Struct), UDMA_MODE_PINGPONG,
+                               &g_pui8UartDmaRing[ui32Offset],
+                               (void *)(UART0_BASE + UART_O_DR), ui32Len);
+    g_pui32UartDmaSpan[ui32Struct] = ui32Len;
+    g_ui32UartDmaQueued += ui32Len;
+    return true;
+}
+
+/*
+ * Retires finished spans in the order they were armed, refills whichever
+ * structures are free, and restarts the channel if it ran dry before the
+ * refill landed. Runs with interrupts masked.
+ */
+static void UartDmaService(void)
+{
+    uint32_t ui32Next = g_ui32UartDmaNext;
+
+    while (g_pui32UartDmaSpan[ui32Next] != 0U &&
+           MAP_uDMAChannelModeGet(UartDmaSelect(ui32Next)) == UDMA_MODE_STOP)
+    {
+        g_ui32UartDmaTail += g_pui32UartDmaSpan[ui32Next];
+        g_pui32UartDmaSpan[ui32Next] = 0;
+        ui32Next ^= 1U;
+    }
+    g_ui32UartDmaNext = ui32Next;
+
+    if (g_pui32UartDmaSpan[ui32Next] == 0U && !UartDmaArm(ui32Next))
+    {
+        return;
+    }
+    if (g_pui32UartDmaSpan[ui32Next ^ 1U] == 0U)
+    {
+        UartDmaArm(ui32Next ^ 1U);
+    }
+
+    if (!MAP_uDMAChannelIsEnabled(UART_DMA_CHANNEL))
+    {
+        if (ui32Next)
+        {
+            MAP_uDMAChannelAttributeEnable(UART_DMA_CHANNEL, UDMA_ATTR_ALTSELECT);
+        }
+        else
+        {
+            MAP_uDMAChannelAttributeDisable(UART_DMA_CHANNEL, UDMA_ATTR_ALTSELECT);
+        }
+        MAP_uDMAChannelEnable(UART_DMA_CHANNEL);
+    }
+}
+
+void UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
+{
+    (void)ui32PortNum;
+
+    MAP_UARTConfigSetExpClk(UART0_BASE, ui32SrcClock, ui32Baud,
+                            UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    MAP_UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+    MAP_UARTFIFOEnable(UART0_BASE);
+    MAP_UARTDMAEnable(UART0_BASE, UART_DMA_TX);
+
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    MAP_uDMAEnable();
+    MAP_uDMAControlBaseSet(g_psUartDmaTable);
+    MAP_uDMAChannelAssign(UDMA_CH9_UART0TX);
+    MAP_uDMAChannelAttributeDisable(UART_DMA_CHANNEL, UDMA_ATTR_ALL);
+    MAP_uDMAChannelControlSet(UART_DMA_CHANNEL | UDMA_PRI_SELECT,
+                              UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+    MAP_uDMAChannelControlSet(UART_DMA_CHANNEL | UDMA_ALT_SELECT,
+                              UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+
+    MAP_IntEnable(INT_UART0);
+}
+
+/* UART0 vector: the µDMA signals span completion on the peripheral's line. */
+void UARTStdioIntHandler(void)
+{
+    bool bMasked;
+
+    MAP_UARTIntClear(UART0_BASE, MAP_UARTIntStatus(UART0_BASE, true));
+    MAP_uDMAIntClear(1U << UART_DMA_CHANNEL);
+
+    bMasked = MAP_IntMasterDisable();
+    UartDmaService();
+    if (!bMasked)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+/* As uartstdio: "\n" goes out as "\r\n"; returns the input bytes taken. */
+int UARTwrite(const char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t ui32Idx;
+    uint32_t ui32Head;
+    bool bMasked = MAP_IntMasterDisable();
+
+    ui32Head = g_ui32UartDmaHead;
+    for (ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        uint32_t ui32Need = (pcBuf[ui32Idx] == '\n') ? 2U : 1U;
+
+        if (PORTGREMLIN_UART_DMA_RING - (ui32Head - g_ui32UartDmaTail) < ui32Need)
+        {
+            break;
+        }
+        if (pcBuf[ui32Idx] == '\n')
+        {
+            g_pui8UartDmaRing[ui32Head++ & UART_DMA_MASK] = '\r';
+        }
+        g_pui8UartDmaRing[ui32Head++ & UART_DMA_MASK] = (uint8_t)pcBuf[ui32Idx];
+    }
+    g_ui32UartDmaHead = ui32Head;
+    UartDmaService();
+
+    if (!bMasked)
+    {
+        MAP_IntMasterEnable();
+    }
+    return (int)ui32Idx;
+}
+
+/* Waits for everything written so far, or drops what is not yet armed. */
+void UARTFlushTx(bool bDiscard)
+{
+    bool bMasked;
+
+    if (bDiscard)
+    {
+        bMasked = MAP_IntMasterDisable();
+        g_ui32UartDmaHead = g_ui32UartDmaQueued;
+        if (!bMasked)
+        {
+            MAP_IntMasterEnable();
+        }
+        return;
+    }
+
+    /* Polls the channel itself, so it also works with interrupts masked. */
+    while (g_ui32UartDmaTail != g_ui32UartDmaHead)
+    {
+        bMasked = MAP_IntMasterDisable();
+        UartDmaService();
+        if (!bMasked)
+        {
+            MAP_IntMasterEnable();
+        }
+    }
+}
+
+/* --- UARTprintf: the uartstdio subset (%c %d %i %p %s %u %x %X, 0 and width) --- */
+
+typedef struct
+{
+    char pcBuf[UART_DMA_CHUNK];
+    uint32_t ui32Len;
+} UartDmaLine;
+
+static void UartDmaPutc(UartDmaLine *psLine, char cChar)
+{
+    if (psLine->ui32Len == UART_DMA_CHUNK)
+    {
+        UARTwrite(psLine->pcBuf, psLine->ui32Len);
+        psLine->ui32Len = 0;
+    }
+    psLine->pcBuf[psLine->ui32Len++] = cChar;
+}
+
+static uint32_t UartDmaPuts(UartDmaLine *psLine, const char *pcStr)
+{
+    uint32_t ui32Len = 0;
+
+    while (pcStr[ui32Len])
+    {
+        UartDmaPutc(psLine, pcStr[ui32Len++]);
+    }
+    return ui32Len;
+}
+
+static void UartDmaPutNumber(UartDmaLine *psLine, uint32_t ui32Value, uint32_t ui32Base,
+                             bool bNegative, bool bUpper, uint32_t ui32Width, char cFill)
+{
+    const char *pcDigits = bUpper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char pcTmp[UART_DMA_MAX_WIDTH];
+    uint32_t ui32Count = 0;
+
+    do
+    {
+        pcTmp[ui32Count++] = pcDigits[ui32Value % ui32Base];
+        ui32Value /= ui32Base;
+    } while (ui32Value != 0U && ui32Count < UART_DMA_MAX_WIDTH);
+
+    if (bNegative && cFill == '0')
+    {
+        UartDmaPutc(psLine, '-');
+    }
+    if (bNegative)
+    {
+        ui32Count++;
+    }
+    while (ui32Width > ui32Count)
+    {
+        UartDmaPutc(psLine, cFill);
+        ui32Width--;
+    }
+    if (bNegative)
+    {
+        ui32Count--;
+        if (cFill != '0')
+        {
+            UartDmaPutc(psLine, '-');
+        }
+    }
+    while (ui32Count != 0U)
+    {
+        UartDmaPutc(psLine, pcTmp[--ui32Count]);
+    }
+}
+
+void UARTvprintf(const char *pcString, va_list vaArgP)
+{
+    UartDmaLine sLine;
+
+    sLine.ui32Len = 0;
+    while (*pcString)
+    {
+        uint32_t ui32Width = 0;
+        char cFill = ' ';
+
+        if (*pcString != '%')
+        {
+            UartDmaPutc(&sLine, *pcString++);
+            continue;
+        }
+        pcString++;
+        if (*pcString == '0')
+        {
+            cFill = '0';
+            pcString++;
+        }
+        while (*pcString >= '0' && *pcString <= '9')
+        {
+            ui32Width = ui32Width * 10U + (uint32_t)(*pcString++ - '0');
+        }
+        if (ui32Width > UART_DMA_MAX_WIDTH)
+        {
+            ui32Width = UART_DMA_MAX_WIDTH;
+        }
+
+        switch (*pcString)
+        {
+            case 'c':
+                UartDmaPutc(&sLine, (char)va_arg(vaArgP, int));
+                break;
+
+            case 'd':
+            case 'i':
+            {
+                int32_t i32Value = va_arg(vaArgP, int32_t);
+                bool bNegative = i32Value < 0;
+
+                UartDmaPutNumber(&sLine, bNegative ? 0U - (uint32_t)i32Value : (uint32_t)i32Value,
+                                 10, bNegative, false, ui32Width, cFill);
+                break;
+            }
+
+            case 'u':
+                UartDmaPutNumber(&sLine, va_arg(vaArgP, uint32_t), 10, false, false,
+                                 ui32Width, cFill);
+                break;
+
+            case 'x':
+            case 'X':
+            case 'p':
+                UartDmaPutNumber(&sLine, va_arg(vaArgP, uint32_t), 16, false, *pcString == 'X',
+                                 ui32Width, cFill);
+                break;
+
+            case 's':
+            {
+                uint32_t ui32Len = UartDmaPuts(&sLine, va_arg(vaArgP, const char *));
+
+                while (ui32Width > ui32Len)
+                {
+                    UartDmaPutc(&sLine, ' ');
+                    ui32Width--;
+                }
+                break;
+            }
+
+            case '%':
+                UartDmaPutc(&sLine, '%');
+                break;
+
+            case '\0':
+                continue;
+
+            default:
+                UartDmaPuts(&sLine, "ERROR");
+                break;
+        }
+        pcString++;
+    }
+
+    if (sLine.ui32Len != 0U)
+    {
+        UARTwrite(sLine.pcBuf, sLine.ui32Len);
+    }
+}
+
+void UARTprintf(const char *pcString, ...)
+{
+    va_list vaArgP;
+
+    va_start(vaArgP, pcString);
+    UARTvprintf(pcString, vaArgP);
+    va_end(vaArgP);
+}
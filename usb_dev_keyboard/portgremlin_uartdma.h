@@ -0,0 +1,23 @@
+#ifndef PORTGREMLIN_UARTDMA_H
+#define PORTGREMLIN_UARTDMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * µDMA transmit path for UART0, built with `make UART_DMA=1` in place of
+ * uartstdio's output side. UARTprintf/UARTwrite copy into a ring and the
+ * µDMA (channel 9, ping-pong) moves contiguous spans of it into the UART
+ * FIFO; the UART0 interrupt only fires when a span completes, to retire it
+ * and queue the next. Like UART_BUFFERED, text that does not fit is dropped.
+ */
+
+/* Power of two. */
+#ifndef PORTGREMLIN_UART_DMA_RING
+#define PORTGREMLIN_UART_DMA_RING       2048
+#endif
+
+/* Largest single µDMA transfer. */
+#define PORTGREMLIN_UART_DMA_MAX_SPAN   1024
+
+#endif
@@ -1,8 +1,8 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include "portgremlin_config.h"
-#include "portgremlin_oracle.h"
 #include "portgremlin_vidpid.h"
+#include "portgremlin_alias.h"
 #include "usblib/device/usbdhidkeyb.h"
 
 static const uint16_t g_pui16KnownVIDs[] =
@@ -140,22 +140,48 @@ static void SetPowerFields(void *pDevice, VIDPIDDeviceType eType,
     }
 }
 
+static void ApplyPowerAttributes(void *pDevice, VIDPIDDeviceType eType,
+                                 const PortGremlinSettings *psSettings)
+{
+    if (psSettings->bPowerPinned)
+    {
+        SetPowerFields(pDevice, eType,
+                       psSettings->ui16PinnedPowermA,
+                       psSettings->ui8PinnedPwrAttributes);
+    }
+    else if (psSettings->bMalformedMode)
+    {
+        static const uint16_t g_pui16BadPower[] = { 0, 5000, 9999 };
+        static const uint8_t g_pui8BadAttr[] = { 0x00, 0xFF, 0x80 };
+
+        SetPowerFields(pDevice, eType,
+                       g_pui16BadPower[rand() % 3],
+                       g_pui8BadAttr[rand() % 3]);
+    }
+}
+
 void PortGremlinRandomizeVIDPID(void *pDevice, VIDPIDDeviceType eType)
 {
+    PortGremlinSettings sSettings;
     uint16_t ui16VID;
     uint16_t ui16PID;
 
-    if (g_sOracle.bContradictionMode || g_sOracle.bIdentityLocked)
+    PortGremlinConfigRead(&sSettings);
+    if (sSettings.bContradictionMode || sSettings.bIdentityLocked)
+    {
+        ui16VID = sSettings.ui16PinnedVID;
+        ui16PID = sSettings.ui16PinnedPID;
+    }
+    else if (sSettings.bAliasWalk && PortGremlinAliasNext(eType, &ui16VID, &ui16PID))
     {
-        ui16VID = g_sOracle.ui16PinnedVID;
-        ui16PID = g_sOracle.ui16PinnedPID;
+        /* An identity some host driver binds; see portgremlin_alias.c. */
     }
-    else if (g_sConfig.bMalformedMode)
+    else if (sSettings.bMalformedMode)
     {
         ui16VID = g_pui16MalformedVIDs[rand() % 2];
         ui16PID = g_pui16MalformedPIDs[rand() % 2];
     }
-    else if (g_sConfig.bRealVIDPID)
+    else if (sSettings.bRealVIDPID)
     {
         ui16VID = PickKnownVID();
         ui16PID = PickRandomPID();
@@ -167,25 +193,23 @@ void PortGremlinRandomizeVIDPID(void *pDevice, VIDPIDDeviceType eType)
     }
 
     SetVIDPID(pDevice, eType, ui16VID, ui16PID);
-    PortGremlinApplyPowerAttributes(pDevice, eType);
+    ApplyPowerAttributes(pDevice, eType, &sSettings);
 }
 
 void PortGremlinSetPinnedVIDPID(uint16_t ui16VID, uint16_t ui16PID)
 {
-    g_sOracle.ui16PinnedVID = ui16VID;
-    g_sOracle.ui16PinnedPID = ui16PID;
-    g_sOracle.bIdentityLocked = true;
+    PortGremlinSettings *psSettings = PortGremlinConfigBegin();
+
+    psSettings->ui16PinnedVID = ui16VID;
+    psSettings->ui16PinnedPID = ui16PID;
+    psSettings->bIdentityLocked = true;
+    PortGremlinConfigCommit();
 }
 
 void PortGremlinApplyPowerAttributes(void *pDevice, VIDPIDDeviceType eType)
 {
-    if (g_sConfig.bMalformedMode)
-    {
-        static const uint16_t g_pui16BadPower[] = { 0, 5000, 9999 };
-        static const uint8_t g_pui8BadAttr[] = { 0x00, 0xFF, 0x80 };
+    PortGremlinSettings sSettings;
 
-        SetPowerFields(pDevice, eType,
-                       g_pui16BadPower[rand() % 3],
-                       g_pui8BadAttr[rand() % 3]);
-    }
+    PortGremlinConfigRead(&sSettings);
+    ApplyPowerAttributes(pDevice, eType, &sSettings);
 }
@@ -0,0 +1,299 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+#include "driverlib/usb.h"
+#include "usblib/usblib.h"
+#include "usblib/usbhid.h"
+#include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdhid.h"
+#include "usblib/device/usbdhidkeyb.h"
+#include "drivers/buttons.h"
+#include "utils/uartstdio.h"
+#include "usb_keyb_structs.h"
+#include "portgremlin_config.h"
+#include "portgremlin_oracle.h"
+#include "qemu/portgremlin_qemu.h"
+
+/* SYSTICKS_PER_SECOND in usb_dev_keyboard.c. */
+#define QEMU_SYSTICKS_PER_SECOND    100
+#define QEMU_MS_PER_TICK            (1000 / QEMU_SYSTICKS_PER_SECOND)
+#define QEMU_ATTACH_TICKS           (PORTGREMLIN_QEMU_ATTACH_MS / QEMU_MS_PER_TICK)
+#define QEMU_CONFIG_TICKS           (PORTGREMLIN_QEMU_HOST_LATENCY_MS / QEMU_MS_PER_TICK)
+
+typedef enum
+{
+    QEMU_BUS_IDLE = 0,
+    QEMU_BUS_ATTACHING,
+    QEMU_BUS_ADDRESSED,
+    QEMU_BUS_CONFIGURED
+} QemuBusState;
+
+/* A point in time: SysTicks since boot plus cycles into the current one. */
+typedef struct
+{
+    uint32_t ui32Tick;
+    uint32_t ui32Cycle;
+} QemuStamp;
+
+static tUSBCallback g_pfnQemuCallback;
+static void *g_pvQemuCBData;
+static volatile QemuBusState g_eQemuBus;
+static volatile uint32_t g_ui32QemuWait;
+static bool g_bQemuHeld;
+static bool g_bQemuDetached;
+static bool g_bQemuWorking;
+static bool g_bQemuBooted;
+static uint32_t g_ui32QemuReadyCycles;
+static QemuStamp g_sQemuBoot;
+static QemuStamp g_sQemuWork;
+
+static void QemuStampNow(QemuStamp *psStamp)
+{
+    uint32_t ui32Tick;
+
+    do
+    {
+        ui32Tick = g_ui32SysTickCount;
+        psStamp->ui32Cycle = HWREG(NVIC_ST_RELOAD) - HWREG(NVIC_ST_CURRENT);
+    } while (ui32Tick != g_ui32SysTickCount);
+    psStamp->ui32Tick = ui32Tick;
+}
+
+/*
+ * Inside the SysTick handler (where auto-cycle re-enumerates) the tick
+ * count stands still, so a negative span means the counter wrapped once.
+ * Spans measured there must stay under one tick.
+ */
+static uint32_t QemuCyclesSince(const QemuStamp *psStart)
+{
+    QemuStamp sNow;
+    int64_t i64Span;
+    uint32_t ui32Period = HWREG(NVIC_ST_RELOAD) + 1U;
+
+    QemuStampNow(&sNow);
+    i64Span = (int64_t)(sNow.ui32Tick - psStart->ui32Tick) * ui32Period +
+              (int64_t)sNow.ui32Cycle - (int64_t)psStart->ui32Cycle;
+    if (i64Span < 0)
+    {
+        i64Span += ui32Period;
+    }
+    return (uint32_t)i64Span;
+}
+
+static void QemuEvent(uint32_t ui32Event)
+{
+    if (g_pfnQemuCallback)
+    {
+        g_pfnQemuCallback(g_pvQemuCBData, ui32Event, 0, NULL);
+    }
+}
+
+/* Every stack call after a disconnect is re-enumeration work; time it. */
+static void QemuStackCall(void)
+{
+    if (g_bQemuDetached)
+    {
+        g_bQemuDetached = false;
+        g_bQemuWorking = true;
+        QemuStampNow(&g_sQemuWork);
+    }
+}
+
+static void QemuAttach(tUSBCallback pfnCallback, void *pvCBData)
+{
+    if (g_ui32QemuReadyCycles == 0U)
+    {
+        g_ui32QemuReadyCycles = QemuCyclesSince(&g_sQemuBoot);
+    }
+    QemuStackCall();
+    g_pfnQemuCallback = pfnCallback;
+    g_pvQemuCBData = pvCBData;
+    if (!g_bQemuHeld)
+    {
+        g_ui32QemuWait = QEMU_ATTACH_TICKS;
+        g_eQemuBus = QEMU_BUS_ATTACHING;
+    }
+}
+
+void PortGremlinQemuInit(void)
+{
+    MAP_SysTickPeriodSet(MAP_SysCtlClockGet() / QEMU_SYSTICKS_PER_SECOND);
+    MAP_SysTickIntEnable();
+    MAP_SysTickEnable();
+    QemuStampNow(&g_sQemuBoot);
+}
+
+/* Called from SysTickIntHandler: steps the virtual host one tick. */
+void PortGremlinQemuTick(void)
+{
+    if (g_eQemuBus == QEMU_BUS_IDLE || g_eQemuBus == QEMU_BUS_CONFIGURED)
+    {
+        return;
+    }
+    if (g_ui32QemuWait > 1U)
+    {
+        g_ui32QemuWait--;
+        return;
+    }
+
+    if (g_eQemuBus == QEMU_BUS_ATTACHING)
+    {
+        QemuEvent(USB_EVENT_CONNECTED);
+        for (uint32_t i = 0; i < PORTGREMLIN_QEMU_HOST_RESETS; i++)
+        {
+            QemuEvent(USB_EVENT_RESET);
+        }
+        g_ui32QemuWait = QEMU_CONFIG_TICKS;
+        g_eQemuBus = QEMU_BUS_ADDRESSED;
+        return;
+    }
+
+    QemuEvent(USB_EVENT_CONFIG_SET);
+    g_eQemuBus = QEMU_BUS_CONFIGURED;
+    if (!g_bQemuBooted)
+    {
+        g_bQemuBooted = true;
+        UARTprintf("@PG{\"e\":\"qboot\",\"c\":%u,\"cfg\":%u,\"hz\":%u,\"t\":%u}\n\r",
+                   g_ui32QemuReadyCycles, QemuCyclesSince(&g_sQemuBoot),
+                   MAP_SysCtlClockGet(), g_ui32SysTickCount);
+    }
+}
+
+/* --- usblib and USB driverlib stand-ins --- */
+
+void USB0DeviceIntHandler(void)
+{
+}
+
+void USBStackModeSet(uint32_t ui32Index, tUSBMode iUSBMode, tUSBModeCallback pfnCallback)
+{
+    (void)ui32Index;
+    (void)iUSBMode;
+    (void)pfnCallback;
+}
+
+void USBDevDisconnect(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    g_bQemuHeld = true;
+    g_bQemuDetached = true;
+    g_eQemuBus = QEMU_BUS_IDLE;
+}
+
+void USBDevConnect(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    g_bQemuHeld = false;
+    if (g_bQemuWorking)
+    {
+        g_bQemuWorking = false;
+        UARTprintf("@PG{\"e\":\"qenum\",\"n\":%u,\"cy\":%u,\"c\":%u,\"t\":%u}\n\r",
+                   g_sConfig.ui32EnumCount, g_sConfig.ui32CycleCount,
+                   QemuCyclesSince(&g_sQemuWork), g_ui32SysTickCount);
+    }
+    if (g_pfnQemuCallback)
+    {
+        g_ui32QemuWait = QEMU_ATTACH_TICKS;
+        g_eQemuBus = QEMU_BUS_ATTACHING;
+    }
+}
+
+void *USBDHIDKeyboardInit(uint32_t ui32Index, tUSBDHIDKeyboardDevice *psHIDKbDevice)
+{
+    (void)ui32Index;
+    QemuAttach(psHIDKbDevice->pfnCallback, psHIDKbDevice->pvCBData);
+    return psHIDKbDevice;
+}
+
+void USBDHIDKeyboardTerm(void *pvKeyboardDevice)
+{
+    (void)pvKeyboardDevice;
+    QemuStackCall();
+    g_pfnQemuCallback = NULL;
+    g_eQemuBus = QEMU_BUS_IDLE;
+}
+
+uint32_t USBDHIDKeyboardKeyStateChange(void *pvKeyboardDevice, uint8_t ui8Modifiers,
+                                       uint8_t ui8UsageCode, bool bPress)
+{
+    (void)pvKeyboardDevice;
+    (void)ui8Modifiers;
+    (void)ui8UsageCode;
+    (void)bPress;
+    if (g_eQemuBus != QEMU_BUS_CONFIGURED)
+    {
+        return KEYB_ERR_NOT_CONFIGURED;
+    }
+    QemuEvent(USB_EVENT_TX_COMPLETE);
+    return KEYB_SUCCESS;
+}
+
+bool USBDHIDKeyboardRemoteWakeupRequest(void *pvKeyboardDevice)
+{
+    (void)pvKeyboardDevice;
+    return false;
+}
+
+bool USBDCDRemoteWakeupRequest(uint32_t ui32Index)
+{
+    (void)ui32Index;
+    return false;
+}
+
+/*
+ * Audio, MIDI, Printer and Gamepad all come through USBDCDInit() with
+ * their class struct as the callback data; the four share one layout.
+ */
+void USBDCDInit(uint32_t ui32Index, tDeviceInfo *psDevice, void *pvDCDCBData)
+{
+    tUSBAudioDevice *psClass = (tUSBAudioDevice *)pvDCDCBData;
+
+    (void)ui32Index;
+    (void)psDevice;
+    QemuAttach(psClass->pfnHandler, psClass->pvCBData);
+}
+
+/* The virtual host sends no control requests, so EP0 is never answered. */
+void USBDCDSendDataEP0(uint32_t ui32Index, uint8_t *pui8Data, uint32_t ui32Size)
+{
+    (void)ui32Index;
+    (void)pui8Data;
+    (void)ui32Size;
+}
+
+void USBDCDStallEP0(uint32_t ui32Index)
+{
+    (void)ui32Index;
+}
+
+void USBDevEndpointDataAck(uint32_t ui32Base, uint32_t ui32Endpoint, bool bIsLastPacket)
+{
+    (void)ui32Base;
+    (void)ui32Endpoint;
+    (void)bIsLastPacket;
+}
+
+/* lm3s6965evb has no LaunchPad switches; report them released. */
+void ButtonsInit(void)
+{
+}
+
+uint8_t ButtonsPoll(uint8_t *pui8Delta, uint8_t *pui8RawState)
+{
+    if (pui8Delta)
+    {
+        *pui8Delta = 0;
+    }
+    if (pui8RawState)
+    {
+        *pui8RawState = 0;
+    }
+    return 0;
+}
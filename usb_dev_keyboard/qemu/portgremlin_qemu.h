@@ -0,0 +1,35 @@
+#ifndef PORTGREMLIN_QEMU_H
+#define PORTGREMLIN_QEMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * QEMU flavor of the firmware, built by "make qemu" for qemu-system-arm
+ * -M lm3s6965evb. That board has the same UART0, GPIO and SysTick but no
+ * USB controller, so this file stands in for usblib and the USB driverlib
+ * calls: a virtual host answers every connect with CONNECTED, bus resets
+ * and SET_CONFIGURATION on SysTick boundaries, like the one cosim drives.
+ *
+ * Run under -icount the emulated SysTick counts guest instructions, which
+ * makes the cycle records repeatable enough for tools/portgremlin-qemu.py
+ * to hold them against a baseline. "qboot" gives the cycles from clock
+ * setup to the first USB stack init (c) and to the first SET_CONFIGURATION
+ * (cfg, which includes the virtual host's delays); "qenum" gives each
+ * re-enumeration's cycles from the first stack call after the D+ hold to
+ * reconnect.
+ */
+
+/* The host the virtual bus pretends to be; the defaults classify as Linux. */
+#ifndef PORTGREMLIN_QEMU_HOST_RESETS
+#define PORTGREMLIN_QEMU_HOST_RESETS        1
+#endif
+#ifndef PORTGREMLIN_QEMU_HOST_LATENCY_MS
+#define PORTGREMLIN_QEMU_HOST_LATENCY_MS    900
+#endif
+#define PORTGREMLIN_QEMU_ATTACH_MS          100
+
+void PortGremlinQemuInit(void);
+void PortGremlinQemuTick(void);
+
+#endif
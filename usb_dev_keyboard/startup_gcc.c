@@ -1,11 +1,12 @@
 #include <stdint.h>
+#include "portgremlin_stack.h"
 
 extern uint32_t __stack_top;
 
 extern int main(void);
 extern void SysTickIntHandler(void);
 extern void UARTStdioIntHandler(void);
-extern void USB0DeviceIntHandler(void);
+extern void PortGremlinUSBIntHandler(void);
 
 __attribute__((used))
 void Default_Handler(void)
@@ -16,7 +17,7 @@ void Default_Handler(void)
 #define WEAK_DEFAULT __attribute__((weak, alias("Default_Handler")))
 
 void Reset_Handler(void);
-void WEAK_DEFAULT NMI_Handler(void);
+void WEAK_DEFAULT PortGremlinWatchdogIntHandler(void);
 void WEAK_DEFAULT HardFault_Handler(void);
 void WEAK_DEFAULT MemManage_Handler(void);
 void WEAK_DEFAULT BusFault_Handler(void);
@@ -25,13 +26,14 @@ void WEAK_DEFAULT SVC_Handler(void);
 void WEAK_DEFAULT DebugMon_Handler(void);
 void WEAK_DEFAULT PendSV_Handler(void);
 void WEAK_DEFAULT SysTickIntHandler(void);
+void WEAK_DEFAULT PortGremlinProfileIntHandler(void);
 
 __attribute__((section(".vectors")))
 void (* const g_pfnVectorTable[])(void) =
 {
     (void (*)(void))&__stack_top,
     Reset_Handler,
-    NMI_Handler,
+    PortGremlinWatchdogIntHandler,
     HardFault_Handler,
     MemManage_Handler,
     BusFault_Handler,
@@ -63,6 +65,7 @@ void (* const g_pfnVectorTable[])(void) =
     Default_Handler,
     Default_Handler,
     Default_Handler,
+    PortGremlinProfileIntHandler,
     Default_Handler,
     Default_Handler,
     Default_Handler,
@@ -85,6 +88,7 @@ void (* const g_pfnVectorTable[])(void) =
     Default_Handler,
     Default_Handler,
     Default_Handler,
+    PortGremlinUSBIntHandler,
     Default_Handler,
     Default_Handler,
     Default_Handler,
@@ -92,8 +96,6 @@ void (* const g_pfnVectorTable[])(void) =
     Default_Handler,
     Default_Handler,
     Default_Handler,
-    USB0DeviceIntHandler,
-    Default_Handler,
     Default_Handler,
     Default_Handler,
     Default_Handler,
@@ -215,6 +217,7 @@ extern uint32_t __data_end;
 extern uint32_t __data_load;
 extern uint32_t __bss_start;
 extern uint32_t __bss_end;
+extern uint32_t __stack_start;
 
 void Reset_Handler(void)
 {
@@ -229,6 +232,12 @@ void Reset_Handler(void)
     while (dst < &__bss_end)
         *dst++ = 0;
 
+    /* Paint the stack below this frame for the high-water mark. */
+    __asm volatile ("mov %0, sp" : "=r" (src));
+    dst = &__stack_start;
+    while (dst < src)
+        *dst++ = PORTGREMLIN_STACK_PAINT;
+
     main();
     while (1);
 }
@@ -7,6 +7,7 @@
 #include "inc/hw_types.h"
 #include "inc/hw_gpio.h"
 #include "inc/hw_sysctl.h"
+#include "inc/hw_usb.h"
 #include "driverlib/debug.h"
 #include "driverlib/fpu.h"
 #include "driverlib/gpio.h"
@@ -16,6 +17,7 @@
 #include "driverlib/sysctl.h"
 #include "driverlib/systick.h"
 #include "driverlib/uart.h"
+#include "driverlib/watchdog.h"
 #include "usblib/usblib.h"
 #include "usblib/usbhid.h"
 #include "usblib/device/usbdevice.h"
@@ -31,11 +33,30 @@
 #include "portgremlin_uart.h"
 #include "portgremlin_evolve.h"
 #include "portgremlin_telemetry.h"
+#include "portgremlin_sof.h"
+#include "portgremlin_mutate.h"
+#include "portgremlin_descriptors.h"
+#include "portgremlin_health.h"
+#include "portgremlin_stack.h"
+#include "portgremlin_bandit.h"
+#ifdef PORTGREMLIN_PROFILE
+#include "portgremlin_profile.h"
+#endif
+#ifdef PORTGREMLIN_QEMU
+#include "qemu/portgremlin_qemu.h"
+#endif
 
 #define SYSTICKS_PER_SECOND     100
 #define USB_RESUME_DURATION_MS  15
 #define MAX_SEND_DELAY          50
 
+/* Cortex-M4 DWT cycle counter; inc/hw_nvic.h stops short of the DWT. */
+#define DWT_DEMCR               0xE000EDFC
+#define DWT_DEMCR_TRCENA        0x01000000
+#define DWT_CTRL                0xE0001000
+#define DWT_CTRL_CYCCNTENA      0x00000001
+#define DWT_CYCCNT              0xE0001004
+
 static const int8_t g_ppi8KeyUsageCodes[][2] =
 {
     { 0, HID_KEYB_USAGE_SPACE },                       //   0x20
@@ -162,6 +183,7 @@ void __error__(char *pcFilename, uint32_t ui32Line) { }
 
 static void SendString(char *pcStr);
 static bool WaitForSendIdle(uint_fast32_t ui32TimeoutTicks);
+static void WatchdogFeed(void);
 
 uint32_t KeyboardHandler(void *pvCBData, uint32_t ui32Event,
                           uint32_t ui32MsgData, void *pvMsgData)
@@ -348,6 +370,8 @@ static bool WaitForSendIdle(uint_fast32_t ui32TimeoutTicks)
         if (g_eKeyboardState == STATE_IDLE)
             return true;
 
+        WatchdogFeed();
+
         uint32_t ui32Now = g_ui32SysTickCount;
         ui32Elapsed = (ui32Start < ui32Now)
             ? (ui32Now - ui32Start)
@@ -463,74 +487,353 @@ void RandomizeVIDPID(void *pDevice, VIDPIDDeviceType type)
     PortGremlinRandomizeVIDPID(pDevice, type);
 }
 
-void USBAudioDeviceInit(uint32_t ui32Index, tUSBAudioDevice *pDevice)
+void USBRemoteWakeup(void)
 {
-    USBDCDInit(ui32Index, (tDeviceInfo *)pDevice, pDevice);
+    if (g_bSuspended)
+    {
+        USBDCDRemoteWakeupRequest(0);
+        UARTprintf("Sent USB remote wake-up signal\n\r");
+    }
 }
 
-void USBPrinterDeviceInit(uint32_t ui32Index, tUSBPrinterDevice *pDevice)
+void USBDeviceRemoteWakeupRequest(void *pDevice)
 {
-    USBDCDInit(ui32Index, (tDeviceInfo *)pDevice, pDevice);
+    (void)pDevice;
+    USBRemoteWakeup();
 }
 
-void USBMIDIDeviceInit(uint32_t ui32Index, tUSBMIDIDevice *pDevice)
+void USBGamepadRemoteWakeupRequest(void *pDevice)
 {
-    USBDCDInit(ui32Index, (tDeviceInfo *)pDevice, pDevice);
+    USBDeviceRemoteWakeupRequest(pDevice);
 }
 
-void USBAudioInit(uint32_t ui32Index, tUSBAudioDevice *pDevice)
+void USBAudioRemoteWakeupRequest(void *pDevice)
 {
-    USBAudioDeviceInit(ui32Index, pDevice);
+    USBDeviceRemoteWakeupRequest(pDevice);
 }
 
-void USBDHIDGamepadInit(uint32_t ui32Index, tUSBDHIDGamepadDevice *pDevice)
+void USBMIDIRemoteWakeupRequest(void *pDevice)
 {
-    USBDHIDInit(ui32Index, (tUSBDHIDDevice *)pDevice);
+    USBDeviceRemoteWakeupRequest(pDevice);
 }
 
-void USBPrinterInit(uint32_t ui32Index, tUSBPrinterDevice *pDevice)
+void USBPrinterRemoteWakeupRequest(void *pDevice)
 {
-    USBPrinterDeviceInit(ui32Index, pDevice);
+    USBDeviceRemoteWakeupRequest(pDevice);
 }
 
-void USBMIDIInit(uint32_t ui32Index, tUSBMIDIDevice *pDevice)
+/*
+ * usblib answers GET_DESCRIPTOR through the tDeviceInfo the class driver
+ * registered, and the HID class serves the report descriptor through its
+ * psHIDDescriptor/ppui8ClassDescriptors. With malformed mode and mutation
+ * operators on, all three are repointed at the mutation arena right after
+ * the class init, before the host gets to ask.
+ */
+static tConfigSection g_sMutateSection;
+static const tConfigSection *g_ppsMutateSections[] = { &g_sMutateSection };
+static const tConfigHeader g_sMutateConfig = { 1, g_ppsMutateSections };
+static const tConfigHeader * const g_ppsMutateConfigs[] = { &g_sMutateConfig };
+static const uint8_t *g_ppui8MutateClassDescriptors[1];
+
+static const PortGremlinDescSet *MutateDescriptors(tDeviceInfo *psInfo,
+                                                   const uint8_t *pui8Report,
+                                                   uint32_t ui32ReportLen)
 {
-    USBMIDIDeviceInit(ui32Index, pDevice);
+    const PortGremlinSettings *psSettings = PortGremlinConfigCurrent();
+    uint8_t *pui8Config = PortGremlinMutateConfigSlot();
+    const tConfigHeader *psHeader;
+    const PortGremlinDescSet *psSet;
+    uint32_t ui32Len = 0;
+
+    if (!psSettings->bMalformedMode || psSettings->ui8MutateOps == 0U ||
+        !psInfo->pui8DeviceDescriptor || !psInfo->ppsConfigDescriptors)
+    {
+        return NULL;
+    }
+
+    psHeader = psInfo->ppsConfigDescriptors[0];
+    for (uint32_t i = 0; i < psHeader->ui8NumSections; i++)
+    {
+        const tConfigSection *psSection = psHeader->psSections[i];
+
+        if (ui32Len + psSection->ui16Size > PORTGREMLIN_MUTATE_CONFIG_BYTES)
+        {
+            return NULL;
+        }
+        memcpy(pui8Config + ui32Len, psSection->pui8Data, psSection->ui16Size);
+        ui32Len += psSection->ui16Size;
+    }
+
+    if (!PortGremlinMutateLoad(psInfo->pui8DeviceDescriptor, pui8Config, ui32Len,
+                               pui8Report, ui32ReportLen))
+    {
+        return NULL;
+    }
+    psSet = PortGremlinMutateApply(psSettings->ui8MutateOps);
+
+    g_sMutateSection.ui16Size = (uint16_t)psSet->ui32ConfigServe;
+    g_sMutateSection.pui8Data = psSet->pui8Config;
+    psInfo->pui8DeviceDescriptor = psSet->pui8Device;
+    psInfo->ppsConfigDescriptors = g_ppsMutateConfigs;
+    return psSet;
 }
 
-void USBRemoteWakeup(void)
+static void KeyboardDeviceInit(void)
 {
-    if (g_bSuspended)
+    tUSBDHIDDevice *psHID = &g_sKeyboardDevice.sPrivateData.sHIDDevice;
+    const PortGremlinDescSet *psSet;
+
+    USBDHIDKeyboardInit(0, &g_sKeyboardDevice);
+    psSet = MutateDescriptors(&psHID->sPrivateData.sDevInfo, psHID->ppui8ClassDescriptors[0],
+                              psHID->psHIDDescriptor->sClassDescriptor[0].wDescriptorLength);
+    if (psSet && psSet->pui8HIDDescriptor)
     {
-        USBDCDRemoteWakeupRequest(0);
-        UARTprintf("Sent USB remote wake-up signal\n\r");
+        g_ppui8MutateClassDescriptors[0] = psSet->pui8Report;
+        psHID->psHIDDescriptor = (const tHIDDescriptor *)psSet->pui8HIDDescriptor;
+        psHID->ppui8ClassDescriptors = g_ppui8MutateClassDescriptors;
     }
 }
 
-void USBDeviceRemoteWakeupRequest(void *pDevice)
+/*
+ * Audio, MIDI, Printer and Gamepad have no usblib class driver here; they
+ * are served from the flash tables in portgremlin_descriptors.c by this
+ * one. usblib handles the standard requests from the tDeviceInfo below and
+ * configures the endpoints from the descriptors; the callbacks answer the
+ * few class requests hosts send during bind (HID SET_IDLE/GET_REPORT,
+ * printer GET_DEVICE_ID/GET_PORT_STATUS) and turn bus events into the
+ * Oracle's events. Only the device descriptor and configuration header
+ * live in RAM, for VID/PID and power.
+ */
+#define PRINTER_GET_DEVICE_ID       0x00
+#define PRINTER_GET_PORT_STATUS     0x01
+#define PRINTER_STATUS_SELECTED     0x18
+#define CLASS_REPORT_BYTES          8
+
+typedef struct
 {
-    (void)pDevice;
-    USBRemoteWakeup();
+    tDeviceInfo sDevInfo;
+    tConfigSection sHeaderSection;
+    tConfigSection sBodySection;
+    const tConfigSection *ppsSections[2];
+    tConfigHeader sConfigHeader;
+    const tConfigHeader *ppsConfigs[1];
+    uint8_t pui8Device[PORTGREMLIN_DESC_DEVICE_LEN];
+    uint8_t pui8ConfigHeader[PORTGREMLIN_DESC_CONFIG_LEN];
+    const PortGremlinClassDescriptors *psDesc;
+    const uint8_t *pui8Report;
+    uint32_t ui32ReportLen;
+    tUSBCallback pfnHandler;
+    void *pvCBData;
+    bool bSession;
+} ClassDevice;
+
+static ClassDevice g_sClassDevice;
+
+static void ClassEvent(uint32_t ui32Event)
+{
+    if (g_sClassDevice.pfnHandler)
+    {
+        g_sClassDevice.pfnHandler(g_sClassDevice.pvCBData, ui32Event, 0, NULL);
+    }
 }
 
-void USBGamepadRemoteWakeupRequest(void *pDevice)
+static void ClassSendEP0(const uint8_t *pui8Data, uint32_t ui32Len, uint16_t ui16Requested)
 {
-    USBDeviceRemoteWakeupRequest(pDevice);
+    MAP_USBDevEndpointDataAck(USB0_BASE, USB_EP_0, false);
+    USBDCDSendDataEP0(0, (uint8_t *)pui8Data, ui32Len < ui16Requested ? ui32Len : ui16Requested);
 }
 
-void USBAudioRemoteWakeupRequest(void *pDevice)
+static void ClassGetDescriptor(void *pvInstance, tUSBRequest *psRequest)
 {
-    USBDeviceRemoteWakeupRequest(pDevice);
+    (void)pvInstance;
+    if ((psRequest->wValue >> 8) == USB_HID_DTYPE_REPORT && g_sClassDevice.pui8Report)
+    {
+        ClassSendEP0(g_sClassDevice.pui8Report, g_sClassDevice.ui32ReportLen,
+                     psRequest->wLength);
+        return;
+    }
+    USBDCDStallEP0(0);
 }
 
-void USBMIDIRemoteWakeupRequest(void *pDevice)
+static void ClassRequest(void *pvInstance, tUSBRequest *psRequest)
 {
-    USBDeviceRemoteWakeupRequest(pDevice);
+    static const uint8_t pui8Zero[CLASS_REPORT_BYTES] = { 0 };
+    static const uint8_t ui8PortStatus = PRINTER_STATUS_SELECTED;
+    const PortGremlinClassDescriptors *psDesc = g_sClassDevice.psDesc;
+
+    (void)pvInstance;
+    if ((psRequest->bmRequestType & USB_RTYPE_TYPE_M) != USB_RTYPE_CLASS || !psDesc)
+    {
+        USBDCDStallEP0(0);
+        return;
+    }
+
+    if (psDesc->pui8DeviceID)
+    {
+        if (psRequest->bRequest == PRINTER_GET_DEVICE_ID)
+        {
+            ClassSendEP0(psDesc->pui8DeviceID, psDesc->ui16DeviceIDLen, psRequest->wLength);
+            return;
+        }
+        if (psRequest->bRequest == PRINTER_GET_PORT_STATUS)
+        {
+            ClassSendEP0(&ui8PortStatus, 1, psRequest->wLength);
+            return;
+        }
+    }
+    else if (psDesc->pui8Report)
+    {
+        switch (psRequest->bRequest)
+        {
+            case USBREQ_SET_IDLE:
+            case USBREQ_SET_PROTOCOL:
+                MAP_USBDevEndpointDataAck(USB0_BASE, USB_EP_0, true);
+                return;
+
+            case USBREQ_GET_REPORT:
+                ClassSendEP0(pui8Zero, sizeof(pui8Zero), psRequest->wLength);
+                return;
+
+            default:
+                break;
+        }
+    }
+    USBDCDStallEP0(0);
 }
 
-void USBPrinterRemoteWakeupRequest(void *pDevice)
+static void ClassConfigChange(void *pvInstance, uint32_t ui32Info)
 {
-    USBDeviceRemoteWakeupRequest(pDevice);
+    (void)pvInstance;
+    if (ui32Info != 0U)
+    {
+        ClassEvent(USB_EVENT_CONFIG_SET);
+    }
+}
+
+/* The first reset of a session is the host noticing the device. */
+static void ClassReset(void *pvInstance)
+{
+    (void)pvInstance;
+    if (!g_sClassDevice.bSession)
+    {
+        g_sClassDevice.bSession = true;
+        ClassEvent(USB_EVENT_CONNECTED);
+    }
+    ClassEvent(USB_EVENT_RESET);
+}
+
+static void ClassSuspend(void *pvInstance)
+{
+    (void)pvInstance;
+    ClassEvent(USB_EVENT_SUSPEND);
+}
+
+static void ClassResume(void *pvInstance)
+{
+    (void)pvInstance;
+    ClassEvent(USB_EVENT_RESUME);
+}
+
+static void ClassDisconnect(void *pvInstance)
+{
+    (void)pvInstance;
+    g_sClassDevice.bSession = false;
+    ClassEvent(USB_EVENT_DISCONNECTED);
+}
+
+static const tCustomHandlers g_sClassHandlers =
+{
+    .pfnGetDescriptor = ClassGetDescriptor,
+    .pfnRequestHandler = ClassRequest,
+    .pfnConfigChange = ClassConfigChange,
+    .pfnResetHandler = ClassReset,
+    .pfnSuspendHandler = ClassSuspend,
+    .pfnResumeHandler = ClassResume,
+    .pfnDisconnectHandler = ClassDisconnect,
+};
+
+/* The gamepad, audio, MIDI and printer structs share one layout. */
+static void ClassDeviceInit(uint32_t ui32Index, DeviceType eDevice, void *pvDevice)
+{
+    const tUSBAudioDevice *psClass = (const tUSBAudioDevice *)pvDevice;
+    ClassDevice *psDev = &g_sClassDevice;
+    const PortGremlinClassDescriptors *psDesc = PortGremlinDescriptorsFor(eDevice);
+    const PortGremlinDescSet *psSet;
+
+    if (!psDesc)
+    {
+        return;
+    }
+
+    psDev->psDesc = psDesc;
+    psDev->pfnHandler = psClass->pfnHandler;
+    psDev->pvCBData = psClass->pvCBData;
+    psDev->bSession = false;
+    psDev->pui8Report = psDesc->pui8Report;
+    psDev->ui32ReportLen = psDesc->ui16ReportLen;
+
+    PortGremlinDescriptorsDevice(eDevice, psClass->ui16VID, psClass->ui16PID, psDev->pui8Device);
+    PortGremlinDescriptorsConfigHeader(eDevice, psClass->ui16MaxPowermA,
+                                       psClass->ui8PwrAttributes, psDev->pui8ConfigHeader);
+    psDev->sHeaderSection.ui16Size = PORTGREMLIN_DESC_CONFIG_LEN;
+    psDev->sHeaderSection.pui8Data = psDev->pui8ConfigHeader;
+    psDev->sBodySection.ui16Size = psDesc->ui16ConfigLen - PORTGREMLIN_DESC_CONFIG_LEN;
+    psDev->sBodySection.pui8Data = psDesc->pui8Config + PORTGREMLIN_DESC_CONFIG_LEN;
+    psDev->ppsSections[0] = &psDev->sHeaderSection;
+    psDev->ppsSections[1] = &psDev->sBodySection;
+    psDev->sConfigHeader.ui8NumSections = 2;
+    psDev->sConfigHeader.psSections = psDev->ppsSections;
+    psDev->ppsConfigs[0] = &psDev->sConfigHeader;
+
+    psDev->sDevInfo.psCallbacks = &g_sClassHandlers;
+    psDev->sDevInfo.pui8DeviceDescriptor = psDev->pui8Device;
+    psDev->sDevInfo.ppsConfigDescriptors = psDev->ppsConfigs;
+    psDev->sDevInfo.ppui8StringDescriptors = psClass->ppui8StringDescriptors;
+    psDev->sDevInfo.ui32NumStringDescriptors = psClass->ui32NumStringDescriptors;
+
+    psSet = MutateDescriptors(&psDev->sDevInfo, psDev->pui8Report, psDev->ui32ReportLen);
+    if (psSet && psDev->pui8Report)
+    {
+        psDev->pui8Report = psSet->pui8Report;
+        psDev->ui32ReportLen = psSet->ui32ReportServe;
+    }
+
+    USBDCDInit(ui32Index, &psDev->sDevInfo, pvDevice);
+}
+
+void USBAudioDeviceInit(uint32_t ui32Index, tUSBAudioDevice *pDevice)
+{
+    ClassDeviceInit(ui32Index, DEVICE_AUDIO, pDevice);
+}
+
+void USBPrinterDeviceInit(uint32_t ui32Index, tUSBPrinterDevice *pDevice)
+{
+    ClassDeviceInit(ui32Index, DEVICE_PRINTER, pDevice);
+}
+
+void USBMIDIDeviceInit(uint32_t ui32Index, tUSBMIDIDevice *pDevice)
+{
+    ClassDeviceInit(ui32Index, DEVICE_MIDI, pDevice);
+}
+
+void USBAudioInit(uint32_t ui32Index, tUSBAudioDevice *pDevice)
+{
+    USBAudioDeviceInit(ui32Index, pDevice);
+}
+
+void USBDHIDGamepadInit(uint32_t ui32Index, tUSBDHIDGamepadDevice *pDevice)
+{
+    ClassDeviceInit(ui32Index, DEVICE_GAMEPAD, pDevice);
+}
+
+void USBPrinterInit(uint32_t ui32Index, tUSBPrinterDevice *pDevice)
+{
+    USBPrinterDeviceInit(ui32Index, pDevice);
+}
+
+void USBMIDIInit(uint32_t ui32Index, tUSBMIDIDevice *pDevice)
+{
+    USBMIDIDeviceInit(ui32Index, pDevice);
 }
 
 void ReenumerateWithRandomVIDPID(VIDPIDDeviceType deviceType)
@@ -549,7 +852,7 @@ void ReenumerateWithRandomVIDPID(VIDPIDDeviceType deviceType)
             PortGremlinRandomizeVIDPID(&g_sKeyboardDevice, VIDPID_TYPE_KEYBOARD);
             UARTprintf("New VID: 0x%04X, PID: 0x%04X\n\r",
                 g_sKeyboardDevice.ui16VID, g_sKeyboardDevice.ui16PID);
-            USBDHIDKeyboardInit(0, &g_sKeyboardDevice);
+            KeyboardDeviceInit();
             break;
 
         case VIDPID_TYPE_AUDIO:
@@ -590,26 +893,14 @@ void ReenumerateWithRandomVIDPID(VIDPIDDeviceType deviceType)
     PortGremlinOracleOnEnumerate();
     PortGremlinEvolveTick();
     USBDevConnect(USB0_BASE);
-}
-
-static VIDPIDDeviceType DeviceTypeToVIDPID(DeviceType eDevice)
-{
-    switch (eDevice)
-    {
-        case DEVICE_KEYBOARD: return VIDPID_TYPE_KEYBOARD;
-        case DEVICE_AUDIO:    return VIDPID_TYPE_AUDIO;
-        case DEVICE_PRINTER:  return VIDPID_TYPE_PRINTER;
-        case DEVICE_MIDI:     return VIDPID_TYPE_MIDI;
-        case DEVICE_GAMEPAD:  return VIDPID_TYPE_GAMEPAD;
-        default:              return VIDPID_TYPE_GENERIC;
-    }
+    PortGremlinHealthOnConnect();
 }
 
 void CycleDeviceType(void)
 {
     DeviceType eNext = PortGremlinNextEnabledDevice(g_eCurrentDevice);
 
-    if (eNext == g_eCurrentDevice && !g_sConfig.bClassEnabled[g_eCurrentDevice])
+    if (eNext == g_eCurrentDevice && !PortGremlinConfigCurrent()->bClassEnabled[g_eCurrentDevice])
     {
         UARTprintf("No enabled device classes.\n\r");
         return;
@@ -629,7 +920,7 @@ void CycleDeviceType(void)
             g_pActiveDevice = &g_sKeyboardDevice;
             PortGremlinRandomizeVIDPID(&g_sKeyboardDevice, VIDPID_TYPE_KEYBOARD);
             g_eCurrentDeviceType = VIDPID_TYPE_KEYBOARD;
-            USBDHIDKeyboardInit(0, &g_sKeyboardDevice);
+            KeyboardDeviceInit();
             break;
 
         case DEVICE_AUDIO:
@@ -674,43 +965,213 @@ void CycleDeviceType(void)
 
     g_sConfig.ui32CycleCount++;
     USBDevConnect(USB0_BASE);
+    PortGremlinHealthOnConnect();
+}
+
+static void ServiceForcedEnumeration(void)
+{
+    if (g_sConfig.bForceCycle)
+    {
+        g_sConfig.bForceCycle = false;
+        CycleDeviceType();
+    }
+    else if (g_sConfig.bForceReenum)
+    {
+        g_sConfig.bForceReenum = false;
+        ReenumerateWithRandomVIDPID(g_eCurrentDeviceType);
+    }
+}
+
+/* Brings the current class back up with the identity it already has. */
+static void StartCurrentDevice(void)
+{
+    switch (g_eCurrentDeviceType)
+    {
+        case VIDPID_TYPE_KEYBOARD:
+            KeyboardDeviceInit();
+            break;
+        case VIDPID_TYPE_AUDIO:
+            USBAudioInit(0, &g_sAudioDevice);
+            break;
+        case VIDPID_TYPE_GAMEPAD:
+            USBDHIDGamepadInit(0, &g_sGamepadDevice);
+            break;
+        case VIDPID_TYPE_MIDI:
+            USBMIDIInit(0, &g_sMIDIDevice);
+            break;
+        case VIDPID_TYPE_PRINTER:
+            USBPrinterInit(0, &g_sPrinterDevice);
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * The health supervisor's targeted recovery: the host has gone quiet or a
+ * report never completed, so reset the controller and usblib's view of it
+ * rather than the whole campaign.
+ */
+void PortGremlinHealthResetUSB(void)
+{
+    UARTprintf("No progress; resetting the USB controller...\n\r");
+
+    USBDevDisconnect(USB0_BASE);
+    if (g_eCurrentDeviceType == VIDPID_TYPE_KEYBOARD)
+    {
+        USBDHIDKeyboardTerm(&g_sKeyboardDevice);
+    }
+#ifndef PORTGREMLIN_QEMU
+    MAP_SysCtlPeripheralReset(SYSCTL_PERIPH_USB0);
+#endif
+    SysCtlDelay(SysCtlClockGet() / 3);
+
+    g_bConnected = false;
+    g_bSuspended = false;
+    g_eKeyboardState = STATE_UNCONFIGURED;
+    g_eAudioState = STATE_UNCONFIGURED;
+    g_eMidiState = STATE_UNCONFIGURED;
+    g_eGamepadState = STATE_UNCONFIGURED;
+    g_ePrinterState = STATE_UNCONFIGURED;
+
+    USBStackModeSet(0, eUSBModeForceDevice, 0);
+    StartCurrentDevice();
+    USBDevConnect(USB0_BASE);
+    PortGremlinHealthOnConnect();
+}
+
+/* The checkpoint is already written; let the last records out first. */
+void PortGremlinHealthResetSystem(void)
+{
+    UARTFlushTx(false);
+    MAP_SysCtlReset();
+}
+
+/*
+ * First watchdog timeout, raised as an NMI so it gets in even while an ISR
+ * is wedged. Checkpoint and reset now rather than wait for the second.
+ */
+void PortGremlinWatchdogIntHandler(void)
+{
+    PortGremlinHealthOnWatchdog();
+    MAP_SysCtlReset();
+}
+
+static void WatchdogInit(void)
+{
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_WDOG0);
+#ifndef PORTGREMLIN_QEMU
+    /* The lm3s6965 has no peripheral-ready registers; they read as zero. */
+    while (!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_WDOG0))
+    {
+    }
+#endif
+
+    MAP_WatchdogReloadSet(WATCHDOG0_BASE,
+                          MAP_SysCtlClockGet() / 1000U * PORTGREMLIN_HEALTH_WATCHDOG_MS);
+    MAP_WatchdogIntTypeSet(WATCHDOG0_BASE, WATCHDOG_INT_TYPE_NMI);
+    MAP_WatchdogResetEnable(WATCHDOG0_BASE);
+    MAP_WatchdogStallEnable(WATCHDOG0_BASE);
+    MAP_WatchdogEnable(WATCHDOG0_BASE);
+}
+
+static void WatchdogFeed(void)
+{
+    MAP_WatchdogIntClear(WATCHDOG0_BASE);
+}
+
+extern uint32_t __data_start, __data_end, __bss_start, __bss_end;
+extern uint32_t __noinit_start, __noinit_end, __stack_start, __stack_top, __sram_end;
+
+void PortGremlinStackLayout(PortGremlinMemLayout *psLayout)
+{
+    psLayout->pui32StackBase = &__stack_start;
+    psLayout->pui32StackTop = &__stack_top;
+    psLayout->ui32Data = (uint32_t)&__data_end - (uint32_t)&__data_start;
+    psLayout->ui32Bss = (uint32_t)&__bss_end - (uint32_t)&__bss_start;
+    psLayout->ui32NoInit = (uint32_t)&__noinit_end - (uint32_t)&__noinit_start;
+    psLayout->ui32Free = (uint32_t)&__sram_end - (uint32_t)&__stack_top;
+}
+
+/* QEMU's lm3s6965evb has no DWT, and no USB to take SOFs from. */
+static void CycleCounterInit(void)
+{
+#ifndef PORTGREMLIN_QEMU
+    HWREG(DWT_DEMCR) |= DWT_DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+#endif
+}
+
+uint32_t PortGremlinCycleCount(void)
+{
+#ifdef PORTGREMLIN_QEMU
+    return 0;
+#else
+    return HWREG(DWT_CYCCNT);
+#endif
+}
+
+/*
+ * USB0 vector. usblib keeps the SOF interrupt enabled, so this sees every
+ * frame; the frame number is read before usblib gets to run.
+ */
+void PortGremlinUSBIntHandler(void)
+{
+    PortGremlinSofObserve(HWREG(USB0_BASE + USB_O_FRAME));
+    USB0DeviceIntHandler();
 }
 
 void SysTickIntHandler(void)
 {
     static uint32_t ui32TickCounter = 0;
+    PortGremlinSettings sSettings;
     g_ui32SysTickCount++;
 
-    if (!g_sConfig.bAutoCycle)
+#ifdef PORTGREMLIN_QEMU
+    PortGremlinQemuTick();
+#endif
+
+    PortGremlinHealthTick(g_eKeyboardState == STATE_SENDING);
+
+    PortGremlinConfigRead(&sSettings);
+    if (!sSettings.bAutoCycle)
     {
         return;
     }
 
     ui32TickCounter++;
-    if (ui32TickCounter < g_sConfig.ui32CycleIntervalTicks)
+    if (ui32TickCounter < sSettings.ui32CycleIntervalTicks)
     {
         return;
     }
     ui32TickCounter = 0;
 
-    if (!g_sConfig.bClassEnabled[g_eCurrentDevice])
+    if (!sSettings.bClassEnabled[g_eCurrentDevice])
     {
         g_eCurrentDevice = PortGremlinNextEnabledDevice(g_eCurrentDevice);
-        g_eCurrentDeviceType = DeviceTypeToVIDPID(g_eCurrentDevice);
+        g_eCurrentDeviceType = PortGremlinDeviceVIDPIDType(g_eCurrentDevice);
     }
 
     ReenumerateWithRandomVIDPID(g_eCurrentDeviceType);
     g_eCurrentDevice = PortGremlinNextEnabledDevice(g_eCurrentDevice);
-    g_eCurrentDeviceType = DeviceTypeToVIDPID(g_eCurrentDevice);
+    g_eCurrentDeviceType = PortGremlinDeviceVIDPIDType(g_eCurrentDevice);
 }
 
 int main(void)
 {
+    uint32_t ui32ResetCause;
+
     MAP_FPULazyStackingEnable();
     MAP_SysCtlClockSet(SYSCTL_SYSDIV_4 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN |
                        SYSCTL_XTAL_16MHZ);
+#ifdef PORTGREMLIN_QEMU
+    PortGremlinQemuInit();
+#endif
 
     srand(MAP_SysCtlClockGet());
+    ui32ResetCause = MAP_SysCtlResetCauseGet();
+    MAP_SysCtlResetCauseClear(ui32ResetCause);
 
     ConfigureUART();
     PortGremlinConfigInit();
@@ -718,9 +1179,15 @@ int main(void)
     PortGremlinPersonaInit();
     PortGremlinTelemetryInit();
     PortGremlinEvolveInit();
+    PortGremlinBanditInit();
+    CycleCounterInit();
+    PortGremlinSofInit(MAP_SysCtlClockGet());
     UsbKeybStructsInit();
     UARTprintf("PortGremlin - Closed-Loop USB Enumeration Attack Platform\n\r");
     PortGremlinUARTPrintHelp();
+    PortGremlinHealthInit((ui32ResetCause & SYSCTL_CAUSE_POR) != 0U,
+                          (ui32ResetCause & SYSCTL_CAUSE_WDOG0) != 0U);
+    PortGremlinStackInit();
 
     MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOD);
     MAP_GPIOPinTypeUSBAnalog(GPIO_PORTD_BASE, GPIO_PIN_4 | GPIO_PIN_5);
@@ -749,11 +1216,17 @@ int main(void)
     g_pActiveDevice = &g_sKeyboardDevice;
     PortGremlinRandomizeIdentity(DEVICE_KEYBOARD);
     PortGremlinRandomizeVIDPID(&g_sKeyboardDevice, VIDPID_TYPE_KEYBOARD);
-    USBDHIDKeyboardInit(0, &g_sKeyboardDevice);
+    KeyboardDeviceInit();
+    PortGremlinHealthOnConnect();
 
     MAP_SysTickPeriodSet(MAP_SysCtlClockGet() / SYSTICKS_PER_SECOND);
     MAP_SysTickIntEnable();
     MAP_SysTickEnable();
+    WatchdogInit();
+
+#ifdef PORTGREMLIN_PROFILE
+    PortGremlinProfileInit();
+#endif
 
     while (1)
     {
@@ -766,8 +1239,13 @@ int main(void)
         {
             PortGremlinUARTPoll();
             PortGremlinBrainTick();
+            PortGremlinBanditTick();
             PortGremlinChoreoTick();
             PortGremlinEvolveTick();
+            ServiceForcedEnumeration();
+            PortGremlinHealthService();
+            PortGremlinStackService();
+            WatchdogFeed();
         }
 
         UARTprintf("Host connected.\n\r");
@@ -782,19 +1260,13 @@ int main(void)
 
             PortGremlinUARTPoll();
             PortGremlinBrainTick();
+            PortGremlinBanditTick();
             PortGremlinChoreoTick();
             PortGremlinEvolveTick();
-
-            if (g_sConfig.bForceCycle)
-            {
-                g_sConfig.bForceCycle = false;
-                CycleDeviceType();
-            }
-            else if (g_sConfig.bForceReenum)
-            {
-                g_sConfig.bForceReenum = false;
-                ReenumerateWithRandomVIDPID(g_eCurrentDeviceType);
-            }
+            ServiceForcedEnumeration();
+            PortGremlinHealthService();
+            PortGremlinStackService();
+            WatchdogFeed();
 
             if (bLastSuspend != g_bSuspended)
             {
@@ -98,6 +98,12 @@ extern const uint8_t * const g_ppui8StringDescriptorsGamepad[];
 extern const uint8_t * const g_ppui8StringDescriptorsPrinter[];
 extern const uint8_t * const g_ppui8StringDescriptorsMIDI[];
 
+/* Served from the descriptor tables in portgremlin_descriptors.c. */
+void USBAudioInit(uint32_t ui32Index, tUSBAudioDevice *pDevice);
+void USBPrinterInit(uint32_t ui32Index, tUSBPrinterDevice *pDevice);
+void USBMIDIInit(uint32_t ui32Index, tUSBMIDIDevice *pDevice);
+void USBDHIDGamepadInit(uint32_t ui32Index, tUSBDHIDGamepadDevice *pDevice);
+
 void SetSerialNumberString(uint32_t value);
 void UsbKeybStructsInit(void);
 